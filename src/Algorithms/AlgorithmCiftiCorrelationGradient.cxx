@@ -21,6 +21,7 @@
 #include "AlgorithmCiftiCorrelationGradient.h"
 #include "AlgorithmException.h"
 #include "AlgorithmMetricGradient.h"
+#include "MetricGradientObject.h"
 #include "MetricSmoothingObject.h"
 #include "AlgorithmVolumeGradient.h"
 #include "CaretLogger.h"
@@ -290,7 +291,8 @@ void AlgorithmCiftiCorrelationGradient::processSurfaceComponent(StructureEnum::E
     bool cacheFullInput = true;
     if (memLimitGB >= 0.0f)
     {
-        numCacheRows = numRowsForMem(memLimitGB, m_numCols * sizeof(float), (mySurf->getNumberOfNodes() * (sizeof(float) * 8 + 1)) / 8, mapSize, cacheFullInput);
+        int64_t floatsPerNode = (surfKern > 0.0f ? 3 : 2);//correlation, smoothed, and gradient columns all exist for every row of a pass
+        numCacheRows = numRowsForMem(memLimitGB, m_numCols * sizeof(float), (mySurf->getNumberOfNodes() * (sizeof(float) * 8 * floatsPerNode + 1)) / 8, mapSize, cacheFullInput);
     }
     if (numCacheRows > mapSize)
     {
@@ -329,6 +331,8 @@ void AlgorithmCiftiCorrelationGradient::processSurfaceComponent(StructureEnum::E
     {
         mySmooth.grabNew(new MetricSmoothingObject(mySurf, surfKern, &myRoi, MetricSmoothingObject::GEO_GAUSS_AREA, areaData));//computes the smoothing weights only once per surface
     }
+    MetricGradientObject myGradient(mySurf, myRoi.getValuePointerForColumn(0), false, areaData);//likewise, the gradient stencils only depend on the surface and roi
+    vector<float> gradientScratch;//gradients of all columns of a pass, so they are computed together
     for (int startpos = 0; startpos < mapSize; startpos += numCacheRows)
     {
         int endpos = startpos + numCacheRows;
@@ -378,22 +382,29 @@ void AlgorithmCiftiCorrelationGradient::processSurfaceComponent(StructureEnum::E
             }
         }
         int numMetricCols = endpos - startpos;
-        MetricFile outputMetric, outputMetric2;
+        MetricFile smoothedMetric;
+        const MetricFile* gradientInput = &computeMetric;
+        if (surfKern > 0.0f)
+        {
+            mySmooth->smoothMetric(&computeMetric, &smoothedMetric);//each column smoothed into its own column
+            gradientInput = &smoothedMetric;
+        }
+        const int64_t numNodes = mySurf->getNumberOfNodes();
+        gradientScratch.resize(numNodes * numMetricCols);
+        vector<const float*> gradientIn(numMetricCols);
+        vector<float*> gradientOut(numMetricCols);
         for (int j = 0; j < numMetricCols; ++j)
         {
-            const float* myCol;
-            if (surfKern > 0.0f)
-            {
-                mySmooth->smoothColumn(&computeMetric, j, &outputMetric);
-                AlgorithmMetricGradient(NULL, mySurf, &outputMetric, &outputMetric2, NULL, -1.0f, &myRoi, false, -1, myAreas);
-                myCol = outputMetric2.getValuePointerForColumn(0);
-            } else {
-                AlgorithmMetricGradient(NULL, mySurf, &computeMetric, &outputMetric, NULL, -1.0f, &myRoi, false, j, myAreas);
-                myCol = outputMetric.getValuePointerForColumn(0);
-            }
+            gradientIn[j] = gradientInput->getValuePointerForColumn(j);
+            gradientOut[j] = gradientScratch.data() + j * numNodes;
+        }
+        myGradient.computeGradients(gradientIn, gradientOut);//all columns in one pass over the vertices
+        const float* roiColumn = myRoi.getValuePointerForColumn(0);
+        for (int j = 0; j < numMetricCols; ++j)
+        {
+            const float* myCol = gradientOut[j];
             for (int i = 0; i < mapSize; ++i)
             {
-                const float* roiColumn = myRoi.getValuePointerForColumn(0);
                 if (roiColumn[myMap[i].m_surfaceNode] > 0.0f)
                 {
                     accum[i] += myCol[myMap[i].m_surfaceNode];
@@ -23,9 +23,16 @@
 
 #include "AlgorithmCiftiParcellate.h"
 #include "AlgorithmCiftiSeparate.h" //for cropped volume space
+#include "CaretOMP.h"
+#include "CaretSparseFile.h"
 #include "CiftiFile.h"
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
+#include "Vector3D.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
 
 using namespace caret;
 using namespace std;
@@ -57,10 +64,21 @@ OperationParameters* AlgorithmCiftiLabelAdjacency::getParameters()
     OptionalParameter* cerebSurfaceOpt = ret->createOptionalParameter(5, "-cerebellum-surface", "specify the cerebellum surface to use");
     cerebSurfaceOpt->addSurfaceParameter(1, "surface", "the cerebellum surface file");
     
+    ret->createOptionalParameter(6, "-weighted", "use border length and area instead of counts");
+    
+    OptionalParameter* sparseOpt = ret->createOptionalParameter(7, "-sparse-out", "also write the adjacency counts as a sparse matrix");
+    sparseOpt->addStringParameter(1, "wbsparse-out", "output - the output wbsparse file, should end in .wbsparse");//HACK: fake the output format since we don't have a wbsparse parameter type
+    
     ret->setHelpText(
         AString("Find face-adjacent voxels and connected vertices that have different label values, and count them for each pair.  ") +
         "Put the resulting counts into a parcellated connectivity file, with the diagonal being zero.  " +
-        "This gives a rough estimate of how long or expansive the border between two labels is."
+        "This gives a rough estimate of how long or expansive the border between two labels is.\n\n" +
+        "When -weighted is specified, each pair of connected vertices instead contributes the length in mm of the border between them " +
+        "(the distances from the midpoint of their edge to the centers of the triangles that share the edge), " +
+        "and each pair of face-adjacent voxels contributes the area in mm^2 of the shared face.\n\n" +
+        "The -sparse-out option writes the same matrix as a wbsparse file, which only stores the nonzero elements.  " +
+        "The file name should end in .wbsparse (not .trajTEMP.wbsparse, which is for fiber trajectories).  " +
+        "wbsparse files store integers, so it can't be combined with -weighted."
     );
     return ret;
 }
@@ -87,13 +105,25 @@ void AlgorithmCiftiLabelAdjacency::useParameters(OperationParameters* myParams,
     {
         myCerebSurf = cerebSurfOpt->getSurface(1);
     }
-    AlgorithmCiftiLabelAdjacency(myProgObj, myLabelIn, myAdjOut, myLeftSurf, myRightSurf, myCerebSurf);
+    bool weighted = myParams->getOptionalParameter(6)->m_present;
+    AString sparseOutName;
+    OptionalParameter* sparseOpt = myParams->getOptionalParameter(7);
+    if (sparseOpt->m_present)
+    {
+        sparseOutName = sparseOpt->getString(1);
+    }
+    AlgorithmCiftiLabelAdjacency(myProgObj, myLabelIn, myAdjOut, myLeftSurf, myRightSurf, myCerebSurf, weighted, sparseOutName);
 }
 
 AlgorithmCiftiLabelAdjacency::AlgorithmCiftiLabelAdjacency(ProgressObject* myProgObj, const CiftiFile* myLabelIn, CiftiFile* myAdjOut,
-                                                           const SurfaceFile* myLeftSurf, const SurfaceFile* myRightSurf, const SurfaceFile* myCerebSurf) : AbstractAlgorithm(myProgObj)
+                                                           const SurfaceFile* myLeftSurf, const SurfaceFile* myRightSurf, const SurfaceFile* myCerebSurf,
+                                                           const bool& weighted, const AString& sparseOutName) : AbstractAlgorithm(myProgObj)
 {
     LevelProgress myProgress(myProgObj);
+    if (weighted && sparseOutName != "")
+    {
+        throw AlgorithmException("sparse output stores integers, it can't be used with weighting");
+    }
     const CiftiXML& myLabelXML = myLabelIn->getCiftiXML();
     if (myLabelXML.getNumberOfDimensions() != 2 ||
         myLabelXML.getMappingType(CiftiXML::ALONG_ROW) != CiftiMappingType::LABELS ||
@@ -143,7 +173,7 @@ AlgorithmCiftiLabelAdjacency::AlgorithmCiftiLabelAdjacency(ProgressObject* myPro
     outXML.setMap(CiftiXML::ALONG_ROW, myParcelMap);
     outXML.setMap(CiftiXML::ALONG_COLUMN, myParcelMap);
     myAdjOut->setCiftiXML(outXML);
-    vector<vector<int64_t> > adjCount(numParcels, vector<int64_t>(numParcels, 0));//count as int, translate back to float when writing
+    vector<map<int, double> > adjAccum(numParcels);//sparse, each pair is stored once, in the row of the lower parcel, and mirrored when writing
     for (int whichStruct = 0; whichStruct < (int)surfaceList.size(); ++whichStruct)
     {
         const SurfaceFile* mySurf = NULL;
@@ -164,26 +194,57 @@ AlgorithmCiftiLabelAdjacency::AlgorithmCiftiLabelAdjacency(ProgressObject* myPro
         }
         CaretPointer<TopologyHelper> myHelp = mySurf->getTopologyHelper();
         int numNodes = mySurf->getNumberOfNodes();
-        for (int i = 0; i < numNodes - 1; ++i)//to avoid double counting, only count pairs that are in ascending order - this means the last node won't have any valid edges
+        const StructureEnum::Enum myStructure = surfaceList[whichStruct];
+#pragma omp CARET_PAR
         {
-            int64_t baseIndex = myDenseMap.getIndexForNode(i, surfaceList[whichStruct]);
-            if (baseIndex < 0) continue;
-            int baseLabel = indexToParcel[baseIndex];//translate on the fly, to do separate we would need to put indexToParcel into a temporary CiftiFile
-            if (baseLabel < 0) continue;
-            const vector<int32_t>& neighbors = myHelp->getNodeNeighbors(i);
-            int numNeighbors = (int)neighbors.size();
-            for (int j = 0; j < numNeighbors; ++j)
+            vector<map<int, double> > threadAccum(numParcels);//merge once at the end, rather than locking per edge
+#pragma omp CARET_FOR schedule(dynamic, 4096)
+            for (int i = 0; i < numNodes - 1; ++i)//to avoid double counting, only count pairs that are in ascending order - this means the last node won't have any valid edges
             {
-                if (neighbors[j] > i)
+                int64_t baseIndex = myDenseMap.getIndexForNode(i, myStructure);
+                if (baseIndex < 0) continue;
+                int baseLabel = indexToParcel[baseIndex];//translate on the fly, to do separate we would need to put indexToParcel into a temporary CiftiFile
+                if (baseLabel < 0) continue;
+                const vector<int32_t>& neighbors = myHelp->getNodeNeighbors(i);
+                int numNeighbors = (int)neighbors.size();
+                for (int j = 0; j < numNeighbors; ++j)
                 {
-                    int64_t neighIndex = myDenseMap.getIndexForNode(neighbors[j], surfaceList[whichStruct]);
-                    if (neighIndex < 0) continue;
-                    int neighLabel = indexToParcel[neighIndex];
-                    if (neighLabel < 0) continue;
-                    if (baseLabel != neighLabel)
+                    if (neighbors[j] > i)
                     {
-                        ++adjCount[baseLabel][neighLabel];
-                        ++adjCount[neighLabel][baseLabel];
+                        int64_t neighIndex = myDenseMap.getIndexForNode(neighbors[j], myStructure);
+                        if (neighIndex < 0) continue;
+                        int neighLabel = indexToParcel[neighIndex];
+                        if (neighLabel < 0) continue;
+                        if (baseLabel != neighLabel)
+                        {
+                            double weight = 1.0;
+                            if (weighted)
+                            {//the border crosses the edge, and runs from the edge midpoint to the center of each triangle on the edge
+                                weight = 0.0;
+                                Vector3D midpoint = (Vector3D(mySurf->getCoordinate(i)) + Vector3D(mySurf->getCoordinate(neighbors[j]))) / 2.0f;
+                                const vector<int32_t>& tiles = myHelp->getNodeTiles(i);
+                                for (int k = 0; k < (int)tiles.size(); ++k)
+                                {
+                                    const int32_t* tri = mySurf->getTriangle(tiles[k]);
+                                    if (tri[0] == neighbors[j] || tri[1] == neighbors[j] || tri[2] == neighbors[j])
+                                    {
+                                        Vector3D center = (Vector3D(mySurf->getCoordinate(tri[0])) + Vector3D(mySurf->getCoordinate(tri[1])) + Vector3D(mySurf->getCoordinate(tri[2]))) / 3.0f;
+                                        weight += (center - midpoint).length();
+                                    }
+                                }
+                            }
+                            threadAccum[min(baseLabel, neighLabel)][max(baseLabel, neighLabel)] += weight;
+                        }
+                    }
+                }
+            }
+#pragma omp critical
+            {
+                for (int i = 0; i < numParcels; ++i)
+                {
+                    for (map<int, double>::const_iterator iter = threadAccum[i].begin(); iter != threadAccum[i].end(); ++iter)
+                    {
+                        adjAccum[i][iter->first] += iter->second;
                     }
                 }
             }
@@ -197,41 +258,94 @@ AlgorithmCiftiLabelAdjacency::AlgorithmCiftiLabelAdjacency(ProgressObject* myPro
         int64_t stencil[9] = {1, 0, 0,
                                 0, 1, 0,
                                 0, 0, 1};//only forward differences, to avoid double counting
-        int64_t ijk[3];
-        for (ijk[2] = offset[2]; ijk[2] < offset[2] + dims[2]; ++ijk[2])
+        double faceWeights[3] = {1.0, 1.0, 1.0};
+        if (weighted)
+        {//area of the face shared with each forward neighbor
+            Vector3D ivec, jvec, kvec, origin;
+            myDenseMap.getVolumeSpace().getSpacingVectors(ivec, jvec, kvec, origin);
+            faceWeights[0] = jvec.cross(kvec).length();
+            faceWeights[1] = ivec.cross(kvec).length();
+            faceWeights[2] = ivec.cross(jvec).length();
+        }
+#pragma omp CARET_PAR
         {
-            for (ijk[1] = offset[1]; ijk[1] < offset[1] + dims[1]; ++ijk[1])
+            vector<map<int, double> > threadAccum(numParcels);
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int64_t k = offset[2]; k < offset[2] + dims[2]; ++k)
             {
-                for (ijk[0] = offset[0]; ijk[0] < offset[0] + dims[0]; ++ijk[0])
+                int64_t ijk[3];
+                ijk[2] = k;
+                for (ijk[1] = offset[1]; ijk[1] < offset[1] + dims[1]; ++ijk[1])
                 {
-                    int64_t baseIndex = myDenseMap.getIndexForVoxel(ijk);
-                    if (baseIndex < 0) continue;
-                    int baseLabel = indexToParcel[baseIndex];
-                    if (baseLabel < 0) continue;
-                    for (int neighbor = 0; neighbor < 9; neighbor += 3)
+                    for (ijk[0] = offset[0]; ijk[0] < offset[0] + dims[0]; ++ijk[0])
                     {
-                        int64_t neighIndex = myDenseMap.getIndexForVoxel(ijk[0] + stencil[neighbor], ijk[1] + stencil[neighbor + 1], ijk[2] + stencil[neighbor + 2]);
-                        if (neighIndex < 0) continue;
-                        int neighLabel = indexToParcel[neighIndex];
-                        if (neighLabel < 0) continue;
-                        if (baseLabel != neighLabel)
+                        int64_t baseIndex = myDenseMap.getIndexForVoxel(ijk);
+                        if (baseIndex < 0) continue;
+                        int baseLabel = indexToParcel[baseIndex];
+                        if (baseLabel < 0) continue;
+                        for (int neighbor = 0; neighbor < 9; neighbor += 3)
                         {
-                            ++adjCount[baseLabel][neighLabel];
-                            ++adjCount[neighLabel][baseLabel];
+                            int64_t neighIndex = myDenseMap.getIndexForVoxel(ijk[0] + stencil[neighbor], ijk[1] + stencil[neighbor + 1], ijk[2] + stencil[neighbor + 2]);
+                            if (neighIndex < 0) continue;
+                            int neighLabel = indexToParcel[neighIndex];
+                            if (neighLabel < 0) continue;
+                            if (baseLabel != neighLabel)
+                            {
+                                threadAccum[min(baseLabel, neighLabel)][max(baseLabel, neighLabel)] += faceWeights[neighbor / 3];
+                            }
                         }
                     }
                 }
             }
+#pragma omp critical
+            {
+                for (int i = 0; i < numParcels; ++i)
+                {
+                    for (map<int, double>::const_iterator iter = threadAccum[i].begin(); iter != threadAccum[i].end(); ++iter)
+                    {
+                        adjAccum[i][iter->first] += iter->second;
+                    }
+                }
+            }
+        }
+    }
+    vector<map<int, double> > fullRows(numParcels);//mirror the pairs so each row can be written in order
+    for (int i = 0; i < numParcels; ++i)
+    {
+        for (map<int, double>::const_iterator iter = adjAccum[i].begin(); iter != adjAccum[i].end(); ++iter)
+        {
+            fullRows[i][iter->first] = iter->second;
+            fullRows[iter->first][i] = iter->second;
         }
+        adjAccum[i].clear();
+    }
+    CaretPointer<CaretSparseFileWriter> sparseWriter;
+    if (sparseOutName != "")
+    {
+        sparseWriter.grabNew(new CaretSparseFileWriter(sparseOutName, outXML, false));
     }
     vector<float> tempRow(numParcels);
+    vector<int64_t> sparseIndices, sparseValues;
     for (int i = 0; i < numParcels; ++i)
     {
-        for (int j = 0; j < numParcels; ++j)
+        tempRow.assign(numParcels, 0.0f);
+        sparseIndices.clear();
+        sparseValues.clear();
+        for (map<int, double>::const_iterator iter = fullRows[i].begin(); iter != fullRows[i].end(); ++iter)
         {
-            tempRow[j] = adjCount[i][j];
+            tempRow[iter->first] = iter->second;
+            sparseIndices.push_back(iter->first);
+            sparseValues.push_back((int64_t)llround(iter->second));//only used for counts, so this is exact
         }
         myAdjOut->setRow(tempRow.data(), i);
+        if (sparseWriter != NULL && !sparseIndices.empty())
+        {
+            sparseWriter->writeRowSparse(i, sparseIndices, sparseValues);
+        }
+    }
+    if (sparseWriter != NULL)
+    {
+        sparseWriter->finish();
     }
 }
 
@@ -20,17 +20,20 @@
 
 #include "AlgorithmCiftiParcellate.h"
 #include "AlgorithmException.h"
+#include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "CiftiFile.h"
 #include "GiftiLabel.h"
 #include "GiftiLabelTable.h"
+#include "GiftiLabelTableLookup.h"
 #include "MetricFile.h"
 #include "MultiDimIterator.h"
 #include "ReductionOperation.h"
 #include "SurfaceFile.h"
 
+#include <algorithm>
 #include <cmath>
-#include <map>
 
 using namespace caret;
 using namespace std;
@@ -237,269 +240,74 @@ void AlgorithmCiftiParcellate::useParameters(OperationParameters* myParams, Prog
                              includeEmpty, emptyFillValue, emptyMaskOut);
 }
 
-AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
-                                                   const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric,
-                                                   const bool& includeEmpty, const float& emptyFillVal, CiftiFile* emptyMaskOut) : AbstractAlgorithm(myProgObj)
+namespace
 {
-    LevelProgress myProgress(myProgObj);
-    CaretAssert(direction >= 0);
-    const CiftiXML& myInputXML = myCiftiIn->getCiftiXML();
-    const CiftiXML& myLabelXML = myCiftiLabel->getCiftiXML();
-    vector<int64_t> dims = myInputXML.getDimensions();
-    if (direction >= (int)dims.size()) throw AlgorithmException("specified direction doesn't exist in input file");
-    if (myInputXML.getMappingType(direction) != CiftiMappingType::BRAIN_MODELS)
-    {
-        throw AlgorithmException("input cifti file does not have brain models mapping type in specified direction");
-    }
-    if (myLabelXML.getNumberOfDimensions() != 2 ||
-        myLabelXML.getMappingType(CiftiXML::ALONG_ROW) != CiftiMappingType::LABELS ||
-        myLabelXML.getMappingType(CiftiXML::ALONG_COLUMN) != CiftiMappingType::BRAIN_MODELS)
-    {
-        throw AlgorithmException("input cifti label file has the wrong mapping types");
-    }
-    const CiftiBrainModelsMap& inputDense = myInputXML.getBrainModelsMap(direction);
-    const CiftiBrainModelsMap& labelDense = myLabelXML.getBrainModelsMap(CiftiXML::ALONG_COLUMN);
-    if (inputDense.hasVolumeData())
-    {//don't check volume space if direction doesn't have volume data
-        if (labelDense.hasVolumeData() && !inputDense.getVolumeSpace().matches(labelDense.getVolumeSpace()))
-        {
-            throw AlgorithmException("input cifti files must have the same volume space");
-        }
-    }
-    vector<int> indexToParcel;
-    CiftiXML myOutXML = myInputXML;
-    CiftiParcelsMap outParcelMap = parcellateMapping(myCiftiLabel, inputDense, indexToParcel, includeEmpty);
-    int numParcels = outParcelMap.getLength();
-    if (numParcels < 1)
-    {
-        throw AlgorithmException("no parcels found, output file would be empty, aborting");
-    }
-    myOutXML.setMap(direction, outParcelMap);
-    myCiftiOut->setCiftiXML(myOutXML);
-    int64_t numCols = myInputXML.getDimensionLength(CiftiXML::ALONG_ROW);
-    vector<float> scratchRow(numCols);
-    vector<int64_t> parcelCounts(numParcels, 0);
-    for (int64_t j = 0; j < (int64_t)indexToParcel.size(); ++j)
-    {
-        int parcel = indexToParcel[j];
-        CaretAssert(parcel > -2 && parcel < numParcels);
-        if (parcel != -1)
-        {
-            ++parcelCounts[parcel];
-        }
-    }
-    if (emptyMaskOut != NULL)
-    {
-        CiftiXML maskOutXML;
-        maskOutXML.setNumberOfDimensions(2);
-        maskOutXML.setMap(CiftiXML::ALONG_COLUMN, outParcelMap);
-        CiftiScalarsMap maskNameMap;
-        maskNameMap.setLength(1);
-        maskNameMap.setMapName(0, "parcel not empty");
-        maskOutXML.setMap(CiftiXML::ALONG_ROW, maskNameMap);
-        emptyMaskOut->setCiftiXML(maskOutXML);
-        vector<float> emptyMaskData(numParcels, 1.0f);
-        for (int i = 0; i < numParcels; ++i)
-        {
-            if (parcelCounts[i] == 0)
-            {
-                emptyMaskData[i] = 0.0f;
-            }
-        }
-        emptyMaskOut->setColumn(emptyMaskData.data(), 0);
-    }
-    bool isLabel = false;
-    int labelDir = -1;
-    for (int i = 0; i < (int)dims.size(); ++i)
-    {
-        if (myInputXML.getMappingType(i) == CiftiMappingType::LABELS)
-        {
-            isLabel = true;
-            labelDir = i;
-            break;//there should never be more than one dimension with LABEL type, and if there is, just use the first one, i guess...
-        }
-    }
-    if (isLabel && method != ReductionEnum::MODE)
-    {
-        CaretLogWarning(ReductionEnum::toName(method) + " reduction requested while parcellating label data");
-    }
-    if (direction == CiftiXML::ALONG_ROW)
-    {
-        vector<float> scratchOutRow(numParcels);
-        vector<vector<float> > parcelData(numParcels);//float so we can use ReductionOperation
-        for (int j = 0; j < numParcels; ++j)
-        {
-            parcelData[j].reserve(parcelCounts[j]);
-        }
-        for (MultiDimIterator<int64_t> iter(vector<int64_t>(dims.begin() + 1, dims.end())); !iter.atEnd(); ++iter)
+    const int64_t MAX_BLOCK_BYTES = ((int64_t)1) << 28;//how much memory to use for buffering independent rows
+    
+    float reduceParcel(const float* data, const float* weights, const int64_t& count, const ReductionEnum::Enum& method,
+                       const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric)
+    {//weights is NULL for unweighted parcellation
+        if (weights == NULL)
         {
-            for (int j = 0; j < numParcels; ++j)
+            if (excludeLow > 0.0f && excludeHigh > 0.0f)
             {
-                parcelData[j].clear();//doesn't change allocation
+                return ReductionOperation::reduceExcludeDev(data, count, method, excludeLow, excludeHigh);
             }
-            myCiftiIn->getRow(scratchRow.data(), *iter);
-            for (int64_t j = 0; j < numCols; ++j)
+            if (onlyNumeric)
             {
-                int parcel = indexToParcel[j];
-                if (parcel != -1)
-                {
-                    if (isLabel)
-                    {
-                        parcelData[parcel].push_back(floor(scratchRow[j] + 0.5f));//round to nearest integer to be safe
-                    } else {
-                        parcelData[parcel].push_back(scratchRow[j]);
-                    }
-                }
-            }
-            for (int j = 0; j < numParcels; ++j)
-            {
-                CaretAssert(parcelCounts[j] == (int64_t)parcelData[j].size());
-                if (parcelCounts[j] > 0 && (method != ReductionEnum::SAMPSTDEV || parcelCounts[j] > 1))
-                {
-                    if (excludeLow > 0.0f && excludeHigh > 0.0f)
-                    {
-                        scratchOutRow[j] = ReductionOperation::reduceExcludeDev(parcelData[j].data(), parcelData[j].size(), method, excludeLow, excludeHigh);
-                    } else {
-                        if (onlyNumeric)
-                        {
-                            scratchOutRow[j] = ReductionOperation::reduceOnlyNumeric(parcelData[j].data(), parcelData[j].size(), method);
-                        } else {
-                            scratchOutRow[j] = ReductionOperation::reduce(parcelData[j].data(), parcelData[j].size(), method);
-                        }
-                    }
-                } else {//labelDir can't be 0 (row) because we are parcellating along row, so row must be dense
-                    if (isLabel)
-                    {
-                        scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable((*iter)[labelDir - 1])->getUnassignedLabelKey();
-                    } else {
-                        scratchOutRow[j] = emptyFillVal;//odd corner case, but probably fine: with nonzero empty fill value and SAMPSTDEV, parcels with only one element get the fill value, but aren't technically empty
-                    }
-                }
+                return ReductionOperation::reduceOnlyNumeric(data, count, method);
             }
-            myCiftiOut->setRow(scratchOutRow.data(), *iter);
+            return ReductionOperation::reduce(data, count, method);
         }
-    } else {
-        vector<float> scratchOutRow(numCols);
-        vector<int64_t> otherDims = dims;
-        otherDims.erase(otherDims.begin() + direction);//direction being parcellated
-        otherDims.erase(otherDims.begin());//row
-        vector<vector<vector<float> > > parcelData(numParcels, vector<vector<float> >(numCols));//float so we can use ReductionOperation
-        for (int i = 0; i < numParcels; ++i)
+        if (excludeLow > 0.0f && excludeHigh > 0.0f)
         {
-            for (int j = 0; j < numCols; ++j)
-            {
-                parcelData[i][j].reserve(parcelCounts[i]);
-            }
+            return ReductionOperation::reduceWeightedExcludeDev(data, weights, count, method, excludeLow, excludeHigh);
         }
-        for (MultiDimIterator<int64_t> iter(otherDims); !iter.atEnd(); ++iter)
+        if (onlyNumeric)
         {
-            vector<int64_t> indices(dims.size() - 1);//we need to add the parcellated direction index back into the index list to use it in getRow/setRow
-            for (int i = 0; i < (int)otherDims.size(); ++i)
-            {
-                if (i < direction - 1)
-                {
-                    indices[i] = (*iter)[i];
-                } else {
-                    indices[i + 1] = (*iter)[i];
-                }
-            }//indices[direction - 1] is uninitialized, as it is the dimension to be parcellated
-            for (int i = 0; i < numParcels; ++i)
-            {
-                for (int j = 0; j < numCols; ++j)
-                {
-                    parcelData[i][j].clear();//doesn't change allocation
-                }
-            }
-            for (int64_t i = 0; i < dims[direction]; ++i)
-            {
-                int parcel = indexToParcel[i];
-                if (parcel != -1)
-                {
-                    indices[direction - 1] = i;
-                    myCiftiIn->getRow(scratchRow.data(), indices);
-                    vector<vector<float> >& parcelRef = parcelData[parcel];
-                    for (int j = 0; j < numCols; ++j)
-                    {
-                        if (isLabel)
-                        {
-                            parcelRef[j].push_back(floor(scratchRow[j] + 0.5f));
-                        } else {
-                            parcelRef[j].push_back(scratchRow[j]);
-                        }
-                    }
-                }
-            }
-            for (int i = 0; i < numParcels; ++i)
-            {
-                indices[direction - 1] = i;
-                int64_t count = parcelCounts[i];
-                vector<vector<float> >& parcelRef = parcelData[i];
-                if (count > 0 && (method != ReductionEnum::SAMPSTDEV || count > 1))
-                {
-                    for (int j = 0; j < numCols; ++j)
-                    {
-                        CaretAssert((int64_t)parcelRef[j].size() == count);
-                        if (excludeLow > 0.0f && excludeHigh > 0.0f)
-                        {
-                            scratchOutRow[j] = ReductionOperation::reduceExcludeDev(parcelRef[j].data(), parcelRef[j].size(), method, excludeLow, excludeHigh);
-                        } else {
-                            if (onlyNumeric)
-                            {
-                                scratchOutRow[j] = ReductionOperation::reduceOnlyNumeric(parcelRef[j].data(), parcelRef[j].size(), method);
-                            } else {
-                                scratchOutRow[j] = ReductionOperation::reduce(parcelRef[j].data(), parcelRef[j].size(), method);
-                            }
-                        }
-                    }
-                } else {
-                    for (int j = 0; j < numCols; ++j)
-                    {
-                        CaretAssert((int64_t)parcelRef[j].size() == count);
-                        if (isLabel)
-                        {
-                            if (labelDir == CiftiXML::ALONG_ROW)
-                            {
-                                scratchOutRow[j] = myOutXML.getLabelsMap(CiftiXML::ALONG_ROW).getMapLabelTable(j)->getUnassignedLabelKey();
-                            } else {
-                                scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(indices[labelDir - 1])->getUnassignedLabelKey();
-                            }
-                        } else {
-                            scratchOutRow[j] = emptyFillVal;
-                        }
-                    }
-                }
-                myCiftiOut->setRow(scratchOutRow.data(), indices);
-            }
+            return ReductionOperation::reduceWeightedOnlyNumeric(data, weights, count, method);
         }
+        return ReductionOperation::reduceWeighted(data, weights, count, method);
     }
-}
-
-namespace
-{
-    void doWeightedParcellation(const CiftiFile* myCiftiIn, const int& direction, CiftiFile* myCiftiOut, const vector<int>& indexToParcel,
-                                const vector<vector<float> >& parcelWeights, const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric,
-                                const float& emptyFillVal, CiftiFile* emptyMaskOut)
+    
+    //parcelWeights is NULL for unweighted parcellation
+    void doParcellation(const CiftiFile* myCiftiIn, const int& direction, CiftiFile* myCiftiOut, const vector<int>& indexToParcel,
+                        const vector<vector<float> >* parcelWeights, const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric,
+                        const float& emptyFillVal, CiftiFile* emptyMaskOut)
     {
         const CiftiXML& myInputXML = myCiftiIn->getCiftiXML();
         const CiftiXML& myOutXML = myCiftiOut->getCiftiXML();
         vector<int64_t> dims = myInputXML.getDimensions();
         CaretAssert(direction < (int)dims.size());
-        bool isLabel = false;
-        int labelDir = -1;
-        for (int i = 0; i < (int)dims.size(); ++i)
+        int numParcels = myOutXML.getDimensionLength(direction);
+        vector<int64_t> memberStart(numParcels + 1, 0);//offsets into memberIndex, which lists the indices in each parcel, in increasing order
+        for (int64_t j = 0; j < (int64_t)indexToParcel.size(); ++j)
         {
-            if (myInputXML.getMappingType(i) == CiftiMappingType::LABELS)
+            int parcel = indexToParcel[j];
+            CaretAssert(parcel > -2 && parcel < numParcels);
+            if (parcel != -1)
             {
-                isLabel = true;
-                labelDir = i;
-                break;//there should never be more than one dimension with LABEL type, and if there is, just use the first one, i guess...
+                ++memberStart[parcel + 1];
             }
         }
-        if (isLabel && method != ReductionEnum::MODE)
+        int64_t maxCount = 0;
+        for (int i = 0; i < numParcels; ++i)
         {
-            CaretLogWarning(ReductionEnum::toName(method) + " reduction requested while parcellating label data");
+            CaretAssert(parcelWeights == NULL || (int64_t)(*parcelWeights)[i].size() == memberStart[i + 1]);
+            maxCount = max(maxCount, memberStart[i + 1]);
+            memberStart[i + 1] += memberStart[i];
+        }
+        vector<int64_t> memberIndex(memberStart[numParcels]), memberSlot(indexToParcel.size(), -1), memberFill(memberStart.begin(), memberStart.end() - 1);
+        for (int64_t j = 0; j < (int64_t)indexToParcel.size(); ++j)
+        {
+            int parcel = indexToParcel[j];
+            if (parcel != -1)
+            {
+                memberIndex[memberFill[parcel]] = j;
+                memberSlot[j] = memberFill[parcel];
+                ++memberFill[parcel];
+            }
         }
-        int numParcels = myOutXML.getDimensionLength(direction);
         if (emptyMaskOut != NULL)
         {
             CiftiXML maskOutXML;
@@ -513,83 +321,100 @@ namespace
             vector<float> emptyMaskData(numParcels, 1.0f);
             for (int i = 0; i < numParcels; ++i)
             {
-                if (parcelWeights[i].size() == 0)
+                if (memberStart[i + 1] == memberStart[i])
                 {
                     emptyMaskData[i] = 0.0f;
                 }
             }
             emptyMaskOut->setColumn(emptyMaskData.data(), 0);
         }
-        int64_t numCols = myInputXML.getDimensionLength(CiftiXML::ALONG_ROW);
-        vector<float> scratchRow(numCols);
-        if (direction == CiftiXML::ALONG_ROW)
+        bool isLabel = false;
+        int labelDir = -1;
+        for (int i = 0; i < (int)dims.size(); ++i)
         {
-            vector<float> scratchOutRow(numParcels);
-            vector<vector<float> > parcelData(numParcels);//float so we can use ReductionOperation
-            for (int j = 0; j < numParcels; ++j)
+            if (myInputXML.getMappingType(i) == CiftiMappingType::LABELS)
             {
-                parcelData[j].reserve(parcelWeights[j].size());
+                isLabel = true;
+                labelDir = i;
+                break;//there should never be more than one dimension with LABEL type, and if there is, just use the first one, i guess...
             }
+        }
+        if (isLabel && method != ReductionEnum::MODE)
+        {
+            CaretLogWarning(ReductionEnum::toName(method) + " reduction requested while parcellating label data");
+        }
+        int64_t numCols = myInputXML.getDimensionLength(CiftiXML::ALONG_ROW);
+        if (direction == CiftiXML::ALONG_ROW)
+        {//rows are independent, so read a block of them, reduce the rows in parallel, then write the block
+            vector<vector<int64_t> > rowIndices;
             for (MultiDimIterator<int64_t> iter(vector<int64_t>(dims.begin() + 1, dims.end())); !iter.atEnd(); ++iter)
             {
-                for (int j = 0; j < numParcels; ++j)
-                {
-                    parcelData[j].clear();//doesn't change allocation
-                }
-                myCiftiIn->getRow(scratchRow.data(), *iter);
-                for (int64_t j = 0; j < numCols; ++j)
+                rowIndices.push_back(*iter);
+            }
+            const int64_t numRows = (int64_t)rowIndices.size();
+            const int64_t blockRows = max((int64_t)1, min(numRows, MAX_BLOCK_BYTES / (int64_t)(sizeof(float) * (numCols + numParcels))));
+            vector<float> inBlock(blockRows * numCols), outBlock(blockRows * numParcels), emptyFill(blockRows, emptyFillVal);
+            for (int64_t blockStart = 0; blockStart < numRows; blockStart += blockRows)
+            {
+                const int64_t blockEnd = min(blockStart + blockRows, numRows);
+                for (int64_t row = blockStart; row < blockEnd; ++row)
                 {
-                    int parcel = indexToParcel[j];
-                    if (parcel != -1)
-                    {
-                        if (isLabel)
-                        {
-                            parcelData[parcel].push_back(floor(scratchRow[j] + 0.5f));//round to nearest integer to be safe
-                        } else {
-                            parcelData[parcel].push_back(scratchRow[j]);
-                        }
+                    myCiftiIn->getRow(inBlock.data() + (row - blockStart) * numCols, rowIndices[row]);
+                    if (isLabel)
+                    {//labelDir can't be 0 (row) because we are parcellating along row, so row must be dense
+                        emptyFill[row - blockStart] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(rowIndices[row][labelDir - 1])->getUnassignedLabelKey();
                     }
                 }
-                for (int j = 0; j < numParcels; ++j)
+#pragma omp CARET_PAR
                 {
-                    CaretAssert(parcelWeights[j].size() == parcelData[j].size());
-                    if (parcelData[j].size() > 0 && (method != ReductionEnum::SAMPSTDEV || parcelData[j].size() > 1))
+                    vector<float> parcelData(maxCount);//float so we can use ReductionOperation
+#pragma omp CARET_FOR schedule(dynamic)
+                    for (int64_t row = blockStart; row < blockEnd; ++row)
                     {
-                        if (excludeLow > 0.0f && excludeHigh > 0.0f)
+                        const float* scratchRow = inBlock.data() + (row - blockStart) * numCols;
+                        float* scratchOutRow = outBlock.data() + (row - blockStart) * numParcels;
+                        for (int j = 0; j < numParcels; ++j)
                         {
-                            scratchOutRow[j] = ReductionOperation::reduceWeightedExcludeDev(parcelData[j].data(), parcelWeights[j].data(), parcelData[j].size(), method, excludeLow, excludeHigh);
-                        } else {
-                            if (onlyNumeric)
+                            int64_t count = memberStart[j + 1] - memberStart[j];
+                            if (count > 0 && (method != ReductionEnum::SAMPSTDEV || count > 1))
                             {
-                                scratchOutRow[j] = ReductionOperation::reduceWeightedOnlyNumeric(parcelData[j].data(), parcelWeights[j].data(), parcelData[j].size(), method);
-                            } else {
-                                scratchOutRow[j] = ReductionOperation::reduceWeighted(parcelData[j].data(), parcelWeights[j].data(), parcelData[j].size(), method);
+                                const int64_t* members = memberIndex.data() + memberStart[j];
+                                for (int64_t k = 0; k < count; ++k)
+                                {
+                                    if (isLabel)
+                                    {
+                                        parcelData[k] = floor(scratchRow[members[k]] + 0.5f);//round to nearest integer to be safe
+                                    } else {
+                                        parcelData[k] = scratchRow[members[k]];
+                                    }
+                                }
+                                scratchOutRow[j] = reduceParcel(parcelData.data(), (parcelWeights == NULL ? NULL : (*parcelWeights)[j].data()), count,
+                                                                method, excludeLow, excludeHigh, onlyNumeric);
+                            } else {//odd corner case, but probably fine: with nonzero empty fill value and SAMPSTDEV, parcels with only one element get the fill value, but aren't technically empty
+                                scratchOutRow[j] = emptyFill[row - blockStart];
                             }
                         }
-                    } else {//labelDir can't be 0 (row) because we are parcellating along row, so row must be dense
-                        if (isLabel)
-                        {
-                            scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable((*iter)[labelDir - 1])->getUnassignedLabelKey();
-                        } else {
-                            scratchOutRow[j] = emptyFillVal;
-                        }
                     }
                 }
-                myCiftiOut->setRow(scratchOutRow.data(), *iter);
+                for (int64_t row = blockStart; row < blockEnd; ++row)
+                {
+                    myCiftiOut->setRow(outBlock.data() + (row - blockStart) * numParcels, rowIndices[row]);
+                }
             }
         } else {
-            vector<float> scratchOutRow(numCols);
             vector<int64_t> otherDims = dims;
             otherDims.erase(otherDims.begin() + direction);//direction being parcellated
             otherDims.erase(otherDims.begin());//row
-            vector<vector<vector<float> > > parcelData(numParcels, vector<vector<float> >(numCols));//float so we can use ReductionOperation
-            for (int i = 0; i < numParcels; ++i)
+            const int64_t numMembers = memberStart[numParcels];
+            const int64_t outBytes = (int64_t)sizeof(float) * numParcels * numCols;//output rows are always complete, since setRow needs whole rows
+            int64_t blockCols = numCols;//member rows are buffered by blocks of columns, rereading the rows for each block if they don't fit
+            if (numMembers > 0 && outBytes + (int64_t)sizeof(float) * numMembers * numCols > MAX_BLOCK_BYTES)
             {
-                for (int j = 0; j < numCols; ++j)
-                {
-                    parcelData[i][j].reserve(parcelWeights[i].size());
-                }
+                blockCols = max((int64_t)1, (MAX_BLOCK_BYTES - outBytes) / (int64_t)(sizeof(float) * numMembers));
+                blockCols = min(blockCols, numCols);
             }
+            vector<float> inData(numMembers * blockCols), outData(numParcels * numCols), emptyFill(numCols, emptyFillVal), rowScratch;
+            if (blockCols < numCols) rowScratch.resize(numCols);
             for (MultiDimIterator<int64_t> iter(otherDims); !iter.atEnd(); ++iter)
             {
                 vector<int64_t> indices(dims.size() - 1);//we need to add the parcellated direction index back into the index list to use it in getRow/setRow
@@ -602,78 +427,124 @@ namespace
                         indices[i + 1] = (*iter)[i];
                     }
                 }//indices[direction - 1] is uninitialized, as it is the dimension to be parcellated
-                for (int i = 0; i < numParcels; ++i)
-                {
-                    for (int j = 0; j < numCols; ++j)
-                    {
-                        parcelData[i][j].clear();//doesn't change allocation
-                    }
-                }
-                for (int64_t i = 0; i < dims[direction]; ++i)
+                if (isLabel)
                 {
-                    int parcel = indexToParcel[i];
-                    if (parcel != -1)
+                    for (int64_t j = 0; j < numCols; ++j)
                     {
-                        indices[direction - 1] = i;
-                        myCiftiIn->getRow(scratchRow.data(), indices);
-                        vector<vector<float> >& parcelRef = parcelData[parcel];
-                        for (int j = 0; j < numCols; ++j)
+                        if (labelDir == CiftiXML::ALONG_ROW)
                         {
-                            if (isLabel)
-                            {
-                                parcelRef[j].push_back(floor(scratchRow[j] + 0.5f));
-                            } else {
-                                parcelRef[j].push_back(scratchRow[j]);
-                            }
+                            emptyFill[j] = myOutXML.getLabelsMap(CiftiXML::ALONG_ROW).getMapLabelTable(j)->getUnassignedLabelKey();
+                        } else {
+                            emptyFill[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(indices[labelDir - 1])->getUnassignedLabelKey();
                         }
                     }
                 }
-                for (int i = 0; i < numParcels; ++i)
+                for (int64_t colStart = 0; colStart < numCols; colStart += blockCols)
                 {
-                    indices[direction - 1] = i;
-                    int64_t count = (int64_t)parcelWeights[i].size();
-                    vector<vector<float> >& parcelRef = parcelData[i];
-                    if (count > 0 && (method != ReductionEnum::SAMPSTDEV || count > 1))
-                    {
-                        for (int j = 0; j < numCols; ++j)
+                    const int64_t curCols = min(blockCols, numCols - colStart);
+                    for (int64_t i = 0; i < dims[direction]; ++i)
+                    {//read in file order, store grouped by parcel
+                        if (memberSlot[i] != -1)
                         {
-                            CaretAssert((int64_t)parcelRef[j].size() == count);
-                            if (excludeLow > 0.0f && excludeHigh > 0.0f)
+                            indices[direction - 1] = i;
+                            if (curCols == numCols)
                             {
-                                scratchOutRow[j] = ReductionOperation::reduceWeightedExcludeDev(parcelRef[j].data(), parcelWeights[i].data(), parcelRef[j].size(), method, excludeLow, excludeHigh);
+                                myCiftiIn->getRow(inData.data() + memberSlot[i] * numCols, indices);
                             } else {
-                                if (onlyNumeric)
+                                myCiftiIn->getRow(rowScratch.data(), indices);
+                                for (int64_t j = 0; j < curCols; ++j)
                                 {
-                                    scratchOutRow[j] = ReductionOperation::reduceWeightedOnlyNumeric(parcelRef[j].data(), parcelWeights[i].data(), parcelRef[j].size(), method);
-                                } else {
-                                    scratchOutRow[j] = ReductionOperation::reduceWeighted(parcelRef[j].data(), parcelWeights[i].data(), parcelRef[j].size(), method);
+                                    inData[memberSlot[i] * curCols + j] = rowScratch[colStart + j];
                                 }
                             }
                         }
-                    } else {
-                        for (int j = 0; j < numCols; ++j)
+                    }
+#pragma omp CARET_PAR
+                    {
+                        vector<float> parcelData(maxCount);//float so we can use ReductionOperation
+#pragma omp CARET_FOR schedule(dynamic)
+                        for (int i = 0; i < numParcels; ++i)
                         {
-                            CaretAssert((int64_t)parcelRef[j].size() == count);
-                            if (isLabel)
+                            int64_t count = memberStart[i + 1] - memberStart[i];
+                            float* scratchOutRow = outData.data() + i * numCols + colStart;
+                            if (count > 0 && (method != ReductionEnum::SAMPSTDEV || count > 1))
                             {
-                                if (labelDir == CiftiXML::ALONG_ROW)
+                                const float* parcelRows = inData.data() + memberStart[i] * curCols;
+                                for (int64_t j = 0; j < curCols; ++j)
                                 {
-                                    scratchOutRow[j] = myOutXML.getLabelsMap(CiftiXML::ALONG_ROW).getMapLabelTable(j)->getUnassignedLabelKey();
-                                } else {
-                                    scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(indices[labelDir - 1])->getUnassignedLabelKey();
+                                    for (int64_t k = 0; k < count; ++k)
+                                    {
+                                        if (isLabel)
+                                        {
+                                            parcelData[k] = floor(parcelRows[k * curCols + j] + 0.5f);
+                                        } else {
+                                            parcelData[k] = parcelRows[k * curCols + j];
+                                        }
+                                    }
+                                    scratchOutRow[j] = reduceParcel(parcelData.data(), (parcelWeights == NULL ? NULL : (*parcelWeights)[i].data()), count,
+                                                                    method, excludeLow, excludeHigh, onlyNumeric);
                                 }
                             } else {
-                                scratchOutRow[j] = emptyFillVal;
+                                for (int64_t j = 0; j < curCols; ++j)
+                                {
+                                    scratchOutRow[j] = emptyFill[colStart + j];
+                                }
                             }
                         }
                     }
-                    myCiftiOut->setRow(scratchOutRow.data(), indices);
+                }
+                for (int i = 0; i < numParcels; ++i)
+                {
+                    indices[direction - 1] = i;
+                    myCiftiOut->setRow(outData.data() + i * numCols, indices);
                 }
             }
         }
     }
 }
 
+AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
+                                                   const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric,
+                                                   const bool& includeEmpty, const float& emptyFillVal, CiftiFile* emptyMaskOut) : AbstractAlgorithm(myProgObj)
+{
+    LevelProgress myProgress(myProgObj);
+    CaretAssert(direction >= 0);
+    const CiftiXML& myInputXML = myCiftiIn->getCiftiXML();
+    const CiftiXML& myLabelXML = myCiftiLabel->getCiftiXML();
+    vector<int64_t> dims = myInputXML.getDimensions();
+    if (direction >= (int)dims.size()) throw AlgorithmException("specified direction doesn't exist in input file");
+    if (myInputXML.getMappingType(direction) != CiftiMappingType::BRAIN_MODELS)
+    {
+        throw AlgorithmException("input cifti file does not have brain models mapping type in specified direction");
+    }
+    if (myLabelXML.getNumberOfDimensions() != 2 ||
+        myLabelXML.getMappingType(CiftiXML::ALONG_ROW) != CiftiMappingType::LABELS ||
+        myLabelXML.getMappingType(CiftiXML::ALONG_COLUMN) != CiftiMappingType::BRAIN_MODELS)
+    {
+        throw AlgorithmException("input cifti label file has the wrong mapping types");
+    }
+    const CiftiBrainModelsMap& inputDense = myInputXML.getBrainModelsMap(direction);
+    const CiftiBrainModelsMap& labelDense = myLabelXML.getBrainModelsMap(CiftiXML::ALONG_COLUMN);
+    if (inputDense.hasVolumeData())
+    {//don't check volume space if direction doesn't have volume data
+        if (labelDense.hasVolumeData() && !inputDense.getVolumeSpace().matches(labelDense.getVolumeSpace()))
+        {
+            throw AlgorithmException("input cifti files must have the same volume space");
+        }
+    }
+    vector<int> indexToParcel;
+    CiftiXML myOutXML = myInputXML;
+    CiftiParcelsMap outParcelMap = parcellateMapping(myCiftiLabel, inputDense, indexToParcel, includeEmpty);
+    int numParcels = outParcelMap.getLength();
+    if (numParcels < 1)
+    {
+        throw AlgorithmException("no parcels found, output file would be empty, aborting");
+    }
+    myOutXML.setMap(direction, outParcelMap);
+    myCiftiOut->setCiftiXML(myOutXML);
+    doParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, NULL, method, excludeLow, excludeHigh, onlyNumeric, emptyFillVal, emptyMaskOut);
+}
+
 AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
                                                    const MetricFile* leftWeights, const MetricFile* rightWeights, const MetricFile* cerebWeights, const ReductionEnum::Enum& method,
                                                    const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric,
@@ -773,7 +644,7 @@ AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, co
             }
         }
     }
-    doWeightedParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, parcelWeights, method, excludeLow, excludeHigh, onlyNumeric, emptyFillVal, emptyMaskOut);
+    doParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, &parcelWeights, method, excludeLow, excludeHigh, onlyNumeric, emptyFillVal, emptyMaskOut);
 }
 
 AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
@@ -835,7 +706,7 @@ AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, co
             parcelWeights[parcel].push_back(weightCol[j]);//we already tested that the dense mappings matched
         }
     }
-    doWeightedParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, parcelWeights, method, excludeLow, excludeHigh, onlyNumeric, emptyFillVal, emptyMaskOut);
+    doParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, &parcelWeights, method, excludeLow, excludeHigh, onlyNumeric, emptyFillVal, emptyMaskOut);
 }
 
 CiftiParcelsMap AlgorithmCiftiParcellate::parcellateMapping(const CiftiFile* myCiftiLabel, const CiftiBrainModelsMap& toParcellate, vector<int>& indexToParcelOut, const bool& includeEmpty)
@@ -859,6 +730,8 @@ CiftiParcelsMap AlgorithmCiftiParcellate::parcellateMapping(const CiftiFile* myC
         ret.setVolumeSpace(toParcellate.getVolumeSpace());
     }
     const GiftiLabelTable* myLabelTable = myLabelsMap.getMapLabelTable(0);
+    const GiftiLabelTableLookup myLabelLookup(myLabelTable);//flat key lookup, label indices are in key order
+    const int32_t numLabels = myLabelLookup.getNumberOfLabels();
     vector<float> labelData(myLabelXML.getDimensionLength(CiftiXML::ALONG_COLUMN));
     int unusedKey = myLabelTable->getUnassignedLabelKey();
     myCiftiLabel->getColumn(labelData.data(), 0);
@@ -868,17 +741,16 @@ CiftiParcelsMap AlgorithmCiftiParcellate::parcellateMapping(const CiftiFile* myC
     if (includeEmpty)
     {//if we include empty, then the dlabel file by itself determines the entire parcel map, ignoring the data map
         const vector<StructureEnum::Enum> labelSurfList = labelDenseMap.getSurfaceStructureList();
-        const set<int32_t> allLabelKeys = myLabelTable->getKeys();
-        map<int32_t, int32_t> keyToParcel;
+        vector<int32_t> labelToParcel(numLabels, -1);
         int32_t count = 0;
         vector<CiftiParcelsMap::Parcel> parcelList;
-        for (set<int32_t>::const_iterator iter = allLabelKeys.begin(); iter != allLabelKeys.end(); ++iter)
+        for (int32_t label = 0; label < numLabels; ++label)
         {
-            if (*iter != unusedKey)
+            if (myLabelLookup.getLabelKey(label) != unusedKey)
             {
-                keyToParcel[*iter] = count;
+                labelToParcel[label] = count;
                 parcelList.push_back(CiftiParcelsMap::Parcel());
-                parcelList.back().m_name = myLabelTable->getLabelName(*iter);
+                parcelList.back().m_name = myLabelLookup.getLabel(label)->getName();
                 ++count;
             }
         }
@@ -897,10 +769,10 @@ CiftiParcelsMap AlgorithmCiftiParcellate::parcellateMapping(const CiftiFile* myC
             for (int64_t j = 0; j < (int64_t)labelSurfMap.size(); ++j)
             {
                 int labelKey = (int)floor(labelData[labelSurfMap[j].m_ciftiIndex] + 0.5f);
-                map<int32_t, int32_t>::iterator found = keyToParcel.find(labelKey);//could be unlabeled, or wild key value
-                if (found != keyToParcel.end())
+                int32_t labelIndex = myLabelLookup.getLabelIndex(labelKey);//could be unlabeled, or wild key value
+                if (labelIndex != -1 && labelToParcel[labelIndex] != -1)
                 {
-                    int32_t whichParcel = found->second;
+                    int32_t whichParcel = labelToParcel[labelIndex];
                     parcelList[whichParcel].m_surfaceNodes[myStruct].insert(labelSurfMap[j].m_surfaceNode);
                     int64_t dataIndex = toParcellate.getIndexForNode(labelSurfMap[j].m_surfaceNode, myStruct);
                     if (dataIndex != -1)
@@ -914,10 +786,10 @@ CiftiParcelsMap AlgorithmCiftiParcellate::parcellateMapping(const CiftiFile* myC
         for (int64_t i = 0; i < (int64_t)labelVolMap.size(); ++i)
         {
             int labelKey = (int)floor(labelData[labelVolMap[i].m_ciftiIndex] + 0.5f);
-            map<int32_t, int32_t>::iterator found = keyToParcel.find(labelKey);//could be unlabeled, or wild key value
-            if (found != keyToParcel.end())
+            int32_t labelIndex = myLabelLookup.getLabelIndex(labelKey);//could be unlabeled, or wild key value
+            if (labelIndex != -1 && labelToParcel[labelIndex] != -1)
             {
-                int32_t whichParcel = found->second;
+                int32_t whichParcel = labelToParcel[labelIndex];
                 parcelList[whichParcel].m_voxelIndices.insert(labelVolMap[i].m_ijk);
                 int64_t dataIndex = toParcellate.getIndexForVoxel(labelVolMap[i].m_ijk);
                 if (dataIndex != -1)
@@ -931,7 +803,8 @@ CiftiParcelsMap AlgorithmCiftiParcellate::parcellateMapping(const CiftiFile* myC
             ret.addParcel(parcelList[i]);
         }
     } else {
-        map<int, pair<CiftiParcelsMap::Parcel, int> > usedKeys;//the keys from the label table that actually overlap with data in the input file
+        vector<int> labelToTemp(numLabels, -1);//the labels from the label table that actually overlap with data in the input file, in order of first use
+        vector<CiftiParcelsMap::Parcel> tempParcels;
         for (int i = 0; i < (int)surfList.size(); ++i)
         {
             StructureEnum::Enum myStruct = surfList[i];
@@ -950,26 +823,18 @@ CiftiParcelsMap AlgorithmCiftiParcellate::parcellateMapping(const CiftiFile* myC
                     if (labelIndex != -1)
                     {
                         int labelKey = (int)floor(labelData[labelIndex] + 0.5f);
-                        if (labelKey != unusedKey)
+                        int labelTableIndex = myLabelLookup.getLabelIndex(labelKey);
+                        if (labelKey != unusedKey && labelTableIndex != -1)//ignore values that aren't in the label table
                         {
-                            int tempVal = -1;
-                            map<int, pair<CiftiParcelsMap::Parcel, int> >::iterator iter = usedKeys.find(labelKey);
-                            if (iter == usedKeys.end())
+                            int tempVal = labelToTemp[labelTableIndex];
+                            if (tempVal == -1)
                             {
-                                const GiftiLabel* myLabel = myLabelTable->getLabel(labelKey);
-                                if (myLabel != NULL)//ignore values that aren't in the label table
-                                {
-                                    tempVal = usedKeys.size();
-                                    CiftiParcelsMap::Parcel tempParcel;
-                                    tempParcel.m_name = myLabel->getName();
-                                    tempParcel.m_surfaceNodes[myStruct].insert(surfMap[j].m_surfaceNode);
-                                    usedKeys[labelKey] = pair<CiftiParcelsMap::Parcel, int>(tempParcel, tempVal);
-                                }
-                            } else {
-                                tempVal = iter->second.second;
-                                CiftiParcelsMap::Parcel& tempParcel = iter->second.first;
-                                tempParcel.m_surfaceNodes[myStruct].insert(surfMap[j].m_surfaceNode);
+                                tempVal = tempParcels.size();
+                                labelToTemp[labelTableIndex] = tempVal;
+                                tempParcels.push_back(CiftiParcelsMap::Parcel());
+                                tempParcels.back().m_name = myLabelLookup.getLabel(labelTableIndex)->getName();
                             }
+                            tempParcels[tempVal].m_surfaceNodes[myStruct].insert(surfMap[j].m_surfaceNode);
                             indexToParcelOut[surfMap[j].m_ciftiIndex] = tempVal;//we will remap these to be in order of label keys later
                         }
                     }
@@ -983,38 +848,34 @@ CiftiParcelsMap AlgorithmCiftiParcellate::parcellateMapping(const CiftiFile* myC
             if (labelIndex != -1)
             {
                 int labelKey = (int)floor(labelData[labelIndex] + 0.5f);
-                if (labelKey != unusedKey)
+                int labelTableIndex = myLabelLookup.getLabelIndex(labelKey);
+                if (labelKey != unusedKey && labelTableIndex != -1)//ignore values that aren't in the label table
                 {
-                    int tempVal = -1;
-                    map<int, pair<CiftiParcelsMap::Parcel, int> >::iterator iter = usedKeys.find(labelKey);
-                    if (iter == usedKeys.end())
+                    int tempVal = labelToTemp[labelTableIndex];
+                    if (tempVal == -1)
                     {
-                        const GiftiLabel* myLabel = myLabelTable->getLabel(labelKey);
-                        if (myLabel != NULL)//ignore values that aren't in the label table
-                        {
-                            tempVal = usedKeys.size();
-                            CiftiParcelsMap::Parcel tempParcel;
-                            tempParcel.m_name = myLabel->getName();
-                            tempParcel.m_voxelIndices.insert(VoxelIJK(volMap[i].m_ijk));
-                            usedKeys[labelKey] = pair<CiftiParcelsMap::Parcel, int>(tempParcel, tempVal);
-                        }
-                    } else {
-                        tempVal = iter->second.second;
-                        CiftiParcelsMap::Parcel& tempParcel = iter->second.first;
-                        tempParcel.m_voxelIndices.insert(VoxelIJK(volMap[i].m_ijk));
+                        tempVal = tempParcels.size();
+                        labelToTemp[labelTableIndex] = tempVal;
+                        tempParcels.push_back(CiftiParcelsMap::Parcel());
+                        tempParcels.back().m_name = myLabelLookup.getLabel(labelTableIndex)->getName();
                     }
+                    tempParcels[tempVal].m_voxelIndices.insert(VoxelIJK(volMap[i].m_ijk));
                     indexToParcelOut[volMap[i].m_ciftiIndex] = tempVal;//we will remap these to be in order of label keys later
                 }
             }
         }
-        int numParcels = (int)usedKeys.size();
+        int numParcels = (int)tempParcels.size();
         vector<int> valRemap(numParcels, -1);
         int count = 0;
-        for (map<int, pair<CiftiParcelsMap::Parcel, int> >::const_iterator iter = usedKeys.begin(); iter != usedKeys.end(); ++iter)
+        for (int32_t label = 0; label < numLabels; ++label)//label indices are in key order
         {
-            valRemap[iter->second.second] = count;//build a lookup from temp values to label key rank
-            ret.addParcel(iter->second.first);
-            ++count;
+            int tempVal = labelToTemp[label];
+            if (tempVal != -1)
+            {
+                valRemap[tempVal] = count;//build a lookup from temp values to label key rank
+                ret.addParcel(tempParcels[tempVal]);
+                ++count;
+            }
         }
         int64_t lookupSize = (int64_t)indexToParcelOut.size();
         for (int64_t i = 0; i < lookupSize; ++i)//finally, remap the temporary values to the key order of the labels
@@ -26,6 +26,7 @@
 #include "MultiDimIterator.h"
 #include "ReductionOperation.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace caret;
@@ -111,16 +112,39 @@ AlgorithmCiftiReduce::AlgorithmCiftiReduce(ProgressObject* myProgObj, const Cift
         vector<float> scratchInRow(inDims[0]);
         for (MultiDimIterator<int64_t> iter(vector<int64_t>(inDims.begin() + 1, inDims.end())); !iter.atEnd(); ++iter)
         {// + 1 to exclude row dimension, because getRow/setRow
-            ciftiIn->getRow(scratchInRow.data(), *iter);
+            const float* inRow = ciftiIn->getRowPointer(*iter);//no copy needed when in memory
+            if (inRow == NULL)
+            {
+                ciftiIn->getRow(scratchInRow.data(), *iter);
+                inRow = scratchInRow.data();
+            }
             float result = -1;
             if (onlyNumeric)
             {
-                result = ReductionOperation::reduceOnlyNumeric(scratchInRow.data(), inDims[0], myReduce);
+                result = ReductionOperation::reduceOnlyNumeric(inRow, inDims[0], myReduce);
             } else {
-                result = ReductionOperation::reduce(scratchInRow.data(), inDims[0], myReduce);
+                result = ReductionOperation::reduce(inRow, inDims[0], myReduce);
             }
             ciftiOut->setRow(&result, *iter);//if reducing along row, length of output row is 1
         }
+    } else if (inDims.size() == 2) {//reducing along columns of a 2D file, gather panels of columns so that each reduction input is contiguous
+        const int64_t panelColumns = (ciftiIn->isInMemory() ? min((int64_t)64, inDims[0]) : inDims[0]);//on disk, read the file only once
+        vector<float> panel(panelColumns * inDims[1]), outRow(inDims[0]);
+        for (int64_t first = 0; first < inDims[0]; first += panelColumns)
+        {
+            const int64_t numInPanel = min(panelColumns, inDims[0] - first);
+            ciftiIn->getColumns(panel.data(), first, numInPanel);
+            for (int64_t c = 0; c < numInPanel; ++c)
+            {
+                if (onlyNumeric)
+                {
+                    outRow[first + c] = ReductionOperation::reduceOnlyNumeric(panel.data() + c * inDims[1], inDims[1], myReduce);
+                } else {
+                    outRow[first + c] = ReductionOperation::reduce(panel.data() + c * inDims[1], inDims[1], myReduce);
+                }
+            }
+        }
+        ciftiOut->setRow(outRow.data(), 0);
     } else {
         vector<vector<float> > scratchInRows(inDims[direction], vector<float>(inDims[0]));
         vector<float> outRow(inDims[0]), reduceScratch(inDims[direction]);//reduction isn't along row, so out rows will be same length as in rows
@@ -174,10 +198,28 @@ AlgorithmCiftiReduce::AlgorithmCiftiReduce(ProgressObject* myProgObj, const Cift
         vector<float> scratchInRow(inDims[0]);
         for (MultiDimIterator<int64_t> iter(vector<int64_t>(inDims.begin() + 1, inDims.end())); !iter.atEnd(); ++iter)
         {// + 1 to exclude row dimension, because getRow/setRow
-            ciftiIn->getRow(scratchInRow.data(), *iter);
-            float result = ReductionOperation::reduceExcludeDev(scratchInRow.data(), inDims[0], myReduce, sigmaBelow, sigmaAbove);
+            const float* inRow = ciftiIn->getRowPointer(*iter);//no copy needed when in memory
+            if (inRow == NULL)
+            {
+                ciftiIn->getRow(scratchInRow.data(), *iter);
+                inRow = scratchInRow.data();
+            }
+            float result = ReductionOperation::reduceExcludeDev(inRow, inDims[0], myReduce, sigmaBelow, sigmaAbove);
             ciftiOut->setRow(&result, *iter);//if reducing along row, length of output row is 1
         }
+    } else if (inDims.size() == 2) {//reducing along columns of a 2D file, gather panels of columns so that each reduction input is contiguous
+        const int64_t panelColumns = (ciftiIn->isInMemory() ? min((int64_t)64, inDims[0]) : inDims[0]);//on disk, read the file only once
+        vector<float> panel(panelColumns * inDims[1]), outRow(inDims[0]);
+        for (int64_t first = 0; first < inDims[0]; first += panelColumns)
+        {
+            const int64_t numInPanel = min(panelColumns, inDims[0] - first);
+            ciftiIn->getColumns(panel.data(), first, numInPanel);
+            for (int64_t c = 0; c < numInPanel; ++c)
+            {
+                outRow[first + c] = ReductionOperation::reduceExcludeDev(panel.data() + c * inDims[1], inDims[1], myReduce, sigmaBelow, sigmaAbove);
+            }
+        }
+        ciftiOut->setRow(outRow.data(), 0);
     } else {
         vector<vector<float> > scratchInRows(inDims[direction], vector<float>(inDims[0]));
         vector<float> outRow(inDims[0]), reduceScratch(inDims[direction]);//reduction isn't along row, so out rows will be same length as in rows
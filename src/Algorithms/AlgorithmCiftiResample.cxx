@@ -29,6 +29,8 @@
 #include "AlgorithmMetricResample.h"
 #include "AlgorithmVolumeAffineResample.h"
 #include "AlgorithmVolumeWarpfieldResample.h"
+#include "CaretOMP.h"
+#include "CaretPointer.h"
 #include "CiftiFile.h"
 #include "LabelFile.h"
 #include "MetricFile.h"
@@ -499,23 +501,41 @@ pair<bool, AString> AlgorithmCiftiResample::checkForErrors(const CiftiFile* myCi
 namespace
 {//so that we don't need these in the header file
     struct ResampleCache
-    {//a place to stuff anything that can be precomputed or reused for applying to the same structure in multiple maps
+    {//a place to stuff anything that can be precomputed or reused for applying to the same structure in multiple maps - shared by all threads, read only after setup
         SurfaceResamplingHelper surfResamp;
         VolumePaddingHelper volPadding;
         const SurfaceFile* curSphere, *newSphere;
-        MetricFile tempMetric1, tempMetric2, surfDilateRoi;
-        LabelFile tempLabel1, tempLabel2;
-        CaretPointer<VolumeFile> tempVol1, tempVol2, tempVol3, volDilateRoi;
+        MetricFile surfDilateRoi;
+        CaretPointer<VolumeFile> volDilateRoi;
         vector<CiftiBrainModelsMap::SurfaceMap> inSurfMap, outSurfMap;
         vector<CiftiBrainModelsMap::VolumeMap> inVolMap, outVolMap;
-        vector<float> floatScratch1, floatScratch2;
-        vector<int32_t> intScratch1, intScratch2;
-        vector<int64_t> inOffset;
+        int64_t inNumNodes;
+        vector<int64_t> inOffset, inDims;
+        vector<vector<float> > inSform;
         int64_t refDims[3], refOffset[3];
         vector<vector<float> > refSform;
         bool copyMode;
     };
     
+    struct ResampleScratch
+    {//per-thread scratch space for one structure
+        MetricFile tempMetric1, tempMetric2;
+        LabelFile tempLabel1, tempLabel2;
+        CaretPointer<VolumeFile> tempVol1, tempVol2, tempVol3;
+        vector<float> floatScratch1, floatScratch2;
+        vector<int32_t> intScratch1, intScratch2;
+    };
+    
+    struct RowResampleCaches
+    {//the weights are built once, the scratch space is per thread
+        map<StructureEnum::Enum, ResampleCache> surfCache, volCache;//could make them different types, but whatever - two variables in case of structure overlap in surface and volume, as some members may get used by both
+    };
+    
+    struct RowResampleScratch
+    {
+        map<StructureEnum::Enum, ResampleScratch> surfScratch, volScratch;
+    };
+    
     void setupRowResampling(map<StructureEnum::Enum, ResampleCache>& surfCache, map<StructureEnum::Enum, ResampleCache>& volCache, const CiftiFile* myCiftiIn, CiftiFile* myCiftiOut,
                             const SurfaceResamplingMethodEnum::Enum& mySurfMethod, const float& voldilatemm,
                             const SurfaceFile* curLeftSphere, const SurfaceFile* newLeftSphere, const MetricFile* curLeftAreas, const MetricFile* newLeftAreas,
@@ -523,7 +543,6 @@ namespace
                             const SurfaceFile* curCerebSphere, const SurfaceFile* newCerebSphere, const MetricFile* curCerebAreas, const MetricFile* newCerebAreas)
     {
         const CiftiXML& myInputXML = myCiftiIn->getCiftiXML(), &myOutXML = myCiftiOut->getCiftiXML();
-        bool labelMode = (myInputXML.getMappingType(CiftiXML::ALONG_COLUMN) == CiftiMappingType::LABELS);
         const CiftiBrainModelsMap& inModels = myInputXML.getBrainModelsMap(CiftiXML::ALONG_ROW), &outModels = myOutXML.getBrainModelsMap(CiftiXML::ALONG_ROW);
         vector<StructureEnum::Enum> surfList = outModels.getSurfaceStructureList(), volList = outModels.getVolumeStructureList();
         int numSurfStructs = (int)surfList.size(), numVolStructs = (int)volList.size();
@@ -558,10 +577,10 @@ namespace
             ResampleCache& myCache = surfCache[surfList[i]];
             myCache.inSurfMap = inModels.getSurfaceMap(surfList[i]);
             myCache.outSurfMap = outModels.getSurfaceMap(surfList[i]);
+            myCache.inNumNodes = inModels.getSurfaceNumberOfNodes(surfList[i]);
             if (curSphere == NULL)
             {
                 myCache.copyMode = true;
-                myCache.floatScratch1.resize(inModels.getSurfaceNumberOfNodes(surfList[i]), 0.0f);
                 continue;
             }
             myCache.copyMode = false;
@@ -586,54 +605,75 @@ namespace
             {
                 myCache.surfDilateRoi.setValue(j, 0, (tempRoi[j] > 0.0f ? 0.0f : 1.0f));
             }
-            if (labelMode)
-            {
-                myCache.intScratch1.resize(curSphere->getNumberOfNodes(), 0);
-                myCache.intScratch2.resize(newSphere->getNumberOfNodes(), 0);
-                myCache.tempLabel1.setNumberOfNodesAndColumns(newSphere->getNumberOfNodes(), 1);
-            } else {
-                myCache.floatScratch1.resize(curSphere->getNumberOfNodes(), 0.0f);
-                myCache.floatScratch2.resize(newSphere->getNumberOfNodes(), 0.0f);
-                myCache.tempMetric1.setNumberOfNodesAndColumns(newSphere->getNumberOfNodes(), 1);
-            }
         }
         for (int i = 0; i < numVolStructs; ++i)
         {
             ResampleCache& myCache = volCache[volList[i]];
             myCache.inVolMap = inModels.getVolumeStructureMap(volList[i]);
             myCache.outVolMap = outModels.getVolumeStructureMap(volList[i]);
-            vector<vector<float> > sform;
-            vector<int64_t> inDims(3);
+            myCache.inDims.resize(3);
             myCache.inOffset.resize(3);
-            myCache.floatScratch1.resize(inDims[0] * inDims[1] * inDims[2]);
-            AlgorithmCiftiSeparate::getCroppedVolSpace(myCiftiIn, CiftiXML::ALONG_ROW, volList[i], inDims.data(), sform, myCache.inOffset.data());
+            AlgorithmCiftiSeparate::getCroppedVolSpace(myCiftiIn, CiftiXML::ALONG_ROW, volList[i], myCache.inDims.data(), myCache.inSform, myCache.inOffset.data());
             AlgorithmCiftiSeparate::getCroppedVolSpace(myCiftiOut, CiftiXML::ALONG_ROW, volList[i], myCache.refDims, myCache.refSform, myCache.refOffset);
-            if (labelMode)
-            {
-                myCache.tempVol1.grabNew(new VolumeFile(inDims, sform, 1, SubvolumeAttributes::LABEL));
-            } else {
-                myCache.tempVol1.grabNew(new VolumeFile(inDims, sform));
-                myCache.tempVol1->setValueAllVoxels(0.0f);
-            }
-            myCache.tempVol2.grabNew(new VolumeFile(inDims, sform));//temporarily use to make the dilation roi, if needed
             if (voldilatemm > 0.0f)
             {
-                myCache.volPadding = VolumePaddingHelper::padMM(myCache.tempVol1, voldilatemm);
+                VolumeFile tempVol(myCache.inDims, myCache.inSform);//to make the dilation roi
+                myCache.volPadding = VolumePaddingHelper::padMM(&tempVol, voldilatemm);
                 myCache.volDilateRoi.grabNew(new VolumeFile());
-                myCache.tempVol3.grabNew(new VolumeFile());
-                myCache.tempVol2->setValueAllVoxels(1.0f);
+                tempVol.setValueAllVoxels(1.0f);
                 for (int j = 0; j < (int)myCache.inVolMap.size(); ++j)
                 {
-                    myCache.tempVol2->setValue(0.0f, myCache.inVolMap[j].m_ijk[0] - myCache.inOffset[0],
-                                                     myCache.inVolMap[j].m_ijk[1] - myCache.inOffset[1],
-                                                     myCache.inVolMap[j].m_ijk[2] - myCache.inOffset[2]);
+                    tempVol.setValue(0.0f, myCache.inVolMap[j].m_ijk[0] - myCache.inOffset[0],
+                                           myCache.inVolMap[j].m_ijk[1] - myCache.inOffset[1],
+                                           myCache.inVolMap[j].m_ijk[2] - myCache.inOffset[2]);
                 }
-                myCache.volPadding.doPadding(myCache.tempVol2, myCache.volDilateRoi, 1.0f);
+                myCache.volPadding.doPadding(&tempVol, myCache.volDilateRoi, 1.0f);
             }
         }
     }
     
-    void processRowSurface(ResampleCache& myCache, const vector<float>& inRow, vector<float>& outRow, const CiftiXML& myInputXML,
+    void setupRowScratch(const RowResampleCaches& myCaches, RowResampleScratch& myScratch, const bool& labelMode, const float& voldilatemm)
+    {//only sizes scratch space, so it is cheap to do for every thread
+        for (map<StructureEnum::Enum, ResampleCache>::const_iterator iter = myCaches.surfCache.begin(); iter != myCaches.surfCache.end(); ++iter)
+        {
+            const ResampleCache& myCache = iter->second;
+            ResampleScratch& scratch = myScratch.surfScratch[iter->first];
+            if (myCache.copyMode)
+            {
+                scratch.floatScratch1.resize(myCache.inNumNodes, 0.0f);
+                continue;
+            }
+            if (labelMode)
+            {
+                scratch.intScratch1.resize(myCache.curSphere->getNumberOfNodes(), 0);
+                scratch.intScratch2.resize(myCache.newSphere->getNumberOfNodes(), 0);
+                scratch.tempLabel1.setNumberOfNodesAndColumns(myCache.newSphere->getNumberOfNodes(), 1);
+            } else {
+                scratch.floatScratch1.resize(myCache.curSphere->getNumberOfNodes(), 0.0f);
+                scratch.floatScratch2.resize(myCache.newSphere->getNumberOfNodes(), 0.0f);
+                scratch.tempMetric1.setNumberOfNodesAndColumns(myCache.newSphere->getNumberOfNodes(), 1);
+            }
+        }
+        for (map<StructureEnum::Enum, ResampleCache>::const_iterator iter = myCaches.volCache.begin(); iter != myCaches.volCache.end(); ++iter)
+        {
+            const ResampleCache& myCache = iter->second;
+            ResampleScratch& scratch = myScratch.volScratch[iter->first];
+            if (labelMode)
+            {
+                scratch.tempVol1.grabNew(new VolumeFile(myCache.inDims, myCache.inSform, 1, SubvolumeAttributes::LABEL));
+            } else {
+                scratch.tempVol1.grabNew(new VolumeFile(myCache.inDims, myCache.inSform));
+                scratch.tempVol1->setValueAllVoxels(0.0f);
+            }
+            scratch.tempVol2.grabNew(new VolumeFile(myCache.inDims, myCache.inSform));
+            if (voldilatemm > 0.0f)
+            {
+                scratch.tempVol3.grabNew(new VolumeFile());
+            }
+        }
+    }
+    
+    void processRowSurface(const ResampleCache& myCache, ResampleScratch& myScratch, const float* inRow, float* outRow, const CiftiXML& myInputXML,
                            const float& surfdilatemm, const bool& surfLargest, const int& unassignedLabelKey, const int64_t& row,
                            const AlgorithmMetricDilate::Method& surfDilateMethod, const float& surfDilateExponent)
     {
@@ -643,11 +683,11 @@ namespace
         {
             for (int j = 0; j < inMapSize; ++j)
             {
-                myCache.floatScratch1[myCache.inSurfMap[j].m_surfaceNode] = inRow[myCache.inSurfMap[j].m_ciftiIndex];
+                myScratch.floatScratch1[myCache.inSurfMap[j].m_surfaceNode] = inRow[myCache.inSurfMap[j].m_ciftiIndex];
             }
             for (int j = 0; j < outMapSize; ++j)
             {
-                outRow[myCache.outSurfMap[j].m_ciftiIndex] = myCache.floatScratch1[myCache.outSurfMap[j].m_surfaceNode];
+                outRow[myCache.outSurfMap[j].m_ciftiIndex] = myScratch.floatScratch1[myCache.outSurfMap[j].m_surfaceNode];
             }
         } else {
             if (labelMode)
@@ -655,21 +695,21 @@ namespace
                 const CiftiLabelsMap& myLabelMap = myInputXML.getLabelsMap(CiftiXML::ALONG_COLUMN);
                 for (int j = 0; j < inMapSize; ++j)
                 {
-                    myCache.intScratch1[myCache.inSurfMap[j].m_surfaceNode] = (int)floor(inRow[myCache.inSurfMap[j].m_ciftiIndex] + 0.5f);
+                    myScratch.intScratch1[myCache.inSurfMap[j].m_surfaceNode] = (int)floor(inRow[myCache.inSurfMap[j].m_ciftiIndex] + 0.5f);
                 }
                 if (surfLargest)
                 {
-                    myCache.surfResamp.resampleLargest(myCache.intScratch1.data(), myCache.intScratch2.data(), unassignedLabelKey);
+                    myCache.surfResamp.resampleLargest(myScratch.intScratch1.data(), myScratch.intScratch2.data(), unassignedLabelKey);
                 } else {
-                    myCache.surfResamp.resamplePopular(myCache.intScratch1.data(), myCache.intScratch2.data(), unassignedLabelKey);
+                    myCache.surfResamp.resamplePopular(myScratch.intScratch1.data(), myScratch.intScratch2.data(), unassignedLabelKey);
                 }
-                *(myCache.tempLabel1.getLabelTable()) = *(myLabelMap.getMapLabelTable(row));
-                myCache.tempLabel1.setLabelKeysForColumn(0, myCache.intScratch2.data());
-                LabelFile* toUse = &(myCache.tempLabel1);
+                *(myScratch.tempLabel1.getLabelTable()) = *(myLabelMap.getMapLabelTable(row));
+                myScratch.tempLabel1.setLabelKeysForColumn(0, myScratch.intScratch2.data());
+                LabelFile* toUse = &(myScratch.tempLabel1);
                 if (surfdilatemm > 0.0f)
                 {
-                    AlgorithmLabelDilate(NULL, toUse, myCache.newSphere, surfdilatemm, &(myCache.tempLabel2), &(myCache.surfDilateRoi), 0);
-                    toUse = &(myCache.tempLabel2);
+                    AlgorithmLabelDilate(NULL, toUse, myCache.newSphere, surfdilatemm, &(myScratch.tempLabel2), &(myCache.surfDilateRoi), 0);
+                    toUse = &(myScratch.tempLabel2);
                 }
                 const int32_t* outData = toUse->getLabelKeyPointerForColumn(0);
                 for (int j = 0; j < outMapSize; ++j)
@@ -679,20 +719,20 @@ namespace
             } else {
                 for (int j = 0; j < inMapSize; ++j)
                 {
-                    myCache.floatScratch1[myCache.inSurfMap[j].m_surfaceNode] = inRow[myCache.inSurfMap[j].m_ciftiIndex];
+                    myScratch.floatScratch1[myCache.inSurfMap[j].m_surfaceNode] = inRow[myCache.inSurfMap[j].m_ciftiIndex];
                 }
                 if (surfLargest)
                 {
-                    myCache.surfResamp.resampleLargest(myCache.floatScratch1.data(), myCache.floatScratch2.data());
+                    myCache.surfResamp.resampleLargest(myScratch.floatScratch1.data(), myScratch.floatScratch2.data());
                 } else {
-                    myCache.surfResamp.resampleNormal(myCache.floatScratch1.data(), myCache.floatScratch2.data());
+                    myCache.surfResamp.resampleNormal(myScratch.floatScratch1.data(), myScratch.floatScratch2.data());
                 }
-                myCache.tempMetric1.setValuesForColumn(0, myCache.floatScratch2.data());
-                MetricFile* toUse = &(myCache.tempMetric1);
+                myScratch.tempMetric1.setValuesForColumn(0, myScratch.floatScratch2.data());
+                MetricFile* toUse = &(myScratch.tempMetric1);
                 if (surfdilatemm > 0.0f)
                 {
-                    AlgorithmMetricDilate(NULL, toUse, myCache.newSphere, surfdilatemm, &(myCache.tempMetric2), &(myCache.surfDilateRoi), NULL, 0, surfDilateMethod, surfDilateExponent);
-                    toUse = &(myCache.tempMetric2);
+                    AlgorithmMetricDilate(NULL, toUse, myCache.newSphere, surfdilatemm, &(myScratch.tempMetric2), &(myCache.surfDilateRoi), NULL, 0, surfDilateMethod, surfDilateExponent);
+                    toUse = &(myScratch.tempMetric2);
                 }
                 const float* outData = toUse->getValuePointerForColumn(0);
                 for (int j = 0; j < outMapSize; ++j)
@@ -776,54 +816,95 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
                 unassignedLabelKey[i] = myLabelMap.getMapLabelTable(i)->getUnassignedLabelKey();
             }
         }
-        map<StructureEnum::Enum, ResampleCache> surfCache, volCache;//could make them different types, but whatever - two variables in case of structure overlap in surface and volume, as some members may get used by both
-        setupRowResampling(surfCache, volCache, myCiftiIn, myCiftiOut, mySurfMethod, voldilatemm,
+        int64_t numRows = myInputXML.getDimensionLength(CiftiXML::ALONG_COLUMN);
+        int64_t inRowLength = myInputXML.getDimensionLength(CiftiXML::ALONG_ROW), outRowLength = myOutXML.getDimensionLength(CiftiXML::ALONG_ROW);
+        int numThreads = 1;
+#ifdef CARET_OMP
+        numThreads = omp_get_max_threads();
+#endif
+        RowResampleCaches myCaches;//resampling weights and dilation rois are built once and shared by all threads
+        setupRowResampling(myCaches.surfCache, myCaches.volCache, myCiftiIn, myCiftiOut, mySurfMethod, voldilatemm,
                            curLeftSphere, newLeftSphere, curLeftAreas, newLeftAreas,
                            curRightSphere, newRightSphere, curRightAreas, newRightAreas,
                            curCerebSphere, newCerebSphere, curCerebAreas, newCerebAreas);
-        int64_t numRows = myInputXML.getDimensionLength(CiftiXML::ALONG_COLUMN);
-        vector<float> inRow(myInputXML.getDimensionLength(CiftiXML::ALONG_ROW)), outRow(myOutXML.getDimensionLength(CiftiXML::ALONG_ROW));
-        for (int64_t row = 0; row < numRows; ++row)
+        vector<RowResampleScratch> threadScratch(numThreads);//only scratch space is per thread
+        for (int i = 0; i < numThreads; ++i)
+        {
+            setupRowScratch(myCaches, threadScratch[i], labelMode, voldilatemm);
+        }
+        int64_t blockRows = max((int64_t)1, min(numRows, (int64_t)numThreads * 4));//rows are read and written in order a block at a time, and resampled in parallel
+        vector<float> inBlock(blockRows * inRowLength), outBlock(blockRows * outRowLength);
+        vector<AString> errors(blockRows);
+        for (int64_t blockStart = 0; blockStart < numRows; blockStart += blockRows)
         {
-            myCiftiIn->getRow(inRow.data(), row);
-            for (int i = 0; i < numSurfStructs; ++i)
+            int64_t blockEnd = min(blockStart + blockRows, numRows);
+            for (int64_t row = blockStart; row < blockEnd; ++row)
             {
-                map<StructureEnum::Enum, ResampleCache>::iterator iter = surfCache.find(surfList[i]);
-                CaretAssert(iter != surfCache.end());
-                processRowSurface(iter->second, inRow, outRow, myInputXML, surfdilatemm, surfLargest, unassignedLabelKey[row], row, surfDilateMethod, surfDilateExponent);
+                myCiftiIn->getRow(inBlock.data() + (row - blockStart) * inRowLength, row);
             }
-            for (int i = 0; i < numVolStructs; ++i)
+#pragma omp CARET_PARFOR schedule(dynamic)
+            for (int64_t row = blockStart; row < blockEnd; ++row)
             {
-                map<StructureEnum::Enum, ResampleCache>::iterator iter = volCache.find(volList[i]);
-                CaretAssert(iter != volCache.end());
-                ResampleCache& myCache = iter->second;
-                if (labelMode)//gets initialized to 0 when not using labels
+                try
                 {
-                    myCache.tempVol1->setValueAllVoxels(unassignedLabelKey[row]);
-                }
-                int inMapSize = (int)myCache.inVolMap.size(), outMapSize = (int)myCache.outVolMap.size();
-                for (int j = 0; j < inMapSize; ++j)
-                {
-                    myCache.tempVol1->setValue(inRow[myCache.inVolMap[j].m_ciftiIndex], myCache.inVolMap[j].m_ijk[0] - myCache.inOffset[0],
-                                               myCache.inVolMap[j].m_ijk[1] - myCache.inOffset[1],
-                                               myCache.inVolMap[j].m_ijk[2] - myCache.inOffset[2]);
-                }
-                const VolumeFile* toResample = myCache.tempVol1;
-                if (voldilatemm > 0.0f)
-                {
-                    myCache.volPadding.doPadding(myCache.tempVol1, myCache.tempVol2);
-                    AlgorithmVolumeDilate(NULL, myCache.tempVol2, voldilatemm, volDilateMethod, myCache.tempVol3, myCache.volDilateRoi, NULL, -1, volDilateExponent);
-                    toResample = myCache.tempVol3;
-                }
-                AlgorithmVolumeWarpfieldResample(NULL, toResample, warpfield, myCache.refDims, myCache.refSform, myVolMethod, myCache.tempVol2);
-                for (int j = 0; j < outMapSize; ++j)
-                {
-                    outRow[myCache.outVolMap[j].m_ciftiIndex] = myCache.tempVol2->getValue(myCache.outVolMap[j].m_ijk[0] - myCache.refOffset[0],
-                                                                                           myCache.outVolMap[j].m_ijk[1] - myCache.refOffset[1],
-                                                                                           myCache.outVolMap[j].m_ijk[2] - myCache.refOffset[2]);
+                    int thread = 0;
+#ifdef CARET_OMP
+                    thread = omp_get_thread_num();
+#endif
+                    RowResampleScratch& myScratch = threadScratch[thread];
+                    const float* inRow = inBlock.data() + (row - blockStart) * inRowLength;
+                    float* outRow = outBlock.data() + (row - blockStart) * outRowLength;
+                    int rowUnassignedKey = (unassignedLabelKey.empty() ? 0 : unassignedLabelKey[row]);
+                    for (int i = 0; i < numSurfStructs; ++i)
+                    {
+                        map<StructureEnum::Enum, ResampleCache>::const_iterator iter = myCaches.surfCache.find(surfList[i]);
+                        CaretAssert(iter != myCaches.surfCache.end());
+                        processRowSurface(iter->second, myScratch.surfScratch[surfList[i]], inRow, outRow, myInputXML, surfdilatemm, surfLargest, rowUnassignedKey, row, surfDilateMethod, surfDilateExponent);
+                    }
+                    for (int i = 0; i < numVolStructs; ++i)
+                    {
+                        map<StructureEnum::Enum, ResampleCache>::const_iterator iter = myCaches.volCache.find(volList[i]);
+                        CaretAssert(iter != myCaches.volCache.end());
+                        const ResampleCache& myCache = iter->second;
+                        ResampleScratch& scratch = myScratch.volScratch[volList[i]];
+                        if (labelMode)//gets initialized to 0 when not using labels
+                        {
+                            scratch.tempVol1->setValueAllVoxels(rowUnassignedKey);
+                        }
+                        int inMapSize = (int)myCache.inVolMap.size(), outMapSize = (int)myCache.outVolMap.size();
+                        for (int j = 0; j < inMapSize; ++j)
+                        {
+                            scratch.tempVol1->setValue(inRow[myCache.inVolMap[j].m_ciftiIndex], myCache.inVolMap[j].m_ijk[0] - myCache.inOffset[0],
+                                                       myCache.inVolMap[j].m_ijk[1] - myCache.inOffset[1],
+                                                       myCache.inVolMap[j].m_ijk[2] - myCache.inOffset[2]);
+                        }
+                        const VolumeFile* toResample = scratch.tempVol1;
+                        if (voldilatemm > 0.0f)
+                        {
+                            myCache.volPadding.doPadding(scratch.tempVol1, scratch.tempVol2);
+                            AlgorithmVolumeDilate(NULL, scratch.tempVol2, voldilatemm, volDilateMethod, scratch.tempVol3, myCache.volDilateRoi, NULL, -1, volDilateExponent);
+                            toResample = scratch.tempVol3;
+                        }
+                        AlgorithmVolumeWarpfieldResample(NULL, toResample, warpfield, myCache.refDims, myCache.refSform, myVolMethod, scratch.tempVol2);
+                        for (int j = 0; j < outMapSize; ++j)
+                        {
+                            outRow[myCache.outVolMap[j].m_ciftiIndex] = scratch.tempVol2->getValue(myCache.outVolMap[j].m_ijk[0] - myCache.refOffset[0],
+                                                                                                   myCache.outVolMap[j].m_ijk[1] - myCache.refOffset[1],
+                                                                                                   myCache.outVolMap[j].m_ijk[2] - myCache.refOffset[2]);
+                        }
+                    }
+                } catch (CaretException& e) {
+                    errors[row - blockStart] = e.whatString();
                 }
             }
-            myCiftiOut->setRow(outRow.data(), row);
+            for (int64_t row = blockStart; row < blockEnd; ++row)
+            {
+                if (errors[row - blockStart] != "") throw AlgorithmException(errors[row - blockStart]);
+            }
+            for (int64_t row = blockStart; row < blockEnd; ++row)
+            {
+                myCiftiOut->setRow(outBlock.data() + (row - blockStart) * outRowLength, row);
+            }
         }
     }
 }
@@ -899,50 +980,91 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
                 unassignedLabelKey[i] = myLabelMap.getMapLabelTable(i)->getUnassignedLabelKey();
             }
         }
-        map<StructureEnum::Enum, ResampleCache> surfCache, volCache;//could make them different types, but whatever - two variables in case of structure overlap in surface and volume, as some members may get used by both
-        setupRowResampling(surfCache, volCache, myCiftiIn, myCiftiOut, mySurfMethod, voldilatemm,
+        int64_t numRows = myInputXML.getDimensionLength(CiftiXML::ALONG_COLUMN);
+        int64_t inRowLength = myInputXML.getDimensionLength(CiftiXML::ALONG_ROW), outRowLength = myOutXML.getDimensionLength(CiftiXML::ALONG_ROW);
+        int numThreads = 1;
+#ifdef CARET_OMP
+        numThreads = omp_get_max_threads();
+#endif
+        RowResampleCaches myCaches;//resampling weights and dilation rois are built once and shared by all threads
+        setupRowResampling(myCaches.surfCache, myCaches.volCache, myCiftiIn, myCiftiOut, mySurfMethod, voldilatemm,
                            curLeftSphere, newLeftSphere, curLeftAreas, newLeftAreas,
                            curRightSphere, newRightSphere, curRightAreas, newRightAreas,
                            curCerebSphere, newCerebSphere, curCerebAreas, newCerebAreas);
-        int64_t numRows = myInputXML.getDimensionLength(CiftiXML::ALONG_COLUMN);
-        vector<float> inRow(myInputXML.getDimensionLength(CiftiXML::ALONG_ROW)), outRow(myOutXML.getDimensionLength(CiftiXML::ALONG_ROW));
-        for (int64_t row = 0; row < numRows; ++row)
+        vector<RowResampleScratch> threadScratch(numThreads);//only scratch space is per thread
+        for (int i = 0; i < numThreads; ++i)
+        {
+            setupRowScratch(myCaches, threadScratch[i], labelMode, voldilatemm);
+        }
+        int64_t blockRows = max((int64_t)1, min(numRows, (int64_t)numThreads * 4));//rows are read and written in order a block at a time, and resampled in parallel
+        vector<float> inBlock(blockRows * inRowLength), outBlock(blockRows * outRowLength);
+        vector<AString> errors(blockRows);
+        for (int64_t blockStart = 0; blockStart < numRows; blockStart += blockRows)
         {
-            myCiftiIn->getRow(inRow.data(), row);
-            for (int i = 0; i < numSurfStructs; ++i)
+            int64_t blockEnd = min(blockStart + blockRows, numRows);
+            for (int64_t row = blockStart; row < blockEnd; ++row)
             {
-                map<StructureEnum::Enum, ResampleCache>::iterator iter = surfCache.find(surfList[i]);
-                CaretAssert(iter != surfCache.end());
-                processRowSurface(iter->second, inRow, outRow, myInputXML, surfdilatemm, surfLargest, unassignedLabelKey[row], row, surfDilateMethod, surfDilateExponent);
+                myCiftiIn->getRow(inBlock.data() + (row - blockStart) * inRowLength, row);
             }
-            for (int i = 0; i < numVolStructs; ++i)
+#pragma omp CARET_PARFOR schedule(dynamic)
+            for (int64_t row = blockStart; row < blockEnd; ++row)
             {
-                map<StructureEnum::Enum, ResampleCache>::iterator iter = volCache.find(volList[i]);
-                CaretAssert(iter != volCache.end());
-                ResampleCache& myCache = iter->second;
-                int inMapSize = (int)myCache.inVolMap.size(), outMapSize = (int)myCache.outVolMap.size();
-                for (int j = 0; j < inMapSize; ++j)
+                try
                 {
-                    myCache.tempVol1->setValue(inRow[myCache.inVolMap[j].m_ciftiIndex], myCache.inVolMap[j].m_ijk[0] - myCache.inOffset[0],
-                                               myCache.inVolMap[j].m_ijk[1] - myCache.inOffset[1],
-                                               myCache.inVolMap[j].m_ijk[2] - myCache.inOffset[2]);
-                }
-                const VolumeFile* toResample = myCache.tempVol1;
-                if (voldilatemm > 0.0f)
-                {
-                    myCache.volPadding.doPadding(myCache.tempVol1, myCache.tempVol2);
-                    AlgorithmVolumeDilate(NULL, myCache.tempVol2, voldilatemm, volDilateMethod, myCache.tempVol3, myCache.volDilateRoi, NULL, -1, volDilateExponent);
-                    toResample = myCache.tempVol3;
-                }
-                AlgorithmVolumeAffineResample(NULL, toResample, affine, myCache.refDims, myCache.refSform, myVolMethod, myCache.tempVol2);
-                for (int j = 0; j < outMapSize; ++j)
-                {
-                    outRow[myCache.outVolMap[j].m_ciftiIndex] = myCache.tempVol2->getValue(myCache.outVolMap[j].m_ijk[0] - myCache.refOffset[0],
-                                                                                           myCache.outVolMap[j].m_ijk[1] - myCache.refOffset[1],
-                                                                                           myCache.outVolMap[j].m_ijk[2] - myCache.refOffset[2]);
+                    int thread = 0;
+#ifdef CARET_OMP
+                    thread = omp_get_thread_num();
+#endif
+                    RowResampleScratch& myScratch = threadScratch[thread];
+                    const float* inRow = inBlock.data() + (row - blockStart) * inRowLength;
+                    float* outRow = outBlock.data() + (row - blockStart) * outRowLength;
+                    int rowUnassignedKey = (unassignedLabelKey.empty() ? 0 : unassignedLabelKey[row]);
+                    for (int i = 0; i < numSurfStructs; ++i)
+                    {
+                        map<StructureEnum::Enum, ResampleCache>::const_iterator iter = myCaches.surfCache.find(surfList[i]);
+                        CaretAssert(iter != myCaches.surfCache.end());
+                        processRowSurface(iter->second, myScratch.surfScratch[surfList[i]], inRow, outRow, myInputXML, surfdilatemm, surfLargest, rowUnassignedKey, row, surfDilateMethod, surfDilateExponent);
+                    }
+                    for (int i = 0; i < numVolStructs; ++i)
+                    {
+                        map<StructureEnum::Enum, ResampleCache>::const_iterator iter = myCaches.volCache.find(volList[i]);
+                        CaretAssert(iter != myCaches.volCache.end());
+                        const ResampleCache& myCache = iter->second;
+                        ResampleScratch& scratch = myScratch.volScratch[volList[i]];
+                        int inMapSize = (int)myCache.inVolMap.size(), outMapSize = (int)myCache.outVolMap.size();
+                        for (int j = 0; j < inMapSize; ++j)
+                        {
+                            scratch.tempVol1->setValue(inRow[myCache.inVolMap[j].m_ciftiIndex], myCache.inVolMap[j].m_ijk[0] - myCache.inOffset[0],
+                                                       myCache.inVolMap[j].m_ijk[1] - myCache.inOffset[1],
+                                                       myCache.inVolMap[j].m_ijk[2] - myCache.inOffset[2]);
+                        }
+                        const VolumeFile* toResample = scratch.tempVol1;
+                        if (voldilatemm > 0.0f)
+                        {
+                            myCache.volPadding.doPadding(scratch.tempVol1, scratch.tempVol2);
+                            AlgorithmVolumeDilate(NULL, scratch.tempVol2, voldilatemm, volDilateMethod, scratch.tempVol3, myCache.volDilateRoi, NULL, -1, volDilateExponent);
+                            toResample = scratch.tempVol3;
+                        }
+                        AlgorithmVolumeAffineResample(NULL, toResample, affine, myCache.refDims, myCache.refSform, myVolMethod, scratch.tempVol2);
+                        for (int j = 0; j < outMapSize; ++j)
+                        {
+                            outRow[myCache.outVolMap[j].m_ciftiIndex] = scratch.tempVol2->getValue(myCache.outVolMap[j].m_ijk[0] - myCache.refOffset[0],
+                                                                                                   myCache.outVolMap[j].m_ijk[1] - myCache.refOffset[1],
+                                                                                                   myCache.outVolMap[j].m_ijk[2] - myCache.refOffset[2]);
+                        }
+                    }
+                } catch (CaretException& e) {
+                    errors[row - blockStart] = e.whatString();
                 }
             }
-            myCiftiOut->setRow(outRow.data(), row);
+            for (int64_t row = blockStart; row < blockEnd; ++row)
+            {
+                if (errors[row - blockStart] != "") throw AlgorithmException(errors[row - blockStart]);
+            }
+            for (int64_t row = blockStart; row < blockEnd; ++row)
+            {
+                myCiftiOut->setRow(outBlock.data() + (row - blockStart) * outRowLength, row);
+            }
         }
     }
 }
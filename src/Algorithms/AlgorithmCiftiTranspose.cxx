@@ -91,23 +91,15 @@ AlgorithmCiftiTranspose::AlgorithmCiftiTranspose(ProgressObject* myProgObj, cons
         if (numCacheRows < 1) numCacheRows = 1;
         if (numCacheRows > colSize) numCacheRows = colSize;
     }
-    vector<vector<float> > cacheRows(numCacheRows, vector<float>(rowSize));
-    vector<float> scratchInRow(colSize);
+    vector<float> cachePanel((int64_t)numCacheRows * rowSize);//output rows are input columns, so gather them as a column panel
     for (int i = 0; i < colSize; i += numCacheRows)//loop through cache chunks
     {
         int end = i + numCacheRows;
         if (end > colSize) end = colSize;
-        for (int j = 0; j < rowSize; ++j)//loop through all input rows
-        {
-            ciftiIn->getRow(scratchInRow.data(), j);
-            for (int k = i; k < end; ++k)
-            {
-                cacheRows[k - i][j] = scratchInRow[k];
-            }
-        }
+        ciftiIn->getColumns(cachePanel.data(), i, end - i);//reads each input row once per chunk if on disk
         for (int k = i; k < end; ++k)
         {
-            ciftiOut->setRow(cacheRows[k - i].data(), k);
+            ciftiOut->setRow(cachePanel.data() + (int64_t)(k - i) * rowSize, k);
         }
     }
 }
@@ -252,36 +252,64 @@ AlgorithmCreateSignedDistanceVolume::AlgorithmCreateSignedDistanceVolume(Progres
             }
         }
     }
-    vector<int64_t> exactVoxelList;
+    const int64_t BLOCK_SIZE = 4;//gather voxels in small bricks, so that consecutive distance queries are near each other
+    vector<int64_t> exactVoxelList, blockStarts;
     int64_t ijk[3];
-    for (ijk[2] = 0; ijk[2] < myDims[2]; ++ijk[2])
+    for (int64_t bk = 0; bk < myDims[2]; bk += BLOCK_SIZE)
     {
-        for (ijk[1] = 0; ijk[1] < myDims[1]; ++ijk[1])
+        for (int64_t bj = 0; bj < myDims[1]; bj += BLOCK_SIZE)
         {
-            for (ijk[0] = 0; ijk[0] < myDims[0]; ++ijk[0])
+            for (int64_t bi = 0; bi < myDims[0]; bi += BLOCK_SIZE)
             {
-                if (volMarked[myVolOut->getIndex(ijk)] == 1)
+                int64_t blockStart = (int64_t)exactVoxelList.size();
+                for (ijk[2] = bk; ijk[2] < min(bk + BLOCK_SIZE, myDims[2]); ++ijk[2])
                 {
-                    exactVoxelList.push_back(ijk[0]);
-                    exactVoxelList.push_back(ijk[1]);
-                    exactVoxelList.push_back(ijk[2]);
+                    for (ijk[1] = bj; ijk[1] < min(bj + BLOCK_SIZE, myDims[1]); ++ijk[1])
+                    {
+                        for (ijk[0] = bi; ijk[0] < min(bi + BLOCK_SIZE, myDims[0]); ++ijk[0])
+                        {
+                            if (volMarked[myVolOut->getIndex(ijk)] == 1)
+                            {
+                                exactVoxelList.push_back(ijk[0]);
+                                exactVoxelList.push_back(ijk[1]);
+                                exactVoxelList.push_back(ijk[2]);
+                            }
+                        }
+                    }
+                }
+                if ((int64_t)exactVoxelList.size() != blockStart)
+                {
+                    blockStarts.push_back(blockStart);
                 }
             }
         }
     }
+    blockStarts.push_back((int64_t)exactVoxelList.size());//sentinel for the end of the last block
     myProgress.reportProgress(markweight);
     myProgress.setTask("computing exact distances");
 #pragma omp CARET_PAR
     {
         CaretPointer<SignedDistanceHelper> myDist = mySurf->getSignedDistanceHelper();
-        int numExact = (int)exactVoxelList.size();
-        Vector3D thisCoord;
+        int numBlocks = (int)blockStarts.size() - 1;
+        vector<float> blockCoords, blockDists;
 #pragma omp CARET_FOR schedule(dynamic)
-        for (int i = 0; i < numExact; i += 3)
+        for (int block = 0; block < numBlocks; ++block)
         {
-            myVolOut->indexToSpace(exactVoxelList.data() + i, thisCoord);
-            myVolOut->setValue(myDist->dist(thisCoord, myWinding), exactVoxelList.data() + i);
-            volMarked[myVolOut->getIndex(exactVoxelList.data() + i)] |= 22;//set marked to have valid value (positive and negative), and frozen
+            int64_t blockStart = blockStarts[block];
+            int64_t blockVoxels = (blockStarts[block + 1] - blockStart) / 3;
+            blockCoords.resize(blockVoxels * 3);
+            blockDists.resize(blockVoxels);
+            for (int64_t i = 0; i < blockVoxels; ++i)
+            {
+                myVolOut->indexToSpace(exactVoxelList.data() + blockStart + i * 3, blockCoords.data() + i * 3);
+            }
+            myDist->dist(blockCoords.data(), blockVoxels, myWinding, blockDists.data());
+            for (int64_t i = 0; i < blockVoxels; ++i)
+            {
+                const int64_t* thisVoxel = exactVoxelList.data() + blockStart + i * 3;
+                myVolOut->setValue(blockDists[i], thisVoxel);
+                volMarked[myVolOut->getIndex(thisVoxel)] |= 22;//set marked to have valid value (positive and negative), and frozen
+            }
         }
     }
     myProgress.reportProgress(markweight + exactweight);
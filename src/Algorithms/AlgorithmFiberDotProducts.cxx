@@ -21,6 +21,7 @@
 #include "AlgorithmFiberDotProducts.h"
 #include "AlgorithmException.h"
 #include "CiftiFile.h"
+#include "CaretOMP.h"
 #include "CaretPointLocator.h"
 #include "MetricFile.h"
 #include "SignedDistanceHelper.h"
@@ -92,34 +93,48 @@ void AlgorithmFiberDotProducts::useParameters(OperationParameters* myParams, Pro
 AlgorithmFiberDotProducts::AlgorithmFiberDotProducts(ProgressObject* myProgObj, const SurfaceFile* mySurf, const CiftiFile* myFibers, const float& maxDist, const Direction& myTest, MetricFile* myDotProdOut, MetricFile* myFSampOut) : AbstractAlgorithm(myProgObj)
 {
     LevelProgress myProgress(myProgObj);
-    CaretPointer<SignedDistanceHelper> mySignedHelp = mySurf->getSignedDistanceHelper();
     int rowSize = myFibers->getNumberOfColumns();
     if ((rowSize - 3) % 7 != 0) throw AlgorithmException("input is not a fiber orientation file");
     int numFibers = (rowSize - 3) / 7;
     int64_t numRows = myFibers->getNumberOfRows();
+    vector<float> allRows(numRows * rowSize);//fiber orientation files are small, read them once so the tests can be done in parallel
+    for (int64_t i = 0; i < numRows; ++i)
+    {
+        myFibers->getRow(allRows.data() + i * rowSize, i);
+    }
+    vector<char> passed(numRows, 0);
+#pragma omp CARET_PAR
+    {
+        CaretPointer<SignedDistanceHelper> mySignedHelp = mySurf->getSignedDistanceHelper();//one per thread, they are not meant to be shared
+#pragma omp CARET_FOR schedule(dynamic, 256)
+        for (int64_t i = 0; i < numRows; ++i)
+        {
+            const float* thisRow = allRows.data() + i * rowSize;//the first 3 floats are xyz coords
+            int closeNode = mySurf->closestNode(thisRow, maxDist);
+            if (closeNode == -1) continue;//skip samples that aren't close to a surface node, for speed (signed distance is kinda slow)
+            if (myTest == ANY)
+            {
+                passed[i] = 1;
+            } else {
+                float signedDist = mySignedHelp->dist(thisRow, SignedDistanceHelper::EVEN_ODD);
+                if ((myTest == INSIDE) == (signedDist <= 0.0f))//test for inside/outside surface
+                {
+                    passed[i] = 1;
+                }
+            }
+        }
+    }
     vector<float> coordsInside;
     vector<int64_t> coordIndices;
-    vector<float> rowScratch(rowSize);
     for (int64_t i = 0; i < numRows; ++i)
     {
-        myFibers->getRow(rowScratch.data(), i);
-        int closeNode = mySurf->closestNode(rowScratch.data(), maxDist);
-        if (closeNode == -1) continue;//skip samples that aren't close to a surface node, for speed (signed distance is kinda slow)
-        if (myTest == ANY)
+        if (passed[i] != 0)
         {
-            coordsInside.push_back(rowScratch[0]);//add point to vector for locator
-            coordsInside.push_back(rowScratch[1]);
-            coordsInside.push_back(rowScratch[2]);
+            const float* thisRow = allRows.data() + i * rowSize;
+            coordsInside.push_back(thisRow[0]);//add point to vector for locator
+            coordsInside.push_back(thisRow[1]);
+            coordsInside.push_back(thisRow[2]);
             coordIndices.push_back(i);//and save its cifti index
-        } else {
-            float signedDist = mySignedHelp->dist(rowScratch.data(), SignedDistanceHelper::EVEN_ODD);//the first 3 floats are xyz coords
-            if ((myTest == INSIDE) == (signedDist <= 0.0f))//test for inside/outside surface
-            {
-                coordsInside.push_back(rowScratch[0]);//add point to vector for locator
-                coordsInside.push_back(rowScratch[1]);
-                coordsInside.push_back(rowScratch[2]);
-                coordIndices.push_back(i);//and save its cifti index
-            }
         }
     }
     if (coordIndices.size() == 0) throw AlgorithmException("no fiber samples passed the <max-dist> and <direction> tests");
@@ -135,12 +150,14 @@ AlgorithmFiberDotProducts::AlgorithmFiberDotProducts(ProgressObject* myProgObj,
         myFSampOut->setColumnName(i, "Fiber " + AString::number(i + 1) + " population mean f");
     }
     const float* coordData = mySurf->getCoordinateData();
+    vector<vector<float> > dotProdCols(numFibers, vector<float>(numNodes)), fSampCols(numFibers, vector<float>(numNodes));//set the metrics afterwards, setValue isn't meant for threads
+#pragma omp CARET_PARFOR schedule(dynamic, 256)
     for (int i = 0; i < numNodes; ++i)
     {
         int closest = myLocator.closestPoint(coordData + i * 3);
         if (closest != -1)
         {
-            myFibers->getRow(rowScratch.data(), coordIndices[closest]);
+            const float* rowScratch = allRows.data() + coordIndices[closest] * rowSize;
             Vector3D myNormal = mySurf->getNormalVector(i);
             for (int j = 0; j < numFibers; ++j)
             {
@@ -153,17 +170,22 @@ AlgorithmFiberDotProducts::AlgorithmFiberDotProducts(ProgressObject* myProgObj,
                 direction[1] = sin(theta) * sin(phi);
                 direction[2] = cos(theta);
                 float dotProd = abs(myNormal.dot(direction));
-                myDotProdOut->setValue(i, j, dotProd);
-                myFSampOut->setValue(i, j, fmean);
+                dotProdCols[j][i] = dotProd;
+                fSampCols[j][i] = fmean;
             }
         } else {
             for (int j = 0; j < numFibers; ++j)
             {
-                myDotProdOut->setValue(i, j, 0.0f);
-                myFSampOut->setValue(i, j, 0.0f);
+                dotProdCols[j][i] = 0.0f;
+                fSampCols[j][i] = 0.0f;
             }
         }
     }
+    for (int j = 0; j < numFibers; ++j)
+    {
+        myDotProdOut->setValuesForColumn(j, dotProdCols[j].data());
+        myFSampOut->setValuesForColumn(j, fSampCols[j].data());
+    }
 }
 
 float AlgorithmFiberDotProducts::getAlgorithmInternalWeight()
@@ -28,9 +28,8 @@
 #include "RibbonMappingHelper.h"
 #include "SurfaceFile.h"
 #include "VolumeFile.h"
-#include "VoxelIJK.h"
 
-#include <map>
+#include <algorithm>
 
 using namespace caret;
 using namespace std;
@@ -67,12 +66,15 @@ OperationParameters* AlgorithmMetricToVolumeMapping::getParameters()
     ribbonSubdivOpt->addIntegerParameter(1, "subdiv-num", "number of subdivisions, default 3");
     ribbonOpt->createOptionalParameter(4, "-greedy", "instead of antialiasing partial-volumed voxels, put full metric values (legacy behavior)");
     ribbonOpt->createOptionalParameter(5, "-thick-columns", "use overlapping columns (legacy method)");
+    OptionalParameter* ribbonCacheOpt = ribbonOpt->createOptionalParameter(6, "-weights-cache", "reuse voxel weights computed by a previous run");
+    ribbonCacheOpt->addStringParameter(1, "cache-file", "the weights file to read, or to create if it doesn't exist or was made from different inputs");
     
     ret->setHelpText(
         AString("Maps values from a metric file into a volume file.  ") +
         "You must specify exactly one mapping method option.  " +
         "The -nearest-vertex method uses the value from the vertex closest to the voxel center (useful for integer values).  " +
         "The -ribbon-constrained method uses the same method as in -volume-to-surface-mapping, then uses the weights in reverse.  " +
+        "The -weights-cache option works as in -volume-to-surface-mapping, and the files are interchangeable when the inputs and options match.  " +
         "Mapping to lower resolutions than the mesh may require a larger -voxel-subdiv value in order to have all of the surface data participate."
     );
     return ret;
@@ -107,6 +109,7 @@ void AlgorithmMetricToVolumeMapping::useParameters(OperationParameters* myParams
     SurfaceFile* innerSurf = NULL, *outerSurf = NULL;
     int subDivs = 3;
     bool greedy = false, thick = false;
+    AString weightsCacheFile;
     OptionalParameter* ribbonOpt = myParams->getOptionalParameter(6);
     if (ribbonOpt->m_present)
     {
@@ -129,6 +132,11 @@ void AlgorithmMetricToVolumeMapping::useParameters(OperationParameters* myParams
         }
         greedy = ribbonOpt->getOptionalParameter(4)->m_present;
         thick = ribbonOpt->getOptionalParameter(5)->m_present;
+        OptionalParameter* ribbonCacheOpt = ribbonOpt->getOptionalParameter(6);
+        if (ribbonCacheOpt->m_present)
+        {
+            weightsCacheFile = ribbonCacheOpt->getString(1);
+        }
     }
     if (!haveMethod)
     {
@@ -140,7 +148,7 @@ void AlgorithmMetricToVolumeMapping::useParameters(OperationParameters* myParams
             AlgorithmMetricToVolumeMapping(myProgObj, myMetric, mySurf, myTemplateVol->getVolumeSpace(), myVolOut, nearDist);
             break;
         case RIBBON:
-            AlgorithmMetricToVolumeMapping(myProgObj, myMetric, mySurf, myTemplateVol->getVolumeSpace(), myVolOut, innerSurf, outerSurf, subDivs, greedy, thick);
+            AlgorithmMetricToVolumeMapping(myProgObj, myMetric, mySurf, myTemplateVol->getVolumeSpace(), myVolOut, innerSurf, outerSurf, subDivs, greedy, thick, weightsCacheFile);
             break;
         case INVALID:
             CaretAssert(0);
@@ -198,7 +206,7 @@ AlgorithmMetricToVolumeMapping::AlgorithmMetricToVolumeMapping(ProgressObject* m
 
 AlgorithmMetricToVolumeMapping::AlgorithmMetricToVolumeMapping(ProgressObject* myProgObj, const MetricFile* myMetric, const SurfaceFile* mySurf, const VolumeSpace& myVolSpace,
                                                                VolumeFile* myVolOut, const SurfaceFile* innerSurf, const SurfaceFile* outerSurf, const int& subDivs,
-                                                               const bool& greedy, const bool& thickColumn) : AbstractAlgorithm(myProgObj)
+                                                               const bool& greedy, const bool& thickColumn, const AString& weightsCacheFile) : AbstractAlgorithm(myProgObj)
 {
     int numNodes = mySurf->getNumberOfNodes();
     if (myMetric->getNumberOfNodes() != numNodes)
@@ -218,46 +226,29 @@ AlgorithmMetricToVolumeMapping::AlgorithmMetricToVolumeMapping(ProgressObject* m
     checkStructureMatch(outerSurf, myMetric->getStructure(), "outer surface file", "the metric file has");
     int numCols = myMetric->getNumberOfColumns();
     myVolOut->reinitialize(myVolSpace, numCols);
-    vector<vector<VoxelWeight> > forwardWeights;
-    RibbonMappingHelper::computeWeightsRibbon(forwardWeights, myVolSpace, innerSurf, outerSurf, NULL, subDivs, !thickColumn);
-    map<VoxelIJK, vector<pair<int, float> > > reverseWeights;
-    for (int i = 0; i < numNodes; ++i)
-    {
-        for (int v = 0; v < (int)forwardWeights[i].size(); ++v)
-        {//vectors initialize to empty
-            reverseWeights[VoxelIJK(forwardWeights[i][v].ijk)].push_back(pair<int, float>(i, forwardWeights[i][v].weight));
-        }
-    }
+    RibbonWeightPlan myPlan;
+    RibbonMappingHelper::computeWeightPlan(myPlan, myVolSpace, innerSurf, outerSurf, NULL, subDivs, !thickColumn, weightsCacheFile);
     const int64_t* dims = myVolSpace.getDims();
     const int64_t frameSize = dims[0] * dims[1] * dims[2];
-    vector<float> scratchFrame(frameSize, 0.0f);
-    for (int m = 0; m < numCols; ++m)
+    const int64_t MAX_CHUNK_COLUMNS = 16, MAX_SCRATCH_BYTES = ((int64_t)1) << 28;//each voxel's weights are applied to several columns at once, while bounding the scratch memory
+    const int64_t chunkColumns = max((int64_t)1, min(MAX_CHUNK_COLUMNS, MAX_SCRATCH_BYTES / (int64_t)(sizeof(float) * frameSize)));
+    vector<float> scratchFrames(min(chunkColumns, (int64_t)numCols) * frameSize, 0.0f);//voxels without weights are never written to, so they stay zero
+    for (int chunkStart = 0; chunkStart < numCols; chunkStart += chunkColumns)
     {
-        const float* colData = myMetric->getValuePointerForColumn(m);
-        for (map<VoxelIJK, vector<pair<int, float> > >::const_iterator iter = reverseWeights.begin(); iter != reverseWeights.end(); ++iter)
+        int chunkEnd = (int)min(chunkStart + chunkColumns, (int64_t)numCols);
+        vector<const float*> columns;
+        vector<float*> frames;
+        for (int m = chunkStart; m < chunkEnd; ++m)
         {
-            double accum = 0.0, totalWeight = 0.0;
-            for (int i = 0; i < (int)iter->second.size(); ++i)
-            {
-                totalWeight += iter->second[i].second;
-                accum += colData[iter->second[i].first] * iter->second[i].second;
-            }
-            CaretAssert(totalWeight > 0.0);//ribbon mapping should never add weights of 0 to lists
-            if (greedy)
-            {
-                scratchFrame[myVolSpace.getIndex(iter->first.m_ijk)] = accum / totalWeight;
-            } else {
-                float denom = 1.0f;//thin weights are intended to be space filling without overlapping
-                if (thickColumn) denom = 3.0f;//a bit of a hack - ideally, in thick mode every fully covered voxel should have weights sum to 3
-                if (totalWeight > denom)
-                {
-                    denom = totalWeight;//however, the surface contours occasionally occasionally turn the polyhedrons partly inside out, so voxels can sum to more than they theoretically should
-                }
-                scratchFrame[myVolSpace.getIndex(iter->first.m_ijk)] = accum / denom;
-            }
+            columns.push_back(myMetric->getValuePointerForColumn(m));
+            frames.push_back(scratchFrames.data() + (m - chunkStart) * frameSize);
+        }
+        myPlan.mapToVolume(columns, frames, greedy, thickColumn);
+        for (int m = chunkStart; m < chunkEnd; ++m)
+        {
+            myVolOut->setFrame(frames[m - chunkStart], m);
+            myVolOut->setMapName(m, myMetric->getMapName(m));
         }
-        myVolOut->setFrame(scratchFrame.data(), m);
-        myVolOut->setMapName(m, myMetric->getMapName(m));
     }
 }
 
@@ -40,7 +40,7 @@ namespace caret {
         ///ribbon constrained
         AlgorithmMetricToVolumeMapping(ProgressObject* myProgObj, const MetricFile* myMetric, const SurfaceFile* mySurf, const VolumeSpace& myVolSpace,
                                        VolumeFile* myVolOut, const SurfaceFile* innerSurf, const SurfaceFile* outerSurf,
-                                       const int& subDivs = 3, const bool& greedy = false, const bool& thick = false);
+                                       const int& subDivs = 3, const bool& greedy = false, const bool& thick = false, const AString& weightsCacheFile = "");
         static OperationParameters* getParameters();
         static void useParameters(OperationParameters* myParams, ProgressObject* myProgObj);
         static AString getCommandSwitch();
@@ -24,6 +24,9 @@
 #include "MetricFile.h"
 #include "SurfaceFile.h"
 
+#include <algorithm>
+#include <vector>
+
 using namespace caret;
 using namespace std;
 
@@ -95,10 +98,18 @@ AlgorithmSignedDistanceToSurface::AlgorithmSignedDistanceToSurface(ProgressObjec
 #pragma omp CARET_PAR
     {
         CaretPointer<SignedDistanceHelper> myHelp = levelSetSurf->getSignedDistanceHelper();
+        const int CHUNK_SIZE = 64;//consecutive nodes tend to be near each other, let the helper reuse the previous closest triangle
+        const float* coordData = testSurf->getCoordinateData();
+        vector<float> chunkDists(CHUNK_SIZE);
 #pragma omp CARET_FOR schedule(dynamic)
-        for (int i = 0; i < numNodes; ++i)
+        for (int chunkStart = 0; chunkStart < numNodes; chunkStart += CHUNK_SIZE)
         {
-            myMetricOut->setValue(i, 0, myHelp->dist(testSurf->getCoordinate(i), myWinding));
+            int chunkNodes = min(CHUNK_SIZE, numNodes - chunkStart);
+            myHelp->dist(coordData + chunkStart * 3, chunkNodes, myWinding, chunkDists.data());
+            for (int i = 0; i < chunkNodes; ++i)
+            {
+                myMetricOut->setValue(chunkStart + i, 0, chunkDists[i]);
+            }
         }
     }
 }
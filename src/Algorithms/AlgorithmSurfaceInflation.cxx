@@ -27,7 +27,9 @@
 #include "BoundingBox.h"
 #include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "SurfaceFile.h"
+#include "SurfaceSmoothingHelper.h"
 
 using namespace caret;
 
@@ -138,6 +140,20 @@ AlgorithmSurfaceInflation::AlgorithmSurfaceInflation(ProgressObject* myProgObj,
                                                      const float inflationFactorIn)
    : AbstractAlgorithm(myProgObj)
 {
+    /*
+     * Smoothing helper is used directly, so check its arguments the same way AlgorithmSurfaceSmoothing does
+     */
+    if ((strength < 0.0)
+        || (strength > 1.0)) {
+        throw AlgorithmException("Invalid smoothing strength outside [0.0, 1.0]: "
+                                 + QString::number(strength, 'f', 5));
+    }
+    
+    if (iterations <= 0) {
+        throw AlgorithmException("Invalid iterations value [1, infinity]: "
+                                 + QString::number(iterations));
+    }
+    
     std::vector<ProgressObject*> subAlgProgress;
     if (myProgObj != NULL) {
         subAlgProgress.resize(cycles);
@@ -164,6 +180,16 @@ AlgorithmSurfaceInflation::AlgorithmSurfaceInflation(ProgressObject* myProgObj,
     const float anatomicalRangeZ = anatomicalBoundingBox->getDifferenceZ();
     
     const int32_t numberOfNodes = outputSurfaceFile->getNumberOfNodes();
+    if (numberOfNodes <= 0) {
+        return;
+    }
+    
+    /*
+     * Neighbor lists and coordinate buffers are set up once, and reused by every cycle
+     */
+    SurfaceSmoothingHelper mySmoothHelp(outputSurfaceFile);
+    std::vector<float> coords(outputSurfaceFile->getCoordinateData(), outputSurfaceFile->getCoordinateData() + numberOfNodes * 3);
+    std::vector<float> scratch(numberOfNodes * 3);
     
     for (int iCycle = 0; iCycle < cycles; iCycle++) {
         /*
@@ -174,19 +200,17 @@ AlgorithmSurfaceInflation::AlgorithmSurfaceInflation(ProgressObject* myProgObj,
         {
             subProgress = subAlgProgress[iCycle];
         }
-        AlgorithmSurfaceSmoothing(subProgress,
-                                  outputSurfaceFile,
-                                  outputSurfaceFile,
-                                  strength,
-                                  iterations);
+        {
+            LevelProgress smoothProgress(subProgress);//finishes the smoothing step when it goes out of scope
+            mySmoothHelp.smooth(coords, scratch, strength, iterations);
+        }
         
         /*
          * Inflate
          */
-        float xyz[3];
+#pragma omp CARET_PARFOR schedule(dynamic, 256)
         for (int32_t iNode = 0; iNode < numberOfNodes; iNode++) {
-            outputSurfaceFile->getCoordinate(iNode,
-                                             xyz);
+            float* xyz = coords.data() + iNode * 3;
             
             const float x = xyz[0] / anatomicalRangeX;
             const float y = xyz[1] / anatomicalRangeY;
@@ -198,15 +222,13 @@ AlgorithmSurfaceInflation::AlgorithmSurfaceInflation(ProgressObject* myProgObj,
             xyz[0] *= scale;
             xyz[1] *= scale;
             xyz[2] *= scale;
-            
-            outputSurfaceFile->setCoordinate(iNode,
-                                             xyz);
         }
         
         myProgress.reportProgress(static_cast<float>(iCycle +1)
                                   / static_cast<float>(cycles));
     }
     
+    outputSurfaceFile->setCoordinates(coords.data());
     outputSurfaceFile->computeNormals();
 }
 
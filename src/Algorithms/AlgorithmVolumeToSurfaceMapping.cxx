@@ -21,6 +21,7 @@
 #include "AlgorithmVolumeToSurfaceMapping.h"
 #include "AlgorithmException.h"
 
+#include "CaretAssert.h"
 #include "CaretOMP.h"
 #include "FloatMatrix.h"
 #include "MathFunctions.h"
@@ -30,6 +31,7 @@
 #include "Vector3D.h"
 #include "VolumeFile.h"
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 
@@ -74,6 +76,8 @@ OperationParameters* AlgorithmVolumeToSurfaceMapping::getParameters()
     ribbonWeights->addVolumeOutputParameter(2, "weights-out", "volume to write the weights to");
     OptionalParameter* ribbonWeightsText = ribbonOpt->createOptionalParameter(6, "-output-weights-text", "write the voxel weights for all vertices to a text file");
     ribbonWeightsText->addStringParameter(1, "text-out", "output - the output text filename");//fake the output formatting
+    OptionalParameter* ribbonCache = ribbonOpt->createOptionalParameter(8, "-weights-cache", "reuse voxel weights computed by a previous run");
+    ribbonCache->addStringParameter(1, "cache-file", "the weights file to read, or to create if it doesn't exist or was made from different inputs");
     
     OptionalParameter* myelinStyleOpt = ret->createOptionalParameter(9, "-myelin-style", "use the method from myelin mapping");
     myelinStyleOpt->addVolumeParameter(1, "ribbon-roi", "an roi volume of the cortical ribbon for this hemisphere");
@@ -93,7 +97,10 @@ OperationParameters* AlgorithmVolumeToSurfaceMapping::getParameters()
         "The volume ROI is useful to exclude partial volume effects of voxels the surfaces pass through, and will cause the mapping to ignore " +
         "voxels that don't have a positive value in the mask.  The subdivision number specifies how it approximates the amount of the volume the polyhedron " +
         "intersects, by splitting each voxel into NxNxN pieces, and checking whether the center of each piece is inside the polyhedron.  If you have very large " +
-        "voxels, consider increasing this if you get zeros in your output.\n\n" +
+        "voxels, consider increasing this if you get zeros in your output.  " +
+        "Computing the weights is the slowest part of ribbon mapping, so when mapping many volumes with the same surfaces, use -weights-cache to save them " +
+        "the first time and read them back afterwards.  The file is recomputed automatically if the surfaces, volume space, roi, or ribbon options differ " +
+        "from what it was made with, and the same file can be used by -metric-to-volume-mapping.\n\n" +
         "The myelin style method uses part of the caret5 myelin mapping command to do the mapping: for each surface vertex, take all voxels closer than the thickness at the vertex " +
         "that are within the ribbon ROI, and less than half the thickness value away from the vertex along the direction of the surface normal, and apply a gaussian kernel " +
         "with the specified sigma to them to get the weights to use."
@@ -208,26 +215,33 @@ void AlgorithmVolumeToSurfaceMapping::useParameters(OperationParameters* myParam
                 weightsOutVertex = (int)ribbonWeights->getInteger(1);
                 weightsOut = ribbonWeights->getOutputVolume(2);
             }
-            AlgorithmVolumeToSurfaceMapping(myProgObj, myVolume, mySurface, myMetricOut, innerSurf, outerSurf, myRoiVol, subdivisions, thinColumns, mySubVol, weightsOutVertex, weightsOut);
+            AString weightsCacheFile;
+            OptionalParameter* ribbonCache = ribbonOpt->getOptionalParameter(8);
+            if (ribbonCache->m_present)
+            {
+                weightsCacheFile = ribbonCache->getString(1);
+            }
+            AlgorithmVolumeToSurfaceMapping(myProgObj, myVolume, mySurface, myMetricOut, innerSurf, outerSurf, myRoiVol, subdivisions, thinColumns, mySubVol, weightsOutVertex, weightsOut, weightsCacheFile);
             OptionalParameter* ribbonWeightsText = ribbonOpt->getOptionalParameter(6);
             if (ribbonWeightsText->m_present)
             {//do this after the algorithm, to let it do the error condition checking
                 ofstream outFile(ribbonWeightsText->getString(1).toLocal8Bit().constData());
                 if (!outFile) throw AlgorithmException("failed to open output textfile '" + ribbonWeightsText->getString(1) + "'");
-                vector<vector<VoxelWeight> > myWeights;
+                RibbonWeightPlan myPlan;
                 const float* roiFrame = NULL;
                 if (myRoiVol != NULL) roiFrame = myRoiVol->getFrame();
-                RibbonMappingHelper::computeWeightsRibbon(myWeights, myVolume->getVolumeSpace(), innerSurf, outerSurf, roiFrame, subdivisions, thinColumns);
-                for (int i = 0; i < (int)myWeights.size(); ++i)
+                RibbonMappingHelper::computeWeightPlan(myPlan, myVolume->getVolumeSpace(), innerSurf, outerSurf, roiFrame, subdivisions, thinColumns, weightsCacheFile);
+                const int64_t* planDims = myPlan.getDims();
+                for (int i = 0; i < (int)myPlan.getNumberOfVertices(); ++i)
                 {
-                    outFile << i << ", " << myWeights[i].size();
-                    for (int j = 0; j < (int)myWeights[i].size(); ++j)
+                    int numWeights = (int)myPlan.getNumberOfWeights(i);
+                    const int64_t* voxelIndices = myPlan.getVoxelIndices(i);
+                    const float* weights = myPlan.getWeights(i);
+                    outFile << i << ", " << numWeights;
+                    for (int j = 0; j < numWeights; ++j)
                     {
-                        for (int v = 0; v < 3; ++v)
-                        {
-                            outFile << ", " << myWeights[i][j].ijk[v];
-                        }
-                        outFile << ", " << myWeights[i][j].weight;
+                        outFile << ", " << voxelIndices[j] % planDims[0] << ", " << (voxelIndices[j] / planDims[0]) % planDims[1] << ", " << voxelIndices[j] / (planDims[0] * planDims[1]);
+                        outFile << ", " << weights[j];
                     }
                     outFile << endl;
                 }
@@ -345,7 +359,7 @@ AlgorithmVolumeToSurfaceMapping::AlgorithmVolumeToSurfaceMapping(ProgressObject*
 AlgorithmVolumeToSurfaceMapping::AlgorithmVolumeToSurfaceMapping(ProgressObject* myProgObj, const VolumeFile* myVolume, const SurfaceFile* mySurface, MetricFile* myMetricOut,
                                                                  const SurfaceFile* innerSurf, const SurfaceFile* outerSurf, const VolumeFile* roiVol,
                                                                  const int32_t& subdivisions, const bool& thinColumns, const int64_t& mySubVol,
-                                                                 const int& weightsOutVertex, VolumeFile* weightsOut) : AbstractAlgorithm(myProgObj)
+                                                                 const int& weightsOutVertex, VolumeFile* weightsOut, const AString& weightsCacheFile) : AbstractAlgorithm(myProgObj)
 {
     LevelProgress myProgress(myProgObj);
     vector<int64_t> myVolDims;
@@ -379,89 +393,57 @@ AlgorithmVolumeToSurfaceMapping::AlgorithmVolumeToSurfaceMapping(ProgressObject*
         weightDims.resize(3);
         weightsOut->reinitialize(weightDims, myVolume->getSform());
     }
-    vector<vector<VoxelWeight> > myWeights;
+    RibbonWeightPlan myPlan;
     const float* roiFrame = NULL;
     if (roiVol != NULL) roiFrame = roiVol->getFrame();
-    RibbonMappingHelper::computeWeightsRibbon(myWeights, myVolume->getVolumeSpace(), innerSurf, outerSurf, roiFrame, subdivisions, thinColumns);
+    RibbonMappingHelper::computeWeightPlan(myPlan, myVolume->getVolumeSpace(), innerSurf, outerSurf, roiFrame, subdivisions, thinColumns, weightsCacheFile);
     if (weightsOut != NULL)
     {
-        weightsOut->setValueAllVoxels(0.0f);
-        const vector<VoxelWeight>& vertexWeights = myWeights[weightsOutVertex];
-        int numWeights = (int)vertexWeights.size();
+        vector<float> weightFrame(myVolDims[0] * myVolDims[1] * myVolDims[2], 0.0f);
+        int numWeights = (int)myPlan.getNumberOfWeights(weightsOutVertex);
+        const int64_t* voxelIndices = myPlan.getVoxelIndices(weightsOutVertex);
+        const float* weights = myPlan.getWeights(weightsOutVertex);
         for (int i = 0; i < numWeights; ++i)
         {
-            weightsOut->setValue(vertexWeights[i].weight, vertexWeights[i].ijk);
+            weightFrame[voxelIndices[i]] = weights[i];
         }
+        weightsOut->setFrame(weightFrame.data());
     }
-    CaretArray<float> myScratchArray(numNodes);
-    float* myScratch = myScratchArray.getArray();
-    if (mySubVol == -1)
+    vector<int64_t> colBrick, colComponent;
+    for (int64_t i = 0; i < myVolDims[3]; ++i)
     {
-        for (int64_t i = 0; i < myVolDims[3]; ++i)
-        {
-            for (int64_t j = 0; j < myVolDims[4]; ++j)
-            {
-                int64_t thisCol = i * myVolDims[4] + j;
-                AString metricLabel = myVolume->getMapName(i);
-                if (myVolDims[4] != 1)
-                {
-                    metricLabel += " component " + AString::number(j);
-                }
-                metricLabel += " ribbon constrained";
-                myMetricOut->setColumnName(thisCol, metricLabel);
-#pragma omp CARET_PARFOR schedule(dynamic)
-                for (int64_t node = 0; node < numNodes; ++node)
-                {
-                    myScratch[node] = 0.0f;
-                    float totalWeight = 0.0f;
-                    int numVoxels = (int)myWeights[node].size();
-                    for (int voxel = 0; voxel < numVoxels; ++voxel)
-                    {
-                        float thisWeight = myWeights[node][voxel].weight;
-                        totalWeight += thisWeight;
-                        myScratch[node] += thisWeight * myVolume->getValue(myWeights[node][voxel].ijk, i, j);
-                    }
-                    if (totalWeight != 0.0f)
-                    {
-                        myScratch[node] /= totalWeight;
-                    } else {
-                        myScratch[node] = 0.0f;
-                    }
-                }
-                myMetricOut->setValuesForColumn(thisCol, myScratch);
-            }
-        }
-    } else {
+        if (mySubVol != -1 && i != mySubVol) continue;
         for (int64_t j = 0; j < myVolDims[4]; ++j)
         {
-            AString metricLabel = myVolume->getMapName(mySubVol);
+            int64_t thisCol = (int64_t)colBrick.size();
+            AString metricLabel = myVolume->getMapName(i);
             if (myVolDims[4] != 1)
             {
                 metricLabel += " component " + AString::number(j);
             }
             metricLabel += " ribbon constrained";
-            int64_t thisCol = j;
             myMetricOut->setColumnName(thisCol, metricLabel);
-#pragma omp CARET_PARFOR schedule(dynamic)
-            for (int64_t node = 0; node < numNodes; ++node)
-            {
-                    myScratch[node] = 0.0f;
-                    float totalWeight = 0.0f;
-                    int numVoxels = (int)myWeights[node].size();
-                    for (int voxel = 0; voxel < numVoxels; ++voxel)
-                    {
-                        float thisWeight = myWeights[node][voxel].weight;
-                        totalWeight += thisWeight;
-                        myScratch[node] += thisWeight * myVolume->getValue(myWeights[node][voxel].ijk, mySubVol, j);
-                    }
-                    if (totalWeight != 0.0f)
-                    {
-                        myScratch[node] /= totalWeight;
-                    } else {
-                        myScratch[node] = 0.0f;
-                    }
-            }
-            myMetricOut->setValuesForColumn(thisCol, myScratch);
+            colBrick.push_back(i);
+            colComponent.push_back(j);
+        }
+    }
+    CaretAssert((int64_t)colBrick.size() == numColumns);
+    const int64_t CHUNK_COLUMNS = 64;//each vertex's weights are applied to this many frames at once, while bounding the scratch memory
+    vector<float> myScratch(min(CHUNK_COLUMNS, numColumns) * numNodes);
+    for (int64_t chunkStart = 0; chunkStart < numColumns; chunkStart += CHUNK_COLUMNS)
+    {
+        int64_t chunkEnd = min(chunkStart + CHUNK_COLUMNS, numColumns);
+        vector<const float*> frames;
+        vector<float*> outputs;
+        for (int64_t col = chunkStart; col < chunkEnd; ++col)
+        {
+            frames.push_back(myVolume->getFrame(colBrick[col], colComponent[col]));
+            outputs.push_back(myScratch.data() + (col - chunkStart) * numNodes);
+        }
+        myPlan.mapToSurface(frames, outputs);
+        for (int64_t col = chunkStart; col < chunkEnd; ++col)
+        {
+            myMetricOut->setValuesForColumn(col, outputs[col - chunkStart]);
         }
     }
 }
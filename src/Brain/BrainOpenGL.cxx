@@ -206,13 +206,18 @@ BrainOpenGL::receiveEvent(Event* event)
  *    Pointer to the active OpenGL context.
  * @param viewportContents
  *    Viewport info for drawing.
+ * @param tabImageCache
+ *    If not NULL, tabs that have not changed are drawn from images
+ *    in this cache and the images of the other tabs are cached.
  */
 void BrainOpenGL::drawModels(const int32_t windowIndex,
                              Brain* brain,
                              void* contextSharingGroupPointer,
-                             const std::vector<const BrainOpenGLViewportContent*>& viewportContents)
+                             const std::vector<const BrainOpenGLViewportContent*>& viewportContents,
+                             BrainOpenGLTabImageCacheInterface* tabImageCache)
 {
     m_contextSharingGroupPointer = contextSharingGroupPointer;
+    m_tabImageCache = tabImageCache;
     
     const std::vector<const BrainOpenGLViewportContent*> vpContents(viewportContents.begin(),
                                                                     viewportContents.end());
@@ -228,6 +233,7 @@ void BrainOpenGL::drawModels(const int32_t windowIndex,
     deleteUnusedOpenGLNames();
     
     m_contextSharingGroupPointer = NULL;
+    m_tabImageCache = NULL;
 }
 
 /**
@@ -66,6 +66,7 @@ namespace caret {
     
     class Border;
     class Brain;
+    class BrainOpenGLTabImageCacheInterface;
     class BrainOpenGLTextRenderInterface;
     class BrainOpenGLViewportContent;
     class EventOpenGLObjectToWindowTransform;
@@ -105,7 +106,8 @@ namespace caret {
         void drawModels(const int32_t windowIndex,
                         Brain* brain,
                         void* contextSharingGroupPointer,
-                        const std::vector<const BrainOpenGLViewportContent*>& viewportContents);
+                        const std::vector<const BrainOpenGLViewportContent*>& viewportContents,
+                        BrainOpenGLTabImageCacheInterface* tabImageCache = NULL);
         
         void selectModel(const int32_t windowIndex,
                          Brain* brain,
@@ -192,6 +194,12 @@ namespace caret {
          */
         inline void* getContextSharingGroupPointer() { return m_contextSharingGroupPointer; }
         
+        /**
+         * @return Cache for images of tab drawing, NULL if tabs
+         * are not cached (valid only while drawing models).
+         */
+        inline BrainOpenGLTabImageCacheInterface* getTabImageCache() { return m_tabImageCache; }
+        
     private:
         class OpenGLNameInfo {
         public:
@@ -221,6 +229,9 @@ namespace caret {
         /** Pointer to the current OpenGL Context sharing group */
         void* m_contextSharingGroupPointer = 0;
         
+        /** Cache for images of tab drawing (may be NULL) */
+        BrainOpenGLTabImageCacheInterface* m_tabImageCache = 0;
+        
         BrainOpenGL(const BrainOpenGL&);
         BrainOpenGL& operator=(const BrainOpenGL&);
         
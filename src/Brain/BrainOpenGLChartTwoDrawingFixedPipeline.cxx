@@ -55,7 +55,9 @@
 #include "GraphicsPrimitiveV3f.h"
 #include "GraphicsPrimitiveV3fC4f.h"
 #include "GraphicsPrimitiveV3fC4ub.h"
+#include "GraphicsPrimitiveV3fT3f.h"
 #include "GraphicsShape.h"
+#include "Histogram.h"
 #include "IdentificationWithColor.h"
 #include "MathFunctions.h"
 #include "ModelChartTwo.h"
@@ -981,7 +983,14 @@ BrainOpenGLChartTwoDrawingFixedPipeline::drawHistogramOrLineSeriesChart(const Ch
                     }
                 }
                 else {
-                    GraphicsEngineDataOpenGL::draw(lineChart.m_chartTwoCartesianData->getGraphicsPrimitive());
+                    /*
+                     * Long lines are decimated to the width of the viewport
+                     * using the points within the X-axis range (axis range
+                     * may be a user range that zooms in on the data)
+                     */
+                    GraphicsEngineDataOpenGL::draw(lineChart.m_chartTwoCartesianData->getGraphicsPrimitiveForViewportWidth(chartGraphicsDrawingViewport[2],
+                                                                                                                         xMinBottom,
+                                                                                                                         xMaxBottom));
                 }
                 
                 /*
@@ -1243,10 +1252,20 @@ BrainOpenGLChartTwoDrawingFixedPipeline::drawMatrixChartContent(const ChartableT
                                                                 const float /*zooming*/,
                                                                 std::vector<MatrixRowColumnHighight*>& rowColumnHighlightingOut)
 {
-    GraphicsPrimitiveV3fC4f* matrixPrimitive = matrixChart->getMatrixChartingGraphicsPrimitive(chartViewingType,
-                                                                                               CiftiMappableDataFile::MatrixGridMode::FILLED);
-    if (matrixPrimitive == NULL) {
-        return;
+    /*
+     * Matrix cells are drawn from textures with one texel per cell
+     * which uses far less memory than two colored triangles per cell.
+     * Dense matrices are too large for that and are drawn with a level
+     * of detail pyramid whose visible tiles are loaded when drawing.
+     */
+    std::vector<GraphicsPrimitiveV3fT3f*> matrixTexturePrimitives;
+    const bool levelOfDetailFlag = matrixChart->isMatrixChartingLevelOfDetail();
+    if ( ! levelOfDetailFlag) {
+        matrixChart->getMatrixChartingTexturePrimitives(chartViewingType,
+                                                        matrixTexturePrimitives);
+        if (matrixTexturePrimitives.empty()) {
+            return;
+        }
     }
     
     if (m_identificationModeFlag) {
@@ -1263,42 +1282,101 @@ BrainOpenGLChartTwoDrawingFixedPipeline::drawMatrixChartContent(const ChartableT
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
     if (m_identificationModeFlag) {
-        int32_t primitiveIndex = -1;
-        float   primitiveDepth = 0.0;
-        GraphicsEngineDataOpenGL::drawWithSelection(matrixPrimitive,
-                                                    m_fixedPipelineDrawing->mouseX,
-                                                    m_fixedPipelineDrawing->mouseY,
-                                                    primitiveIndex,
-                                                    primitiveDepth);
-        if (primitiveIndex >= 0) {
-            /*
-             * Two triangles per cell so divided the primitive index by two
-             */
-            CaretAssert(matrixPrimitive->getPrimitiveType() == GraphicsPrimitive::PrimitiveType::OPENGL_TRIANGLES);
-            primitiveIndex /= 2;
-            
+        /*
+         * Cells are 1.0 x 1.0 in model space (scaling is on the model
+         * view matrix) so the cell is found by converting the mouse
+         * position to model coordinates.  Row zero is at the top.
+         */
+        GLdouble modelMatrix[16];
+        GLdouble projectionMatrix[16];
+        GLint viewport[4];
+        glGetDoublev(GL_MODELVIEW_MATRIX, modelMatrix);
+        glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        
+        GLdouble modelXYZ[3];
+        if (gluUnProject(m_fixedPipelineDrawing->mouseX, m_fixedPipelineDrawing->mouseY, 0.0,
+                         modelMatrix, projectionMatrix, viewport,
+                         &modelXYZ[0], &modelXYZ[1], &modelXYZ[2])) {
             int32_t numberOfRows = 0;
             int32_t numberOfColumns = 0;
             matrixChart->getMatrixDimensions(numberOfRows,
                                              numberOfColumns);
             
-            const int32_t rowIndex = primitiveIndex / numberOfColumns;
-            const int32_t colIndex = primitiveIndex % numberOfColumns;
-            
-            if (m_selectionItemMatrix->isOtherScreenDepthCloserToViewer(primitiveDepth)) {
-                m_selectionItemMatrix->setMatrixChart(const_cast<ChartableTwoFileMatrixChart*>(matrixChart),
-                                                      rowIndex,
-                                                      colIndex);
+            if ((modelXYZ[0] >= 0.0)
+                && (modelXYZ[1] >= 0.0)) {
+                const int32_t colIndex = static_cast<int32_t>(modelXYZ[0]);
+                const int32_t rowIndex = numberOfRows - 1 - static_cast<int32_t>(modelXYZ[1]);
+                if ((colIndex < numberOfColumns)
+                    && (rowIndex >= 0)) {
+                    GLdouble windowXYZ[3];
+                    double cellDepth = 0.0;
+                    if (gluProject(colIndex + 0.5, numberOfRows - rowIndex - 0.5, 0.0,
+                                   modelMatrix, projectionMatrix, viewport,
+                                   &windowXYZ[0], &windowXYZ[1], &windowXYZ[2])) {
+                        cellDepth = windowXYZ[2];
+                    }
+                    if (m_selectionItemMatrix->isOtherScreenDepthCloserToViewer(cellDepth)) {
+                        m_selectionItemMatrix->setMatrixChart(const_cast<ChartableTwoFileMatrixChart*>(matrixChart),
+                                                              rowIndex,
+                                                              colIndex);
+                    }
+                }
             }
         }
     }
     else {
-        drawPrimitivePrivate(matrixPrimitive);
+        if (levelOfDetailFlag) {
+            /*
+             * Visible region of the matrix is found by converting
+             * the corners of the viewport to model coordinates
+             */
+            GLdouble modelMatrix[16];
+            GLdouble projectionMatrix[16];
+            GLint viewport[4];
+            glGetDoublev(GL_MODELVIEW_MATRIX, modelMatrix);
+            glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
+            glGetIntegerv(GL_VIEWPORT, viewport);
+            
+            GLdouble bottomLeftXYZ[3];
+            GLdouble topRightXYZ[3];
+            if ((viewport[2] > 0)
+                && (viewport[3] > 0)
+                && gluUnProject(viewport[0], viewport[1], 0.0,
+                                modelMatrix, projectionMatrix, viewport,
+                                &bottomLeftXYZ[0], &bottomLeftXYZ[1], &bottomLeftXYZ[2])
+                && gluUnProject(viewport[0] + viewport[2], viewport[1] + viewport[3], 0.0,
+                                modelMatrix, projectionMatrix, viewport,
+                                &topRightXYZ[0], &topRightXYZ[1], &topRightXYZ[2])) {
+                const float visibleMinX = std::min(bottomLeftXYZ[0], topRightXYZ[0]);
+                const float visibleMaxX = std::max(bottomLeftXYZ[0], topRightXYZ[0]);
+                const float visibleMinY = std::min(bottomLeftXYZ[1], topRightXYZ[1]);
+                const float visibleMaxY = std::max(bottomLeftXYZ[1], topRightXYZ[1]);
+                const float cellsPerPixel = std::max((visibleMaxX - visibleMinX) / viewport[2],
+                                                     (visibleMaxY - visibleMinY) / viewport[3]);
+                matrixChart->getMatrixChartingTexturePrimitives(chartViewingType,
+                                                                visibleMinX,
+                                                                visibleMaxX,
+                                                                visibleMinY,
+                                                                visibleMaxY,
+                                                                cellsPerPixel,
+                                                                matrixTexturePrimitives);
+            }
+        }
+        
+        for (auto texturePrimitive : matrixTexturePrimitives) {
+            drawPrimitivePrivate(texturePrimitive);
+        }
         
         const ChartTwoMatrixDisplayProperties* matrixProperties = m_browserTabContent->getChartTwoMatrixDisplayProperties();
         CaretAssert(matrixProperties);
         
-        if (matrixProperties->isGridLinesDisplayed()) {
+        /*
+         * Grid outline of every cell is not available for
+         * dense matrices and would not be visible
+         */
+        if (matrixProperties->isGridLinesDisplayed()
+            && ( ! levelOfDetailFlag)) {
             GraphicsPrimitiveV3fC4f* matrixGridPrimitive = matrixChart->getMatrixChartingGraphicsPrimitive(chartViewingType,
                                                                                                            CiftiMappableDataFile::MatrixGridMode::OUTLINE);
             drawPrimitivePrivate(matrixGridPrimitive);
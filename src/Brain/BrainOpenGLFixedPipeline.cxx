@@ -52,6 +52,7 @@
 #include "BrainOpenGLShapeCylinder.h"
 #include "BrainOpenGLShapeRing.h"
 #include "BrainOpenGLShapeSphere.h"
+#include "BrainOpenGLTabImageCacheInterface.h"
 #include "BrainOpenGLViewportContent.h"
 #include "BrainStructure.h"
 #include "BrowserTabContent.h"
@@ -584,6 +585,22 @@ BrainOpenGLFixedPipeline::drawModelsImplementation(const int32_t windowIndex,
          */
         updateForegroundAndBackgroundColors(vpContent);
         
+        /*
+         * A tab that has not changed since it was last drawn
+         * is drawn from its cached image.
+         */
+        BrainOpenGLTabImageCacheInterface* tabImageCache = getTabImageCache();
+        if (tabImageCache != NULL) {
+            if (tabImageCache->drawTabImage(vpContent)) {
+                if (vpContent->isTabHighlighted()) {
+                    drawTabHighlighting(m_tabViewport[2],
+                                        m_tabViewport[3],
+                                        m_foregroundColorFloat);
+                }
+                continue;
+            }
+        }
+        
         /*
          * If this is NOT the first viewport content,
          * AND the background color for this viewport content is 
@@ -621,6 +638,14 @@ BrainOpenGLFixedPipeline::drawModelsImplementation(const int32_t windowIndex,
         this->drawModelInternal(MODE_DRAWING,
                                 vpContent);
         
+        /*
+         * Cache before highlighting since highlighting
+         * changes without changing the tab.
+         */
+        if (tabImageCache != NULL) {
+            tabImageCache->cacheTabImage(vpContent);
+        }
+        
         /*
          * Draw border in foreground color around tab that is highlighted
          * in Tile Tabs when user selects a tab.
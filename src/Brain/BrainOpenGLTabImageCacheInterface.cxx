@@ -0,0 +1,54 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "BrainOpenGLTabImageCacheInterface.h"
+
+using namespace caret;
+
+
+    
+/**
+ * \class caret::BrainOpenGLTabImageCacheInterface 
+ * \brief Interface for caching images of tab drawing.
+ * \ingroup Brain
+ *
+ * Drawing a window draws the models of all of its tabs.  When only
+ * some of the tabs have changed, the renderer draws the other tabs
+ * from images cached by this interface, and then draws the tab and
+ * window annotations on top of them.
+ */
+
+/**
+ * Constructor.
+ */
+BrainOpenGLTabImageCacheInterface::BrainOpenGLTabImageCacheInterface()
+: CaretObject()
+{
+    
+}
+
+/**
+ * Destructor.
+ */
+BrainOpenGLTabImageCacheInterface::~BrainOpenGLTabImageCacheInterface()
+{
+}
+
@@ -0,0 +1,68 @@
+#ifndef __BRAIN_OPEN_G_L_TAB_IMAGE_CACHE_INTERFACE_H__
+#define __BRAIN_OPEN_G_L_TAB_IMAGE_CACHE_INTERFACE_H__
+
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+#include "CaretObject.h"
+
+namespace caret {
+    class BrainOpenGLViewportContent;
+
+    class BrainOpenGLTabImageCacheInterface : public CaretObject {
+        
+    protected:
+        BrainOpenGLTabImageCacheInterface();
+        
+    public:
+        virtual ~BrainOpenGLTabImageCacheInterface();
+        
+        /**
+         * If an image of the tab's model drawing is cached and the
+         * tab has not changed since the image was cached, draw the
+         * image into the tab's viewport.
+         *
+         * @param viewportContent
+         *     Viewport content of the tab.
+         * @return
+         *     True if the image was drawn, false if the model
+         *     must be drawn.
+         */
+        virtual bool drawTabImage(const BrainOpenGLViewportContent* viewportContent) = 0;
+        
+        /**
+         * Cache the image of the tab's model drawing that was just
+         * drawn into the tab's viewport.
+         *
+         * @param viewportContent
+         *     Viewport content of the tab.
+         */
+        virtual void cacheTabImage(const BrainOpenGLViewportContent* viewportContent) = 0;
+        
+    private:
+        BrainOpenGLTabImageCacheInterface(const BrainOpenGLTabImageCacheInterface&);
+
+        BrainOpenGLTabImageCacheInterface& operator=(const BrainOpenGLTabImageCacheInterface&);
+    };
+    
+} // namespace
+#endif  //__BRAIN_OPEN_G_L_TAB_IMAGE_CACHE_INTERFACE_H__
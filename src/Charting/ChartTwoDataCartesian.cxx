@@ -23,6 +23,7 @@
 #include "ChartTwoDataCartesian.h"
 #undef __CHART_TWO_DATA_CARTESIAN_DECLARE__
 
+#include <algorithm>
 #include <limits>
 
 #include <QTextStream>
@@ -157,7 +158,7 @@ ChartTwoDataCartesian::initializeMembersChartTwoDataCartesian()
  * @return A new instance of the graphics primitive.
  */
 std::unique_ptr<GraphicsPrimitiveV3f>
-ChartTwoDataCartesian::createGraphicsPrimitive()
+ChartTwoDataCartesian::createGraphicsPrimitive() const
 {
     float rgba[4];
     CaretColorEnum::toRGBAFloat(m_color, rgba);
@@ -251,6 +252,7 @@ ChartTwoDataCartesian::copyHelperChartTwoDataCartesian(const ChartTwoDataCartesi
     m_dataAxisUnitsY = obj.m_dataAxisUnitsY;
 
     m_graphicsPrimitive.reset(dynamic_cast<GraphicsPrimitiveV3f*>(obj.m_graphicsPrimitive->clone()));
+    m_decimatedGraphicsPrimitives.clear();
     
     m_color             = obj.m_color;
     m_lineWidth         = obj.m_lineWidth;
@@ -269,6 +271,153 @@ ChartTwoDataCartesian::getGraphicsPrimitive() const
     return m_graphicsPrimitive.get();
 }
 
+/**
+ * Get a graphics primitive for drawing the cartesian data in a viewport
+ * of the given width.  When there are many more points than pixels,
+ * the returned primitive contains, for each group of consecutive points,
+ * only the first, minimum, maximum, and last points (M4 decimation) so
+ * the line appears the same but drawing cost depends upon the viewport
+ * width instead of the number of points.  Group sizes are powers of two
+ * and the decimated primitive for each size is cached.
+ *
+ * The number of points per pixel is determined by the points within
+ * the visible range of the X-axis so that when the user zooms in on
+ * the data (axis range is less than the data range), fewer points are
+ * removed.
+ *
+ * Identification must use getGraphicsPrimitive() since vertex indices
+ * of a decimated primitive do not correspond to the data.
+ *
+ * @param viewportWidth
+ *     Width, in pixels, of the viewport in which the data is drawn.
+ * @param visibleMinimumX
+ *     Minimum X-coordinate displayed in the viewport.
+ * @param visibleMaximumX
+ *     Maximum X-coordinate displayed in the viewport.
+ * @return Graphics primitive for drawing cartesian data.
+ */
+GraphicsPrimitiveV3f*
+ChartTwoDataCartesian::getGraphicsPrimitiveForViewportWidth(const int32_t viewportWidth,
+                                                            const float visibleMinimumX,
+                                                            const float visibleMaximumX) const
+{
+    GraphicsPrimitiveV3f* primitive = getGraphicsPrimitive();
+    
+    switch (m_graphicsPrimitiveType) {
+        case GraphicsPrimitive::PrimitiveType::OPENGL_LINE_STRIP:
+        case GraphicsPrimitive::PrimitiveType::POLYGONAL_LINE_STRIP_BEVEL_JOIN:
+        case GraphicsPrimitive::PrimitiveType::POLYGONAL_LINE_STRIP_MITER_JOIN:
+            break;
+        default:
+            /*
+             * Other primitive types (such as separate line segments)
+             * cannot be decimated by removing vertices
+             */
+            return primitive;
+            break;
+    }
+    
+    const int32_t numPoints = primitive->getNumberOfVertices();
+    if ((viewportWidth <= 0)
+        || (numPoints <= (viewportWidth * 4))) {
+        return primitive;
+    }
+    
+    /*
+     * Only points within the visible X-range are spread across the viewport
+     */
+    int32_t numVisiblePoints = numPoints;
+    if (visibleMinimumX < visibleMaximumX) {
+        const std::vector<float>& xyz = primitive->getFloatXYZ();
+        numVisiblePoints = 0;
+        for (int32_t i = 0; i < numPoints; i++) {
+            const float x = xyz[i * 3];
+            if ((x >= visibleMinimumX)
+                && (x <= visibleMaximumX)) {
+                numVisiblePoints++;
+            }
+        }
+        if (numVisiblePoints <= (viewportWidth * 4)) {
+            return primitive;
+        }
+    }
+    
+    /*
+     * Largest group size that still provides at least one group per pixel
+     */
+    int32_t level = 0;
+    while ((numVisiblePoints >> (level + 1)) >= viewportWidth) {
+        level++;
+    }
+    
+    auto iter = m_decimatedGraphicsPrimitives.find(level);
+    if (iter == m_decimatedGraphicsPrimitives.end()) {
+        iter = m_decimatedGraphicsPrimitives.insert(std::make_pair(level,
+                                                                   createDecimatedGraphicsPrimitive(level))).first;
+    }
+    
+    GraphicsPrimitiveV3f* decimatedPrimitive = iter->second.get();
+    CaretAssert(decimatedPrimitive);
+    decimatedPrimitive->setLineWidth(GraphicsPrimitive::LineWidthType::PERCENTAGE_VIEWPORT_HEIGHT,
+                                     m_lineWidth);
+    return decimatedPrimitive;
+}
+
+/**
+ * Create a decimated copy of the graphics primitive containing the first,
+ * minimum, maximum, and last point of each group of consecutive points.
+ *
+ * @param level
+ *     Groups contain 2^level points.
+ * @return The decimated graphics primitive.
+ */
+std::unique_ptr<GraphicsPrimitiveV3f>
+ChartTwoDataCartesian::createDecimatedGraphicsPrimitive(const int32_t level) const
+{
+    const std::vector<float>& xyz = m_graphicsPrimitive->getFloatXYZ();
+    const int32_t numPoints = static_cast<int32_t>(xyz.size() / 3);
+    const int32_t groupSize = (1 << level);
+    
+    std::unique_ptr<GraphicsPrimitiveV3f> primitive = createGraphicsPrimitive();
+    primitive->reserveForNumberOfVertices(((numPoints / groupSize) + 1) * 4);
+    
+    for (int32_t groupStart = 0; groupStart < numPoints; groupStart += groupSize) {
+        const int32_t groupEnd = std::min(groupStart + groupSize,
+                                          numPoints);
+        int32_t minIndex = groupStart;
+        int32_t maxIndex = groupStart;
+        for (int32_t i = groupStart + 1; i < groupEnd; i++) {
+            const float y = xyz[i * 3 + 1];
+            if (y < xyz[minIndex * 3 + 1]) {
+                minIndex = i;
+            }
+            if (y > xyz[maxIndex * 3 + 1]) {
+                maxIndex = i;
+            }
+        }
+        
+        /*
+         * Points are added in their original order without duplicates
+         */
+        const int32_t indices[4] = {
+            groupStart,
+            std::min(minIndex, maxIndex),
+            std::max(minIndex, maxIndex),
+            groupEnd - 1
+        };
+        int32_t lastIndexAdded = -1;
+        for (int32_t j = 0; j < 4; j++) {
+            if (indices[j] != lastIndexAdded) {
+                CaretAssertVectorIndex(xyz, indices[j] * 3 + 2);
+                primitive->addVertex(&xyz[indices[j] * 3]);
+                lastIndexAdded = indices[j];
+            }
+        }
+    }
+    
+    return primitive;
+}
+
 /**
  * @return The selection status
  */
@@ -314,6 +463,7 @@ ChartTwoDataCartesian::addPoint(const float x,
                                   const float y)
 {
     m_graphicsPrimitive->addVertex(x, y);
+    m_decimatedGraphicsPrimitives.clear();
 }
 
 /**
@@ -418,6 +568,9 @@ ChartTwoDataCartesian::setColor(const CaretColorEnum::Enum color)
         float rgba[4];
         CaretColorEnum::toRGBAFloat(m_color, rgba);
         m_graphicsPrimitive->replaceAllVertexSolidFloatRGBA(rgba);
+        for (auto& decimatedPrimitive : m_decimatedGraphicsPrimitives) {
+            decimatedPrimitive.second->replaceAllVertexSolidFloatRGBA(rgba);
+        }
     }
 }
 
@@ -498,6 +651,7 @@ ChartTwoDataCartesian::restoreFromScene(const SceneAttributes* sceneAttributes,
         return;
     }
     m_graphicsPrimitive = createGraphicsPrimitive();
+    m_decimatedGraphicsPrimitives.clear();
     
     m_sceneAssistant->restoreMembers(sceneAttributes, sceneClass);
     
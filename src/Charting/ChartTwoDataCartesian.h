@@ -21,6 +21,9 @@
  */
 /*LICENSE_END*/
 
+#include <map>
+#include <memory>
+
 #include "CaretColorEnum.h"
 #include "CaretObjectTracksModification.h"
 #include "CaretUnitsTypeEnum.h"
@@ -59,6 +62,10 @@ namespace caret {
         
         GraphicsPrimitiveV3f* getGraphicsPrimitive() const;
         
+        GraphicsPrimitiveV3f* getGraphicsPrimitiveForViewportWidth(const int32_t viewportWidth,
+                                                                   const float visibleMinimumX,
+                                                                   const float visibleMaximumX) const;
+        
         const MapFileDataSelector* getMapFileDataSelector() const;
         
         void setMapFileDataSelector(const MapFileDataSelector& mapFileDataSelector);
@@ -113,12 +120,17 @@ namespace caret {
 
         void initializeMembersChartTwoDataCartesian();
         
-        std::unique_ptr<GraphicsPrimitiveV3f> createGraphicsPrimitive();
+        std::unique_ptr<GraphicsPrimitiveV3f> createGraphicsPrimitive() const;
+        
+        std::unique_ptr<GraphicsPrimitiveV3f> createDecimatedGraphicsPrimitive(const int32_t level) const;
         
         std::unique_ptr<MapFileDataSelector> m_mapFileDataSelector;
         
         std::unique_ptr<GraphicsPrimitiveV3f> m_graphicsPrimitive;
         
+        /** Decimated copies of the graphics primitive, key is level (group size is 2^level) */
+        mutable std::map<int32_t, std::unique_ptr<GraphicsPrimitiveV3f>> m_decimatedGraphicsPrimitives;
+        
         CaretUnitsTypeEnum::Enum m_dataAxisUnitsX;
         
         CaretUnitsTypeEnum::Enum m_dataAxisUnitsY;
@@ -849,26 +849,9 @@ void CiftiBrainModelsMap::ParseHelperModel::parseBrainModel2(QXmlStreamReader& x
 
 vector<int64_t> CiftiBrainModelsMap::ParseHelperModel::readIndexArray(QXmlStreamReader& xml)
 {
-    vector<int64_t> ret;
     QString text = xml.readElementText();//raises error if it encounters a start element
-    if (xml.hasError()) return ret;
-    QStringList separated = text.split(QRegExp("\\s+"), QString::SkipEmptyParts);
-    int64_t numElems = separated.size();
-    ret.reserve(numElems);
-    for (int64_t i = 0; i < numElems; ++i)
-    {
-        bool ok = false;
-        ret.push_back(separated[i].toLongLong(&ok));
-        if (!ok)
-        {
-            throw DataFileException("found noninteger in index array: " + separated[i]);
-        }
-        if (ret.back() < 0)
-        {
-            throw DataFileException("found negative integer in index array: " + separated[i]);
-        }
-    }
-    return ret;
+    if (xml.hasError()) return vector<int64_t>();
+    return parseIndexArray(text, false);
 }
 
 void CiftiBrainModelsMap::writeXML1(QXmlStreamWriter& xml) const
@@ -24,18 +24,57 @@
 #include "CaretAssert.h"
 #include "CaretHttpManager.h"
 #include "CaretLogger.h"
+#include "CaretMutex.h"
+#include "CaretProfiler.h"
 #include "DataFileException.h"
 #include "FileInformation.h"
 #include "MultiDimArray.h"
 #include "MultiDimIterator.h"
 #include "NiftiIO.h"
 
+#include <algorithm>
+#include <list>
+
 using namespace std;
 using namespace caret;
 
 //private implementation classes
 namespace
 {
+    //parsed XML of the most recently opened files, keyed by the exact extension bytes, so that opening the same file repeatedly
+    //(-batch, reloading in the GUI, multiple operations on one input) doesn't pay for the XML parse each time
+    struct ParsedXMLCacheEntry
+    {
+        vector<char> m_bytes;
+        CiftiXML m_xml;
+    };
+    const size_t PARSED_XML_CACHE_ENTRIES = 8;
+    CaretMutex g_parsedXMLCacheMutex;
+    list<ParsedXMLCacheEntry> g_parsedXMLCache;//most recently used first
+    
+    void readXMLCached(const vector<char>& bytes, CiftiXML& xmlOut)
+    {
+        {
+            CaretMutexLocker locked(&g_parsedXMLCacheMutex);
+            for (list<ParsedXMLCacheEntry>::iterator iter = g_parsedXMLCache.begin(); iter != g_parsedXMLCache.end(); ++iter)
+            {
+                if (iter->m_bytes == bytes)
+                {
+                    g_parsedXMLCache.splice(g_parsedXMLCache.begin(), g_parsedXMLCache, iter);
+                    xmlOut = g_parsedXMLCache.front().m_xml;
+                    xmlOut.clearMutablesModified();
+                    return;
+                }
+            }
+        }
+        xmlOut.readXML(QByteArray(bytes.data(), bytes.size()));//CiftiXML should be under 2GB - parse outside the lock, it may throw
+        CaretMutexLocker locked(&g_parsedXMLCacheMutex);
+        g_parsedXMLCache.push_front(ParsedXMLCacheEntry());
+        g_parsedXMLCache.front().m_bytes = bytes;
+        g_parsedXMLCache.front().m_xml = xmlOut;
+        if (g_parsedXMLCache.size() > PARSED_XML_CACHE_ENTRIES) g_parsedXMLCache.pop_back();
+    }
+    
     class CiftiOnDiskImpl : public CiftiFile::WriteImplInterface
     {
         mutable NiftiIO m_nifti;//because file objects aren't stateless (current position), so reading "changes" them
@@ -62,6 +101,7 @@ namespace
         void getRow(float* dataOut, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead) const;
         void getColumn(float* dataOut, const int64_t& index) const;
         bool isInMemory() const { return true; }
+        const float* getRowPointer(const std::vector<int64_t>& indexSelect) const { return m_array.get(1, indexSelect); }
         void setRow(const float* dataIn, const std::vector<int64_t>& indexSelect);
         void setColumn(const float* dataIn, const int64_t& index);
     };
@@ -257,6 +297,55 @@ void CiftiFile::getColumn(float* dataOut, const int64_t& index) const
     m_readingImpl->getColumn(dataOut, index);
 }
 
+void CiftiFile::getColumns(float* dataOut, const int64_t& firstIndex, const int64_t& numColumns) const
+{
+    if (m_dims.empty()) throw DataFileException("getColumns called on uninitialized CiftiFile");
+    if (m_dims.size() != 2) throw DataFileException("getColumns called on non-2D CiftiFile");
+    CaretAssert(firstIndex >= 0 && numColumns >= 0 && firstIndex + numColumns <= m_dims[0]);
+    if (m_readingImpl == NULL) return;//NOT an error because we are pretending to have a matrix already, while we are waiting for setRow to actually start writing the file
+    const int64_t rowLength = m_dims[0], numRows = m_dims[1];
+    const float* base = m_readingImpl->getRowPointer(vector<int64_t>(1, 0));//in-memory 2D data is contiguous, so the first row gives us all of it
+    if (base != NULL)
+    {
+        const int64_t ROW_TILE = 64;//a tile of rows stays in cache while all columns of the panel are gathered from it
+        for (int64_t rowStart = 0; rowStart < numRows; rowStart += ROW_TILE)
+        {
+            const int64_t rowEnd = min(rowStart + ROW_TILE, numRows);
+            for (int64_t c = 0; c < numColumns; ++c)
+            {
+                float* outColumn = dataOut + c * numRows;
+                const float* inColumn = base + firstIndex + c;
+                for (int64_t row = rowStart; row < rowEnd; ++row)
+                {
+                    outColumn[row] = inColumn[row * rowLength];
+                }
+            }
+        }
+    } else {
+        vector<float> scratchRow(rowLength);
+        for (int64_t row = 0; row < numRows; ++row)
+        {
+            getRow(scratchRow.data(), row);
+            for (int64_t c = 0; c < numColumns; ++c)
+            {
+                dataOut[c * numRows + row] = scratchRow[firstIndex + c];
+            }
+        }
+    }
+}
+
+const float* CiftiFile::getRowPointer(const vector<int64_t>& indexSelect) const
+{
+    if (m_dims.empty()) throw DataFileException("getRowPointer called on uninitialized CiftiFile");
+    if (m_readingImpl == NULL) return NULL;
+    return m_readingImpl->getRowPointer(indexSelect);
+}
+
+const float* CiftiFile::getRowPointer(const int64_t& index) const
+{
+    return getRowPointer(vector<int64_t>(1, index));
+}
+
 void CiftiFile::setCiftiXML(const CiftiXML& xml, const bool useOldMetadata)
 {
     if (xml.getNumberOfDimensions() == 0) throw DataFileException("setCiftiXML called with 0-dimensional CiftiXML");
@@ -473,7 +562,10 @@ CiftiOnDiskImpl::CiftiOnDiskImpl(const QString& filename)
         }
     }
     if (whichExt == -1) throw DataFileException("no cifti extension found in file '" + filename + "'");
-    m_xml.readXML(QByteArray(myHeader.m_extensions[whichExt]->m_bytes.data(), myHeader.m_extensions[whichExt]->m_bytes.size()));//CiftiXML should be under 2GB
+    {
+        CaretProfileScope myScope("cifti-xml-parse");
+        readXMLCached(myHeader.m_extensions[whichExt]->m_bytes, m_xml);
+    }
     vector<int64_t> dimCheck = m_nifti.getDimensions();
     if (dimCheck.size() < 5)
     {
@@ -746,7 +838,10 @@ void CiftiXnatImpl::init(const QString& url)
     }
     myResponse.m_body.push_back('\0');//null terminate it so we can construct an AString easily - CaretHttpManager is nice and pre-reserves this room for this purpose
     AString theBody(myResponse.m_body.data());
-    m_xml.readXML(theBody);
+    {
+        CaretProfileScope myScope("cifti-xml-parse");
+        m_xml.readXML(theBody);
+    }
     if (m_xml.getNumberOfDimensions() != 2)
     {
         throw DataFileException("only 2D cifti are supported via URL at this time");
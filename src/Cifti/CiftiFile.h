@@ -69,6 +69,11 @@ namespace caret
             return MultiDimIterator<int64_t>(std::vector<int64_t>(m_dims.begin() + 1, m_dims.end()));
         }
         void getColumn(float* dataOut, const int64_t& index) const;//for 2D only, will be slow if on disk!
+        ///gather adjacent columns at once, for 2D only, output is column-major (column c starts at dataOut + c * getNumberOfRows()), reads each row only once if on disk
+        void getColumns(float* dataOut, const int64_t& firstIndex, const int64_t& numColumns) const;
+        ///view of a row without copying, returns NULL if the data isn't in memory, the pointer is invalidated by anything that changes where the data is stored
+        const float* getRowPointer(const std::vector<int64_t>& indexSelect) const;
+        const float* getRowPointer(const int64_t& index) const;
         
         void setCiftiXML(const CiftiXML& xml, const bool useOldMetadata = true);
         void setCiftiXML(const CiftiXMLOld &xml, const bool useOldMetadata = true);//set xml from old implementation
@@ -92,6 +97,7 @@ namespace caret
             virtual void getRow(float* dataOut, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead) const = 0;
             virtual void getColumn(float* dataOut, const int64_t& index) const = 0;
             virtual bool isInMemory() const { return false; }
+            virtual const float* getRowPointer(const std::vector<int64_t>&) const { return NULL; }//only in-memory implementations can provide views
             virtual ~ReadImplInterface();
         };
         //assume if you can write to it, you can also read from it
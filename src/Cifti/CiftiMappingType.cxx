@@ -21,7 +21,11 @@
 #include "CiftiMappingType.h"
 
 #include "CaretAssert.h"
+#include "DataFileException.h"
 
+#include <limits>
+
+using namespace std;
 using namespace caret;
 
 CiftiMappingType::~CiftiMappingType()
@@ -70,3 +74,52 @@ void CiftiMappingType::clearMutablesModified() const
 {
     //nothing
 }
+
+vector<int64_t> CiftiMappingType::parseIndexArray(const QString& text, const bool& allowNegative)
+{//hand-written scanner, splitting with a regex and calling toLongLong on every element dominated the parse time of large dense files
+    vector<int64_t> ret;
+    const QChar* data = text.constData();
+    const int length = text.size();
+    const uint64_t maxVal = (uint64_t)numeric_limits<int64_t>::max();
+    int pos = 0;
+    while (true)
+    {
+        while (pos < length && data[pos].isSpace()) ++pos;
+        if (pos >= length) break;
+        const int start = pos;
+        bool negative = false, ok = true;
+        if (data[pos] == QChar('-') || data[pos] == QChar('+'))
+        {
+            negative = (data[pos] == QChar('-'));
+            ++pos;
+        }
+        if (pos >= length || data[pos].isSpace()) ok = false;//lone sign
+        uint64_t value = 0;
+        for (; pos < length && !data[pos].isSpace(); ++pos)
+        {
+            const ushort c = data[pos].unicode();
+            if (c < '0' || c > '9')
+            {
+                ok = false;//keep going to find the end of the token for the error message
+            } else if (ok) {
+                const uint64_t digit = c - '0';
+                if (value > (maxVal - digit) / 10)
+                {
+                    ok = false;//out of range for int64_t, as toLongLong would reject
+                } else {
+                    value = value * 10 + digit;
+                }
+            }
+        }
+        if (!ok)
+        {
+            throw DataFileException("found noninteger in index array: " + text.mid(start, pos - start));
+        }
+        if (negative && value != 0 && !allowNegative)
+        {
+            throw DataFileException("found negative integer in index array: " + text.mid(start, pos - start));
+        }
+        ret.push_back(negative ? -(int64_t)value : (int64_t)value);
+    }
+    return ret;
+}
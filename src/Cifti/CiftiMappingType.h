@@ -27,6 +27,8 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
+#include <vector>
+
 namespace caret
 {
     class CiftiMappingType
@@ -57,6 +59,9 @@ namespace caret
         virtual ~CiftiMappingType();
         
         static QString mappingTypeToName(const MappingType& type);
+        
+        ///parses a whitespace-separated list of integers, as used for vertex and voxel index lists, throws on anything else
+        static std::vector<int64_t> parseIndexArray(const QString& text, const bool& allowNegative);
     };
 }
 
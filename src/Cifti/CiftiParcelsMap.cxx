@@ -625,22 +625,9 @@ CiftiParcelsMap::Parcel CiftiParcelsMap::readParcel2(QXmlStreamReader& xml)
 
 vector<int64_t> CiftiParcelsMap::readIndexArray(QXmlStreamReader& xml)
 {
-    vector<int64_t> ret;
     QString text = xml.readElementText();//raises error if it encounters a start element
-    if (xml.hasError()) return ret;
-    QStringList separated = text.split(QRegExp("\\s+"), QString::SkipEmptyParts);
-    int64_t numElems = separated.size();
-    ret.reserve(numElems);
-    for (int64_t i = 0; i < numElems; ++i)
-    {
-        bool ok = false;
-        ret.push_back(separated[i].toLongLong(&ok));
-        if (!ok)
-        {
-            throw DataFileException("found noninteger in index array: " + separated[i]);
-        }
-    }
-    return ret;
+    if (xml.hasError()) return vector<int64_t>();
+    return parseIndexArray(text, true);
 }
 
 void CiftiParcelsMap::writeXML1(QXmlStreamWriter& xml) const
@@ -0,0 +1,562 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CommandBatch.h"
+
+#include "CaretCommandLine.h"
+#include "CaretLogger.h"
+#include "CaretOMP.h"
+#include "CommandBatchFiles.h"
+#include "CommandOperationManager.h"
+#include "CommandParser.h"
+#include "ProgramParameters.h"
+#include "TextFile.h"
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    struct BatchLine
+    {
+        int m_lineNumber;//in the script, for messages
+        vector<AString> m_arguments;//starting with the command switch
+        CommandParser* m_operation;//owned by CommandOperationManager, only used to make new instances
+        set<AString> m_inputs, m_outputs;//CommandBatchFiles keys of declared file parameters
+        set<AString> m_reads, m_writes;//what ordering is based on, string arguments that might be files count as both
+        set<AString> m_keepOutputs, m_memoryOnlyOutputs;
+        vector<pair<int, AString> > m_handoffInputs;//producing line and key of inputs that will come from memory
+        vector<int> m_dependents;
+        int m_numWaiting;//dependencies that haven't finished yet
+        BatchLine() { m_lineNumber = -1; m_operation = NULL; m_numWaiting = 0; }
+    };
+    
+    ///splits a line into arguments, with quoting and escapes like a posix shell, but no expansion of any kind
+    vector<AString> splitArguments(const AString& line, const int& lineNumber)
+    {
+        vector<AString> ret;
+        AString current;
+        bool inArgument = false;
+        const int length = line.size();
+        for (int i = 0; i < length; ++i)
+        {
+            const QChar c = line[i];
+            if (c == '\'')
+            {
+                int end = line.indexOf('\'', i + 1);
+                if (end == -1) throw CommandException("unterminated single quote on line " + AString::number(lineNumber));
+                current += line.mid(i + 1, end - i - 1);
+                i = end;
+                inArgument = true;
+            } else if (c == '"') {
+                bool closed = false;
+                for (++i; i < length; ++i)
+                {
+                    if (line[i] == '"')
+                    {
+                        closed = true;
+                        break;
+                    }
+                    if (line[i] == '\\' && i + 1 < length && (line[i + 1] == '"' || line[i + 1] == '\\'))
+                    {
+                        ++i;
+                    }
+                    current += line[i];
+                }
+                if (!closed) throw CommandException("unterminated double quote on line " + AString::number(lineNumber));
+                inArgument = true;
+            } else if (c == '\\') {
+                if (i + 1 < length)
+                {
+                    ++i;
+                    current += line[i];
+                    inArgument = true;
+                }
+            } else if (c.isSpace()) {
+                if (inArgument)
+                {
+                    ret.push_back(current);
+                    current = "";
+                    inArgument = false;
+                }
+            } else if (c == '#' && !inArgument) {
+                break;//comment to end of line
+            } else {
+                current += c;
+                inArgument = true;
+            }
+        }
+        if (inArgument) ret.push_back(current);
+        return ret;
+    }
+    
+    ///string arguments are sometimes file names that the operation opens itself (text files, output prefixes, etc)
+    bool mightBeFileName(const AString& argument)
+    {
+        if (argument.indexOf('/') != -1) return true;
+        if (argument.indexOf('.') == -1) return false;
+        bool isNumber = false;
+        argument.toDouble(&isNumber);
+        return !isNumber;
+    }
+    
+    bool intersects(const set<AString>& first, const set<AString>& second)
+    {
+        const set<AString>& smaller = (first.size() < second.size() ? first : second);
+        const set<AString>& larger = (first.size() < second.size() ? second : first);
+        for (set<AString>::const_iterator iter = smaller.begin(); iter != smaller.end(); ++iter)
+        {
+            if (larger.find(*iter) != larger.end()) return true;
+        }
+        return false;
+    }
+    
+    ///find the ordering between lines, and which outputs can be handed off in memory
+    void planLines(vector<BatchLine>& lines, const bool& discardIntermediates, map<pair<int, AString>, int>& handoffCountsOut)
+    {
+        const int numLines = (int)lines.size();
+        handoffCountsOut.clear();
+        for (int j = 0; j < numLines; ++j)
+        {
+            BatchLine& later = lines[j];
+            for (int i = 0; i < j; ++i)
+            {
+                BatchLine& earlier = lines[i];
+                if (intersects(earlier.m_writes, later.m_reads) || intersects(earlier.m_writes, later.m_writes) || intersects(earlier.m_reads, later.m_writes))
+                {
+                    earlier.m_dependents.push_back(j);
+                    ++later.m_numWaiting;
+                }
+            }
+            for (set<AString>::const_iterator iter = later.m_inputs.begin(); iter != later.m_inputs.end(); ++iter)
+            {//use the most recent version from an earlier line, unless a string argument may have changed it on disk since then
+                for (int i = j - 1; i >= 0; --i)
+                {
+                    if (lines[i].m_outputs.find(*iter) != lines[i].m_outputs.end())
+                    {
+                        lines[i].m_keepOutputs.insert(*iter);
+                        later.m_handoffInputs.push_back(make_pair(i, *iter));
+                        ++handoffCountsOut[make_pair(i, *iter)];
+                        break;
+                    }
+                    if (lines[i].m_writes.find(*iter) != lines[i].m_writes.end()) break;
+                }
+            }
+        }
+        if (!discardIntermediates) return;
+        for (int i = 0; i < numLines; ++i)
+        {//outputs that are only ever used as declared inputs, until they are replaced, don't need to be on disk
+            for (set<AString>::const_iterator iter = lines[i].m_keepOutputs.begin(); iter != lines[i].m_keepOutputs.end(); ++iter)
+            {
+                bool memoryOnly = true;
+                for (int j = i + 1; j < numLines; ++j)
+                {
+                    if (lines[j].m_reads.find(*iter) != lines[j].m_reads.end() && lines[j].m_inputs.find(*iter) == lines[j].m_inputs.end())
+                    {
+                        memoryOnly = false;//used as a string argument, so the operation may open it itself
+                        break;
+                    }
+                    if (lines[j].m_outputs.find(*iter) != lines[j].m_outputs.end()) break;
+                }
+                if (memoryOnly) lines[i].m_memoryOnlyOutputs.insert(*iter);
+            }
+        }
+    }
+    
+    class BatchRunner
+    {
+        vector<BatchLine>& m_lines;
+        CommandBatchFiles m_files;
+        map<pair<int, AString>, int> m_handoffRemaining;
+        set<int> m_ready;//start the earliest ready line first, so a single job runs the script in order
+        int m_numRunning, m_numFinished;
+        bool m_failed;
+        AString m_errorMessage;
+        QMutex m_mutex;
+        QWaitCondition m_condition;
+        bool m_discardIntermediates, m_preventProvenance, m_ciftiScale;
+        int16_t m_ciftiDType;
+        double m_ciftiMin, m_ciftiMax;
+        
+        void runLine(BatchLine& line);
+        void lineFinished(BatchLine& line);
+    public:
+        BatchRunner(vector<BatchLine>& lines, const bool& discardIntermediates, const bool& preventProvenance,
+                    const bool& ciftiScale, const int16_t& ciftiDType, const double& ciftiMin, const double& ciftiMax);
+        void workerLoop();
+        bool failed() const { return m_failed; }
+        const AString& getErrorMessage() const { return m_errorMessage; }
+    };
+    
+    class BatchWorker : public QThread
+    {
+        BatchRunner* m_runner;
+        int m_ompThreads;
+    public:
+        BatchWorker(BatchRunner* runner, const int& ompThreads) : m_runner(runner), m_ompThreads(ompThreads) { }
+        void run()
+        {
+#ifdef CARET_OMP
+            omp_set_num_threads(m_ompThreads);//split the cores between the concurrent commands
+#endif
+            m_runner->workerLoop();
+        }
+    };
+    
+    BatchRunner::BatchRunner(vector<BatchLine>& lines, const bool& discardIntermediates, const bool& preventProvenance,
+                             const bool& ciftiScale, const int16_t& ciftiDType, const double& ciftiMin, const double& ciftiMax) : m_lines(lines)
+    {
+        m_numRunning = 0;
+        m_numFinished = 0;
+        m_failed = false;
+        m_discardIntermediates = discardIntermediates;
+        m_preventProvenance = preventProvenance;
+        m_ciftiScale = ciftiScale;
+        m_ciftiDType = ciftiDType;
+        m_ciftiMin = ciftiMin;
+        m_ciftiMax = ciftiMax;
+        planLines(m_lines, m_discardIntermediates, m_handoffRemaining);
+        for (int i = 0; i < (int)m_lines.size(); ++i)
+        {
+            if (m_lines[i].m_numWaiting == 0) m_ready.insert(i);
+        }
+    }
+    
+    void BatchRunner::runLine(BatchLine& line)
+    {
+        CaretLogInfo("batch line " + AString::number(line.m_lineNumber) + ": " + line.m_arguments[0]);
+        CaretPointer<CommandParser> myParser(line.m_operation->newInstance());
+        vector<AString> fullCommand(1, AString("wb_command"));
+        fullCommand.insert(fullCommand.end(), line.m_arguments.begin(), line.m_arguments.end());
+        myParser->setBatchFiles(&m_files, line.m_keepOutputs, line.m_memoryOnlyOutputs, caret_commandLine_fromArguments(fullCommand));
+        if (m_ciftiScale)
+        {
+            myParser->setCiftiOutputDTypeAndScale(m_ciftiDType, m_ciftiMin, m_ciftiMax);
+        } else {
+            myParser->setCiftiOutputDTypeNoScale(m_ciftiDType);
+        }
+        ProgramParameters myParams;
+        for (int i = 1; i < (int)line.m_arguments.size(); ++i)
+        {
+            myParams.addParameter(line.m_arguments[i]);
+        }
+        myParser->execute(myParams, m_preventProvenance);
+    }
+    
+    void BatchRunner::lineFinished(BatchLine& line)
+    {//called with the mutex held
+        for (int i = 0; i < (int)line.m_handoffInputs.size(); ++i)
+        {
+            int& remaining = m_handoffRemaining[line.m_handoffInputs[i]];
+            --remaining;
+            const AString& key = line.m_handoffInputs[i].second;
+            if (remaining == 0 && line.m_outputs.find(key) == line.m_outputs.end())
+            {
+                m_files.removeFile(key);//last reader of this version, free the memory
+            }
+        }
+        for (set<AString>::const_iterator iter = line.m_outputs.begin(); iter != line.m_outputs.end(); ++iter)
+        {
+            if (line.m_keepOutputs.find(*iter) == line.m_keepOutputs.end())
+            {
+                m_files.removeFile(*iter);//don't let an older in-memory version outlive a replacement that went to disk
+            }
+        }
+        for (int i = 0; i < (int)line.m_dependents.size(); ++i)
+        {
+            BatchLine& dependent = m_lines[line.m_dependents[i]];
+            --dependent.m_numWaiting;
+            if (dependent.m_numWaiting == 0) m_ready.insert(line.m_dependents[i]);
+        }
+    }
+    
+    void BatchRunner::workerLoop()
+    {
+        const int numLines = (int)m_lines.size();
+        QMutexLocker locked(&m_mutex);
+        while (true)
+        {
+            while (m_ready.empty() && !m_failed && m_numFinished < numLines)
+            {
+                m_condition.wait(&m_mutex);
+            }
+            if (m_failed || m_ready.empty()) break;//if nothing is ready here, everything is finished
+            int index = *(m_ready.begin());
+            m_ready.erase(m_ready.begin());
+            ++m_numRunning;
+            locked.unlock();
+            bool success = true;
+            AString error;
+            try
+            {
+                runLine(m_lines[index]);
+            } catch (CaretException& e) {
+                success = false;
+                error = e.whatString();
+            } catch (exception& e) {
+                success = false;
+                error = e.what();
+            } catch (...) {
+                success = false;
+                error = "unknown exception type";
+            }
+            locked.relock();
+            --m_numRunning;
+            ++m_numFinished;
+            if (success)
+            {
+                lineFinished(m_lines[index]);
+            } else if (!m_failed) {
+                m_failed = true;//let running lines finish, but don't start any more
+                m_errorMessage = "batch line " + AString::number(m_lines[index].m_lineNumber) + " (" + m_lines[index].m_arguments[0] + ") failed: " + error;
+            }
+            m_condition.wakeAll();
+        }
+    }
+}
+
+/**
+ * Constructor.
+ */
+CommandBatch::CommandBatch()
+: CommandOperation("-batch",
+                   "RUN A SCRIPT OF COMMANDS IN ONE PROCESS")
+{
+    m_preventProvenance = false;
+    m_ciftiScale = false;
+    m_ciftiDType = NIFTI_TYPE_FLOAT32;
+    m_ciftiMin = -1.0;
+    m_ciftiMax = -1.0;
+}
+
+/**
+ * Destructor.
+ */
+CommandBatch::~CommandBatch()
+{
+    
+}
+
+void CommandBatch::disableProvenance()
+{
+    m_preventProvenance = true;
+}
+
+void CommandBatch::setCiftiOutputDTypeAndScale(const int16_t& dtype, const double& minVal, const double& maxVal)
+{
+    m_ciftiDType = dtype;
+    m_ciftiMin = minVal;
+    m_ciftiMax = maxVal;
+    m_ciftiScale = true;
+}
+
+void CommandBatch::setCiftiOutputDTypeNoScale(const int16_t& dtype)
+{
+    m_ciftiDType = dtype;
+    m_ciftiMin = -1.0;
+    m_ciftiMax = -1.0;
+    m_ciftiScale = false;
+}
+
+AString CommandBatch::getHelpInformation(const AString& programName)
+{
+    AString helpInfo = ("\n"
+                        "Run the wb_command lines in a script within a single process.\n"
+                        "\n"
+                        "Usage:  " + programName + " -batch <script-file>\n"
+                        "        [-jobs <num>]\n"
+                        "        [-discard-intermediates]\n"
+                        "\n"
+                        "Options: \n"
+                        "    -jobs <num>\n"
+                        "        Run up to this many lines at the same time, when they\n"
+                        "        don't use any of the same files.  Cores are divided\n"
+                        "        evenly between the concurrent lines.  Default 1.\n"
+                        "    \n"
+                        "    -discard-intermediates\n"
+                        "        Don't write outputs to disk when they are only used as\n"
+                        "        inputs to later lines before being replaced.\n"
+                        "\n"
+                        "Each line of the script is one command, with or without\n"
+                        "'wb_command' at the start.  Arguments are split as in a posix\n"
+                        "shell: single and double quotes, backslash escapes, backslash at\n"
+                        "the end of a line to continue it, and # for comments.  Variables,\n"
+                        "wildcards, pipes and redirection are NOT supported.\n"
+                        "\n"
+                        "When a later line uses an output of an earlier line as an input\n"
+                        "file, it is given the file that is already in memory instead of\n"
+                        "reading it back from disk.  Lines are ordered by the files they\n"
+                        "declare as inputs and outputs, plus any string arguments that\n"
+                        "look like file names, so lines that share none of these can run\n"
+                        "concurrently when -jobs is more than 1.\n"
+                        "\n"
+                        "Global options must be given before -batch, and apply to every\n"
+                        "line.  The whole script is checked for errors before any line is\n"
+                        "run, and the script stops at the first line that fails.\n"
+                        );
+    return helpInfo;
+}
+
+/**
+ * Execute the operation.
+ * 
+ * @param parameters
+ *   Parameters for the operation.
+ * @throws CommandException
+ *   If the command failed.
+ * @throws ProgramParametersException
+ *   If there is an error in the parameters.
+ */
+void CommandBatch::executeOperation(ProgramParameters& parameters)
+{
+    const bool preventProvenance = m_preventProvenance;
+    m_preventProvenance = false;//don't keep it around for another call
+    AString scriptName = parameters.nextString("script file");
+    int numJobs = 1;
+    bool discardIntermediates = false;
+    while (parameters.hasNext())
+    {
+        AString option = parameters.nextString("option");
+        if (option == "-jobs")
+        {
+            numJobs = parameters.nextInt("number of jobs");
+            if (numJobs < 1) throw CommandException("-jobs must be at least 1");
+        } else if (option == "-discard-intermediates") {
+            discardIntermediates = true;
+        } else {
+            throw CommandException("Invalid parameter: " + option);
+        }
+    }
+    TextFile scriptFile;
+    scriptFile.readFile(scriptName);
+    QStringList physicalLines = scriptFile.getText().split('\n');
+    vector<CommandOperation*> operations = CommandOperationManager::getCommandOperationManager()->getCommandOperations();
+    const char* globalOptions[] = { "-disable-provenance", "-logging", "-simd", "-cifti-output-datatype", "-cifti-output-range", "-threads", "-timing", "-profile" };
+    const int numGlobalOptions = sizeof(globalOptions) / sizeof(globalOptions[0]);
+    vector<BatchLine> lines;
+    for (int i = 0; i < physicalLines.size(); ++i)
+    {
+        BatchLine myLine;
+        myLine.m_lineNumber = i + 1;
+        AString joined = physicalLines[i];
+        if (joined.endsWith('\r')) joined.chop(1);
+        while (joined.endsWith('\\') && i + 1 < physicalLines.size())
+        {//continuation
+            joined.chop(1);
+            ++i;
+            joined += physicalLines[i];
+            if (joined.endsWith('\r')) joined.chop(1);
+        }
+        myLine.m_arguments = splitArguments(joined, myLine.m_lineNumber);
+        if (!myLine.m_arguments.empty() && (myLine.m_arguments[0] == "wb_command" || myLine.m_arguments[0].endsWith("/wb_command")))
+        {
+            myLine.m_arguments.erase(myLine.m_arguments.begin());
+        }
+        if (myLine.m_arguments.empty()) continue;
+        const AString lineString = "line " + AString::number(myLine.m_lineNumber);
+        for (int j = 1; j < (int)myLine.m_arguments.size(); ++j)
+        {
+            for (int k = 0; k < numGlobalOptions; ++k)
+            {
+                if (myLine.m_arguments[j] == globalOptions[k])
+                {
+                    throw CommandException("global option '" + myLine.m_arguments[j] + "' on " + lineString + ", global options must be given before -batch");
+                }
+            }
+        }
+        for (int j = 0; j < (int)operations.size(); ++j)
+        {
+            if (operations[j]->getCommandLineSwitch() == myLine.m_arguments[0])
+            {
+                myLine.m_operation = dynamic_cast<CommandParser*>(operations[j]);
+                if (myLine.m_operation == NULL) throw CommandException("command '" + myLine.m_arguments[0] + "' on " + lineString + " can't be used in a batch script");
+                break;
+            }
+        }
+        if (myLine.m_operation == NULL) throw CommandException("unknown command '" + myLine.m_arguments[0] + "' on " + lineString);
+        ProgramParameters myParams;
+        for (int j = 1; j < (int)myLine.m_arguments.size(); ++j)
+        {
+            myParams.addParameter(myLine.m_arguments[j]);
+        }
+        vector<AString> inputs, outputs, strings;
+        try
+        {
+            myLine.m_operation->getFileArguments(myParams, inputs, outputs, strings);
+        } catch (CaretException& e) {
+            throw CommandException("error parsing " + lineString + " (" + myLine.m_arguments[0] + "): " + e.whatString());
+        }
+        for (int j = 0; j < (int)inputs.size(); ++j)
+        {
+            AString key = CommandBatchFiles::makeKey(inputs[j]);
+            myLine.m_inputs.insert(key);
+            myLine.m_reads.insert(key);
+        }
+        for (int j = 0; j < (int)outputs.size(); ++j)
+        {
+            AString key = CommandBatchFiles::makeKey(outputs[j]);
+            myLine.m_outputs.insert(key);
+            myLine.m_writes.insert(key);
+        }
+        for (int j = 0; j < (int)strings.size(); ++j)
+        {
+            if (mightBeFileName(strings[j]))
+            {
+                AString key = CommandBatchFiles::makeKey(strings[j]);
+                myLine.m_reads.insert(key);
+                myLine.m_writes.insert(key);
+            }
+        }
+        lines.push_back(myLine);
+    }
+    if (lines.empty()) return;
+    BatchRunner myRunner(lines, discardIntermediates, preventProvenance, m_ciftiScale, m_ciftiDType, m_ciftiMin, m_ciftiMax);
+    numJobs = min(numJobs, (int)lines.size());
+    if (numJobs == 1)
+    {
+        myRunner.workerLoop();
+    } else {
+        int ompThreads = 1;
+#ifdef CARET_OMP
+        ompThreads = max(1, omp_get_max_threads() / numJobs);//respects -threads and OMP_NUM_THREADS
+#endif
+        vector<CaretPointer<BatchWorker> > workers(numJobs);
+        for (int i = 0; i < numJobs; ++i)
+        {
+            workers[i].grabNew(new BatchWorker(&myRunner, ompThreads));
+            workers[i]->start();
+        }
+        for (int i = 0; i < numJobs; ++i)
+        {
+            workers[i]->wait();
+        }
+    }
+    if (myRunner.failed()) throw CommandException(myRunner.getErrorMessage());
+}
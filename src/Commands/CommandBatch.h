@@ -0,0 +1,66 @@
+#ifndef __COMMAND_BATCH_H__
+#define __COMMAND_BATCH_H__
+
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CommandOperation.h"
+
+namespace caret {
+
+    /// Command that runs a script of wb_command lines in one process, handing off intermediate files in memory.
+    class CommandBatch : public CommandOperation {
+        
+    public:
+        CommandBatch();
+        
+        virtual ~CommandBatch();
+
+        virtual void executeOperation(ProgramParameters& parameters);
+        
+        AString getHelpInformation(const AString& programName);
+        
+        virtual void setCiftiOutputDTypeAndScale(const int16_t& dtype, const double& minVal, const double& maxVal);
+        
+        virtual void setCiftiOutputDTypeNoScale(const int16_t& dtype);
+        
+    protected:
+        virtual void disableProvenance();
+        
+    private:
+        
+        CommandBatch(const CommandBatch&);
+
+        CommandBatch& operator=(const CommandBatch&);
+        
+        /** global options given to the batch command, applied to every line */
+        bool m_preventProvenance;
+        
+        bool m_ciftiScale;
+        
+        int16_t m_ciftiDType;
+        
+        double m_ciftiMin, m_ciftiMax;
+    };
+    
+} // namespace
+
+#endif // __COMMAND_BATCH_H__
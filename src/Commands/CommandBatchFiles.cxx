@@ -0,0 +1,101 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CommandBatchFiles.h"
+
+#include "BorderFile.h"
+#include "CiftiFile.h"
+#include "FileInformation.h"
+#include "FociFile.h"
+#include "LabelFile.h"
+#include "MetricFile.h"
+#include "SurfaceFile.h"
+#include "VolumeFile.h"
+
+using namespace caret;
+using namespace std;
+
+namespace caret
+{//specializations must be in the same namespace as the template
+    template<> CaretPointer<BorderFile>& CommandBatchFiles::Entry::member<BorderFile>() { return m_border; }
+    template<> CaretPointer<CiftiFile>& CommandBatchFiles::Entry::member<CiftiFile>() { return m_cifti; }
+    template<> CaretPointer<FociFile>& CommandBatchFiles::Entry::member<FociFile>() { return m_foci; }
+    template<> CaretPointer<LabelFile>& CommandBatchFiles::Entry::member<LabelFile>() { return m_label; }
+    template<> CaretPointer<MetricFile>& CommandBatchFiles::Entry::member<MetricFile>() { return m_metric; }
+    template<> CaretPointer<SurfaceFile>& CommandBatchFiles::Entry::member<SurfaceFile>() { return m_surface; }
+    template<> CaretPointer<VolumeFile>& CommandBatchFiles::Entry::member<VolumeFile>() { return m_volume; }
+}
+
+CommandBatchFiles::CommandBatchFiles()
+{
+}
+
+CommandBatchFiles::~CommandBatchFiles()
+{
+}
+
+AString CommandBatchFiles::makeKey(const AString& fileName)
+{
+    return FileInformation(fileName).getAbsoluteFilePath();
+}
+
+template<typename T>
+bool CommandBatchFiles::getFile(const AString& fileName, CaretPointer<T>& fileOut)
+{
+    CaretMutexLocker locked(&m_mutex);
+    map<AString, Entry>::iterator iter = m_files.find(makeKey(fileName));
+    if (iter == m_files.end()) return false;
+    CaretPointer<T>& stored = iter->second.member<T>();
+    if (stored == NULL) return false;
+    fileOut = stored;
+    return true;
+}
+
+template<typename T>
+void CommandBatchFiles::putFile(const AString& fileName, const CaretPointer<T>& file)
+{
+    CaretMutexLocker locked(&m_mutex);
+    Entry& myEntry = m_files[makeKey(fileName)];
+    myEntry = Entry();//a file name only holds one file at a time, even if the type changes
+    myEntry.member<T>() = file;
+}
+
+void CommandBatchFiles::removeFile(const AString& fileName)
+{
+    CaretMutexLocker locked(&m_mutex);
+    m_files.erase(makeKey(fileName));
+}
+
+//the types that command parameters use
+template bool CommandBatchFiles::getFile<BorderFile>(const AString&, CaretPointer<BorderFile>&);
+template bool CommandBatchFiles::getFile<CiftiFile>(const AString&, CaretPointer<CiftiFile>&);
+template bool CommandBatchFiles::getFile<FociFile>(const AString&, CaretPointer<FociFile>&);
+template bool CommandBatchFiles::getFile<LabelFile>(const AString&, CaretPointer<LabelFile>&);
+template bool CommandBatchFiles::getFile<MetricFile>(const AString&, CaretPointer<MetricFile>&);
+template bool CommandBatchFiles::getFile<SurfaceFile>(const AString&, CaretPointer<SurfaceFile>&);
+template bool CommandBatchFiles::getFile<VolumeFile>(const AString&, CaretPointer<VolumeFile>&);
+template void CommandBatchFiles::putFile<BorderFile>(const AString&, const CaretPointer<BorderFile>&);
+template void CommandBatchFiles::putFile<CiftiFile>(const AString&, const CaretPointer<CiftiFile>&);
+template void CommandBatchFiles::putFile<FociFile>(const AString&, const CaretPointer<FociFile>&);
+template void CommandBatchFiles::putFile<LabelFile>(const AString&, const CaretPointer<LabelFile>&);
+template void CommandBatchFiles::putFile<MetricFile>(const AString&, const CaretPointer<MetricFile>&);
+template void CommandBatchFiles::putFile<SurfaceFile>(const AString&, const CaretPointer<SurfaceFile>&);
+template void CommandBatchFiles::putFile<VolumeFile>(const AString&, const CaretPointer<VolumeFile>&);
@@ -0,0 +1,76 @@
+#ifndef __COMMAND_BATCH_FILES_H__
+#define __COMMAND_BATCH_FILES_H__
+
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+#include "CaretMutex.h"
+#include "CaretPointer.h"
+
+#include <map>
+
+namespace caret {
+
+    class BorderFile;
+    class CiftiFile;
+    class FociFile;
+    class LabelFile;
+    class MetricFile;
+    class SurfaceFile;
+    class VolumeFile;
+    
+    ///in-memory files handed from one command in a batch script to later commands, so they don't need to be reread from disk
+    class CommandBatchFiles
+    {
+        struct Entry
+        {//only one member is used, depending on what type of output the file was
+            CaretPointer<BorderFile> m_border;
+            CaretPointer<CiftiFile> m_cifti;
+            CaretPointer<FociFile> m_foci;
+            CaretPointer<LabelFile> m_label;
+            CaretPointer<MetricFile> m_metric;
+            CaretPointer<SurfaceFile> m_surface;
+            CaretPointer<VolumeFile> m_volume;
+            template<typename T> CaretPointer<T>& member();
+        };
+        std::map<AString, Entry> m_files;
+        mutable CaretMutex m_mutex;
+        CommandBatchFiles(const CommandBatchFiles&);
+        CommandBatchFiles& operator=(const CommandBatchFiles&);
+    public:
+        CommandBatchFiles();
+        ~CommandBatchFiles();
+        
+        ///the name that files are stored under, so that different relative paths to the same file match
+        static AString makeKey(const AString& fileName);
+        
+        ///returns false if the file isn't in memory, or was stored as a different type
+        template<typename T> bool getFile(const AString& fileName, CaretPointer<T>& fileOut);
+        
+        template<typename T> void putFile(const AString& fileName, const CaretPointer<T>& file);
+        
+        void removeFile(const AString& fileName);
+    };
+    
+}
+
+#endif //__COMMAND_BATCH_FILES_H__
@@ -231,6 +231,7 @@
 #include "CommandParser.h"
 #include "OperationException.h"
 
+#include "CommandBatch.h"
 #include "CommandClassAddMember.h"
 #include "CommandClassCreate.h"
 #include "CommandClassCreateAlgorithm.h"
@@ -240,8 +241,12 @@
 #include "CommandUnitTest.h"
 #include "ProgramParameters.h"
 
+#include "CaretCommandLine.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
+#include "CaretProfiler.h"
 #include "dot_wrapper.h"
+#include "ElapsedTimer.h"
 #include "StructureEnum.h"
 
 #include <iostream>
@@ -481,6 +486,7 @@ CommandOperationManager::CommandOperationManager()
     this->commandOperations.push_back(new CommandParser(new AutoOperationZipSceneFile()));
     this->commandOperations.push_back(new CommandParser(new AutoOperationZipSpecFile()));
     
+    this->commandOperations.push_back(new CommandBatch());
     this->commandOperations.push_back(new CommandClassAddMember());
     this->commandOperations.push_back(new CommandClassCreate());
     this->commandOperations.push_back(new CommandClassCreateAlgorithm());
@@ -575,6 +581,27 @@ CommandOperationManager::runCommand(ProgramParameters& parameters)
             CaretLogWarning("SIMD type '" + DotSIMDEnum::toName(impl) + "' not supported (could be cpu, compiler, or build options), using '" + DotSIMDEnum::toName(retval) + "'");
         }
     }
+    if (getGlobalOption(parameters, "-threads", 1, globalOptionArgs))
+    {
+        bool valid = false;
+        int numThreads = globalOptionArgs[0].toInt(&valid);
+        if (!valid || numThreads < 1) throw CommandException("invalid number of threads: '" + globalOptionArgs[0] + "'");
+#ifdef CARET_OMP
+        omp_set_num_threads(numThreads);
+#else
+        CaretLogWarning("-threads has no effect, this build does not use OpenMP");
+#endif
+    }
+    bool showTiming = getGlobalOption(parameters, "-timing", 0, globalOptionArgs);
+    AString profileFileName;
+    if (getGlobalOption(parameters, "-profile", 1, globalOptionArgs))
+    {
+        profileFileName = globalOptionArgs[0];
+    }
+    if (showTiming || profileFileName != "")
+    {
+        CaretProfiler::setEnabled(true);
+    }
     int16_t ciftiDType = NIFTI_TYPE_FLOAT32;
     bool ciftiScale = false;
     double ciftiMin = -1.0, ciftiMax = -1.0;
@@ -668,7 +695,25 @@ CommandOperationManager::runCommand(ProgramParameters& parameters)
                 } else {
                     operation->setCiftiOutputDTypeNoScale(ciftiDType);
                 }
+                ElapsedTimer myTimer;
+                myTimer.start();
                 operation->execute(parameters, preventProvenance);
+                if (CaretProfiler::isEnabled())
+                {
+                    double totalSeconds = myTimer.getElapsedTimeSeconds();
+                    if (showTiming)
+                    {
+                        cerr << CaretProfiler::getReportText(totalSeconds);//stderr, so it doesn't mix with output from commands like -file-information
+                    }
+                    if (profileFileName != "")
+                    {
+                        int numThreads = 1;
+#ifdef CARET_OMP
+                        numThreads = omp_get_max_threads();
+#endif
+                        CaretProfiler::writeReportJson(profileFileName, caret_global_commandLine, totalSeconds, numThreads);
+                    }
+                }
             }
         }
     }
@@ -714,7 +759,18 @@ AString CommandOperationManager::doCompletion(ProgramParameters& parameters, con
     {//can't tab complete a literal number
         return "";
     }
-    ret = "wordlist -disable-provenance\\ -logging\\ -simd\\ -cifti-output-datatype\\ -cifti-output-range";//we could prevent suggesting an already-provided global option, but that would be a bit surprising
+    OptionInfo threadsInfo = parseGlobalOption(parameters, "-threads", 1, globalOptionArgs, true);
+    if (threadsInfo.specified && !threadsInfo.complete)
+    {//can't tab complete a literal number
+        return "";
+    }
+    /*OptionInfo timingInfo = */parseGlobalOption(parameters, "-timing", 0, globalOptionArgs, true);
+    OptionInfo profileInfo = parseGlobalOption(parameters, "-profile", 1, globalOptionArgs, true);
+    if (profileInfo.specified && !profileInfo.complete)
+    {
+        return "fileglob *.json";
+    }
+    ret = "wordlist -disable-provenance\\ -logging\\ -simd\\ -cifti-output-datatype\\ -cifti-output-range\\ -threads\\ -timing\\ -profile";//we could prevent suggesting an already-provided global option, but that would be a bit surprising
     const uint64_t numberOfCommands = this->commandOperations.size();
     const uint64_t numberOfDeprecated = this->deprecatedOperations.size();
     if (!parameters.hasNext())
@@ -1086,6 +1142,15 @@ void CommandOperationManager::printGlobalOptions()
     }
     cout << endl;//add a line after the logging types for readability
     //guide for wrap, assuming 80 columns:                                                  |
+    cout << "   -threads <num>                    use at most this many threads, overrides" << endl;
+    cout << "                                        OMP_NUM_THREADS" << endl;
+    cout << endl;
+    cout << "   -timing                           print time spent in each phase (reading," << endl;
+    cout << "                                        computing, writing, etc) to stderr" << endl;
+    cout << endl;
+    cout << "   -profile <file>                   write wall time, cpu time, and bytes" << endl;
+    cout << "                                        for each phase to a json file" << endl;
+    cout << endl;
     cout << "   -simd <type>                      set the SIMD implementation to use" << endl;
     cout << "                                        (currently used only for correlation," << endl;
     cout << "                                        default AUTO which selects fastest" << endl;
@@ -1202,6 +1267,11 @@ void CommandOperationManager::printParallelHelp(const AString& programName)
     cout << endl;//guide for wrap, assuming 80 columns:                                     |
     cout << "$ OMP_NUM_THREADS=4 "<< programName << " -volume-smoothing input.nii.gz 4 output.nii.gz" << endl;
     cout << endl;//guide for wrap, assuming 80 columns:                                     |
+    cout << "   The -threads global option does the same thing for a single command, and" << endl;
+    cout << "   takes precedence over OMP_NUM_THREADS:" << endl;
+    cout << endl;//guide for wrap, assuming 80 columns:                                     |
+    cout << "$ "<< programName << " -threads 4 -volume-smoothing input.nii.gz 4 output.nii.gz" << endl;
+    cout << endl;//guide for wrap, assuming 80 columns:                                     |
     cout << "   If you have a multi-socket system, be aware that the parallelization can be" << endl;
     cout << "   much slower when threads are on different sockets, and this interacts badly" << endl;
     cout << "   with the default behavior of using all available cores.  It is advisable to" << endl;
@@ -27,7 +27,9 @@
 #include "CaretCommandLine.h"
 #include "CaretDataFileHelper.h"
 #include "CaretLogger.h"
+#include "CaretProfiler.h"
 #include "CiftiFile.h"
+#include "CommandBatchFiles.h"
 #include "DataFileException.h"
 #include "FileInformation.h"
 #include "FociFile.h"
@@ -59,6 +61,8 @@ CommandParser::CommandParser(AutoOperationInterface* myAutoOper) :
     m_ciftiDType = NIFTI_TYPE_FLOAT32;
     m_ciftiMax = -1.0;//these values won't get used, but don't leave them uninitialized
     m_ciftiMin = -1.0;
+    m_batchFiles = NULL;
+    m_namesOnly = false;
 }
 
 void CommandParser::disableProvenance()
@@ -86,7 +90,12 @@ void CommandParser::executeOperation(ProgramParameters& parameters)
 {
     CaretPointer<OperationParameters> myAlgParams(m_autoOper->getParameters());//could be an autopointer, but this is safer
     vector<OutputAssoc> myOutAssoc;
-    m_provenance = caret_global_commandLine;
+    if (m_batchFiles != NULL)
+    {
+        m_provenance = m_batchCommandLine;//the process command line is just the batch script
+    } else {
+        m_provenance = caret_global_commandLine;
+    }
     //the idea is to have m_provenance set before the command executes, so it can be overridden, but have m_parentProvenance set AFTER the processing is complete
     //the parent provenance should never be generated manually
     m_parentProvenance = "";//in case someone tries to use the same instance more than once
@@ -97,7 +106,10 @@ void CommandParser::executeOperation(ProgramParameters& parameters)
     makeOnDiskOutputs(myOutAssoc);//check for input on-disk files used as output on-disk files
     //code to show what arguments map to what parameters should go here
     if (m_doProvenance) provenanceBeforeOperation(myOutAssoc);
-    m_autoOper->useParameters(myAlgParams.getPointer(), NULL);//TODO: progress status for caret_command? would probably get messed up by any command info output
+    {
+        CaretProfileScope myScope("compute");
+        m_autoOper->useParameters(myAlgParams.getPointer(), NULL);//TODO: progress status for caret_command? would probably get messed up by any command info output
+    }
     vector<AString> uncheckedWarnings = myAlgParams->findUncheckedParams("the command");
     for (size_t i = 0; i < uncheckedWarnings.size(); ++i)
     {
@@ -105,6 +117,7 @@ void CommandParser::executeOperation(ProgramParameters& parameters)
     }
     if (m_doProvenance) provenanceAfterOperation(myOutAssoc);
     //TODO: deallocate input files - give abstract parameter a virtual deallocate method? use CaretPointer and rely on reference counting?
+    CaretProfileScope myScope("write");
     writeOutput(myOutAssoc);
 }
 
@@ -150,6 +163,29 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 continue;//so skip trying to parse it as a required argument
             }
         }
+        if (m_namesOnly)
+        {//only record what would be used, don't open anything
+            bool isFile = false;
+            switch (myComponent->m_paramList[i]->getType())
+            {
+                case OperationParametersEnum::BORDER:
+                case OperationParametersEnum::CIFTI:
+                case OperationParametersEnum::FOCI:
+                case OperationParametersEnum::LABEL:
+                case OperationParametersEnum::METRIC:
+                case OperationParametersEnum::SURFACE:
+                case OperationParametersEnum::VOLUME:
+                    m_namesOnlyInputs.push_back(nextArg);
+                    isFile = true;
+                    break;
+                case OperationParametersEnum::STRING:
+                    m_namesOnlyStrings.push_back(nextArg);
+                    break;
+                default:
+                    break;
+            }
+            if (isFile) continue;
+        }
         const OperationParametersEnum::Enum nextType = myComponent->m_paramList[i]->getType();// need in catch statement below
         try {
             switch (myComponent->m_paramList[i]->getType())
@@ -167,8 +203,13 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::BORDER:
                 {
-                    CaretPointer<BorderFile> myFile(new BorderFile());
-                    myFile->readFile(nextArg);
+                    CaretProfileScope myScope("read");
+                    CaretPointer<BorderFile> myFile;
+                    if (!getBatchInput(nextArg, myFile))
+                    {
+                        myFile.grabNew(new BorderFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -192,9 +233,18 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 case OperationParametersEnum::CIFTI:
                 {
                     FileInformation myInfo(nextArg);
-                    CaretPointer<CiftiFile> myFile(new CiftiFile());
-                    myFile->openFile(nextArg);
-                    m_inputCiftiNames[myInfo.getCanonicalFilePath()] = myFile;//track input cifti, so we can check their size
+                    CaretProfileScope myScope("read");
+                    CaretPointer<CiftiFile> myFile;
+                    if (!getBatchInput(nextArg, myFile))
+                    {
+                        myFile.grabNew(new CiftiFile());
+                        myFile->openFile(nextArg);
+                    }
+                    AString canonicalPath = myInfo.getCanonicalFilePath();
+                    if (canonicalPath != "")//an input handed off in memory may not exist on disk, and new outputs also get an empty canonical path
+                    {
+                        m_inputCiftiNames[canonicalPath] = myFile;//track input cifti, so we can check their size
+                    }
                     if (m_doProvenance)//just an optimization, if we aren't going to write provenance, don't generate it, either
                     {
                         const GiftiMetaData* md = myFile->getCiftiXML().getFileMetaData();
@@ -231,8 +281,13 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::FOCI:
                 {
-                    CaretPointer<FociFile> myFile(new FociFile());
-                    myFile->readFile(nextArg);
+                    CaretProfileScope myScope("read");
+                    CaretPointer<FociFile> myFile;
+                    if (!getBatchInput(nextArg, myFile))
+                    {
+                        myFile.grabNew(new FociFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -266,8 +321,13 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::LABEL:
                 {
-                    CaretPointer<LabelFile> myFile(new LabelFile());
-                    myFile->readFile(nextArg);
+                    CaretProfileScope myScope("read");
+                    CaretPointer<LabelFile> myFile;
+                    if (!getBatchInput(nextArg, myFile))
+                    {
+                        myFile.grabNew(new LabelFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -290,8 +350,13 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::METRIC:
                 {
-                    CaretPointer<MetricFile> myFile(new MetricFile());
-                    myFile->readFile(nextArg);
+                    CaretProfileScope myScope("read");
+                    CaretPointer<MetricFile> myFile;
+                    if (!getBatchInput(nextArg, myFile))
+                    {
+                        myFile.grabNew(new MetricFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -324,8 +389,13 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::SURFACE:
                 {
-                    CaretPointer<SurfaceFile> myFile(new SurfaceFile());
-                    myFile->readFile(nextArg);
+                    CaretProfileScope myScope("read");
+                    CaretPointer<SurfaceFile> myFile;
+                    if (!getBatchInput(nextArg, myFile))
+                    {
+                        myFile.grabNew(new SurfaceFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -348,8 +418,13 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
                 }
                 case OperationParametersEnum::VOLUME:
                 {
-                    CaretPointer<VolumeFile> myFile(new VolumeFile());
-                    myFile->readFile(nextArg);
+                    CaretProfileScope myScope("read");
+                    CaretPointer<VolumeFile> myFile;
+                    if (!getBatchInput(nextArg, myFile))
+                    {
+                        myFile.grabNew(new VolumeFile());
+                        myFile->readFile(nextArg);
+                    }
                     if (m_doProvenance)
                     {
                         const GiftiMetaData* md = myFile->getFileMetaData();
@@ -948,7 +1023,9 @@ void CommandParser::makeOnDiskOutputs(const vector<OutputAssoc>& outAssociation)
             {
                 CiftiParameter* myCiftiParam = (CiftiParameter*)myParam;
                 FileInformation myInfo(outAssociation[i].m_fileName);
-                map<AString, const CiftiFile*>::iterator iter = m_inputCiftiNames.find(myInfo.getCanonicalFilePath());
+                AString canonicalPath = myInfo.getCanonicalFilePath();
+                map<AString, const CiftiFile*>::iterator iter = m_inputCiftiNames.end();
+                if (canonicalPath != "") iter = m_inputCiftiNames.find(canonicalPath);//output doesn't exist yet, so it can't collide
                 if (iter != m_inputCiftiNames.end())
                 {
                     vector<int64_t> dims = iter->second->getDimensions();
@@ -962,7 +1039,9 @@ void CommandParser::makeOnDiskOutputs(const vector<OutputAssoc>& outAssociation)
                         CaretLogInfo("Computing output file '" + outAssociation[i].m_fileName + "' in memory due to collision with input file");
                     }
                     myCiftiParam->m_parameter.grabNew(new CiftiFile());
-               } else {
+               } else if (isBatchKept(outAssociation[i].m_fileName)) {
+                    myCiftiParam->m_parameter.grabNew(new CiftiFile());//later commands read it, so compute it in memory
+                } else {
                     myCiftiParam->m_parameter.grabNew(new CiftiFile());
                     myCiftiParam->m_parameter->setWritingFile(outAssociation[i].m_fileName);
                 }
@@ -985,6 +1064,8 @@ void CommandParser::writeOutput(const vector<OutputAssoc>& outAssociation)
     for (uint32_t i = 0; i < outAssociation.size(); ++i)
     {
         AbstractParameter* myParam = outAssociation[i].m_param;
+        const bool kept = isBatchKept(outAssociation[i].m_fileName);
+        const bool doWrite = !isBatchMemoryOnly(outAssociation[i].m_fileName);
         switch (myParam->getType())
         {
             case OperationParametersEnum::BOOL://ignores the name you give the output for now, but what gives primitive type output and how is it used?
@@ -992,15 +1073,27 @@ void CommandParser::writeOutput(const vector<OutputAssoc>& outAssociation)
                 break;
             case OperationParametersEnum::BORDER:
             {
-                BorderFile* myFile = ((BorderParameter*)myParam)->m_parameter;
-                myFile->writeFile(outAssociation[i].m_fileName);
+                CaretPointer<BorderFile>& myFile = ((BorderParameter*)myParam)->m_parameter;
+                if (doWrite) myFile->writeFile(outAssociation[i].m_fileName);
+                if (kept) m_batchFiles->putFile(outAssociation[i].m_fileName, myFile);
                 break;
             }
             case OperationParametersEnum::CIFTI:
             {
-                CiftiFile* myFile = ((CiftiParameter*)myParam)->m_parameter;//we can't set metadata here because the XML is already on disk, see provenanceForOnDiskOutputs
-                myFile->writeFile(outAssociation[i].m_fileName);//this is basically a noop unless outputs and inputs collide, we opened ON_DISK and set cache file to this name back in makeOnDiskOutputs
-                myFile->close();//if there is a problem flushing the file, let it throw here instead of doing a severe log message
+                CaretPointer<CiftiFile>& myFile = ((CiftiParameter*)myParam)->m_parameter;//we can't set metadata here because the XML is already on disk, see provenanceForOnDiskOutputs
+                if (doWrite) myFile->writeFile(outAssociation[i].m_fileName);//this is basically a noop unless outputs and inputs collide, we opened ON_DISK and set cache file to this name back in makeOnDiskOutputs
+                if (kept)
+                {//set the writing type again before other commands can share it, so anything that writes the handed-off file uses -cifti-output-datatype
+                    if (m_ciftiScale)
+                    {
+                        myFile->setWritingDataTypeAndScaling(m_ciftiDType, m_ciftiMin, m_ciftiMax);
+                    } else {
+                        myFile->setWritingDataTypeNoScaling(m_ciftiDType);
+                    }
+                    m_batchFiles->putFile(outAssociation[i].m_fileName, myFile);//kept outputs are in memory, and later commands still need the data
+                } else {
+                    myFile->close();//if there is a problem flushing the file, let it throw here instead of doing a severe log message
+                }
                 break;
             }
             case OperationParametersEnum::DOUBLE:
@@ -1011,20 +1104,23 @@ void CommandParser::writeOutput(const vector<OutputAssoc>& outAssociation)
                 break;
             case OperationParametersEnum::FOCI:
             {
-                FociFile* myFile = ((FociParameter*)myParam)->m_parameter;
-                myFile->writeFile(outAssociation[i].m_fileName);
+                CaretPointer<FociFile>& myFile = ((FociParameter*)myParam)->m_parameter;
+                if (doWrite) myFile->writeFile(outAssociation[i].m_fileName);
+                if (kept) m_batchFiles->putFile(outAssociation[i].m_fileName, myFile);
                 break;
             }
             case OperationParametersEnum::LABEL:
             {
-                LabelFile* myFile = ((LabelParameter*)myParam)->m_parameter;
-                myFile->writeFile(outAssociation[i].m_fileName);
+                CaretPointer<LabelFile>& myFile = ((LabelParameter*)myParam)->m_parameter;
+                if (doWrite) myFile->writeFile(outAssociation[i].m_fileName);
+                if (kept) m_batchFiles->putFile(outAssociation[i].m_fileName, myFile);
                 break;
             }
             case OperationParametersEnum::METRIC:
             {
-                MetricFile* myFile = ((MetricParameter*)myParam)->m_parameter;
-                myFile->writeFile(outAssociation[i].m_fileName);
+                CaretPointer<MetricFile>& myFile = ((MetricParameter*)myParam)->m_parameter;
+                if (doWrite) myFile->writeFile(outAssociation[i].m_fileName);
+                if (kept) m_batchFiles->putFile(outAssociation[i].m_fileName, myFile);
                 break;
             }
             case OperationParametersEnum::STRING:
@@ -1032,14 +1128,16 @@ void CommandParser::writeOutput(const vector<OutputAssoc>& outAssociation)
                 break;
             case OperationParametersEnum::SURFACE:
             {
-                SurfaceFile* myFile = ((SurfaceParameter*)myParam)->m_parameter;
-                myFile->writeFile(outAssociation[i].m_fileName);
+                CaretPointer<SurfaceFile>& myFile = ((SurfaceParameter*)myParam)->m_parameter;
+                if (doWrite) myFile->writeFile(outAssociation[i].m_fileName);
+                if (kept) m_batchFiles->putFile(outAssociation[i].m_fileName, myFile);
                 break;
             }
             case OperationParametersEnum::VOLUME:
             {
-                VolumeFile* myFile = ((VolumeParameter*)myParam)->m_parameter;
-                myFile->writeFile(outAssociation[i].m_fileName);
+                CaretPointer<VolumeFile>& myFile = ((VolumeParameter*)myParam)->m_parameter;
+                if (doWrite) myFile->writeFile(outAssociation[i].m_fileName);
+                if (kept) m_batchFiles->putFile(outAssociation[i].m_fileName, myFile);
                 break;
             }
             default:
@@ -1049,6 +1147,73 @@ void CommandParser::writeOutput(const vector<OutputAssoc>& outAssociation)
     }
 }
 
+bool CommandParser::isBatchKept(const AString& fileName) const
+{
+    if (m_batchFiles == NULL) return false;
+    return m_batchKeepOutputs.find(CommandBatchFiles::makeKey(fileName)) != m_batchKeepOutputs.end();
+}
+
+bool CommandParser::isBatchMemoryOnly(const AString& fileName) const
+{
+    if (m_batchFiles == NULL) return false;
+    return m_batchMemoryOnly.find(CommandBatchFiles::makeKey(fileName)) != m_batchMemoryOnly.end();
+}
+
+template<typename T>
+bool CommandParser::getBatchInput(const AString& fileName, CaretPointer<T>& fileOut)
+{
+    if (m_batchFiles == NULL) return false;
+    return m_batchFiles->getFile(fileName, fileOut);
+}
+
+CommandParser* CommandParser::newInstance()
+{
+    return new CommandParser(m_autoOper->clone());
+}
+
+void CommandParser::setBatchFiles(CommandBatchFiles* batchFiles, const set<AString>& keepOutputs, const set<AString>& memoryOnlyOutputs, const AString& commandLine)
+{
+    m_batchFiles = batchFiles;
+    m_batchKeepOutputs = keepOutputs;
+    m_batchMemoryOnly = memoryOnlyOutputs;
+    m_batchCommandLine = commandLine;
+}
+
+void CommandParser::getFileArguments(ProgramParameters& parameters, vector<AString>& inputsOut, vector<AString>& outputsOut, vector<AString>& stringsOut)
+{
+    CaretPointer<OperationParameters> myAlgParams(m_autoOper->getParameters());
+    vector<OutputAssoc> myOutAssoc;
+    m_namesOnlyInputs.clear();
+    m_namesOnlyStrings.clear();
+    m_namesOnly = true;
+    try
+    {
+        parseComponent(myAlgParams.getPointer(), parameters, myOutAssoc);
+        parameters.verifyAllParametersProcessed();
+    } catch (...) {
+        m_namesOnly = false;
+        throw;
+    }
+    m_namesOnly = false;
+    inputsOut = m_namesOnlyInputs;
+    stringsOut = m_namesOnlyStrings;
+    outputsOut.clear();
+    for (size_t i = 0; i < myOutAssoc.size(); ++i)
+    {
+        switch (myOutAssoc[i].m_param->getType())
+        {
+            case OperationParametersEnum::BOOL://primitive outputs are only printed
+            case OperationParametersEnum::DOUBLE:
+            case OperationParametersEnum::INT:
+            case OperationParametersEnum::STRING:
+                break;
+            default:
+                outputsOut.push_back(myOutAssoc[i].m_fileName);
+                break;
+        }
+    }
+}
+
 AString CommandParser::getHelpInformation(const AString& programName)
 {
     m_minIndent = 0;
@@ -32,6 +32,8 @@
 #include <set>
 
 namespace caret {
+    
+    class CommandBatchFiles;
 
     class CommandParser : public CommandOperation, OperationParserInterface
     {
@@ -42,6 +44,11 @@ namespace caret {
         int16_t m_ciftiDType;
         const static AString PROVENANCE_NAME, PARENT_PROVENANCE_NAME, PROGRAM_PROVENANCE_NAME, CWD_PROVENANCE_NAME;//TODO: put this elsewhere?
         std::map<AString, const CiftiFile*> m_inputCiftiNames;
+        CommandBatchFiles* m_batchFiles;//NULL unless running from a batch script
+        std::set<AString> m_batchKeepOutputs, m_batchMemoryOnly;//batch file keys of outputs to hand off to later commands, and which of those not to write to disk
+        AString m_batchCommandLine;
+        bool m_namesOnly;//parse without opening files, for getFileArguments
+        std::vector<AString> m_namesOnlyInputs, m_namesOnlyStrings;
         struct OutputAssoc
         {//how the output is stored is up to the parser, in the GUI it should load into memory without writing to disk
             AString m_fileName;
@@ -60,6 +67,9 @@ namespace caret {
         void provenanceAfterOperation(const std::vector<OutputAssoc>& outAssociation);
         void makeOnDiskOutputs(const std::vector<OutputAssoc>& outAssociation);//ensures on-disk inputs aren't used as on-disk outputs, keeping outputs in-memory when needed
         void writeOutput(const std::vector<OutputAssoc>& outAssociation);
+        bool isBatchKept(const AString& fileName) const;
+        bool isBatchMemoryOnly(const AString& fileName) const;
+        template<typename T> bool getBatchInput(const AString& fileName, CaretPointer<T>& fileOut);
         AString getIndentString(int desired);
         void addHelpComponent(AString& info, ParameterComponent* myComponent, int curIndent);
         void addHelpOptions(AString& info, ParameterComponent* myAlgParams, int curIndent);
@@ -81,6 +91,15 @@ namespace caret {
         AString doCompletion(ProgramParameters& parameters, const bool& useExtGlob);
         AString getHelpInformation(const AString& programName);
         bool takesParameters();
+        
+        ///a new parser for the same operation, with its own state, so that commands can run concurrently
+        CommandParser* newInstance();
+        
+        ///take inputs from earlier batch commands when they are in memory, and keep the listed outputs (as CommandBatchFiles keys) in memory for later commands
+        void setBatchFiles(CommandBatchFiles* batchFiles, const std::set<AString>& keepOutputs, const std::set<AString>& memoryOnlyOutputs, const AString& commandLine);
+        
+        ///parse the command without opening any files, to find which files it would use - strings are returned separately, as some are file names
+        void getFileArguments(ProgramParameters& parameters, std::vector<AString>& inputsOut, std::vector<AString>& outputsOut, std::vector<AString>& stringsOut);
     };
 
 };
@@ -27,13 +27,19 @@
 
 #include "CaretAssert.h"
 #include "CaretBinaryFile.h"
+#include "CaretHttpManager.h"
 #include "CaretLogger.h"
+#include "CaretProfiler.h"
 #include "DataFileException.h"
 
 #include <QFile>
 #include "zlib.h"
 
 #include <algorithm>
+#include <cstring>
+#include <list>
+#include <map>
+#include <vector>
 
 using namespace caret;
 using namespace std;
@@ -76,6 +82,37 @@ namespace caret
     };
     
     const int64_t QFileImpl::CHUNK_SIZE = 1<<30;//1GiB, QT4 apparently chokes at more than 2GiB via buffer.read using int32
+    
+    class HttpRangeFileImpl : public CaretBinaryFile::ImplInterface
+    {//read-only access to a file on a web server via HTTP byte range requests, with an LRU block cache and read-ahead for sequential reads
+        struct CacheBlock
+        {
+            int64_t m_blockIndex;
+            vector<char> m_data;//last block of the file may be short
+        };
+        list<CacheBlock> m_cache;//most recently used first
+        map<int64_t, list<CacheBlock>::iterator> m_cacheLookup;
+        int64_t m_position, m_fileSize;
+        int64_t m_nextSequentialBlock, m_readAheadBlocks;//block following the previous fetch, and how many blocks to fetch when that block is requested
+        const static int64_t BLOCK_SIZE, MAX_CACHE_BLOCKS, MAX_READ_AHEAD_BLOCKS;
+        void requestRange(const int64_t& start, const int64_t& end, CaretHttpResponse& responseOut);
+        void throwTooLargeWithoutRanges(const AString& sizeString);
+        void addBlocks(const int64_t& firstBlock, const vector<char>& data);
+        const vector<char>& getBlock(const int64_t& blockIndex);
+    public:
+        HttpRangeFileImpl();
+        void open(const QString& filename, const CaretBinaryFile::OpenMode& opmode);
+        void close();
+        void seek(const int64_t& position) { m_position = position; }
+        int64_t pos() { return m_position; }
+        int64_t size() { return m_fileSize; }
+        void read(void* dataOut, const int64_t& count, int64_t* numRead);
+        void write(const void* dataIn, const int64_t& count);
+    };
+    
+    const int64_t HttpRangeFileImpl::BLOCK_SIZE = 1<<20;//1MiB, rows of large files are usually smaller, but requests have substantial latency
+    const int64_t HttpRangeFileImpl::MAX_CACHE_BLOCKS = 128;
+    const int64_t HttpRangeFileImpl::MAX_READ_AHEAD_BLOCKS = 32;//must be less than MAX_CACHE_BLOCKS
 }
 
 CaretBinaryFile::ImplInterface::~ImplInterface()
@@ -115,7 +152,11 @@ void CaretBinaryFile::open(const QString& filename, const OpenMode& opmode)
 {
     close();
     if (opmode == NONE) throw DataFileException("can't open file with NONE mode");
-    if (filename.endsWith(".gz"))
+    if (filename.startsWith("http://") || filename.startsWith("https://"))
+    {
+        if (filename.endsWith(".gz")) throw DataFileException("can't open compressed file '" + filename + "' on a web server, compressed files can't be read by byte ranges");
+        m_impl.grabNew(new HttpRangeFileImpl());
+    } else if (filename.endsWith(".gz"))
     {
 #ifdef ZLIB_VERSION
         m_impl.grabNew(new ZFileImpl());
@@ -133,7 +174,9 @@ void CaretBinaryFile::read(void* dataOut, const int64_t& count, int64_t* numRead
 {
     CaretAssert(count >= 0);//not sure about allowing 0
     if (!getOpenForRead()) throw DataFileException("file is not open for reading");
+    CaretProfileScope myScope("file-read");
     m_impl->read(dataOut, count, numRead);
+    myScope.addBytes(numRead != NULL ? *numRead : count);
 }
 
 void CaretBinaryFile::seek(const int64_t& position)
@@ -159,7 +202,9 @@ void CaretBinaryFile::write(const void* dataIn, const int64_t& count)
 {
     CaretAssert(count >= 0);//not sure about allowing 0
     if (!getOpenForWrite()) throw DataFileException("file is not open for writing");
+    CaretProfileScope myScope("file-write");
     m_impl->write(dataIn, count);
+    myScope.addBytes(count);
 }
 
 #ifdef ZLIB_VERSION
@@ -374,3 +419,188 @@ void QFileImpl::write(const void* dataIn, const int64_t& count)
                          + " bytes.");
     if (total != count) throw DataFileException(msg);
 }
+
+HttpRangeFileImpl::HttpRangeFileImpl()
+{
+    m_position = 0;
+    m_fileSize = -1;
+    m_nextSequentialBlock = -1;
+    m_readAheadBlocks = 1;
+}
+
+void HttpRangeFileImpl::open(const QString& filename, const CaretBinaryFile::OpenMode& opmode)
+{
+    close();
+    m_fileName = filename;
+    if (opmode != CaretBinaryFile::READ) throw DataFileException("file '" + filename + "' on a web server can only be opened for reading");
+    {//ask for the headers first, so that a server that says it ignores ranges can't make us download a huge file
+        CaretHttpRequest headRequest;
+        headRequest.m_method = CaretHttpManager::HEAD;
+        headRequest.m_url = filename;
+        CaretHttpResponse headResponse;
+        CaretHttpManager::httpRequest(headRequest, headResponse);
+        if (headResponse.m_ok)//some servers don't allow HEAD, the body size limit on the GET still protects us then
+        {
+            bool noRanges = false;
+            int64_t contentLength = -1;
+            for (map<AString, AString>::const_iterator iter = headResponse.m_headers.begin(); iter != headResponse.m_headers.end(); ++iter)
+            {
+                if (iter->first.toLower() == "accept-ranges")
+                {
+                    noRanges = (iter->second.trimmed().toLower() == "none");//a missing header doesn't mean no support, so only trust an explicit refusal
+                } else if (iter->first.toLower() == "content-length") {
+                    bool ok = false;
+                    contentLength = iter->second.trimmed().toLongLong(&ok);
+                    if (!ok) contentLength = -1;
+                }
+            }
+            if (noRanges && contentLength > MAX_CACHE_BLOCKS * BLOCK_SIZE)
+            {
+                throwTooLargeWithoutRanges(AString::number(contentLength) + " bytes");
+            }
+        }
+    }
+    CaretHttpResponse myResponse;
+    requestRange(0, BLOCK_SIZE - 1, myResponse);//also gets the file size from Content-Range
+    if (myResponse.m_responseCode == 200)
+    {//server ignored the range and sent the whole file, which requestRange limits to what fits in the cache, keep it so nothing needs to be fetched again
+        CaretLogFine("server does not support byte ranges, read entire file '" + filename + "'");
+        m_fileSize = myResponse.m_body.size();
+        addBlocks(0, myResponse.m_body);
+        return;
+    }
+    for (map<AString, AString>::const_iterator iter = myResponse.m_headers.begin(); iter != myResponse.m_headers.end(); ++iter)
+    {
+        if (iter->first.toLower() == "content-range")//"bytes 0-1048575/123456789"
+        {
+            int slashPos = iter->second.lastIndexOf('/');
+            bool ok = false;
+            if (slashPos >= 0) m_fileSize = iter->second.mid(slashPos + 1).trimmed().toLongLong(&ok);
+            if (!ok) m_fileSize = -1;
+            break;
+        }
+    }
+    if (m_fileSize < 0) throw DataFileException("web server did not report the size of file '" + filename + "'");
+    addBlocks(0, myResponse.m_body);
+    m_nextSequentialBlock = 1;
+}
+
+void HttpRangeFileImpl::close()
+{
+    m_cache.clear();
+    m_cacheLookup.clear();
+    m_position = 0;
+    m_fileSize = -1;
+    m_nextSequentialBlock = -1;
+    m_readAheadBlocks = 1;
+}
+
+void HttpRangeFileImpl::requestRange(const int64_t& start, const int64_t& end, CaretHttpResponse& responseOut)
+{
+    CaretHttpRequest myRequest;
+    myRequest.m_method = CaretHttpManager::GET;
+    myRequest.m_url = m_fileName;
+    myRequest.m_headers["Range"] = "bytes=" + AString::number(start) + "-" + AString::number(end);//inclusive
+    myRequest.m_maxBodySize = MAX_CACHE_BLOCKS * BLOCK_SIZE;//a server that ignores the range sends the whole file, stop as soon as it can't fit in the cache
+    CaretHttpManager::httpRequest(myRequest, responseOut);
+    if (responseOut.m_bodyTooLarge) throwTooLargeWithoutRanges("more than " + AString::number(MAX_CACHE_BLOCKS * BLOCK_SIZE) + " bytes");
+    if (responseOut.m_responseCode == 206) return;
+    if (responseOut.m_responseCode == 200 && start == 0) return;//whole file, open() handles this
+    throw DataFileException("failed to read bytes " + AString::number(start) + " to " + AString::number(end) + " of '" + m_fileName +
+                            "' from web server, response code " + AString::number(responseOut.m_responseCode));
+}
+
+void HttpRangeFileImpl::throwTooLargeWithoutRanges(const AString& sizeString)
+{
+    throw DataFileException("web server does not support byte ranges, file '" + m_fileName + "' is too large to read without them (" +
+                            sizeString + ", limit is " + AString::number(MAX_CACHE_BLOCKS * BLOCK_SIZE) + ")");
+}
+
+void HttpRangeFileImpl::addBlocks(const int64_t& firstBlock, const vector<char>& data)
+{
+    int64_t numBlocks = ((int64_t)data.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    for (int64_t i = numBlocks - 1; i >= 0; --i)//add in reverse so that the first block is most recently used
+    {
+        int64_t blockIndex = firstBlock + i;
+        map<int64_t, list<CacheBlock>::iterator>::iterator found = m_cacheLookup.find(blockIndex);
+        if (found != m_cacheLookup.end())
+        {
+            m_cache.erase(found->second);
+            m_cacheLookup.erase(found);
+        }
+        m_cache.push_front(CacheBlock());
+        m_cache.front().m_blockIndex = blockIndex;
+        m_cache.front().m_data.assign(data.begin() + i * BLOCK_SIZE, data.begin() + min((i + 1) * BLOCK_SIZE, (int64_t)data.size()));
+        m_cacheLookup[blockIndex] = m_cache.begin();
+    }
+    while ((int64_t)m_cache.size() > MAX_CACHE_BLOCKS)
+    {
+        m_cacheLookup.erase(m_cache.back().m_blockIndex);
+        m_cache.pop_back();
+    }
+}
+
+const vector<char>& HttpRangeFileImpl::getBlock(const int64_t& blockIndex)
+{
+    map<int64_t, list<CacheBlock>::iterator>::iterator found = m_cacheLookup.find(blockIndex);
+    if (found != m_cacheLookup.end())
+    {
+        m_cache.splice(m_cache.begin(), m_cache, found->second);//list iterators stay valid
+        return m_cache.front().m_data;
+    }
+    if (blockIndex == m_nextSequentialBlock)
+    {//sequential scan, fetch more blocks per request each time, to amortize latency
+        m_readAheadBlocks = min(m_readAheadBlocks * 2, MAX_READ_AHEAD_BLOCKS);
+    } else {
+        m_readAheadBlocks = 1;
+    }
+    int64_t numFileBlocks = (m_fileSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int64_t numBlocks = 1;
+    while (numBlocks < m_readAheadBlocks && blockIndex + numBlocks < numFileBlocks &&
+           m_cacheLookup.find(blockIndex + numBlocks) == m_cacheLookup.end())
+    {
+        ++numBlocks;
+    }
+    int64_t start = blockIndex * BLOCK_SIZE;
+    int64_t end = min((blockIndex + numBlocks) * BLOCK_SIZE, m_fileSize) - 1;
+    CaretHttpResponse myResponse;
+    requestRange(start, end, myResponse);
+    if ((int64_t)myResponse.m_body.size() != end - start + 1)
+    {
+        throw DataFileException("web server returned " + AString::number(myResponse.m_body.size()) + " bytes instead of " +
+                                AString::number(end - start + 1) + " for '" + m_fileName + "'");
+    }
+    addBlocks(blockIndex, myResponse.m_body);
+    m_nextSequentialBlock = blockIndex + numBlocks;
+    CaretAssert(m_cache.front().m_blockIndex == blockIndex);
+    return m_cache.front().m_data;
+}
+
+void HttpRangeFileImpl::read(void* dataOut, const int64_t& count, int64_t* numRead)
+{
+    int64_t total = 0;
+    int64_t toRead = max((int64_t)0, min(count, m_fileSize - m_position));
+    while (total < toRead)
+    {
+        int64_t curPos = m_position + total;
+        int64_t blockIndex = curPos / BLOCK_SIZE;
+        const vector<char>& block = getBlock(blockIndex);
+        int64_t blockOffset = curPos - blockIndex * BLOCK_SIZE;
+        int64_t numCopy = min(toRead - total, (int64_t)block.size() - blockOffset);
+        if (numCopy < 1) break;//shouldn't happen, blocks are checked for size when fetched
+        memcpy(((char*)dataOut) + total, block.data() + blockOffset, numCopy);
+        total += numCopy;
+    }
+    m_position += total;
+    if (numRead == NULL)
+    {
+        if (total != count) throw DataFileException("premature end of file in '" + m_fileName + "'");
+    } else {
+        *numRead = total;
+    }
+}
+
+void HttpRangeFileImpl::write(const void*, const int64_t&)
+{
+    throw DataFileException("can't write to file '" + m_fileName + "' on a web server");
+}
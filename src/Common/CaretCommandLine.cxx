@@ -27,11 +27,11 @@ AString caret::caret_global_commandLine;
 
 namespace
 {//private namespace
-    void add_parameter(const AString& param)
+    void add_parameter(AString& commandLine, const AString& param)
     {
-        if (caret_global_commandLine.size() != 0)
+        if (commandLine.size() != 0)
         {
-            caret_global_commandLine += " ";
+            commandLine += " ";
         }
         if (param.indexOfAnyChar(" $();&<>\"`*?{|") != -1)//check for things that the shell is likely to treat specially EXCEPT for ' itself - assume bash for now, but ignore some more specialized cases
         {//NOTE: not checking for \ or replacing with \\, because it is rare except in windows native paths where it will wreak havok to double it
@@ -39,18 +39,18 @@ namespace
             {//we COULD check if it is safe to use "", but "" and non-CDATA xml text don't look nice (we avoid CDATA in CIFTI because the matlab GIFTI toolbox at least used to choke on it after conversion)
                 AString replaced = param;
                 replaced.replace('\'', "'\\''");//that is '\''
-                caret_global_commandLine += "'" + replaced + "'";
+                commandLine += "'" + replaced + "'";
             } else {
-                caret_global_commandLine += "'" + param + "'";
+                commandLine += "'" + param + "'";
             }
         } else {
             if (param.indexOf('\'') != -1)//has ' but no other problems, doesn't need quoting
             {
                 AString replaced = param;
                 replaced.replace('\'', "\\'");//that is \'
-                caret_global_commandLine += replaced;
+                commandLine += replaced;
             } else {
-                caret_global_commandLine += param;
+                commandLine += param;
             }
         }
     }
@@ -60,10 +60,10 @@ void caret::caret_global_commandLine_init(const ProgramParameters& params)
 {
     int32_t numParams = params.getNumberOfParameters();
     caret_global_commandLine = "";
-    add_parameter(params.getProgramName());
+    add_parameter(caret_global_commandLine, params.getProgramName());
     for (int32_t i = 0; i < numParams; ++i)
     {
-        add_parameter(params.getParameter(i));
+        add_parameter(caret_global_commandLine, params.getParameter(i));
     }
 }
 
@@ -72,3 +72,13 @@ void caret::caret_global_commandLine_init(const int& argc, const char *const * a
     ProgramParameters params(argc, argv);
     caret_global_commandLine_init(params);
 }
+
+AString caret::caret_commandLine_fromArguments(const std::vector<AString>& arguments)
+{
+    AString ret;
+    for (size_t i = 0; i < arguments.size(); ++i)
+    {
+        add_parameter(ret, arguments[i]);
+    }
+    return ret;
+}
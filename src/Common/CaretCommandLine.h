@@ -23,6 +23,8 @@
 
 #include "AString.h"
 
+#include <vector>
+
 namespace caret {
     
     class ProgramParameters;
@@ -33,6 +35,9 @@ namespace caret {
     
     void caret_global_commandLine_init(const int& argc, const char *const * argv);
     
+    ///quotes arguments the same way as caret_global_commandLine, for commands that don't come from argv
+    AString caret_commandLine_fromArguments(const std::vector<AString>& arguments);
+    
 }
 
 #endif //__CARET_COMMAND_LINE_H__
@@ -193,7 +193,9 @@ void CaretHttpManager::httpRequest(const CaretHttpRequest &request, CaretHttpRes
             httpRequestPrivate(redirectedRequest,
                                redirectedResponse);
             /* need header from orginal and redirected response */
-            std::map<AString,AString> allHeaders = response.m_headers;
+            std::map<AString,AString> allHeaders = redirectedResponse.m_headers; // redirected response wins (Content-Range, etc)
+            allHeaders.insert(response.m_headers.begin(),
+                              response.m_headers.end());
             allHeaders.insert(redirectedRequest.m_headers.begin(),
                                 redirectedRequest.m_headers.end());
             response = redirectedResponse;
@@ -319,6 +321,11 @@ void CaretHttpManager::httpRequestPrivate(const CaretHttpRequest &request, Caret
 #if QT_VERSION >= 0x050000
         myUrl.setQuery(myUrlQuery);
 #endif // QT_VERSION
+        for (std::map<AString,AString>::const_iterator headerIter = request.m_headers.begin();
+             headerIter != request.m_headers.end();
+             headerIter++) {
+            myRequest.setRawHeader(headerIter->first.toLatin1(), headerIter->second.toLatin1());
+        }
         myRequest.setUrl(myUrl);
         CaretLogInfo("GET URL: " + myUrl.toString());
         myReply = myQNetMgr->get(myRequest);
@@ -335,6 +342,11 @@ void CaretHttpManager::httpRequestPrivate(const CaretHttpRequest &request, Caret
 #if QT_VERSION >= 0x050000
         myUrl.setQuery(myUrlQuery);
 #endif // QT_VERSION
+        for (std::map<AString,AString>::const_iterator headerIter = request.m_headers.begin();
+             headerIter != request.m_headers.end();
+             headerIter++) {
+            myRequest.setRawHeader(headerIter->first.toLatin1(), headerIter->second.toLatin1());
+        }
         myRequest.setUrl(myUrl);
         CaretLogInfo("HEAD URL: " + myUrl.toString());
         myReply = myQNetMgr->head(myRequest);
@@ -343,13 +355,37 @@ void CaretHttpManager::httpRequestPrivate(const CaretHttpRequest &request, Caret
     //QObject::connect(myReply, SIGNAL(sslErrors(QList<QSslError>)), &myLoop, SLOT(quit()));
     //QObject::connect(myQNetMgr, SIGNAL(authenticationRequired(QNetworkReply*,QAuthenticator*)), myCaretMgr, SLOT(authenticationCallback(QNetworkReply*,QAuthenticator*)));
     QObject::connect(myReply, SIGNAL(finished()), &myLoop, SLOT(quit()));//this is safe, because nothing will hand this thread events except queued through this thread's event mechanism
+    if (request.m_maxBodySize >= 0)
+    {
+        QObject::connect(myReply, SIGNAL(metaDataChanged()), &myLoop, SLOT(quit()));//wake up to check the size as soon as the headers arrive
+        QObject::connect(myReply, SIGNAL(downloadProgress(qint64,qint64)), &myLoop, SLOT(quit()));//and as the body arrives, in case there is no Content-Length
+    }
     /*QObject::connect(myReply,
         SIGNAL(sslErrors(const QList<QSslError> & )),
         CaretHttpManager::getHttpManager(),
         SLOT(handleSslErrors(const QList<QSslError> & )));//*/
-    myLoop.exec();//so, they can only be delivered after myLoop.exec() starts
+    bool bodyTooLarge = false;
+    while (!myReply->isFinished())
+    {
+        myLoop.exec();//so, they can only be delivered after myLoop.exec() starts
+        if (request.m_maxBodySize >= 0 && !myReply->isFinished())
+        {
+            bool ok = false;
+            qint64 contentLength = myReply->header(QNetworkRequest::ContentLengthHeader).toLongLong(&ok);
+            if ((ok && contentLength > request.m_maxBodySize) || myReply->bytesAvailable() > request.m_maxBodySize)
+            {
+                bodyTooLarge = true;
+                break;
+            }
+        }
+    }
+    if (bodyTooLarge)
+    {
+        myReply->abort();//don't download the rest
+    }
     response.m_method = request.m_method;
     response.m_ok = false;
+    response.m_bodyTooLarge = bodyTooLarge;
     response.m_redirectionUrlValid = false;
     response.m_responseCode = -1;
     response.m_responseCodeValid = false;
@@ -359,7 +395,8 @@ void CaretHttpManager::httpRequestPrivate(const CaretHttpRequest &request, Caret
         response.m_responseCode = myReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
         response.m_responseCodeValid = true;
     }
-    if (response.m_responseCode == 200)
+    if ((response.m_responseCode == 200)
+        || (response.m_responseCode == 206)) // 206 is partial content, reply to a Range request
     {
         response.m_ok = true;
     }
@@ -377,7 +414,7 @@ void CaretHttpManager::httpRequestPrivate(const CaretHttpRequest &request, Caret
     
     const bool showHeaderValues = false;
     if (showHeaderValues
-        || (response.m_responseCode != 200)) {
+        || ( ! response.m_ok)) {
         logHeadersFromRequest(myRequest,
                               request);
         logHeadersFromReply(*myReply,
@@ -385,6 +422,14 @@ void CaretHttpManager::httpRequestPrivate(const CaretHttpRequest &request, Caret
                             response);
     }
     
+    if (bodyTooLarge)
+    {
+        response.m_ok = false;
+        response.m_body.clear();
+        CaretLogInfo("aborted transfer from URL " + request.m_url + ", body is larger than " + AString::number(request.m_maxBodySize) + " bytes");
+        delete myReply;
+        return;
+    }
     QByteArray myBody = myReply->readAll();
     int64_t mySize = myBody.size();
     response.m_body.reserve(mySize + 1);//make room for the null terminator that will sometimes be added to the end
@@ -77,6 +77,7 @@ namespace caret {
         QUrl m_redirectionUrl;
         bool m_redirectionUrlValid;
         std::map<AString, AString> m_headers; // map so that newer values replace older values
+        bool m_bodyTooLarge;//transfer was aborted because the body exceeded the request's m_maxBodySize, m_body is empty
     };
 
     struct CaretHttpRequest
@@ -86,6 +87,8 @@ namespace caret {
         AString m_uploadFileName;  // used when mode is POST_FILE
         std::vector<std::pair<AString, AString> > m_arguments, m_queries;//arguments go to post data if method is POST_ARGUMENTS, queries stay as queries
         std::map<AString, AString> m_headers; // map so that newer values replace older values
+        int64_t m_maxBodySize;//abort the transfer if the response body would be larger than this, negative means no limit
+        CaretHttpRequest() { m_maxBodySize = -1; }
     };
 
 }
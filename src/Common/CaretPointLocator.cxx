@@ -19,395 +19,479 @@
 /*LICENSE_END*/
 
 #include "CaretPointLocator.h"
-#include "CaretHeap.h"
+#include "CaretAssert.h"
+#include "CaretOMP.h"
+
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 using namespace caret;
 using namespace std;
 
-void CaretPointLocator::addPoint(Oct<LeafVector<Point> >* thisOct, const float point[3], const int64_t index, const int32_t pointSet)
+namespace
 {
-    if (thisOct->m_leaf)
+    struct PointCompare
     {
-        thisOct->m_data.m_vector->push_back(Point(point, index, pointSet));
-        int curSize = (int)thisOct->m_data.m_vector->size();
-        if (curSize > NUM_POINTS_SPLIT)
-        {//test that not all points are the same, or that they have some minimum percentage spread, or...
-            vector<Point>& myVecRef = *(thisOct->m_data.m_vector);
-            Vector3D minBox = myVecRef[0].m_point, maxBox = myVecRef[0].m_point, tempvec;
-            tempvec[0] = thisOct->m_bounds[0][2] - thisOct->m_bounds[0][0];
-            tempvec[1] = thisOct->m_bounds[1][2] - thisOct->m_bounds[1][0];
-            tempvec[2] = thisOct->m_bounds[2][2] - thisOct->m_bounds[2][0];
-            float diagonal = tempvec.length();
-            bool safeToSplit = false;
-            for (int i = 1; i < curSize; ++i)
-            {//this will slow down if lots of stuff is continuously put in an Oct that is far too big - use random sampling?
-                if (myVecRef[i].m_point[0] < minBox[0]) minBox[0] = myVecRef[i].m_point[0];
-                if (myVecRef[i].m_point[1] < minBox[1]) minBox[1] = myVecRef[i].m_point[1];
-                if (myVecRef[i].m_point[2] < minBox[2]) minBox[2] = myVecRef[i].m_point[2];
-                if (myVecRef[i].m_point[0] > maxBox[0]) maxBox[0] = myVecRef[i].m_point[0];
-                if (myVecRef[i].m_point[1] > maxBox[1]) maxBox[1] = myVecRef[i].m_point[1];
-                if (myVecRef[i].m_point[2] > maxBox[2]) maxBox[2] = myVecRef[i].m_point[2];
-                tempvec = minBox - maxBox;
-                if (tempvec.length() > 0.01f * diagonal)//make sure points aren't all identical, would go to infinity recursively
-                {
-                    safeToSplit = true;
-                    break;
-                }
-            }
-            if (safeToSplit)
-            {
-                thisOct->makeChildren();
-                for (int i = 0; i < curSize; ++i)
-                {
-                    addPoint(thisOct->containingChild(myVecRef[i].m_point), myVecRef[i].m_point, myVecRef[i].m_index, myVecRef[i].m_mySet);
-                }
-                thisOct->m_data.freeData();
-            }
+        int m_axis;
+        PointCompare(const int axis) : m_axis(axis) { }
+        template <typename T>
+        bool operator()(const T& left, const T& right) const
+        {
+            return left.m_point[m_axis] < right.m_point[m_axis];
         }
-    } else {
-        addPoint(thisOct->containingChild(point), point, index, pointSet);
+    };
+    
+    struct StackEntry
+    {
+        int64_t m_heapIndex;
+        int m_level;
+        float m_dist2;
+    };
+    
+    const int MAX_STACK = 130;//depth can't exceed 63 with int64_t point counts, and each level adds at most 2 entries
+    
+    inline float distSquared(const float* a, const float* b)
+    {
+        float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+        return dx * dx + dy * dy + dz * dz;
     }
 }
 
-int32_t CaretPointLocator::addPointSet(const float* coordsIn, const int64_t numCoords)
+float CaretPointLocator::KdNode::distSquaredToPoint(const float point[3]) const
 {
-    CaretMutexLocker locked(&m_modifyMutex);
-    int32_t setNum = newIndex();
-    if (numCoords < 1) return setNum;
-    if (m_tree == NULL)
-    {
-        Vector3D minBox, maxBox;
-        minBox = maxBox = coordsIn;//hack - first triple
-        for (int64_t i = 1; i < numCoords; ++i)
-        {
-            int64_t i3 = i * 3;
-            if (coordsIn[i3] < minBox[0]) minBox[0] = coordsIn[i3];
-            if (coordsIn[i3 + 1] < minBox[1]) minBox[1] = coordsIn[i3 + 1];
-            if (coordsIn[i3 + 2] < minBox[2]) minBox[2] = coordsIn[i3 + 2];
-            if (coordsIn[i3] > maxBox[0]) maxBox[0] = coordsIn[i3];
-            if (coordsIn[i3 + 1] > maxBox[1]) maxBox[1] = coordsIn[i3 + 1];
-            if (coordsIn[i3 + 2] > maxBox[2]) maxBox[2] = coordsIn[i3 + 2];
-        }
-        m_tree = new Oct<LeafVector<Point> >(minBox, maxBox);
-    }
-    for (int64_t i = 0; i < numCoords; ++i)
+    float ret = 0.0f;
+    for (int i = 0; i < 3; ++i)
     {
-        int64_t i3 = i * 3;
-        m_tree = m_tree->makeContains(coordsIn + i3);//make new root if needed
-        addPoint(m_tree, coordsIn + i3, i, setNum);//and add the point
+        float temp = max(max(m_min[i] - point[i], point[i] - m_max[i]), 0.0f);
+        ret += temp * temp;
     }
-    return setNum;
+    return ret;
 }
 
 CaretPointLocator::CaretPointLocator(const float* coordsIn, const int64_t numCoords)
 {
     m_nextSetIndex = 1;//next set will be set #1
-    m_tree = NULL;
+    m_depth = 0;
     if (numCoords >= 1)
     {
-        Vector3D minBox, maxBox;
-        minBox = maxBox = coordsIn;//hack - first triple
-        for (int64_t i = 1; i < numCoords; ++i)
-        {
-            int64_t i3 = i * 3;
-            if (coordsIn[i3] < minBox[0]) minBox[0] = coordsIn[i3];
-            if (coordsIn[i3 + 1] < minBox[1]) minBox[1] = coordsIn[i3 + 1];
-            if (coordsIn[i3 + 2] < minBox[2]) minBox[2] = coordsIn[i3 + 2];
-            if (coordsIn[i3] > maxBox[0]) maxBox[0] = coordsIn[i3];
-            if (coordsIn[i3 + 1] > maxBox[1]) maxBox[1] = coordsIn[i3 + 1];
-            if (coordsIn[i3 + 2] > maxBox[2]) maxBox[2] = coordsIn[i3 + 2];
-        }
-        m_tree = new Oct<LeafVector<Point> >(minBox, maxBox);
+        m_coords.assign(coordsIn, coordsIn + numCoords * 3);
+        m_indices.resize(numCoords);
+        m_sets.resize(numCoords, 0);//this is set #0
         for (int64_t i = 0; i < numCoords; ++i)
         {
-            int64_t i3 = i * 3;
-            addPoint(m_tree, coordsIn + i3, i, 0);//this is set #0
+            m_indices[i] = i;
         }
+        rebuildTree();
     }
 }
 
-CaretPointLocator::CaretPointLocator(const float minBounds[3], const float maxBounds[3])
+CaretPointLocator::CaretPointLocator(const float[3], const float[3])
 {
     m_nextSetIndex = 0;
-    m_tree = new Oct<LeafVector<Point> >(minBounds, maxBounds);
+    m_depth = 0;
 }
 
-int64_t CaretPointLocator::closestPoint(const float target[3], LocatorInfo* infoOut) const
+int32_t CaretPointLocator::addPointSet(const float* coordsIn, const int64_t numCoords)
 {
-    if (m_tree == NULL) return -1;
-    CaretSimpleMinHeap<Oct<LeafVector<Point> >*, float> myHeap;
-    bool first = true;
-    float bestDist2 = -1.0f, bestDist = -1.0f, tempf, curDist = m_tree->distToPoint(target);
-    Vector3D bestPoint;
-    int64_t bestIndex = -1;
-    int32_t bestSet = -1;
-    myHeap.push(m_tree, curDist);
-    while (curDist < bestDist || first)
+    CaretMutexLocker locked(&m_modifyMutex);
+    int32_t setNum = newIndex();
+    if (numCoords < 1) return setNum;
+    m_coords.insert(m_coords.end(), coordsIn, coordsIn + numCoords * 3);
+    for (int64_t i = 0; i < numCoords; ++i)
     {
-        Oct<LeafVector<Point> >* thisOct = myHeap.pop();
-        if (thisOct->m_leaf)
-        {
-            vector<Point>& myVecRef = *(thisOct->m_data.m_vector);
-            int curSize = (int)myVecRef.size();
-            for (int i = 0; i < curSize; ++i)
-            {
-                tempf = MathFunctions::distanceSquared3D(myVecRef[i].m_point, target);
-                if (tempf < bestDist2 || first)
-                {
-                    first = false;
-                    bestDist2 = tempf;
-                    bestPoint = myVecRef[i].m_point;
-                    bestSet = myVecRef[i].m_mySet;
-                    bestIndex = myVecRef[i].m_index;
-                }
-            }
-            bestDist = sqrt(bestDist2);
-        } else {
-            for (int ii = 0; ii < 2; ++ii)
-            {
-                for (int ij = 0; ij < 2; ++ij)
-                {
-                    for (int ik = 0; ik < 2; ++ik)
-                    {
-                        tempf = thisOct->m_children[ii][ij][ik]->distToPoint(target);
-                        if (tempf < bestDist || first)
-                        {
-                            myHeap.push(thisOct->m_children[ii][ij][ik], tempf);
-                        }
-                    }
-                }
-            }
-        }
-        if (myHeap.isEmpty())
+        m_indices.push_back(i);
+        m_sets.push_back(setNum);
+    }
+    rebuildTree();
+    return setNum;
+}
+
+void CaretPointLocator::removePointSet(const int32_t whichSet)
+{
+    CaretMutexLocker locked(&m_modifyMutex);
+    m_unusedIndexes.push_back(whichSet);
+    int64_t numPoints = (int64_t)m_indices.size(), outSlot = 0;
+    for (int64_t i = 0; i < numPoints; ++i)
+    {
+        if (m_sets[i] != whichSet)
         {
-            break;//allows us to use top() without violating an assertion
+            m_coords[outSlot * 3] = m_coords[i * 3];
+            m_coords[outSlot * 3 + 1] = m_coords[i * 3 + 1];
+            m_coords[outSlot * 3 + 2] = m_coords[i * 3 + 2];
+            m_indices[outSlot] = m_indices[i];
+            m_sets[outSlot] = m_sets[i];
+            ++outSlot;
         }
-        myHeap.top(&curDist);//get the key for the next item
     }
-    if (infoOut != NULL)
+    if (outSlot == numPoints) return;//nothing removed, tree is still valid
+    m_coords.resize(outSlot * 3);
+    m_indices.resize(outSlot);
+    m_sets.resize(outSlot);
+    rebuildTree();
+}
+
+int32_t CaretPointLocator::newIndex()
+{
+    if (m_unusedIndexes.empty())
     {
-        infoOut->whichSet = bestSet;
-        infoOut->coords = bestPoint;
-        infoOut->index = bestIndex;
+        return m_nextSetIndex++;
+    } else {
+        int32_t ret = m_unusedIndexes[m_unusedIndexes.size() - 1];
+        m_unusedIndexes.pop_back();
+        return ret;
     }
-    return bestIndex;
 }
 
-int64_t CaretPointLocator::closestPointLimited(const float target[3], const float& maxDist, LocatorInfo* infoOut) const
+void CaretPointLocator::getNodeRange(const int64_t heapIndex, const int level, int64_t& startOut, int64_t& endOut) const
+{//node i of a level covers [n * i / 2^level, n * (i + 1) / 2^level), so children always split their parent's range exactly
+    int64_t numPoints = (int64_t)m_indices.size();
+    int64_t position = heapIndex - (((int64_t)1 << level) - 1);
+    startOut = (numPoints * position) >> level;
+    endOut = (numPoints * (position + 1)) >> level;
+}
+
+void CaretPointLocator::computeNodeBounds(const int64_t heapIndex, const int64_t start, const int64_t end)
 {
-    if (m_tree == NULL) return -1;
-    float curDist2 = m_tree->distSquaredToPoint(target), maxDist2 = maxDist * maxDist;
-    if (curDist2 > maxDist2)
+    CaretAssert(end > start);
+    KdNode& thisNode = m_nodes[heapIndex];
+    for (int m = 0; m < 3; ++m)
+    {
+        thisNode.m_min[m] = thisNode.m_max[m] = m_coords[start * 3 + m];
+    }
+    for (int64_t i = start + 1; i < end; ++i)
     {
-        if (infoOut != NULL)
+        for (int m = 0; m < 3; ++m)
         {
-            infoOut->whichSet = -1;
-            infoOut->index = -1;
+            float val = m_coords[i * 3 + m];
+            if (val < thisNode.m_min[m]) thisNode.m_min[m] = val;
+            if (val > thisNode.m_max[m]) thisNode.m_max[m] = val;
         }
-        return -1;
     }
-    CaretSimpleMinHeap<Oct<LeafVector<Point> >*, float> myHeap;
-    bool first = true;
-    float bestDist2 = -1.0f, tempf;
-    Vector3D bestPoint;
-    int64_t bestIndex = -1;
-    int32_t bestSet = -1;
-    myHeap.push(m_tree, curDist2);
-    while (curDist2 < bestDist2 || first)
+}
+
+void CaretPointLocator::rebuildTree()
+{
+    int64_t numPoints = (int64_t)m_indices.size();
+    m_nodes.clear();
+    m_depth = 0;
+    if (numPoints == 0) return;
+    while (((numPoints - 1) >> m_depth) + 1 > LEAF_SIZE) ++m_depth;//stop when ceil(numPoints / 2^depth) fits in a leaf
+    m_nodes.resize(((int64_t)2 << m_depth) - 1);
+    vector<Point> points(numPoints);
+    for (int64_t i = 0; i < numPoints; ++i)
     {
-        Oct<LeafVector<Point> >* thisOct = myHeap.pop();
-        if (thisOct->m_leaf)
+        points[i].m_point[0] = m_coords[i * 3];
+        points[i].m_point[1] = m_coords[i * 3 + 1];
+        points[i].m_point[2] = m_coords[i * 3 + 2];
+        points[i].m_index = m_indices[i];
+        points[i].m_mySet = m_sets[i];
+    }
+    for (int level = 0; level < m_depth; ++level)
+    {//nodes on the same level have disjoint ranges, so each level can be split in parallel
+        int64_t levelNodes = (int64_t)1 << level;
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int64_t position = 0; position < levelNodes; ++position)
         {
-            vector<Point>& myVecRef = *(thisOct->m_data.m_vector);
-            int curSize = (int)myVecRef.size();
-            for (int i = 0; i < curSize; ++i)
+            int64_t start = (numPoints * position) >> level, end = (numPoints * (position + 1)) >> level;
+            int64_t mid = (numPoints * (2 * position + 1)) >> (level + 1);//where the children will split the range
+            float minCoord[3], maxCoord[3];
+            for (int m = 0; m < 3; ++m)
             {
-                tempf = MathFunctions::distanceSquared3D(myVecRef[i].m_point, target);
-                if (tempf < bestDist2 || (first && tempf <= maxDist2))
-                {
-                    first = false;
-                    bestDist2 = tempf;
-                    bestPoint = myVecRef[i].m_point;
-                    bestSet = myVecRef[i].m_mySet;
-                    bestIndex = myVecRef[i].m_index;
-                }
+                minCoord[m] = maxCoord[m] = points[start].m_point[m];
             }
-        } else {
-            for (int ii = 0; ii < 2; ++ii)
+            for (int64_t i = start + 1; i < end; ++i)
             {
-                for (int ij = 0; ij < 2; ++ij)
+                for (int m = 0; m < 3; ++m)
                 {
-                    for (int ik = 0; ik < 2; ++ik)
-                    {
-                        tempf = thisOct->m_children[ii][ij][ik]->distSquaredToPoint(target);
-                        if (tempf < bestDist2 || (first && tempf <= maxDist2))
-                        {
-                            myHeap.push(thisOct->m_children[ii][ij][ik], tempf);
-                        }
-                    }
+                    if (points[i].m_point[m] < minCoord[m]) minCoord[m] = points[i].m_point[m];
+                    if (points[i].m_point[m] > maxCoord[m]) maxCoord[m] = points[i].m_point[m];
                 }
             }
+            int axis = 0;
+            if (maxCoord[1] - minCoord[1] > maxCoord[axis] - minCoord[axis]) axis = 1;
+            if (maxCoord[2] - minCoord[2] > maxCoord[axis] - minCoord[axis]) axis = 2;
+            nth_element(points.begin() + start, points.begin() + mid, points.begin() + end, PointCompare(axis));
         }
-        if (myHeap.isEmpty())
-        {
-            break;//allows us to use top() without violating an assertion
-        }
-        myHeap.top(&curDist2);//get the key for the next item
     }
-    if (infoOut != NULL)
+#pragma omp CARET_PARFOR schedule(static)
+    for (int64_t i = 0; i < numPoints; ++i)
     {
-        infoOut->whichSet = bestSet;
-        infoOut->coords = bestPoint;
-        infoOut->index = bestIndex;
+        m_coords[i * 3] = points[i].m_point[0];
+        m_coords[i * 3 + 1] = points[i].m_point[1];
+        m_coords[i * 3 + 2] = points[i].m_point[2];
+        m_indices[i] = points[i].m_index;
+        m_sets[i] = points[i].m_mySet;
     }
-    return bestIndex;
-}
-
-set<LocatorInfo> CaretPointLocator::pointsInRange(const float target[3], const float& maxDist) const
-{
-    set<LocatorInfo> ret;
-    if (m_tree == NULL) return ret;
-    float curDist2 = m_tree->distSquaredToPoint(target), maxDist2 = maxDist * maxDist;
-    if (curDist2 > maxDist2) return ret;
-    vector<Oct<LeafVector<Point> >*> myStack;//since we don't need the points sorted by distance
-    myStack.push_back(m_tree);
-    while (!myStack.empty())
+    for (int level = m_depth; level >= 0; --level)
     {
-        Oct<LeafVector<Point> >* thisOct = myStack.back();
-        myStack.pop_back();
-        if (thisOct->m_leaf)
+        int64_t levelStart = ((int64_t)1 << level) - 1;
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int64_t heapIndex = levelStart; heapIndex < 2 * levelStart + 1; ++heapIndex)
         {
-            vector<Point>& myVecRef = *(thisOct->m_data.m_vector);
-            int curSize = (int)myVecRef.size();
-            for (int i = 0; i < curSize; ++i)
-            {
-                float tempf = MathFunctions::distanceSquared3D(myVecRef[i].m_point, target);
-                if (tempf <= maxDist2)
-                {
-                    ret.insert(LocatorInfo(myVecRef[i].m_index, myVecRef[i].m_mySet, myVecRef[i].m_point));
-                }
-            }
-        } else {
-            for (int ii = 0; ii < 2; ++ii)
+            if (level == m_depth)
             {
-                for (int ij = 0; ij < 2; ++ij)
+                int64_t start, end;
+                getNodeRange(heapIndex, level, start, end);
+                computeNodeBounds(heapIndex, start, end);
+            } else {
+                const KdNode& child1 = m_nodes[2 * heapIndex + 1], &child2 = m_nodes[2 * heapIndex + 2];
+                for (int m = 0; m < 3; ++m)
                 {
-                    for (int ik = 0; ik < 2; ++ik)
-                    {
-                        float tempf = thisOct->m_children[ii][ij][ik]->distSquaredToPoint(target);
-                        if (tempf <= maxDist2)
-                        {
-                            myStack.push_back(thisOct->m_children[ii][ij][ik]);
-                        }
-                    }
+                    m_nodes[heapIndex].m_min[m] = min(child1.m_min[m], child2.m_min[m]);
+                    m_nodes[heapIndex].m_max[m] = max(child1.m_max[m], child2.m_max[m]);
                 }
             }
         }
     }
-    return ret;
 }
 
-bool CaretPointLocator::anyInRange(const float target[3], const float& maxDist) const
+int64_t CaretPointLocator::closestSlot(const float target[3], const float maxDist2, const int64_t hintSlot) const
 {
-    if (m_tree == NULL) return false;
-    float curDist2 = m_tree->distSquaredToPoint(target), maxDist2 = maxDist * maxDist, tempf;
-    if (curDist2 > maxDist2) return false;
-    CaretSimpleMinHeap<Oct<LeafVector<Point> >*, float> myHeap;//closer octs are more likely to contain a close enough point
-    myHeap.push(m_tree, curDist2);
-    while (!myHeap.isEmpty())
+    if (m_nodes.empty()) return -1;
+    int64_t bestSlot = -1;
+    float bestDist2 = maxDist2;
+    if (hintSlot >= 0)
+    {//a previous answer for a nearby target gives an upper bound before any traversal
+        float tempf = distSquared(m_coords.data() + hintSlot * 3, target);
+        if (tempf <= bestDist2)
+        {
+            bestSlot = hintSlot;
+            bestDist2 = tempf;
+        }
+    }
+    StackEntry myStack[MAX_STACK];
+    int stackSize = 1;
+    myStack[0].m_heapIndex = 0;
+    myStack[0].m_level = 0;
+    myStack[0].m_dist2 = m_nodes[0].distSquaredToPoint(target);
+    while (stackSize > 0)
     {
-        Oct<LeafVector<Point> >* thisOct = myHeap.pop(&curDist2);
-        if (thisOct->m_leaf)
+        const StackEntry cur = myStack[--stackSize];
+        if (cur.m_dist2 > bestDist2) continue;//can't contain anything better, equal distance is still searched so that ties don't depend on the hint
+        if (cur.m_level == m_depth)
         {
-            vector<Point>& myVecRef = *(thisOct->m_data.m_vector);
-            int curSize = (int)myVecRef.size();
-            for (int i = 0; i < curSize; ++i)
+            int64_t start, end;
+            getNodeRange(cur.m_heapIndex, cur.m_level, start, end);
+            const float* coords = m_coords.data();
+            for (int64_t i = start; i < end; ++i)
             {
-                tempf = MathFunctions::distanceSquared3D(myVecRef[i].m_point, target);
-                if (tempf < maxDist2)
-                {
-                    return true;
+                float tempf = distSquared(coords + i * 3, target);
+                if (tempf < bestDist2 || (tempf == bestDist2 && (bestSlot == -1 || i < bestSlot)))
+                {//on equal distance, the lowest slot wins, so the result is the same regardless of search order
+                    bestSlot = i;
+                    bestDist2 = tempf;
                 }
             }
         } else {
-            for (int ii = 0; ii < 2; ++ii)
-            {
-                for (int ij = 0; ij < 2; ++ij)
-                {
-                    for (int ik = 0; ik < 2; ++ik)
-                    {
-                        tempf = thisOct->m_children[ii][ij][ik]->distSquaredToPoint(target);
-                        if (tempf <= maxDist2)
-                        {
-                            myHeap.push(thisOct->m_children[ii][ij][ik], tempf);
-                        }
-                    }
-                }
-            }
+            StackEntry nearEntry, farEntry;
+            nearEntry.m_heapIndex = 2 * cur.m_heapIndex + 1;
+            farEntry.m_heapIndex = nearEntry.m_heapIndex + 1;
+            nearEntry.m_level = farEntry.m_level = cur.m_level + 1;
+            nearEntry.m_dist2 = m_nodes[nearEntry.m_heapIndex].distSquaredToPoint(target);
+            farEntry.m_dist2 = m_nodes[farEntry.m_heapIndex].distSquaredToPoint(target);
+            if (farEntry.m_dist2 < nearEntry.m_dist2) swap(nearEntry, farEntry);
+            CaretAssert(stackSize + 2 <= MAX_STACK);
+            if (farEntry.m_dist2 <= bestDist2) myStack[stackSize++] = farEntry;//push the far child first, so the near child is searched first
+            if (nearEntry.m_dist2 <= bestDist2) myStack[stackSize++] = nearEntry;
         }
     }
-    return false;
+    return bestSlot;
 }
 
-int32_t CaretPointLocator::newIndex()
+void CaretPointLocator::fillInfo(const int64_t slot, LocatorInfo* infoOut) const
 {
-    if (m_unusedIndexes.empty())
+    if (infoOut == NULL) return;
+    if (slot == -1)
     {
-        return m_nextSetIndex++;
-    } else {
-        int32_t ret = m_unusedIndexes[m_unusedIndexes.size() - 1];
-        m_unusedIndexes.pop_back();
-        return ret;
+        infoOut->whichSet = -1;
+        infoOut->index = -1;
+        return;
     }
+    infoOut->whichSet = m_sets[slot];
+    infoOut->coords = m_coords.data() + slot * 3;
+    infoOut->index = m_indices[slot];
 }
 
-void CaretPointLocator::removePointSet(int32_t whichSet)
+int64_t CaretPointLocator::closestPoint(const float target[3], LocatorInfo* infoOut) const
 {
-    CaretMutexLocker locked(&m_modifyMutex);
-    m_unusedIndexes.push_back(whichSet);
-    removeSetHelper(m_tree, whichSet);
+    int64_t slot = closestSlot(target, numeric_limits<float>::infinity(), -1);
+    fillInfo(slot, infoOut);
+    if (slot == -1) return -1;
+    return m_indices[slot];
 }
 
-void CaretPointLocator::removeSetHelper(Oct<LeafVector<CaretPointLocator::Point> >* thisOct, int32_t thisSet)
+int64_t CaretPointLocator::closestPointLimited(const float target[3], const float& maxDist, LocatorInfo* infoOut) const
 {
-    if (thisOct == NULL) return;
-    if (thisOct->m_leaf)
+    int64_t slot = closestSlot(target, maxDist * maxDist, -1);
+    fillInfo(slot, infoOut);
+    if (slot == -1) return -1;
+    return m_indices[slot];
+}
+
+void CaretPointLocator::closestPoints(const float* targets, const int64_t numTargets, vector<int64_t>& indicesOut, vector<int32_t>* setsOut) const
+{
+    closestPointsLimited(targets, numTargets, numeric_limits<float>::infinity(), indicesOut, setsOut);
+}
+
+void CaretPointLocator::closestPointsLimited(const float* targets, const int64_t numTargets, const float& maxDist, vector<int64_t>& indicesOut, vector<int32_t>* setsOut) const
+{
+    indicesOut.resize(numTargets);
+    if (setsOut != NULL) setsOut->resize(numTargets);
+    const float maxDist2 = maxDist * maxDist;
+#pragma omp CARET_PAR
     {
-        vector<Point>& myVecRef = *(thisOct->m_data.m_vector);
-        int curSize = (int)myVecRef.size();
-        bool match = false;
-        for (int i = 0; i < curSize; ++i)//make sure something gets removed, so we don't have to do an allocation if it isn't needed
+        int64_t hintSlot = -1;//consecutive targets in a chunk are usually near each other, the hint only bounds the search, it can't change the result
+#pragma omp CARET_FOR schedule(dynamic, 256)
+        for (int64_t i = 0; i < numTargets; ++i)
         {
-            if (myVecRef[i].m_mySet == thisSet)
+            int64_t slot = closestSlot(targets + i * 3, maxDist2, hintSlot);
+            if (slot != -1)
             {
-                match = true;
-                break;
+                hintSlot = slot;
+                indicesOut[i] = m_indices[slot];
+                if (setsOut != NULL) (*setsOut)[i] = m_sets[slot];
+            } else {
+                indicesOut[i] = -1;
+                if (setsOut != NULL) (*setsOut)[i] = -1;
             }
         }
-        if (match)
+    }
+}
+
+set<LocatorInfo> CaretPointLocator::pointsInRange(const float target[3], const float& maxDist) const
+{
+    vector<LocatorInfo> found;
+    pointsInRange(target, maxDist, found);
+    return set<LocatorInfo>(found.begin(), found.end());
+}
+
+void CaretPointLocator::pointsInRange(const float target[3], const float& maxDist, vector<LocatorInfo>& resultsOut) const
+{
+    resultsOut.clear();
+    if (m_nodes.empty()) return;
+    const float maxDist2 = maxDist * maxDist;
+    StackEntry myStack[MAX_STACK];
+    int stackSize = 1;
+    myStack[0].m_heapIndex = 0;
+    myStack[0].m_level = 0;
+    while (stackSize > 0)
+    {
+        const StackEntry cur = myStack[--stackSize];
+        if (m_nodes[cur.m_heapIndex].distSquaredToPoint(target) > maxDist2) continue;
+        if (cur.m_level == m_depth)
         {
-            vector<Point> tempvec;
-            tempvec.reserve(curSize - 1);//because at least one is getting removed
-            for (int i = 0; i < curSize; ++i)
+            int64_t start, end;
+            getNodeRange(cur.m_heapIndex, cur.m_level, start, end);
+            for (int64_t i = start; i < end; ++i)
             {
-                if (myVecRef[i].m_mySet != thisSet)
+                if (distSquared(m_coords.data() + i * 3, target) <= maxDist2)
                 {
-                    tempvec.push_back(myVecRef[i]);
+                    resultsOut.push_back(LocatorInfo(m_indices[i], m_sets[i], m_coords.data() + i * 3));
                 }
             }
-            myVecRef = tempvec;
+        } else {
+            CaretAssert(stackSize + 2 <= MAX_STACK);
+            for (int child = 1; child <= 2; ++child)
+            {
+                myStack[stackSize].m_heapIndex = 2 * cur.m_heapIndex + child;
+                myStack[stackSize].m_level = cur.m_level + 1;
+                ++stackSize;
+            }
         }
-    } else {
-        for (int ii = 0; ii < 2; ++ii)
+    }
+}
+
+bool CaretPointLocator::anyInRange(const float target[3], const float& maxDist) const
+{
+    if (m_nodes.empty()) return false;
+    const float maxDist2 = maxDist * maxDist;
+    StackEntry myStack[MAX_STACK];
+    int stackSize = 1;
+    myStack[0].m_heapIndex = 0;
+    myStack[0].m_level = 0;
+    myStack[0].m_dist2 = m_nodes[0].distSquaredToPoint(target);
+    while (stackSize > 0)
+    {
+        const StackEntry cur = myStack[--stackSize];
+        if (cur.m_dist2 > maxDist2) continue;
+        if (cur.m_level == m_depth)
+        {
+            int64_t start, end;
+            getNodeRange(cur.m_heapIndex, cur.m_level, start, end);
+            for (int64_t i = start; i < end; ++i)
+            {
+                if (distSquared(m_coords.data() + i * 3, target) < maxDist2)
+                {
+                    return true;
+                }
+            }
+        } else {//closer nodes are more likely to contain a close enough point
+            StackEntry nearEntry, farEntry;
+            nearEntry.m_heapIndex = 2 * cur.m_heapIndex + 1;
+            farEntry.m_heapIndex = nearEntry.m_heapIndex + 1;
+            nearEntry.m_level = farEntry.m_level = cur.m_level + 1;
+            nearEntry.m_dist2 = m_nodes[nearEntry.m_heapIndex].distSquaredToPoint(target);
+            farEntry.m_dist2 = m_nodes[farEntry.m_heapIndex].distSquaredToPoint(target);
+            if (farEntry.m_dist2 < nearEntry.m_dist2) swap(nearEntry, farEntry);
+            CaretAssert(stackSize + 2 <= MAX_STACK);
+            myStack[stackSize++] = farEntry;
+            myStack[stackSize++] = nearEntry;
+        }
+    }
+    return false;
+}
+
+void CaretPointLocator::kNearest(const float target[3], const int& k, vector<LocatorInfo>& resultsOut) const
+{
+    resultsOut.clear();
+    if (m_nodes.empty() || k < 1) return;
+    vector<pair<float, int64_t> > myHeap;//max heap on distance, so the worst of the current k is on top
+    myHeap.reserve(k + 1);
+    StackEntry myStack[MAX_STACK];
+    int stackSize = 1;
+    myStack[0].m_heapIndex = 0;
+    myStack[0].m_level = 0;
+    myStack[0].m_dist2 = m_nodes[0].distSquaredToPoint(target);
+    while (stackSize > 0)
+    {
+        const StackEntry cur = myStack[--stackSize];
+        if ((int)myHeap.size() == k && cur.m_dist2 >= myHeap[0].first) continue;
+        if (cur.m_level == m_depth)
         {
-            for (int ij = 0; ij < 2; ++ij)
+            int64_t start, end;
+            getNodeRange(cur.m_heapIndex, cur.m_level, start, end);
+            for (int64_t i = start; i < end; ++i)
             {
-                for (int ik = 0; ik < 2; ++ik)
+                float tempf = distSquared(m_coords.data() + i * 3, target);
+                if ((int)myHeap.size() < k)
                 {
-                    removeSetHelper(thisOct->m_children[ii][ij][ik], thisSet);
+                    myHeap.push_back(make_pair(tempf, i));
+                    push_heap(myHeap.begin(), myHeap.end());
+                } else if (tempf < myHeap[0].first) {
+                    pop_heap(myHeap.begin(), myHeap.end());
+                    myHeap.back() = make_pair(tempf, i);
+                    push_heap(myHeap.begin(), myHeap.end());
                 }
             }
+        } else {
+            StackEntry nearEntry, farEntry;
+            nearEntry.m_heapIndex = 2 * cur.m_heapIndex + 1;
+            farEntry.m_heapIndex = nearEntry.m_heapIndex + 1;
+            nearEntry.m_level = farEntry.m_level = cur.m_level + 1;
+            nearEntry.m_dist2 = m_nodes[nearEntry.m_heapIndex].distSquaredToPoint(target);
+            farEntry.m_dist2 = m_nodes[farEntry.m_heapIndex].distSquaredToPoint(target);
+            if (farEntry.m_dist2 < nearEntry.m_dist2) swap(nearEntry, farEntry);
+            CaretAssert(stackSize + 2 <= MAX_STACK);
+            myStack[stackSize++] = farEntry;
+            myStack[stackSize++] = nearEntry;
         }
     }
+    sort_heap(myHeap.begin(), myHeap.end());//ascending
+    resultsOut.reserve(myHeap.size());
+    for (size_t i = 0; i < myHeap.size(); ++i)
+    {
+        int64_t slot = myHeap[i].second;
+        resultsOut.push_back(LocatorInfo(m_indices[slot], m_sets[slot], m_coords.data() + slot * 3));
+    }
 }
@@ -23,7 +23,6 @@
 /*LICENSE_END*/
 
 #include "CaretMutex.h"
-#include "OctTree.h"
 #include "Vector3D.h"
 
 #include <set>
@@ -49,35 +48,43 @@ namespace caret {
         }
     };
     
+    ///k-d tree with implicit layout: node h has children 2h + 1 and 2h + 2, and each node's points are a contiguous range of the point arrays
     class CaretPointLocator
     {
         struct Point
-        {
-            Vector3D m_point;
+        {//only used during construction
+            float m_point[3];
             int64_t m_index;
             int32_t m_mySet;
-            Point(const float point[3], const int64_t index, const int32_t mySet)
-            {
-                m_point = point;
-                m_index = index;
-                m_mySet = mySet;
-            }
+        };
+        struct KdNode
+        {//bounding box of the points in the node, tighter than the split planes
+            float m_min[3], m_max[3];
+            float distSquaredToPoint(const float point[3]) const;
         };
         CaretMutex m_modifyMutex;//thread safety, don't let multiple threads modify the point sets at once
-        Oct<LeafVector<Point> >* m_tree;
+        std::vector<KdNode> m_nodes;
+        std::vector<float> m_coords;//points in tree order, so leaves are contiguous
+        std::vector<int64_t> m_indices;
+        std::vector<int32_t> m_sets;
+        int m_depth;//nodes at this depth are leaves
         int32_t m_nextSetIndex;
         std::vector<int32_t> m_unusedIndexes;
-        void addPoint(Oct<LeafVector<Point> >* thisOct, const float point[3], const int64_t index, const int32_t pointSet);
+        static const int LEAF_SIZE = 16;//leaves hold between LEAF_SIZE / 2 and LEAF_SIZE points
         int32_t newIndex();
-        static const int NUM_POINTS_SPLIT = 100;
-        void removeSetHelper(Oct<LeafVector<Point> >* thisOct, const int32_t thisSet);
+        void rebuildTree();
+        void getNodeRange(const int64_t heapIndex, const int level, int64_t& startOut, int64_t& endOut) const;
+        void computeNodeBounds(const int64_t heapIndex, const int64_t start, const int64_t end);
+        int64_t closestSlot(const float target[3], const float maxDist2, const int64_t hintSlot) const;
+        void fillInfo(const int64_t slot, LocatorInfo* infoOut) const;
         CaretPointLocator();
     public:
-        ///make an empty point locator with given bounding box (bounding box can expand later, but may be less efficient
+        ///make an empty point locator, the bounds are not needed by the k-d tree and are accepted for compatibility
         CaretPointLocator(const float minBounds[3], const float maxBounds[3]);
         ///make a point locator with the bounding box of this point set, and use this point set as set #0
         CaretPointLocator(const float* coordsIn, const int64_t numCoords);
         ///add a point set, SAVE THE RETURN VALUE because it is how you identify which point set found points belong to
+        ///the tree is rebuilt, so add all point sets before querying if possible
         int32_t addPointSet(const float* coordsIn, const int64_t numCoords);
         ///remove a point set by its set number
         void removePointSet(const int32_t whichSet);
@@ -85,7 +92,15 @@ namespace caret {
         int64_t closestPoint(const float target[3], LocatorInfo* infoOut = NULL) const;
         int64_t closestPointLimited(const float target[3], const float& maxDist, LocatorInfo* infoOut = NULL) const;
         std::set<LocatorInfo> pointsInRange(const float target[3], const float& maxDist) const;
+        ///same as above, but without allocating per point found, results are in no particular order
+        void pointsInRange(const float target[3], const float& maxDist, std::vector<LocatorInfo>& resultsOut) const;
         bool anyInRange(const float target[3], const float& maxDist) const;
+        ///the k closest points, sorted by increasing distance, fewer if there aren't k points
+        void kNearest(const float target[3], const int& k, std::vector<LocatorInfo>& resultsOut) const;
+        ///closest point for each of many targets, in parallel, setsOut is optional
+        void closestPoints(const float* targets, const int64_t numTargets, std::vector<int64_t>& indicesOut, std::vector<int32_t>* setsOut = NULL) const;
+        ///-1 for targets with no point within maxDist
+        void closestPointsLimited(const float* targets, const int64_t numTargets, const float& maxDist, std::vector<int64_t>& indicesOut, std::vector<int32_t>* setsOut = NULL) const;
     };
 }
 
@@ -0,0 +1,167 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretProfiler.h"
+
+#include "CaretMutex.h"
+#include "DataFileException.h"
+
+#include <QFile>
+#include <QTextStream>
+
+#include <map>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+bool CaretProfiler::s_enabled = false;
+
+namespace
+{
+    struct PhaseInfo
+    {
+        AString m_name;
+        int64_t m_calls, m_bytes;
+        double m_wallSeconds, m_cpuSeconds;
+        PhaseInfo() { m_calls = 0; m_bytes = 0; m_wallSeconds = 0.0; m_cpuSeconds = 0.0; }
+    };
+    
+    CaretMutex g_phaseMutex;
+    vector<PhaseInfo> g_phases;//in order of first use
+    map<AString, size_t> g_phaseIndex;
+    
+    AString jsonEscape(const AString& in)
+    {
+        AString ret;
+        for (int i = 0; i < in.size(); ++i)
+        {
+            const QChar c = in[i];
+            if (c == '"' || c == '\\')
+            {
+                ret += '\\';
+                ret += c;
+            } else if (c == '\n') {
+                ret += "\\n";
+            } else if (c.unicode() < 32) {
+                ret += "\\u" + AString::number(c.unicode(), 16).rightJustified(4, '0');
+            } else {
+                ret += c;
+            }
+        }
+        return ret;
+    }
+}
+
+void CaretProfiler::setEnabled(const bool& enabled)
+{
+    s_enabled = enabled;
+}
+
+void CaretProfiler::addSample(const char* phase, const double& wallSeconds, const double& cpuSeconds, const int64_t& bytes)
+{
+    CaretMutexLocker locked(&g_phaseMutex);
+    AString name(phase);
+    map<AString, size_t>::iterator iter = g_phaseIndex.find(name);
+    size_t index;
+    if (iter == g_phaseIndex.end())
+    {
+        index = g_phases.size();
+        g_phaseIndex[name] = index;
+        g_phases.push_back(PhaseInfo());
+        g_phases.back().m_name = name;
+    } else {
+        index = iter->second;
+    }
+    PhaseInfo& myInfo = g_phases[index];
+    ++myInfo.m_calls;
+    myInfo.m_wallSeconds += wallSeconds;
+    myInfo.m_cpuSeconds += cpuSeconds;
+    myInfo.m_bytes += bytes;
+}
+
+AString CaretProfiler::getReportText(const double& totalWallSeconds)
+{
+    CaretMutexLocker locked(&g_phaseMutex);
+    AString ret = "phase                      calls      wall (s)       cpu (s)         bytes\n";
+    for (size_t i = 0; i < g_phases.size(); ++i)
+    {
+        const PhaseInfo& myInfo = g_phases[i];
+        ret += myInfo.m_name.leftJustified(22) + AString::number(myInfo.m_calls).rightJustified(10) +
+               AString::number(myInfo.m_wallSeconds, 'f', 3).rightJustified(14) + AString::number(myInfo.m_cpuSeconds, 'f', 3).rightJustified(14) +
+               AString::number(myInfo.m_bytes).rightJustified(14) + "\n";
+    }
+    ret += AString("total").leftJustified(22) + AString("").rightJustified(10) + AString::number(totalWallSeconds, 'f', 3).rightJustified(14) + "\n";
+    return ret;
+}
+
+void CaretProfiler::writeReportJson(const AString& fileName, const AString& commandLine, const double& totalWallSeconds, const int& numThreads)
+{
+    QFile myFile(fileName);
+    if (!myFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        throw DataFileException(fileName, "unable to open file for writing: " + myFile.errorString());
+    }
+    QTextStream myStream(&myFile);
+    CaretMutexLocker locked(&g_phaseMutex);
+    myStream << "{\n";
+    myStream << "    \"command\": \"" << jsonEscape(commandLine) << "\",\n";
+    myStream << "    \"threads\": " << numThreads << ",\n";
+    myStream << "    \"wall_seconds\": " << AString::number(totalWallSeconds, 'f', 6) << ",\n";
+    myStream << "    \"phases\": [";
+    for (size_t i = 0; i < g_phases.size(); ++i)
+    {
+        const PhaseInfo& myInfo = g_phases[i];
+        if (i != 0) myStream << ",";
+        myStream << "\n        { \"name\": \"" << jsonEscape(myInfo.m_name) << "\", \"calls\": " << myInfo.m_calls
+                 << ", \"wall_seconds\": " << AString::number(myInfo.m_wallSeconds, 'f', 6)
+                 << ", \"cpu_seconds\": " << AString::number(myInfo.m_cpuSeconds, 'f', 6)
+                 << ", \"bytes\": " << myInfo.m_bytes << " }";
+    }
+    myStream << "\n    ]\n}\n";
+    myStream.flush();
+    if (myFile.error() != QFile::NoError)
+    {
+        throw DataFileException(fileName, "error writing file: " + myFile.errorString());
+    }
+}
+
+CaretProfileScope::CaretProfileScope(const char* phase)
+{
+    m_phase = phase;
+    m_bytes = 0;
+    m_active = CaretProfiler::isEnabled();
+    if (m_active)
+    {
+        m_cpuStart = std::clock();
+        m_timer.start();
+    }
+}
+
+CaretProfileScope::~CaretProfileScope()
+{
+    if (m_active)
+    {
+        double wall = m_timer.nsecsElapsed() / 1e9;
+        double cpu = double(std::clock() - m_cpuStart) / CLOCKS_PER_SEC;//process cpu time, so it includes other threads that are running at the same time
+        CaretProfiler::addSample(m_phase, wall, cpu, m_bytes);
+    }
+}
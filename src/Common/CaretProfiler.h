@@ -0,0 +1,70 @@
+#ifndef __CARET_PROFILER_H__
+#define __CARET_PROFILER_H__
+
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+
+#include <QElapsedTimer>
+
+#include <ctime>
+#include <stdint.h>
+
+namespace caret {
+    
+    ///accumulates wall time, cpu time and bytes for named phases of a command, when enabled by the -timing or -profile global options
+    ///phases can nest (for instance, on-disk cifti rows are read during "compute"), so times are inclusive
+    class CaretProfiler
+    {
+        static bool s_enabled;
+        CaretProfiler();
+    public:
+        static void setEnabled(const bool& enabled);
+        static bool isEnabled() { return s_enabled; }
+        static void addSample(const char* phase, const double& wallSeconds, const double& cpuSeconds, const int64_t& bytes);
+        
+        ///human-readable table of all phases, in order of first use
+        static AString getReportText(const double& totalWallSeconds);
+        
+        static void writeReportJson(const AString& fileName, const AString& commandLine, const double& totalWallSeconds, const int& numThreads);
+    };
+    
+    ///records the time between construction and destruction as one call to the phase, does almost nothing when profiling is disabled
+    class CaretProfileScope
+    {
+        const char* m_phase;
+        bool m_active;
+        int64_t m_bytes;
+        QElapsedTimer m_timer;
+        std::clock_t m_cpuStart;
+        CaretProfileScope(const CaretProfileScope&);
+        CaretProfileScope& operator=(const CaretProfileScope&);
+    public:
+        ///phase must be a string literal, or otherwise outlive the scope
+        CaretProfileScope(const char* phase);
+        ~CaretProfileScope();
+        void addBytes(const int64_t& bytes) { m_bytes += bytes; }
+    };
+    
+}
+
+#endif //__CARET_PROFILER_H__
@@ -20,6 +20,8 @@
 /*LICENSE_END*/
 
 #include "FastStatistics.h"
+#include "CaretAssert.h"
+#include "CaretOMP.h"
 #include "CaretPointer.h"
 
 #include <algorithm>
@@ -29,7 +31,88 @@
 using namespace caret;
 using namespace std;
 
-const int64_t NUM_BUCKETS_PERCENTILE_HIST = 10000;//10,000 maximum to deal with some outliers outliers until I think of a better fix
+namespace
+{
+    const int64_t NUM_QUANTILE_STEPS = 10000;//exact values every 0.01%, which covers the precision of the palette percentage settings
+    const int64_t MAX_SORT_BUCKETS = 10000;
+    
+    ///sort by scattering into equal-width buckets and then sorting each bucket, expected linear time unless the values are extremely clustered
+    void bucketSort(float* data, const int64_t& count)
+    {
+        if (count < 2) return;
+        float minVal = data[0], maxVal = data[0];
+        for (int64_t i = 1; i < count; ++i)
+        {
+            if (data[i] < minVal) minVal = data[i];
+            if (data[i] > maxVal) maxVal = data[i];
+        }
+        if (minVal == maxVal) return;
+        const int64_t numBuckets = min(MAX_SORT_BUCKETS, count);
+        const double scale = numBuckets / ((double)maxVal - minVal);//double, so that tiny or huge ranges don't overflow
+        vector<int64_t> bucketStarts(numBuckets + 1, 0);
+        vector<int32_t> whichBucket(count);
+        for (int64_t i = 0; i < count; ++i)
+        {
+            int64_t bucket = (int64_t)(((double)data[i] - minVal) * scale);
+            if (bucket >= numBuckets) bucket = numBuckets - 1;
+            whichBucket[i] = (int32_t)bucket;
+            ++bucketStarts[bucket + 1];
+        }
+        for (int64_t b = 0; b < numBuckets; ++b)
+        {
+            bucketStarts[b + 1] += bucketStarts[b];
+        }
+        vector<int64_t> nextSlot(bucketStarts.begin(), bucketStarts.end() - 1);
+        vector<float> scattered(count);
+        for (int64_t i = 0; i < count; ++i)
+        {
+            scattered[nextSlot[whichBucket[i]]++] = data[i];
+        }
+#pragma omp CARET_PARFOR schedule(dynamic, 64) if (count >= 100000)
+        for (int64_t b = 0; b < numBuckets; ++b)
+        {
+            sort(scattered.begin() + bucketStarts[b], scattered.begin() + bucketStarts[b + 1]);
+        }
+        for (int64_t i = 0; i < count; ++i)
+        {
+            data[i] = scattered[i];
+        }
+    }
+    
+    ///same interpolation between ranks as numpy's default percentile
+    float sortedPercentile(const float* sorted, const int64_t& count, const double& fraction)
+    {
+        CaretAssert(count > 0);
+        double index = fraction * (count - 1);
+        int64_t lowIndex = (int64_t)floor(index);
+        if (lowIndex < 0) return sorted[0];
+        if (lowIndex >= count - 1) return sorted[count - 1];
+        double frac = index - lowIndex;
+        return sorted[lowIndex] + frac * (sorted[lowIndex + 1] - sorted[lowIndex]);
+    }
+    
+    void fillQuantiles(const float* sorted, const int64_t& count, vector<float>& quantilesOut)
+    {
+        if (count <= 0)
+        {
+            quantilesOut.clear();
+            return;
+        }
+        quantilesOut.resize(NUM_QUANTILE_STEPS + 1);
+        for (int64_t i = 0; i <= NUM_QUANTILE_STEPS; ++i)
+        {
+            quantilesOut[i] = sortedPercentile(sorted, count, (double)i / NUM_QUANTILE_STEPS);
+        }
+    }
+    
+    ///value at a rank among all numeric values, given sorted positives, sorted negative magnitudes, and the count of zeros
+    float combinedSortedValue(const int64_t& index, const float* positives, const float* negMagnitudes, const int64_t& negCount, const int64_t& zeroCount)
+    {
+        if (index < negCount) return -negMagnitudes[negCount - 1 - index];
+        if (index < negCount + zeroCount) return 0.0f;
+        return positives[index - negCount - zeroCount];
+    }
+}
 
 FastStatistics::FastStatistics()
 {
@@ -51,6 +134,7 @@ void FastStatistics::reset()
     m_nanCount = 0;
     m_absCount = 0;
     m_mean = 0.0f;
+    m_median = 0.0f;
     m_stdDevPop = 0.0f;
     m_stdDevSample = 0.0f;
     m_mostNeg = 0.0f;
@@ -61,12 +145,15 @@ void FastStatistics::reset()
     m_mostAbs = 0.0;
     m_min = 0.0f;
     m_max = 0.0f;
+    m_posQuantiles.clear();
+    m_negQuantiles.clear();
+    m_absQuantiles.clear();
 }
 
 void FastStatistics::update(const float* data, const int64_t& dataCount)
 {
     reset();
-    CaretArray<float> positives(dataCount), negatives(dataCount), absolutes(dataCount);
+    CaretArray<float> positives(dataCount), negatives(dataCount);
     double sum = 0.0;//for numerical stability
     bool first = true;//so min can be positive and max can be negative
     for (int64_t i = 0; i < dataCount; ++i)
@@ -91,11 +178,6 @@ void FastStatistics::update(const float* data, const int64_t& dataCount)
                     ++m_negCount;
                     if (data[i] > m_leastNeg) m_leastNeg = data[i];
                     if (data[i] < m_mostNeg) m_mostNeg = data[i];
-                    
-                    absolutes[m_absCount] = -data[i];
-                    if (absolutes[m_absCount] > m_mostAbs)  m_mostAbs  = absolutes[m_absCount];
-                    if (absolutes[m_absCount] < m_leastAbs) m_leastAbs = absolutes[m_absCount];
-                    ++m_absCount;
                 }
             } else {
                 if (data[i] * 2.0f == data[i])
@@ -107,11 +189,6 @@ void FastStatistics::update(const float* data, const int64_t& dataCount)
                     ++m_posCount;
                     if (data[i] > m_mostPos) m_mostPos = data[i];
                     if (data[i] < m_leastPos) m_leastPos = data[i];
-                    
-                    absolutes[m_absCount] = data[i];
-                    if (absolutes[m_absCount] > m_mostAbs)  m_mostAbs  = absolutes[m_absCount];
-                    if (absolutes[m_absCount] < m_leastAbs) m_leastAbs = absolutes[m_absCount];
-                    ++m_absCount;
                 }
             }
         }
@@ -140,10 +217,8 @@ void FastStatistics::update(const float* data, const int64_t& dataCount)
             m_stdDevSample = sqrt(sum2 / (totalGood - 1));
         }
     }
-    int usebuckets = min(NUM_BUCKETS_PERCENTILE_HIST, dataCount);
-    m_negPercentHist.update(usebuckets, negatives, m_negCount);
-    m_posPercentHist.update(usebuckets, positives, m_posCount);
-    m_absPercentHist.update(usebuckets, absolutes, m_absCount);
+    m_absCount = m_negCount + m_posCount;
+    computeQuantiles(positives, negatives);
     
     if (m_negCount <= 0)
     {
@@ -165,7 +240,7 @@ void FastStatistics::update(const float* data, const int64_t& dataCount)
 void FastStatistics::update(const float* data, const int64_t& dataCount, const float& minThreshInclusive, const float& maxThreshInclusive)
 {
     reset();
-    CaretArray<float> positives(dataCount), negatives(dataCount), absolutes(dataCount);
+    CaretArray<float> positives(dataCount), negatives(dataCount);
     double sum = 0.0;//for numerical stability
     bool first = true;//so min can be positive and max can be negative
     for (int64_t i = 0; i < dataCount; ++i)
@@ -199,17 +274,11 @@ void FastStatistics::update(const float* data, const int64_t& dataCount, const f
                 ++m_negCount;
                 if (data[i] > m_leastNeg) m_leastNeg = data[i];
                 if (data[i] < m_mostNeg) m_mostNeg = data[i];
-                
-                absolutes[m_absCount] = -data[i];
-                ++m_absCount;
             } else {
                 positives[m_posCount] = data[i];
                 ++m_posCount;
                 if (data[i] > m_mostPos) m_mostPos = data[i];
                 if (data[i] < m_leastPos) m_leastPos = data[i];
-                
-                absolutes[m_absCount] = data[i];
-                ++m_absCount;
             }
         }
         if (data[i] > m_max || first) m_max = data[i];
@@ -237,10 +306,8 @@ void FastStatistics::update(const float* data, const int64_t& dataCount, const f
             m_stdDevSample = sqrt(sum2 / (totalGood - 1));
         }
     }
-    int usebuckets = min(NUM_BUCKETS_PERCENTILE_HIST, dataCount);
-    m_negPercentHist.update(usebuckets, negatives, m_negCount);//10,000 will probably allow us to approximate the percentiles pretty closely, and eats only 80K of memory each
-    m_posPercentHist.update(usebuckets, positives, m_posCount);
-    m_absPercentHist.update(usebuckets, absolutes, m_absCount);
+    m_absCount = m_negCount + m_posCount;
+    computeQuantiles(positives, negatives);
     
     if (m_negCount <= 0)
     {
@@ -259,263 +326,86 @@ void FastStatistics::update(const float* data, const int64_t& dataCount, const f
     }
 }
 
-float FastStatistics::getApproxNegativePercentile(const float& percent) const
+void FastStatistics::computeQuantiles(float* positives, float* negatives)
 {
-    float rank = percent / 100.0f * m_negCount;//translate to rank
-    rank = m_negCount - rank;//reverse it because negatives go the other direction, histogram is strictly directional towards positive
-    if (rank <= 0) return m_mostNeg;
-    if (rank >= m_negCount) return m_leastNeg;
-    float histMin, histMax;
-    m_negPercentHist.getRange(histMin, histMax);
-    const vector<int64_t>& cumulative = m_negPercentHist.getHistogramCumulativeCounts();
-    int numBuckets = (int)cumulative.size();
-    int lowBound = -1, highBound = numBuckets, guess;//bisection search, "index" -1 is implicitly valued zero
-    while (highBound - lowBound > 1)
+    for (int64_t i = 0; i < m_negCount; ++i)
     {
-        guess = (lowBound + highBound) / 2;
-        if (cumulative[guess] <= rank)
-        {
-            lowBound = guess;
-        } else {
-            highBound = guess;
-        }
+        negatives[i] = -negatives[i];//sort by magnitude, so all tables go from least to most extreme
     }
-    if (highBound == numBuckets) return m_mostPos;//the count mismatched the histogram somehow
-    float bucketsize = (histMax - histMin) / numBuckets;
-    int64_t curLower, curUpper = cumulative[highBound];
-    if (lowBound > -1)
+    bucketSort(positives, m_posCount);
+    bucketSort(negatives, m_negCount);
+    vector<float> absolutes(m_absCount);
+    merge(positives, positives + m_posCount, negatives, negatives + m_negCount, absolutes.begin());
+    fillQuantiles(positives, m_posCount, m_posQuantiles);
+    fillQuantiles(negatives, m_negCount, m_negQuantiles);
+    for (int64_t i = 0; i < (int64_t)m_negQuantiles.size(); ++i)
     {
-        curLower = cumulative[lowBound];
-    } else {
-        curLower = 0;
+        m_negQuantiles[i] = -m_negQuantiles[i];
     }
-    if (highBound > 0 && ((highBound == 1 && cumulative[0] == 0) || (highBound > 1 && cumulative[highBound - 1] == cumulative[highBound - 2])))
-    {//tweak the function a bit if there is a bin that collected zero to the immediate left, to reduce discontinuities
-        if (rank - curLower >= 1.0f)
-        {
-            ++curLower;//tweak the low end to start from one higher, to make it continuous with the tweak below
-        } else {
-            --highBound;//move left, because this interpolated rank doesn't fall within the highBound bucket
-            --lowBound;
-            curUpper = curLower + 1;//add one to the right end of the flat spot to give it nonzero slope
-            while (lowBound > 0 && cumulative[highBound] == cumulative[lowBound - 1])
-            {
-                --lowBound;//slide left boundary over the flat spot
-            }
-            if (lowBound == 0 && cumulative[lowBound] == 0)
-            {
-                --lowBound;//including if first bucket is zero, this shouldn't happen unless all valid values are equal (and a low count of values)
-            }
-            if (lowBound > -1)
-            {
-                curLower = cumulative[lowBound];
-            } else {
-                curLower = 0;
-            }
-        }
+    fillQuantiles(absolutes.data(), m_absCount, m_absQuantiles);
+    if (m_absCount > 0)
+    {
+        m_leastAbs = absolutes[0];
+        m_mostAbs = absolutes[m_absCount - 1];
+    }
+    int64_t totalGood = m_negCount + m_zeroCount + m_posCount;
+    if (totalGood > 0)
+    {//middle value, or average of the middle two
+        m_median = (combinedSortedValue((totalGood - 1) / 2, positives, negatives, m_negCount, m_zeroCount) +
+                    combinedSortedValue(totalGood / 2, positives, negatives, m_negCount, m_zeroCount)) / 2.0f;
     }
-    float lowValue = histMin + (lowBound + 1) * bucketsize, highValue = histMin + (highBound + 1) * bucketsize;
-    return lowValue + (highValue - lowValue) * (rank - curLower) / (curUpper - curLower);
 }
 
-float FastStatistics::getApproxPositivePercentile(const float& percent) const
+float FastStatistics::getQuantileHelper(const vector<float>& quantiles, const float& percent)
 {
-    float rank = percent / 100.0f * m_posCount;//translate to rank
-    if (rank <= 0.0f) return m_leastPos;
-    if (rank >= m_posCount) return m_mostPos;
-    float histMin, histMax;
-    m_posPercentHist.getRange(histMin, histMax);
-    const vector<int64_t>& cumulative = m_posPercentHist.getHistogramCumulativeCounts();
-    int numBuckets = (int)cumulative.size();
-    int lowBound = -1, highBound = numBuckets, guess;//bisection search, "index" -1 is implicitly valued zero
-    while (highBound - lowBound > 1)
-    {
-        guess = (lowBound + highBound) / 2;
-        if (cumulative[guess] <= rank)
-        {
-            lowBound = guess;
-        } else {
-            highBound = guess;
-        }
-    }
-    if (highBound == numBuckets) return m_mostPos;//the count mismatched the histogram somehow
-    float bucketsize = (histMax - histMin) / numBuckets;
-    int64_t curLower, curUpper = cumulative[highBound];
-    if (lowBound > -1)
-    {
-        curLower = cumulative[lowBound];
-    } else {
-        curLower = 0;
-    }
-    if (highBound > 0 && ((highBound == 1 && cumulative[0] == 0) || (highBound > 1 && cumulative[highBound - 1] == cumulative[highBound - 2])))
-    {//tweak the function a bit if there is a bin that collected zero to the immediate left, to reduce discontinuities
-        if (rank - curLower >= 1.0f)
-        {
-            ++curLower;//tweak the low end to start from one higher, to make it continuous with the tweak below
-        } else {
-            --highBound;//move left, because this interpolated rank doesn't fall within the highBound bucket
-            --lowBound;
-            curUpper = curLower + 1;//add one to the right end of the flat spot to give it nonzero slope
-            while (lowBound > 0 && cumulative[highBound] == cumulative[lowBound - 1])
-            {
-                --lowBound;//slide left boundary over the flat spot
-            }
-            if (lowBound == 0 && cumulative[lowBound] == 0)
-            {
-                --lowBound;//including if first bucket is zero, this shouldn't happen unless all valid values are equal (and a low count of values)
-            }
-            if (lowBound > -1)
-            {
-                curLower = cumulative[lowBound];
-            } else {
-                curLower = 0;
-            }
-        }
-    }
-    float lowValue = histMin + (lowBound + 1) * bucketsize, highValue = histMin + (highBound + 1) * bucketsize;
-    return lowValue + (highValue - lowValue) * (rank - curLower) / (curUpper - curLower);
+    if (quantiles.empty()) return 0.0f;
+    return sortedPercentile(quantiles.data(), (int64_t)quantiles.size(), percent / 100.0);
 }
 
-float FastStatistics::getApproxAbsolutePercentile(const float& percent) const
+float FastStatistics::getNegativePercentile(const float& percent) const
 {
-    float rank = percent / 100.0f * m_absCount;//translate to rank
-    if (rank <= 0.0f) return m_leastAbs;
-    if (rank >= m_absCount) return m_mostAbs;
-    float histMin, histMax;
-    m_absPercentHist.getRange(histMin, histMax);
-    const vector<int64_t>& cumulative = m_absPercentHist.getHistogramCumulativeCounts();
-    int numBuckets = (int)cumulative.size();
-    int lowBound = -1, highBound = numBuckets, guess;//bisection search, "index" -1 is implicitly valued zero
-    while (highBound - lowBound > 1)
-    {
-        guess = (lowBound + highBound) / 2;
-        if (cumulative[guess] <= rank)
-        {
-            lowBound = guess;
-        } else {
-            highBound = guess;
-        }
-    }
-    if (highBound == numBuckets) return m_mostAbs;//the count mismatched the histogram somehow
-    float bucketsize = (histMax - histMin) / numBuckets;
-    int64_t curLower, curUpper = cumulative[highBound];
-    if (lowBound > -1)
-    {
-        curLower = cumulative[lowBound];
-    } else {
-        curLower = 0;
-    }
-    if (highBound > 0 && ((highBound == 1 && cumulative[0] == 0) || (highBound > 1 && cumulative[highBound - 1] == cumulative[highBound - 2])))
-    {//tweak the function a bit if there is a bin that collected zero to the immediate left, to reduce discontinuities
-        if (rank - curLower >= 1.0f)
-        {
-            ++curLower;//tweak the low end to start from one higher, to make it continuous with the tweak below
-        } else {
-            --highBound;//move left, because this interpolated rank doesn't fall within the highBound bucket
-            --lowBound;
-            curUpper = curLower + 1;//add one to the right end of the flat spot to give it nonzero slope
-            while (lowBound > 0 && cumulative[highBound] == cumulative[lowBound - 1])
-            {
-                --lowBound;//slide left boundary over the flat spot
-            }
-            if (lowBound == 0 && cumulative[lowBound] == 0)
-            {
-                --lowBound;//including if first bucket is zero, this shouldn't happen unless all valid values are equal (and a low count of values)
-            }
-            if (lowBound > -1)
-            {
-                curLower = cumulative[lowBound];
-            } else {
-                curLower = 0;
-            }
-        }
-    }
-    float lowValue = histMin + (lowBound + 1) * bucketsize, highValue = histMin + (highBound + 1) * bucketsize;
-    return lowValue + (highValue - lowValue) * (rank - curLower) / (curUpper - curLower);
+    return getQuantileHelper(m_negQuantiles, percent);
 }
 
-float FastStatistics::getApproximateMedian() const
+float FastStatistics::getPositivePercentile(const float& percent) const
 {
-    int64_t totalGood = m_negCount + m_zeroCount + m_posCount;
-    if (m_negCount > m_posCount)
-    {
-        if (m_zeroCount > (m_negCount - m_posCount))
-        {
-            return 0.0f;
-        } else {
-            return getApproxNegativePercentile((m_negCount - m_posCount - m_zeroCount) * 50.0f / totalGood);
-        }
-    } else {
-        if (m_zeroCount > (m_posCount - m_negCount))
-        {
-            return 0.0f;
-        } else {
-            return getApproxNegativePercentile((m_posCount - m_negCount - m_zeroCount) * 50.0f / totalGood);
-        }
-    }
+    return getQuantileHelper(m_posQuantiles, percent);
+}
+
+float FastStatistics::getAbsolutePercentile(const float& percent) const
+{
+    return getQuantileHelper(m_absQuantiles, percent);
 }
 
 float
-FastStatistics::getValuePercentileHelper(const Histogram& histogram, const float numberOfDataValues, const bool negativeDataFlag, const float value)
+FastStatistics::getValuePercentileHelper(const vector<float>& quantiles, const bool negativeDataFlag, const float value)
 {
-    float percentile = 0.0;
-    
-    const std::vector<int64_t>& cumulativeBuckets = histogram.getHistogramCumulativeCounts();
-    if ((numberOfDataValues > 0)
-        && (! cumulativeBuckets.empty())) {
-        float minValue = 0.0;
-        float maxValue = 0.0;
-        histogram.getRange(minValue,
-                                  maxValue);
-        if (value < minValue) {
-            if (negativeDataFlag) {
-                percentile = 100.0;
-            }
-            else {
-                percentile = 0.0;
-            }
-        }
-        else if (value > maxValue) {
-            if (negativeDataFlag) {
-                percentile = 0;
-            }
-            else {
-                percentile = 100.0;
-            }
-        }
-        else {
-            const float histoRange = maxValue - minValue;
-            if (histoRange > 0.0) {
-                const int64_t numBuckets = cumulativeBuckets.size();
-                int64_t bucketIndex = static_cast<int>(((value - minValue) / histoRange) * numBuckets);
-                if (bucketIndex < 0) {
-                    bucketIndex = 0;
-                }
-                else if (bucketIndex >= numBuckets) {
-                    bucketIndex = numBuckets - 1;
-                }
-                
-                CaretAssertVectorIndex(cumulativeBuckets,
-                                       bucketIndex);
-                float cumulativeValue = cumulativeBuckets[bucketIndex];
-                
-                if (negativeDataFlag) {
-                    CaretAssertVectorIndex(cumulativeBuckets, numBuckets - 1);
-                    cumulativeValue = cumulativeBuckets[numBuckets - 1] - cumulativeBuckets[bucketIndex];
-                }
-                
-                percentile = (cumulativeValue / numberOfDataValues) * 100.0;
-            }
+    if (quantiles.empty()) return 0.0f;
+    const float sign = (negativeDataFlag ? -1.0f : 1.0f);//negative tables go towards more negative, flip them to ascending
+    const float searchValue = sign * value;
+    const int64_t numQuantiles = (int64_t)quantiles.size();
+    if (searchValue <= sign * quantiles[0]) return 0.0f;
+    if (searchValue >= sign * quantiles[numQuantiles - 1]) return 100.0f;
+    int64_t lowBound = 0, highBound = numQuantiles - 1;//bisection search, low is always <= value, high always > value
+    while (highBound - lowBound > 1)
+    {
+        int64_t guess = (lowBound + highBound) / 2;
+        if (sign * quantiles[guess] <= searchValue)
+        {
+            lowBound = guess;
+        } else {
+            highBound = guess;
         }
     }
-    
-    return percentile;
+    const float lowValue = sign * quantiles[lowBound], highValue = sign * quantiles[highBound];
+    float position = lowBound + (searchValue - lowValue) / (highValue - lowValue);
+    return position * 100.0f / (numQuantiles - 1);
 }
 
 float
 FastStatistics::getNegativeValuePercentile(const float value) const
 {
-    return getValuePercentileHelper(m_negPercentHist, m_negCount, true, value);
+    return getValuePercentileHelper(m_negQuantiles, true, value);
 }
 
 float
@@ -525,49 +415,11 @@ FastStatistics::getAbsoluteValuePercentile(const float value) const
     if (dataValue < 0.0) {
         dataValue = -dataValue;
     }
-    return getValuePercentileHelper(m_absPercentHist, m_absCount, false, dataValue);
+    return getValuePercentileHelper(m_absQuantiles, false, dataValue);
 }
 
 float
 FastStatistics::getPositiveValuePercentile(const float value) const
 {
-    return getValuePercentileHelper(m_posPercentHist, m_posCount, false, value);
-    
-//    float percentile = 0.0;
-//    
-//    const std::vector<int64_t>& cumulativeBuckets = m_posPercentHist.getHistogramCumulativeCounts();
-//    if ( ! cumulativeBuckets.empty()) {
-//        float minValue = 0.0;
-//        float maxValue = 0.0;
-//        m_posPercentHist.getRange(minValue,
-//                                  maxValue);
-//        if (value < minValue) {
-//            percentile = 0.0;
-//        }
-//        else if (value > maxValue) {
-//            percentile = 100.0;
-//        }
-//        else {
-//            const float histoRange = maxValue - minValue;
-//            if (histoRange > 0.0) {
-//                const int64_t numBuckets = cumulativeBuckets.size();
-//                int64_t bucketIndex = static_cast<int>(((value - minValue) / histoRange) * numBuckets);
-//                if (bucketIndex < 0) {
-//                    bucketIndex = 0;
-//                }
-//                else if (bucketIndex >= numBuckets) {
-//                    bucketIndex = numBuckets - 1;
-//                }
-//                
-//                CaretAssertVectorIndex(cumulativeBuckets,
-//                                       bucketIndex);
-//                const float cumulativeValue = cumulativeBuckets[bucketIndex];
-//                percentile = (cumulativeValue / m_posCount) * 100.0;
-//            }
-//        }
-//    }
-//    
-//    return percentile;
+    return getValuePercentileHelper(m_posQuantiles, false, value);
 }
-
-
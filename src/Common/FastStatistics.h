@@ -21,23 +21,31 @@
  */
 /*LICENSE_END*/
 
-#include "Histogram.h"
+#include "stdint.h"
+#include <vector>
 
 namespace caret
 {
     
-    ///this class does statistics that are linear in complexity only, NO SORTING, this means its percentiles are approximate, using interpolation from a histogram
+    ///this class does statistics that are linear in complexity where possible, percentiles are exact at every 0.01%, and linearly interpolated between those
+    ///percentiles use the same definition as numpy's default (linear interpolation between ranks), so the value at 98% matches other tools
     class FastStatistics
     {
-        Histogram m_posPercentHist, m_negPercentHist, m_absPercentHist;
-        float m_min, m_max, m_mean, m_stdDevPop, m_stdDevSample;
+        ///exact values at each 0.01% step, from least to most extreme (negatives are stored as negative values)
+        std::vector<float> m_posQuantiles, m_negQuantiles, m_absQuantiles;
+        float m_min, m_max, m_mean, m_median, m_stdDevPop, m_stdDevSample;
         float m_mostPos, m_leastPos, m_leastNeg, m_mostNeg, m_leastAbs, m_mostAbs;
         ///counts of each class of number
         int64_t m_posCount, m_zeroCount, m_negCount, m_infCount, m_negInfCount, m_nanCount, m_absCount;
         
         void reset();
         
-        static float getValuePercentileHelper(const Histogram& histogram, const float numberOfDataValues, const bool negativeDataFlag, const float value);
+        ///sorts the collected values and fills the quantile tables and median, negatives are modified to be magnitudes
+        void computeQuantiles(float* positives, float* negatives);
+        
+        static float getQuantileHelper(const std::vector<float>& quantiles, const float& percent);
+        
+        static float getValuePercentileHelper(const std::vector<float>& quantiles, const bool negativeDataFlag, const float value);
 
     public:
         FastStatistics();
@@ -49,11 +57,11 @@ namespace caret
         ///statistics and display are really not that related, so for now, only include a continuous clipping range, excluding the middle from data will do weird things to standard deviation
         void update(const float* data, const int64_t& dataCount, const float& minThreshInclusive, const float& maxThreshInclusive);
         
-        float getApproxPositivePercentile(const float& percent) const;
+        float getPositivePercentile(const float& percent) const;
         
-        float getApproxNegativePercentile(const float& percent) const;
+        float getNegativePercentile(const float& percent) const;
         
-        float getApproxAbsolutePercentile(const float& percent) const;
+        float getAbsolutePercentile(const float& percent) const;
         
         void getCounts(int64_t& posCount, int64_t& zeroCount, int64_t& negCount, int64_t& infCount, int64_t& negInfCount, int64_t& nanCount) const
         {
@@ -89,7 +97,7 @@ namespace caret
         
         float getMean() const { return m_mean; }
         
-        float getApproximateMedian() const;
+        float getMedian() const { return m_median; }
         
         float getSampleStdDev() const { return m_stdDevSample; }
         
@@ -131,12 +131,12 @@ float ReductionOperation::reduce(const float* data, const int64_t& numElems, con
         }
         case ReductionEnum::MEDIAN:
         {
-            vector<float> dataCopy(numElems);
-            for (int64_t i = 0; i < numElems; ++i) dataCopy[i] = data[i];
-            sort(dataCopy.begin(), dataCopy.end());
+            vector<float> dataCopy(data, data + numElems);
+            nth_element(dataCopy.begin(), dataCopy.begin() + numElems / 2, dataCopy.end());//selection is linear, no need to sort everything
             if ((numElems & 1) == 0)//if even, average middle two
             {
-                return (dataCopy[numElems / 2 - 1] + dataCopy[numElems / 2]) / 2.0f;
+                float lowMiddle = *max_element(dataCopy.begin(), dataCopy.begin() + numElems / 2);//after selection, everything to the left is <= the center
+                return (lowMiddle + dataCopy[numElems / 2]) / 2.0f;
             } else {
                 return dataCopy[numElems / 2];//otherwise, take the center
             }
@@ -186,6 +186,26 @@ float ReductionOperation::reduce(const float* data, const int64_t& numElems, con
     return 0.0f;
 }
 
+float ReductionOperation::percentile(const float* data, const int64_t& numElems, const float& percent)
+{
+    CaretAssert(numElems > 0);
+    CaretAssert(percent >= 0.0f && percent <= 100.0f);
+    vector<float> dataCopy(data, data + numElems);
+    double index = percent / 100.0 * (numElems - 1);//same interpolation between ranks as numpy's default
+    int64_t lowIndex = (int64_t)floor(index);
+    if (lowIndex < 0) lowIndex = 0;
+    if (lowIndex >= numElems - 1)
+    {
+        return *max_element(dataCopy.begin(), dataCopy.end());
+    }
+    nth_element(dataCopy.begin(), dataCopy.begin() + lowIndex, dataCopy.end());
+    float lowValue = dataCopy[lowIndex];
+    double frac = index - lowIndex;
+    if (frac <= 0.0) return lowValue;
+    float highValue = *min_element(dataCopy.begin() + lowIndex + 1, dataCopy.end());//after selection, everything to the right is >= lowValue
+    return lowValue + frac * (highValue - lowValue);
+}
+
 float ReductionOperation::reduceExcludeDev(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type, const float& numDevBelow, const float& numDevAbove)
 {
     CaretAssert(numElems > 0);
@@ -33,6 +33,8 @@ namespace caret {
         ///reduce, with exclusion based on number of standard deviations
         static float reduceExcludeDev(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type, const float& numDevBelow, const float& numDevAbove);
         static float reduceOnlyNumeric(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type);
+        ///exact percentile, interpolating between ranks the same way as numpy's default, uses selection instead of sorting
+        static float percentile(const float* data, const int64_t& numElems, const float& percent);
         ///weighted versions, do not accept all reduction types
         static float reduceWeighted(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type);
         static float reduceWeightedExcludeDev(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type, const float& numDevBelow, const float& numDevAbove);
@@ -24,6 +24,7 @@
 #include "ByteSwapping.h"
 #include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "FileInformation.h"
 
 #include <QByteArray>
@@ -160,29 +161,53 @@ void CaretSparseFile::getFibersRow(const int64_t& index, FiberFractions* rowOut)
 {
     if (m_scratchRow.size() != (size_t)m_dims[0]) m_scratchRow.resize(m_dims[0]);
     getRow(index, (int64_t*)m_scratchRow.data());
-    for (int64_t i = 0; i < m_dims[0]; ++i)
+    decodeFibersArray(m_scratchRow.data(), m_dims[0], rowOut);
+}
+
+void CaretSparseFile::getFibersRowSparse(const int64_t& index, vector<int64_t>& indicesOut, vector<FiberFractions>& valuesOut)
+{
+    getRowSparse(index, indicesOut, m_scratchSparseRow);
+    int64_t numNonzero = (int64_t)m_scratchSparseRow.size();
+    valuesOut.resize(numNonzero);
+    if (numNonzero == 0) return;
+    decodeFibersArray((uint64_t*)m_scratchSparseRow.data(), numNonzero, valuesOut.data());
+}
+
+void CaretSparseFile::decodeFibersArray(const uint64_t* coded, const int64_t& count, FiberFractions* decoded)
+{
+    const int64_t PARALLEL_MIN = 4096;//decoding is cheap, don't start threads for short rows
+    int64_t badIndex = -1;
+#pragma omp CARET_PARFOR schedule(static) if (count >= PARALLEL_MIN)
+    for (int64_t i = 0; i < count; ++i)
     {
-        if (m_scratchRow[i] == 0)
+        if (coded[i] == 0)
         {
-            rowOut[i].zero();
+            decoded[i].zero();
         } else {
-             decodeFibers(m_scratchRow[i], rowOut[i]);
+            if (!tryDecodeFibers(coded[i], decoded[i]))
+            {
+#pragma omp critical
+                {
+                    if (badIndex == -1 || i < badIndex) badIndex = i;//report the first bad value, regardless of thread timing
+                }
+            }
         }
     }
+    if (badIndex != -1)
+    {
+        decodeFibers(coded[badIndex], decoded[badIndex]);//throws the error message
+    }
 }
 
-void CaretSparseFile::getFibersRowSparse(const int64_t& index, vector<int64_t>& indicesOut, vector<FiberFractions>& valuesOut)
+void CaretSparseFile::decodeFibers(const uint64_t& coded, FiberFractions& decoded)
 {
-    getRowSparse(index, indicesOut, m_scratchSparseRow);
-    size_t numNonzero = m_scratchSparseRow.size();
-    valuesOut.resize(numNonzero);
-    for (size_t i = 0; i < numNonzero; ++i)
+    if (!tryDecodeFibers(coded, decoded))
     {
-        decodeFibers(((uint64_t*)m_scratchSparseRow.data())[i], valuesOut[i]);
+        throw DataFileException("error decoding value '" + AString::number(coded) + "' from workbench sparse trajectory file");
     }
 }
 
-void CaretSparseFile::decodeFibers(const uint64_t& coded, FiberFractions& decoded)
+bool CaretSparseFile::tryDecodeFibers(const uint64_t& coded, FiberFractions& decoded)
 {
     decoded.fiberFractions.resize(3);
     decoded.totalCount = coded>>32;
@@ -194,9 +219,10 @@ void CaretSparseFile::decodeFibers(const uint64_t& coded, FiberFractions& decode
     decoded.fiberFractions[2] = 1.0f - decoded.fiberFractions[0] - decoded.fiberFractions[1];
     if (decoded.fiberFractions[2] < -0.002f || (temp & (3<<30)))
     {
-        throw DataFileException("error decoding value '" + AString::number(coded) + "' from workbench sparse trajectory file");
+        return false;
     }
     if (decoded.fiberFractions[2] < 0.0f) decoded.fiberFractions[2] = 0.0f;
+    return true;
 }
 
 void FiberFractions::zero()
@@ -206,9 +232,9 @@ void FiberFractions::zero()
     distance = 0.0f;
 }
 
-CaretSparseFileWriter::CaretSparseFileWriter(const AString& fileName, const CiftiXML& xml)
+CaretSparseFileWriter::CaretSparseFileWriter(const AString& fileName, const CiftiXML& xml, const bool& isTrajectory)
 {
-    if (!fileName.endsWith(".trajTEMP.wbsparse"))
+    if (isTrajectory && !fileName.endsWith(".trajTEMP.wbsparse"))
     {//for now (and maybe forever), this format is single-purpose
         CaretLogWarning("sparse trajectory file '" + fileName + "' should be saved ending in .trajTEMP.wbsparse");
     }
@@ -43,6 +43,9 @@ namespace caret {
     class CaretSparseFile /* : public DataFile */
     {
         static void decodeFibers(const uint64_t& coded, FiberFractions& decoded);//takes a uint because right shift on signed is implementation dependent
+        static bool tryDecodeFibers(const uint64_t& coded, FiberFractions& decoded);//returns false instead of throwing, for use inside parallel loops
+        ///decodes many values, in parallel when there are enough of them, zero values give zeroed fractions
+        static void decodeFibersArray(const uint64_t* coded, const int64_t& count, FiberFractions* decoded);
         CaretBinaryFile m_file;
         int64_t m_dims[2], m_valuesOffset;
         std::vector<uint64_t> m_indexArray, m_scratchRow;
@@ -86,7 +89,8 @@ namespace caret {
         CaretSparseFileWriter(const CaretSparseFileWriter& rhs);
         CiftiXML m_xml;
     public:
-        CaretSparseFileWriter(const AString& fileName, const CiftiXML& xml);
+        ///set isTrajectory to false for wbsparse files that don't contain fiber trajectories, so the name isn't checked for .trajTEMP.wbsparse
+        CaretSparseFileWriter(const AString& fileName, const CiftiXML& xml, const bool& isTrajectory = true);
         
         ~CaretSparseFileWriter();
         
@@ -220,16 +220,16 @@ ChartableTwoFileHistogramChart::getHistogramForChartDrawing(const int32_t mapInd
                     mostNeg  = statistics->getMin();
                     break;
                 case PaletteScaleModeEnum::MODE_AUTO_SCALE_ABSOLUTE_PERCENTAGE:
-                    mostPos  =  statistics->getApproxAbsolutePercentile(paletteColorMapping->getAutoScaleAbsolutePercentageMaximum());
-                    leastPos =  statistics->getApproxAbsolutePercentile(paletteColorMapping->getAutoScaleAbsolutePercentageMinimum());
-                    leastNeg = -statistics->getApproxAbsolutePercentile(paletteColorMapping->getAutoScaleAbsolutePercentageMinimum());
-                    mostNeg  = -statistics->getApproxAbsolutePercentile(paletteColorMapping->getAutoScaleAbsolutePercentageMaximum());
+                    mostPos  =  statistics->getAbsolutePercentile(paletteColorMapping->getAutoScaleAbsolutePercentageMaximum());
+                    leastPos =  statistics->getAbsolutePercentile(paletteColorMapping->getAutoScaleAbsolutePercentageMinimum());
+                    leastNeg = -statistics->getAbsolutePercentile(paletteColorMapping->getAutoScaleAbsolutePercentageMinimum());
+                    mostNeg  = -statistics->getAbsolutePercentile(paletteColorMapping->getAutoScaleAbsolutePercentageMaximum());
                     break;
                 case PaletteScaleModeEnum::MODE_AUTO_SCALE_PERCENTAGE:
-                    mostPos  = statistics->getApproxPositivePercentile(paletteColorMapping->getAutoScalePercentagePositiveMaximum());
-                    leastPos = statistics->getApproxPositivePercentile(paletteColorMapping->getAutoScalePercentagePositiveMinimum());
-                    leastNeg = statistics->getApproxNegativePercentile(paletteColorMapping->getAutoScalePercentageNegativeMinimum());
-                    mostNeg  = statistics->getApproxNegativePercentile(paletteColorMapping->getAutoScalePercentageNegativeMaximum());
+                    mostPos  = statistics->getPositivePercentile(paletteColorMapping->getAutoScalePercentagePositiveMaximum());
+                    leastPos = statistics->getPositivePercentile(paletteColorMapping->getAutoScalePercentagePositiveMinimum());
+                    leastNeg = statistics->getNegativePercentile(paletteColorMapping->getAutoScalePercentageNegativeMinimum());
+                    mostNeg  = statistics->getNegativePercentile(paletteColorMapping->getAutoScalePercentageNegativeMaximum());
                     break;
                 case PaletteScaleModeEnum::MODE_USER_SCALE:
                     mostPos  = paletteColorMapping->getUserScalePositiveMaximum();
@@ -25,6 +25,7 @@
 
 #include "CaretAssert.h"
 #include "CiftiConnectivityMatrixParcelFile.h"
+#include "CiftiMappableConnectivityMatrixDataFile.h"
 #include "CiftiParcelLabelFile.h"
 #include "CiftiParcelReordering.h"
 #include "CiftiParcelScalarFile.h"
@@ -92,6 +93,7 @@ m_validRowColumnSelectionDimensions(validRowColumnSelectionDimensions)
             case DataFileTypeEnum::BORDER:
                 break;
             case DataFileTypeEnum::CONNECTIVITY_DENSE:
+                m_matrixDataFileType = MatrixDataFileType::CONNECTIVITY_MATRIX;
                 break;
             case DataFileTypeEnum::CONNECTIVITY_DENSE_DYNAMIC:
                 break;
@@ -111,6 +113,7 @@ m_validRowColumnSelectionDimensions(validRowColumnSelectionDimensions)
                 m_matrixDataFileType = MatrixDataFileType::PARCEL;
                 break;
             case DataFileTypeEnum::CONNECTIVITY_PARCEL_DENSE:
+                m_matrixDataFileType = MatrixDataFileType::CONNECTIVITY_MATRIX;
                 break;
             case DataFileTypeEnum::CONNECTIVITY_PARCEL_LABEL:
                 m_matrixDataFileType = MatrixDataFileType::PARCEL_LABEL;
@@ -157,6 +160,15 @@ m_validRowColumnSelectionDimensions(validRowColumnSelectionDimensions)
                 CaretAssert(0);
                 return;
                 break;
+            case MatrixDataFileType::CONNECTIVITY_MATRIX:
+                /*
+                 * Rows of dense matrices are brainordinates and are not named
+                 */
+                m_connectivityMatrixFile = dynamic_cast<CiftiMappableConnectivityMatrixDataFile*>(ciftiMapFile);
+                CaretAssert(m_connectivityMatrixFile);
+                m_hasRowSelectionFlag    = true;
+                hasRowParcelsFlag        = (ciftiMapFile->getCiftiParcelsMapForDirection(CiftiXML::ALONG_COLUMN) != NULL);
+                break;
             case MatrixDataFileType::PARCEL:
                 m_parcelFile = dynamic_cast<CiftiConnectivityMatrixParcelFile*>(ciftiMapFile);
                 CaretAssert(m_parcelFile);
@@ -279,7 +291,7 @@ m_validRowColumnSelectionDimensions(validRowColumnSelectionDimensions)
     m_matrixTriangularViewingModeSupportedFlag = false;
     if ((m_numberOfRows > 0)
         && (m_numberOfColumns > 0)) {
-        const CiftiConnectivityMatrixParcelFile* matrixFile = dynamic_cast<const CiftiConnectivityMatrixParcelFile*>(parentCaretMappableDataFile);
+        const CiftiMappableConnectivityMatrixDataFile* matrixFile = dynamic_cast<const CiftiMappableConnectivityMatrixDataFile*>(parentCaretMappableDataFile);
         if (matrixFile != NULL) {
             m_matrixTriangularViewingModeSupportedFlag = matrixFile->hasSymetricRowColumnNames();
         }
@@ -423,6 +435,79 @@ ChartableTwoFileMatrixChart::getMatrixChartingGraphicsPrimitive(const ChartTwoMa
                                                             gridMode);
 }
 
+/**
+ * Get the texture primitives containing the matrix representation of the file.
+ * All cells are of dimension 1.0 x 1.0
+ *
+ * @param matrixViewMode
+ *     The matrix visualization mode (upper/lower).
+ * @param texturePrimitivesOut
+ *     Output containing the texture tiles.
+ */
+void
+ChartableTwoFileMatrixChart::getMatrixChartingTexturePrimitives(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                                std::vector<GraphicsPrimitiveV3fT3f*>& texturePrimitivesOut) const
+{
+    const CiftiMappableDataFile* ciftiMapFile = getCiftiMappableDataFile();
+    CaretAssert(ciftiMapFile);
+    
+    ciftiMapFile->getMatrixChartingTexturePrimitives(matrixViewMode,
+                                                     texturePrimitivesOut);
+}
+
+/**
+ * @return True if the matrix is drawn with a level of detail pyramid
+ * so that only the visible region is loaded.
+ */
+bool
+ChartableTwoFileMatrixChart::isMatrixChartingLevelOfDetail() const
+{
+    const CiftiMappableDataFile* ciftiMapFile = getCiftiMappableDataFile();
+    CaretAssert(ciftiMapFile);
+    
+    return ciftiMapFile->isMatrixChartingLevelOfDetail();
+}
+
+/**
+ * Get the texture primitives for the visible region of the matrix.
+ * All cells are of dimension 1.0 x 1.0
+ *
+ * @param matrixViewMode
+ *     The matrix visualization mode (upper/lower).
+ * @param visibleMinX
+ *     Minimum visible X-coordinate.
+ * @param visibleMaxX
+ *     Maximum visible X-coordinate.
+ * @param visibleMinY
+ *     Minimum visible Y-coordinate.
+ * @param visibleMaxY
+ *     Maximum visible Y-coordinate.
+ * @param cellsPerPixel
+ *     Number of matrix cells in a screen pixel.
+ * @param texturePrimitivesOut
+ *     Output containing the texture tiles.
+ */
+void
+ChartableTwoFileMatrixChart::getMatrixChartingTexturePrimitives(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                                const float visibleMinX,
+                                                                const float visibleMaxX,
+                                                                const float visibleMinY,
+                                                                const float visibleMaxY,
+                                                                const float cellsPerPixel,
+                                                                std::vector<GraphicsPrimitiveV3fT3f*>& texturePrimitivesOut) const
+{
+    const CiftiMappableDataFile* ciftiMapFile = getCiftiMappableDataFile();
+    CaretAssert(ciftiMapFile);
+    
+    ciftiMapFile->getMatrixChartingTexturePrimitives(matrixViewMode,
+                                                     visibleMinX,
+                                                     visibleMaxX,
+                                                     visibleMinY,
+                                                     visibleMaxY,
+                                                     cellsPerPixel,
+                                                     texturePrimitivesOut);
+}
+
 /** 
  * @return Identifier for the matrix primitives alternative color used for the grid coloring 
  */
@@ -447,6 +532,9 @@ ChartableTwoFileMatrixChart::getSelectedRowColumnDimension() const
         case MatrixDataFileType::INVALID:
             CaretAssert(0);
             break;
+        case MatrixDataFileType::CONNECTIVITY_MATRIX:
+            CaretAssert(m_connectivityMatrixFile);
+            break;
         case MatrixDataFileType::PARCEL:
             CaretAssert(m_parcelFile);
             switch (m_parcelFile->getMatrixLoadingDimension()) {
@@ -491,6 +579,9 @@ ChartableTwoFileMatrixChart::setSelectedRowColumnDimension(const ChartTwoMatrixL
         case MatrixDataFileType::INVALID:
             CaretAssert(0);
             break;
+        case MatrixDataFileType::CONNECTIVITY_MATRIX:
+            CaretAssert(m_connectivityMatrixFile);
+            break;
         case MatrixDataFileType::PARCEL:
         {
             CaretAssert(m_parcelFile);
@@ -560,6 +651,21 @@ ChartableTwoFileMatrixChart::getSelectedRowColumnIndices(const int32_t tabIndex,
         case MatrixDataFileType::INVALID:
             CaretAssert(0);
             break;
+        case MatrixDataFileType::CONNECTIVITY_MATRIX:
+        {
+            CaretAssert(m_connectivityMatrixFile);
+            const ConnectivityDataLoaded* connDataLoaded = m_connectivityMatrixFile->getConnectivityDataLoaded();
+            if (connDataLoaded != NULL) {
+                int64_t loadedRowIndex = -1;
+                int64_t loadedColumnIndex = -1;
+                connDataLoaded->getRowColumnLoading(loadedRowIndex,
+                                                    loadedColumnIndex);
+                if (loadedRowIndex >= 0) {
+                    rowIndicesSet.insert(loadedRowIndex);
+                }
+            }
+        }
+            break;
         case MatrixDataFileType::PARCEL:
         {
             CaretAssert(m_parcelFile);
@@ -647,6 +753,18 @@ ChartableTwoFileMatrixChart::setSelectedRowColumnIndex(const int32_t tabIndex,
         case MatrixDataFileType::INVALID:
             CaretAssert(0);
             break;
+        case MatrixDataFileType::CONNECTIVITY_MATRIX:
+        {
+            CaretAssert(m_connectivityMatrixFile);
+            int32_t numRows = -1;
+            int32_t numCols = -1;
+            getMatrixDimensions(numRows, numCols);
+            if (rowColumnIndex < numRows) {
+                m_connectivityMatrixFile->loadDataForRowIndex(rowColumnIndex);
+                m_connectivityMatrixFile->invalidateColoringInAllMaps();
+            }
+        }
+            break;
         case MatrixDataFileType::PARCEL:
         {
             CaretAssert(m_parcelFile);
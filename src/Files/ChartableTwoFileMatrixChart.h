@@ -31,11 +31,13 @@
 namespace caret {
 
     class CiftiConnectivityMatrixParcelFile;
+    class CiftiMappableConnectivityMatrixDataFile;
     class CiftiParcelLabelFile;
     class CiftiParcelScalarFile;
     class CiftiParcelSeriesFile;
     class CiftiScalarDataSeriesFile;
     class GraphicsPrimitiveV3fC4f;
+    class GraphicsPrimitiveV3fT3f;
     
     class ChartableTwoFileMatrixChart : public ChartableTwoFileBaseChart {
         
@@ -62,6 +64,19 @@ namespace caret {
         GraphicsPrimitiveV3fC4f* getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
                                                                     const CiftiMappableDataFile::MatrixGridMode gridMode) const;
         
+        void getMatrixChartingTexturePrimitives(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                std::vector<GraphicsPrimitiveV3fT3f*>& texturePrimitivesOut) const;
+        
+        bool isMatrixChartingLevelOfDetail() const;
+        
+        void getMatrixChartingTexturePrimitives(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                const float visibleMinX,
+                                                const float visibleMaxX,
+                                                const float visibleMinY,
+                                                const float visibleMaxY,
+                                                const float cellsPerPixel,
+                                                std::vector<GraphicsPrimitiveV3fT3f*>& texturePrimitivesOut) const;
+        
         int32_t getMatrixChartGraphicsPrimitiveGridColorIdentifier() const;
         
         bool isMatrixTriangularViewingModeSupported() const;
@@ -99,6 +114,7 @@ namespace caret {
     protected:
         enum class MatrixDataFileType {
             INVALID,
+            CONNECTIVITY_MATRIX,
             PARCEL,
             PARCEL_LABEL,
             PARCEL_SCALAR,
@@ -144,6 +160,7 @@ namespace caret {
         MatrixDataFileType m_matrixDataFileType = MatrixDataFileType::INVALID;
         
         CiftiConnectivityMatrixParcelFile *m_parcelFile = NULL;
+        CiftiMappableConnectivityMatrixDataFile* m_connectivityMatrixFile = NULL;
         CiftiParcelLabelFile* m_parcelLabelFile = NULL;
         CiftiParcelScalarFile* m_parcelScalarFile = NULL;
         CiftiParcelSeriesFile* m_parcelSeriesFile = NULL;
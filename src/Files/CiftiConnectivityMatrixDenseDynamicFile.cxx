@@ -19,8 +19,8 @@
  */
 /*LICENSE_END*/
 
+#include <algorithm>
 #include <cmath>
-#include <iostream>
 
 #define __CIFTI_CONNECTIVITY_MATRIX_DENSE_DYNAMIC_FILE_DECLARE__
 #include "CiftiConnectivityMatrixDenseDynamicFile.h"
@@ -61,8 +61,7 @@ m_parentDataSeriesCiftiFile(NULL),
 m_numberOfBrainordinates(-1),
 m_numberOfTimePoints(-1),
 m_validDataFlag(false),
-m_enabledAsLayer(true),
-m_cacheDataFlag(false)
+m_enabledAsLayer(true)
 {
     CaretAssert(m_parentDataSeriesFile);
 
@@ -165,30 +164,33 @@ CiftiConnectivityMatrixDenseDynamicFile::updateAfterReading(const CiftiFile* cif
     m_numberOfBrainordinates = ciftiXML.getBrainModelsMap(CiftiXML::ALONG_COLUMN).getLength();
     m_numberOfTimePoints     = ciftiXML.getSeriesMap(CiftiXML::ALONG_ROW).getLength();
     
-    m_rowData.clear();
+    m_normalizedData.clear();
     
     if ((m_numberOfBrainordinates > 0)
         && (m_numberOfTimePoints > 0)) {
-        m_rowData.resize(m_numberOfBrainordinates);
-        
-        if (m_cacheDataFlag) {
-            /*
-             * Read all of the data.  Time-series type files are not
-             * too large and by caching the data, it eliminates
-             * numerous calls to read the data when correlation
-             * is performed.
-             *
-             * READ DATA FROM PARENT FILE
-             */
-            for (int32_t i = 0; i < m_numberOfBrainordinates; i++) {
-                CaretAssertVectorIndex(m_rowData, i);
-                m_rowData[i].m_data.resize(m_numberOfTimePoints);
-                m_parentDataSeriesCiftiFile->getRow(&m_rowData[i].m_data[0],
-                                                    i);
-            }
+        /*
+         * Read all of the data once, serially since reading may do
+         * disk access, which is not thread-safe.  Each row is then
+         * normalized in place, so that correlating a row with all
+         * other rows is a single matrix-vector product.
+         *
+         * READ DATA FROM PARENT FILE
+         */
+        m_normalizedData.resize(static_cast<int64_t>(m_numberOfBrainordinates) * m_numberOfTimePoints);
+        for (int32_t i = 0; i < m_numberOfBrainordinates; i++) {
+            m_parentDataSeriesCiftiFile->getRow(&m_normalizedData[static_cast<int64_t>(i) * m_numberOfTimePoints],
+                                                i);
         }
         
-        preComputeRowMeanAndSumSquared();
+        /*
+         * TSC: hyperthreading means some cores end up "faster" than others, so "static" scheduling is generally not as fast
+         * there is almost no overhead to dynamic scheduling
+         */
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
+        for (int32_t iRow = 0; iRow < m_numberOfBrainordinates; iRow++) {
+            normalizeData(&m_normalizedData[static_cast<int64_t>(iRow) * m_numberOfTimePoints],
+                          m_numberOfTimePoints);
+        }
         
         m_validDataFlag = true;
     }
@@ -268,25 +270,10 @@ CiftiConnectivityMatrixDenseDynamicFile::getProcessedDataForRow(float* dataOut,
         return;
     }
     
-    std::vector<float> rowData(m_numberOfTimePoints);
-    m_parentDataSeriesCiftiFile->getRow(&rowData[0], index);
-    const float mean = m_rowData[index].m_mean;
-    const float ssxx = m_rowData[index].m_sqrt_ssxx;
-    
-    /*
-     * TSC: hyperthreading means some cores end up "faster" than others, so "static" scheduling is generally not as fast
-     * there is almost no overhead to dynamic scheduling
-     */
-#pragma omp CARET_PARFOR schedule(dynamic)
-    for (int32_t iRow = 0; iRow < m_numberOfBrainordinates; iRow++) {
-        float coefficient = 1.0;
-        
-        if (iRow != index) {
-            coefficient = correlation(rowData, mean, ssxx, iRow, m_numberOfTimePoints);
-        }
-        
-        dataOut[iRow] = coefficient;
-    }
+    CaretAssert((index >= 0) && (index < m_numberOfBrainordinates));
+    correlateWithAllRows(&m_normalizedData[index * m_numberOfTimePoints],
+                         dataOut);
+    dataOut[index] = 1.0;
 }
 
 /**
@@ -316,251 +303,86 @@ CiftiConnectivityMatrixDenseDynamicFile::processRowAverageData(std::vector<float
         return;
     }
     
-    float mean = 0.0;
-    float sumSquared = 0.0;
-    computeDataMeanAndSumSquared(&rowAverageDataInOut[0],
-                                 dataLength,
-                                 mean,
-                                 sumSquared);
+    normalizeData(&rowAverageDataInOut[0],
+                  dataLength);
     
     std::vector<float> processedRowAverageData(m_numberOfBrainordinates);
-    
-    /*
-     * TSC: hyperthreading means some cores end up "faster" than others, so "static" scheduling is generally not as fast
-     * there is almost no overhead to dynamic scheduling
-     */
-#pragma omp CARET_PARFOR schedule(dynamic)
-    for (int32_t iRow = 0; iRow < m_numberOfBrainordinates; iRow++) {
-        const float coefficient = correlation(rowAverageDataInOut,
-                                              mean,
-                                              sumSquared,
-                                              iRow,
-                                              dataLength);
-        CaretAssertVectorIndex(processedRowAverageData, iRow);
-        processedRowAverageData[iRow] = coefficient;
-    }
+    correlateWithAllRows(&rowAverageDataInOut[0],
+                         &processedRowAverageData[0]);
     
     rowAverageDataInOut = processedRowAverageData;
 }
 
-
 /**
- * Compute the mean and sum-squared for each row so that they
- * are only calculated once.
- */
-void
-CiftiConnectivityMatrixDenseDynamicFile::preComputeRowMeanAndSumSquared()
-{
-    CaretAssert(m_numberOfBrainordinates > 0);
-    CaretAssert(m_numberOfTimePoints > 0);
-
-    /*
-     * TSC: hyperthreading means some cores end up "faster" than others, so "static" scheduling is generally not as fast
-     * there is almost no overhead to dynamic scheduling
-     */
-#pragma omp CARET_PARFOR schedule(dynamic)
-    for (int32_t iRow = 0; iRow < m_numberOfBrainordinates; iRow++) {
-
-        CaretAssertVectorIndex(m_rowData, iRow);
-        
-        if (m_cacheDataFlag) {
-            CaretAssertVectorIndex(m_rowData[iRow].m_data, (m_numberOfTimePoints - 1));
-            computeDataMeanAndSumSquared(&m_rowData[iRow].m_data[0],
-                                         m_numberOfTimePoints,
-                                         m_rowData[iRow].m_mean,
-                                         m_rowData[iRow].m_sqrt_ssxx);
-        }
-        else {
-            std::vector<float> data(m_numberOfTimePoints);
-#pragma omp critical
-            {//TSC: this can do disk access, which is not currently thread-safe
-                m_parentDataSeriesCiftiFile->getRow(&data[0], iRow);
-            }
-            computeDataMeanAndSumSquared(&data[0],
-                                         m_numberOfTimePoints,
-                                         m_rowData[iRow].m_mean,
-                                         m_rowData[iRow].m_sqrt_ssxx);
-        }
-        
-//        double sum = 0.0;
-//        double sumSquared = 0.0;
-//        if (m_cacheDataFlag) {
-//            for (int32_t iPoint = 0; iPoint < m_numberOfTimePoints; iPoint++) {
-//                CaretAssertVectorIndex(m_rowData[iRow].m_data, iPoint);
-//                const float d = m_rowData[iRow].m_data[iPoint];
-//                sum        += d;
-//                sumSquared += (d * d);
-//            }
-//        }
-//        else {
-//            std::vector<float> data(m_numberOfTimePoints);
-//            m_parentDataSeriesCiftiFile->getRow(&data[0], iRow);
-//            for (int32_t iPoint = 0; iPoint < m_numberOfTimePoints; iPoint++) {
-//                CaretAssertVectorIndex(data, iPoint);
-//                const float d = data[iPoint];
-//                sum        += d;
-//                sumSquared += (d * d);
-//            }
-//        }
-//        
-//        const float mean       = (sum / numPointsFloat);
-//        const float ssxx = (sumSquared - (numPointsFloat * mean * mean));
-//        CaretAssert(ssxx >= 0.0);
-//        
-//        const float meanDiff = std::fabs(mean - m_rowData[iRow].m_mean);
-//        const float ssDiff   = std::fabs(std::sqrt(ssxx) - m_rowData[iRow].m_sqrt_ssxx);
-//        if ((meanDiff > 0.0001) || (ssDiff > 0.0001)) {
-//            std::cout << "Mean/SS diff" << std::endl;
-//        }
-//        
-//        m_rowData[iRow].m_mean = mean;
-//        m_rowData[iRow].m_sqrt_ssxx = std::sqrt(ssxx);
-    }
-}
-
-/**
- * Compute data's mean and sum-squared
+ * Remove the mean from the data and scale it to unit length so that
+ * the dot product of two normalized rows is their correlation
+ * (https://en.wikipedia.org/wiki/Pearson_product-moment_correlation_coefficient).
+ * Data with no variance (or containing NaN) becomes all zeros, so its
+ * correlation with anything is zero.
  *
- * @param data
- *     Data on which mean and sum-squared are calculated
+ * @param dataInOut
+ *     Data that is normalized.
  * @param dataLength
  *     Number of items in data.
- * @param meanOut
- *     Output with mean of data.
- * @param sumSquaredOut
- *     Output with sum-squared.
  */
 void
-CiftiConnectivityMatrixDenseDynamicFile::computeDataMeanAndSumSquared(const float* data,
-                                                                      const int32_t dataLength,
-                                                                      float& meanOut,
-                                                                      float& sumSquaredOut) const
+CiftiConnectivityMatrixDenseDynamicFile::normalizeData(float* dataInOut,
+                                                       const int32_t dataLength) const
 {
-    meanOut = 0.0;
-    sumSquaredOut = 0.0;
     if (dataLength <= 0) {
         return;
     }
     
     double sum = 0.0;
-    double sumSquared = 0.0;
-    
     for (int32_t i = 0; i < dataLength; i++) {
-        const float d = data[i];
-        sum        += d;
-        sumSquared += (d * d);
+        sum += dataInOut[i];
     }
+    const double mean = (sum / dataLength);
     
-    meanOut = (sum / dataLength);
-    const float ssxx = (sumSquared - (dataLength * meanOut * meanOut));
-    //TSC: do not assert things that depend on input file content (a NaN in the data will trip it), you could print a warning instead
-    //CaretAssert(ssxx >= 0.0);
-    sumSquaredOut = std::sqrt(ssxx);
-}
-
-
-/**
- * Correlation from https://en.wikipedia.org/wiki/Pearson_product-moment_correlation_coefficient
- *
- * @param data
- *     Data for correlation
- * @param mean
- *     Mean of data
- * @param sumSquared
- *     Sum squared of data.
- * @param otherRowIndex
- *     Index of another row
- * @param numberOfPoints
- *     Number of points int the two arrays
- * @return
- *     The correlation coefficient computed on the two arrays.
- */
-float
-CiftiConnectivityMatrixDenseDynamicFile::correlation(const std::vector<float>& data,
-                                                     const float mean,
-                                                     const float sumSquared,
-                                                     const int32_t otherRowIndex,
-                                                     const int32_t numberOfPoints) const
-{
-    const double numFloat = numberOfPoints;
-    double xySum = 0.0;
-    
-    CaretAssertVectorIndex(m_rowData, otherRowIndex);
-    const RowData& otherData = m_rowData[otherRowIndex];
-    
-    if (m_cacheDataFlag) {
-        xySum = dsdot(&data[0], &otherData.m_data[0], numberOfPoints);
-    }
-    else {
-        std::vector<float> otherDataVector(m_numberOfTimePoints);
-        m_parentDataSeriesCiftiFile->getRow(&otherDataVector[0], otherRowIndex);
-        xySum = dsdot(&data[0], &otherDataVector[0], numberOfPoints);
+    double ssxx = 0.0;
+    for (int32_t i = 0; i < dataLength; i++) {
+        const double d = dataInOut[i] - mean;
+        ssxx += (d * d);
     }
     
-    const double ssxy = xySum - (numFloat * mean * otherData.m_mean);
+    if ( ! (ssxx > 0.0)) {
+        std::fill(dataInOut, dataInOut + dataLength, 0.0f);
+        return;
+    }
     
-    float correlationCoefficient = 0.0;
-    if ((sumSquared > 0.0)
-        && (otherData.m_sqrt_ssxx > 0.0)) {
-        correlationCoefficient = (ssxy / (sumSquared * otherData.m_sqrt_ssxx));
+    const double scale = 1.0 / std::sqrt(ssxx);
+    for (int32_t i = 0; i < dataLength; i++) {
+        dataInOut[i] = (dataInOut[i] - mean) * scale;
     }
-    return correlationCoefficient;
 }
 
 /**
- * Correlation from https://en.wikipedia.org/wiki/Pearson_product-moment_correlation_coefficient
+ * Correlate normalized data with every row, as a matrix-vector product
+ * of the normalized rows with the data.
  *
- * @param rowIndex
- *     Index of a row
- * @param otherRowIndex
- *     Index of another row
- * @param numberOfPoints
- *     Number of points int the two arrays
- * @return
- *     The correlation coefficient computed on the two arrays.
+ * @param normalizedData
+ *     Data, normalized with normalizeData().
+ * @param dataOut
+ *     Output with correlation to each row, one per brainordinate.
  */
-float
-CiftiConnectivityMatrixDenseDynamicFile::correlation(const int32_t rowIndex,
-                                                     const int32_t otherRowIndex,
-                                                     const int32_t numberOfPoints) const
+void
+CiftiConnectivityMatrixDenseDynamicFile::correlateWithAllRows(const float* normalizedData,
+                                                              float* dataOut) const
 {
-    const double numFloat = numberOfPoints;
-    double xySum = 0.0;
+    CaretAssert(static_cast<int64_t>(m_normalizedData.size()) == static_cast<int64_t>(m_numberOfBrainordinates) * m_numberOfTimePoints);
     
-    CaretAssertVectorIndex(m_rowData, rowIndex);
-    CaretAssertVectorIndex(m_rowData, otherRowIndex);
-    const RowData& data = m_rowData[rowIndex];
-    const RowData& otherData = m_rowData[otherRowIndex];
-    
-    if (m_cacheDataFlag) {
-        for (int i = 0; i < numberOfPoints; i++) {
-            CaretAssertVectorIndex(data.m_data, i);
-            CaretAssertVectorIndex(otherData.m_data, i);
-            xySum += data.m_data[i] * otherData.m_data[i];
-        }
-    }
-    else {
-        std::vector<float> dataVector(m_numberOfTimePoints);
-        std::vector<float> otherDataVector(m_numberOfTimePoints);
-        m_parentDataSeriesCiftiFile->getRow(&dataVector[0], rowIndex);
-        m_parentDataSeriesCiftiFile->getRow(&otherDataVector[0], otherRowIndex);
-        
-        for (int i = 0; i < numberOfPoints; i++) {
-            CaretAssertVectorIndex(dataVector, i);
-            CaretAssertVectorIndex(otherDataVector, i);
-            xySum += dataVector[i] * otherDataVector[i];
-        }
-    }
-    
-    const double ssxy = xySum - (numFloat * data.m_mean * otherData.m_mean);
-    
-    float correlationCoefficient = 0.0;
-    if ((data.m_sqrt_ssxx > 0.0)
-        && (otherData.m_sqrt_ssxx > 0.0)) {
-        correlationCoefficient = (ssxy / (data.m_sqrt_ssxx * otherData.m_sqrt_ssxx));
+    /*
+     * TSC: hyperthreading means some cores end up "faster" than others, so "static" scheduling is generally not as fast
+     * there is almost no overhead to dynamic scheduling
+     */
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
+    for (int32_t iRow = 0; iRow < m_numberOfBrainordinates; iRow++) {
+        dataOut[iRow] = dsdot(normalizedData,
+                              &m_normalizedData[static_cast<int64_t>(iRow) * m_numberOfTimePoints],
+                              m_numberOfTimePoints);
     }
-    return correlationCoefficient;
 }
+
 /**
  * Save subclass data to the scene.
  *
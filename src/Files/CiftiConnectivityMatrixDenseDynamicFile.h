@@ -72,33 +72,11 @@ namespace caret {
                                                   const SceneClass* sceneClass);
         
     private:
-        class RowData {
-        public:
-            RowData() { }
-            
-            ~RowData() { }
-            
-            std::vector<float> m_data;
-            float m_mean;
-            float m_sqrt_ssxx;
-        };
-        
-        float correlation(const int32_t rowIndex,
-                          const int32_t otherRowIndex,
-                          const int32_t numberOfPoints) const;
-        
-        float correlation(const std::vector<float>& data,
-                          const float mean,
-                          const float sumSquared,
-                          const int32_t otherRowIndex,
-                          const int32_t numberOfPoints) const;
-        
-        void preComputeRowMeanAndSumSquared();
-        
-        void computeDataMeanAndSumSquared(const float* data,
-                                          const int32_t dataLength,
-                                          float& meanOut,
-                                          float& sumSquaredOut) const;
+        void normalizeData(float* dataInOut,
+                           const int32_t dataLength) const;
+        
+        void correlateWithAllRows(const float* normalizedData,
+                                  float* dataOut) const;
         
         CiftiBrainordinateDataSeriesFile* m_parentDataSeriesFile;
         
@@ -108,14 +86,13 @@ namespace caret {
         
         int32_t m_numberOfTimePoints;
         
-        std::vector<RowData> m_rowData;
+        /** Each row with its mean removed and scaled to unit length, so a correlation is a single dot product */
+        std::vector<float> m_normalizedData;
         
         bool m_validDataFlag;
         
         bool m_enabledAsLayer;
         
-        const bool m_cacheDataFlag;
-        
         CaretPointer<SceneClassAssistant> m_sceneAssistant;
         
         // ADD_NEW_MEMBERS_HERE
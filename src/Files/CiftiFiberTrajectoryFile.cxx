@@ -30,6 +30,7 @@
 
 #include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "CaretSparseFile.h"
 #include "CiftiFiberOrientationFile.h"
 #include "CiftiMappableDataFile.h"
@@ -1389,8 +1390,12 @@ CiftiFiberTrajectoryFile::loadRowsForAveraging(const std::vector<int64_t>& rowIn
     const CiftiXML& trajXML = m_sparseFile->getCiftiXML();
     const int64_t numberOfColumns = trajXML.getDimensionLength(CiftiXML::ALONG_ROW);
     
-    std::vector<FiberFractions> fiberFractionsForRowVector(numberOfColumns);
-    FiberFractions* fiberFractionsForRow = &fiberFractionsForRowVector[0];
+    /*
+     * Rows are read sparse so that only the nonzero fibers are decoded
+     * and added, every row counts toward the average of every column.
+     */
+    std::vector<int64_t> fiberIndicesForRow;
+    std::vector<FiberFractions> fiberFractionsForRow;
     
     const int64_t numberOfRowsToLoad = static_cast<int64_t>(rowIndices.size());
     if (numberOfRowsToLoad <= 0) {
@@ -1429,12 +1434,19 @@ CiftiFiberTrajectoryFile::loadRowsForAveraging(const std::vector<int64_t>& rowIn
             }
         }
         
-        m_sparseFile->getFibersRow(rowIndex,
-                                   fiberFractionsForRow);
+        m_sparseFile->getFibersRowSparse(rowIndex,
+                                         fiberIndicesForRow,
+                                         fiberFractionsForRow);
         
-        for (int64_t iCol = 0; iCol < numberOfColumns; iCol++) {
-            FiberOrientationTrajectory* fot = m_fiberOrientationTrajectories[iCol];
-            fot->addFiberFractionsForAveraging(fiberFractionsForRow[iCol]);
+        /*
+         * Indices within a row are unique, so each thread updates
+         * different trajectories.
+         */
+        const int64_t numberOfNonzero = static_cast<int64_t>(fiberIndicesForRow.size());
+#pragma omp CARET_PARFOR schedule(static) if (numberOfNonzero >= 4096)
+        for (int64_t i = 0; i < numberOfNonzero; i++) {
+            FiberOrientationTrajectory* fot = m_fiberOrientationTrajectories[fiberIndicesForRow[i]];
+            fot->addFiberFractionsToSums(fiberFractionsForRow[i]);
         }
     }
     
@@ -1443,6 +1455,10 @@ CiftiFiberTrajectoryFile::loadRowsForAveraging(const std::vector<int64_t>& rowIn
         return false;
     }
     
+    for (int64_t iCol = 0; iCol < numberOfColumns; iCol++) {
+        m_fiberOrientationTrajectories[iCol]->m_countForAveraging = numberOfRowsToLoad;
+    }
+    
     finishFiberOrientationTrajectoriesAveraging();
     
     return true;
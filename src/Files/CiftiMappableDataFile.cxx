@@ -18,6 +18,8 @@
  */
 /*LICENSE_END*/
 
+#include <algorithm>
+#include <cmath>
 #include <set>
 
 #define __CIFTI_MAPPABLE_DATA_FILE_DECLARE__
@@ -27,6 +29,7 @@
 #include "BackgroundAndForegroundColors.h"
 #include "BoundingBox.h"
 #include "CaretAssert.h"
+#include "CaretHttpManager.h"
 #include "CaretLogger.h"
 #include "CaretPreferences.h"
 #include "ChartDataCartesian.h"
@@ -36,6 +39,7 @@
 #include "CiftiFiberTrajectoryFile.h"
 #include "CiftiFile.h"
 #include "CiftiMappableConnectivityMatrixDataFile.h"
+#include "CiftiMatrixTexturePyramid.h"
 #include "CiftiParcelLabelFile.h"
 #include "CiftiParcelReordering.h"
 #include "CiftiParcelScalarFile.h"
@@ -54,9 +58,11 @@
 #include "GiftiLabelTable.h"
 #include "GiftiMetaData.h"
 #include "GraphicsPrimitiveV3fC4f.h"
+#include "GraphicsPrimitiveV3fT3f.h"
 #include "GroupAndNameHierarchyModel.h"
 #include "Histogram.h"
 #include "MapFileDataSelector.h"
+#include "MathFunctions.h"
 #include "NodeAndVoxelColoring.h"
 #include "PaletteColorMapping.h"
 #include "PaletteFile.h"
@@ -459,6 +465,8 @@ CiftiMappableDataFile::clearPrivate()
      * m_fileMapDataType
      */
     
+    m_matrixLevelOfDetailTiles.clear();
+    m_matrixTexturePyramid.reset();
     m_ciftiFile.grabNew(NULL);
     
     resetDataLoadingMembers();
@@ -630,22 +638,42 @@ CiftiMappableDataFile::readFile(const AString& ciftiMapFileName)
                     case FILE_MAP_DATA_TYPE_INVALID:
                         break;
                     case FILE_MAP_DATA_TYPE_MATRIX:
-                        throw DataFileException(ciftiMapFileName
-                                                + " of type "
-                                                + DataFileTypeEnum::toGuiName(getDataFileType())
-                                                + " cannot be read over the network.  The file must be"
-                                                " accessed by reading individual rows and/or columns"
-                                                " and this cannot be performed over a network.");
+                    {
+                        /*
+                         * Matrix files are too large to download, rows and
+                         * columns are read on demand with HTTP range requests.
+                         */
+                        AString username = "";
+                        AString password = "";
+                        AString filenameToOpen = "";
+                        FileInformation fileInfo(ciftiMapFileName);
+                        fileInfo.getRemoteUrlUsernameAndPassword(filenameToOpen,
+                                                                 username,
+                                                                 password);
+                        if (CaretDataFile::getFileReadingUsername().isEmpty() == false) {
+                            username = CaretDataFile::getFileReadingUsername();
+                            password = CaretDataFile::getFileReadingPassword();
+                        }
+                        if (username.isEmpty() == false) {
+                            CaretHttpManager::setAuthentication(filenameToOpen,
+                                                                username,
+                                                                password);
+                        }
+                        m_ciftiFile.grabNew(new CiftiFile());
+                        m_ciftiFile->openFile(filenameToOpen);
+                    }
                         break;
                     case FILE_MAP_DATA_TYPE_MULTI_MAP:
                         break;
                 }
                 
-                CaretTemporaryFile tempFile;
-                tempFile.readFile(ciftiMapFileName);
-                m_ciftiFile.grabNew(new CiftiFile());
-                m_ciftiFile->openFile(tempFile.getFileName());
-                m_ciftiFile->convertToInMemory();
+                if (m_ciftiFile == NULL) {
+                    CaretTemporaryFile tempFile;
+                    tempFile.readFile(ciftiMapFileName);
+                    m_ciftiFile.grabNew(new CiftiFile());
+                    m_ciftiFile->openFile(tempFile.getFileName());
+                    m_ciftiFile->convertToInMemory();
+                }
             }
             else {
                 m_ciftiFile.grabNew(new CiftiFile());
@@ -1399,6 +1427,8 @@ CiftiMappableDataFile::invalidateColoringInAllMaps()
      */
     m_matrixGraphicsPrimitive.reset();
     m_matrixGraphicsOutlinePrimitive.reset();
+    m_matrixTexturePrimitives.clear();
+    m_matrixLevelOfDetailTiles.clear();
     invalidateHistogramChartColoring();
 }
 
@@ -1574,65 +1604,11 @@ CiftiMappableDataFile::getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTr
                         const float* rgba = &matrixRGBA[rgbaOffset];
                         rgbaOffset += 4;
                         
-                        bool drawCellFlag = true;
-                        if (matrixViewMode != ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL) {
-                            if (numberOfRows == numberOfColumns) {
-                                drawCellFlag = false;
-                                switch (matrixViewMode) {
-                                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL:
-                                        break;
-                                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL_NO_DIAGONAL:
-                                        if (rowIndex != columnIndex) {
-                                            drawCellFlag = true;
-                                        }
-                                        break;
-                                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_LOWER_NO_DIAGONAL:
-                                        if (rowIndex > columnIndex) {
-                                            drawCellFlag = true;
-                                        }
-                                        break;
-                                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_UPPER_NO_DIAGONAL:
-                                        if (rowIndex < columnIndex) {
-                                            drawCellFlag = true;
-                                        }
-                                        break;
-                                }
-                            }
-                            else {
-                                drawCellFlag = true;
-                                
-                                /*
-                                 * Diagonals for non-square matrices not allowed
-                                 */
-                                const bool allowNonSquareMatrixDiagonalsFlag = false;
-                                if (allowNonSquareMatrixDiagonalsFlag) {
-                                    drawCellFlag = false;
-                                    const float slope = static_cast<float>(numberOfRows) / static_cast<float>(numberOfColumns);
-                                    const int32_t diagonalRow = static_cast<int32_t>(slope * columnIndex);
-                                    
-                                    switch (matrixViewMode) {
-                                        case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL:
-                                            drawCellFlag = true;
-                                            break;
-                                        case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL_NO_DIAGONAL:
-                                            if (rowIndex != diagonalRow) {
-                                                drawCellFlag = true;
-                                            }
-                                            break;
-                                        case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_LOWER_NO_DIAGONAL:
-                                            if (rowIndex > diagonalRow) {
-                                                drawCellFlag = true;
-                                            }
-                                            break;
-                                        case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_UPPER_NO_DIAGONAL:
-                                            if (rowIndex < diagonalRow) {
-                                                drawCellFlag = true;
-                                            }
-                                            break;
-                                    }
-                                }
-                            }
-                        }
+                        const bool drawCellFlag = isMatrixChartCellDisplayed(matrixViewMode,
+                                                                             numberOfRows,
+                                                                             numberOfColumns,
+                                                                             rowIndex,
+                                                                             columnIndex);
                         
                         switch (gridMode) {
                             case MatrixGridMode::FILLED:
@@ -1691,6 +1667,539 @@ CiftiMappableDataFile::getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTr
 }
 
 
+/**
+ * Is a matrix chart cell displayed for the given triangular viewing mode?
+ *
+ * @param matrixViewMode
+ *     The matrix visualization mode (upper/lower).
+ * @param numberOfRows
+ *     Number of rows in the matrix.
+ * @param numberOfColumns
+ *     Number of columns in the matrix.
+ * @param rowIndex
+ *     Row index of the cell.
+ * @param columnIndex
+ *     Column index of the cell.
+ * @return
+ *     True if the cell is displayed, else false.
+ */
+bool
+CiftiMappableDataFile::isMatrixChartCellDisplayed(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                  const int32_t numberOfRows,
+                                                  const int32_t numberOfColumns,
+                                                  const int32_t rowIndex,
+                                                  const int32_t columnIndex)
+{
+    bool drawCellFlag = true;
+    if (matrixViewMode != ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL) {
+        if (numberOfRows == numberOfColumns) {
+            drawCellFlag = false;
+            switch (matrixViewMode) {
+                case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL:
+                    break;
+                case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL_NO_DIAGONAL:
+                    if (rowIndex != columnIndex) {
+                        drawCellFlag = true;
+                    }
+                    break;
+                case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_LOWER_NO_DIAGONAL:
+                    if (rowIndex > columnIndex) {
+                        drawCellFlag = true;
+                    }
+                    break;
+                case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_UPPER_NO_DIAGONAL:
+                    if (rowIndex < columnIndex) {
+                        drawCellFlag = true;
+                    }
+                    break;
+            }
+        }
+        else {
+            drawCellFlag = true;
+            
+            /*
+             * Diagonals for non-square matrices not allowed
+             */
+            const bool allowNonSquareMatrixDiagonalsFlag = false;
+            if (allowNonSquareMatrixDiagonalsFlag) {
+                drawCellFlag = false;
+                const float slope = static_cast<float>(numberOfRows) / static_cast<float>(numberOfColumns);
+                const int32_t diagonalRow = static_cast<int32_t>(slope * columnIndex);
+                
+                switch (matrixViewMode) {
+                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL:
+                        drawCellFlag = true;
+                        break;
+                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL_NO_DIAGONAL:
+                        if (rowIndex != diagonalRow) {
+                            drawCellFlag = true;
+                        }
+                        break;
+                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_LOWER_NO_DIAGONAL:
+                        if (rowIndex > diagonalRow) {
+                            drawCellFlag = true;
+                        }
+                        break;
+                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_UPPER_NO_DIAGONAL:
+                        if (rowIndex < diagonalRow) {
+                            drawCellFlag = true;
+                        }
+                        break;
+                }
+            }
+        }
+    }
+    
+    return drawCellFlag;
+}
+
+/**
+ * Get the texture primitives containing the matrix representation of the file.
+ * Each matrix cell is one texel so memory use is four bytes per cell,
+ * instead of six colored vertices per cell used by the triangle primitive.
+ * Large matrices are split into tiles so that no texture exceeds the
+ * size supported by OpenGL.  All cells are of dimension 1.0 x 1.0 and
+ * cells that are not displayed due to the triangular view are transparent.
+ *
+ * @param matrixViewMode
+ *     The matrix visualization mode (upper/lower).
+ * @param texturePrimitivesOut
+ *     Output containing the texture tiles (empty if matrix is invalid).
+ */
+void
+CiftiMappableDataFile::getMatrixChartingTexturePrimitives(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                          std::vector<GraphicsPrimitiveV3fT3f*>& texturePrimitivesOut) const
+{
+    texturePrimitivesOut.clear();
+    
+    if (matrixViewMode != m_matrixTexturePrimitivesViewMode) {
+        m_matrixTexturePrimitives.clear();
+    }
+    
+    if (m_matrixTexturePrimitives.empty()) {
+        int32_t numberOfRows = 0;
+        int32_t numberOfColumns = 0;
+        std::vector<float> matrixRGBA;
+        if (getMatrixForChartingRGBA(numberOfRows, numberOfColumns, matrixRGBA)) {
+            if ((numberOfRows > 0)
+                && (numberOfColumns > 0)) {
+                /*
+                 * Tile dimension is limited so that textures do not exceed
+                 * the maximum texture size of most OpenGL implementations
+                 */
+                const int32_t maximumTileDimension = 2048;
+                
+                for (int32_t tileFirstRow = 0; tileFirstRow < numberOfRows; tileFirstRow += maximumTileDimension) {
+                    const int32_t tileNumberOfRows = std::min(maximumTileDimension,
+                                                              numberOfRows - tileFirstRow);
+                    for (int32_t tileFirstColumn = 0; tileFirstColumn < numberOfColumns; tileFirstColumn += maximumTileDimension) {
+                        const int32_t tileNumberOfColumns = std::min(maximumTileDimension,
+                                                                     numberOfColumns - tileFirstColumn);
+                        
+                        /*
+                         * First row of texture image is at the bottom
+                         * so the last matrix row of the tile is first
+                         */
+                        std::vector<uint8_t> imageBytesRGBA(static_cast<int64_t>(tileNumberOfRows) * tileNumberOfColumns * 4);
+                        int64_t imageOffset = 0;
+                        for (int32_t tileRow = tileNumberOfRows - 1; tileRow >= 0; tileRow--) {
+                            const int32_t rowIndex = tileFirstRow + tileRow;
+                            for (int32_t tileColumn = 0; tileColumn < tileNumberOfColumns; tileColumn++) {
+                                const int32_t columnIndex = tileFirstColumn + tileColumn;
+                                const int64_t rgbaOffset = (static_cast<int64_t>(rowIndex) * numberOfColumns + columnIndex) * 4;
+                                CaretAssertVectorIndex(matrixRGBA, rgbaOffset + 3);
+                                CaretAssertVectorIndex(imageBytesRGBA, imageOffset + 3);
+                                if (isMatrixChartCellDisplayed(matrixViewMode,
+                                                               numberOfRows,
+                                                               numberOfColumns,
+                                                               rowIndex,
+                                                               columnIndex)) {
+                                    for (int32_t k = 0; k < 4; k++) {
+                                        imageBytesRGBA[imageOffset + k] = static_cast<uint8_t>(MathFunctions::clamp(matrixRGBA[rgbaOffset + k], 0.0f, 1.0f) * 255.0f + 0.5f);
+                                    }
+                                }
+                                imageOffset += 4;
+                            }
+                        }
+                        
+                        GraphicsPrimitiveV3fT3f* primitive = GraphicsPrimitive::newPrimitiveV3fT3f(GraphicsPrimitive::PrimitiveType::OPENGL_TRIANGLE_STRIP,
+                                                                                                   &imageBytesRGBA[0],
+                                                                                                   tileNumberOfColumns,
+                                                                                                   tileNumberOfRows);
+                        primitive->setTextureFilteringType(GraphicsPrimitive::TextureFilteringType::NEAREST);
+                        primitive->setUsageTypeAll(GraphicsPrimitive::UsageType::MODIFIED_ONCE_DRAWN_MANY_TIMES);
+                        
+                        /*
+                         * Row zero is at the top of the matrix.
+                         * Vertex order is Top Left, Bottom Left, Top Right, Bottom Right.
+                         */
+                        const float minX = tileFirstColumn;
+                        const float maxX = tileFirstColumn + tileNumberOfColumns;
+                        const float maxY = numberOfRows - tileFirstRow;
+                        const float minY = maxY - tileNumberOfRows;
+                        primitive->addVertex(minX, maxY, 0, 1);
+                        primitive->addVertex(minX, minY, 0, 0);
+                        primitive->addVertex(maxX, maxY, 1, 1);
+                        primitive->addVertex(maxX, minY, 1, 0);
+                        
+                        m_matrixTexturePrimitives.push_back(std::unique_ptr<GraphicsPrimitiveV3fT3f>(primitive));
+                    }
+                }
+                m_matrixTexturePrimitivesViewMode = matrixViewMode;
+            }
+        }
+    }
+    
+    for (auto& primitive : m_matrixTexturePrimitives) {
+        texturePrimitivesOut.push_back(primitive.get());
+    }
+}
+
+/**
+ * @return True if the matrix chart of this file is drawn with the level of
+ * detail texture pyramid.  Dense matrices are too large to color and
+ * hold in memory so only the tiles of the pyramid that are visible are
+ * loaded.
+ */
+bool
+CiftiMappableDataFile::isMatrixChartingLevelOfDetail() const
+{
+    switch (getDataFileType()) {
+        case DataFileTypeEnum::CONNECTIVITY_DENSE:
+        case DataFileTypeEnum::CONNECTIVITY_PARCEL_DENSE:
+            return true;
+        default:
+            break;
+    }
+    
+    return false;
+}
+
+/**
+ * Get the texture primitives for the visible region of a matrix drawn
+ * with the level of detail pyramid (see isMatrixChartingLevelOfDetail()).
+ * The pyramid is built the first time this method is called.  The level
+ * is chosen so that a texel is not smaller than a screen pixel and tiles
+ * of the level that overlap the visible region are loaded from the pyramid
+ * and colored.  Tiles are kept for later drawing and the least recently
+ * drawn tiles are removed when there are too many.
+ *
+ * Coordinates are those used by the other matrix primitives: each matrix
+ * cell is 1.0 x 1.0 and row zero is at the top.
+ *
+ * @param matrixViewMode
+ *     The matrix visualization mode (upper/lower).
+ * @param visibleMinX
+ *     Minimum visible X-coordinate.
+ * @param visibleMaxX
+ *     Maximum visible X-coordinate.
+ * @param visibleMinY
+ *     Minimum visible Y-coordinate.
+ * @param visibleMaxY
+ *     Maximum visible Y-coordinate.
+ * @param cellsPerPixel
+ *     Number of matrix cells in a screen pixel.
+ * @param texturePrimitivesOut
+ *     Output containing the visible texture tiles.
+ */
+void
+CiftiMappableDataFile::getMatrixChartingTexturePrimitives(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                          const float visibleMinX,
+                                                          const float visibleMaxX,
+                                                          const float visibleMinY,
+                                                          const float visibleMaxY,
+                                                          const float cellsPerPixel,
+                                                          std::vector<GraphicsPrimitiveV3fT3f*>& texturePrimitivesOut) const
+{
+    texturePrimitivesOut.clear();
+    
+    if ( ! isMatrixChartingLevelOfDetail()) {
+        getMatrixChartingTexturePrimitives(matrixViewMode,
+                                           texturePrimitivesOut);
+        return;
+    }
+    
+    if (m_ciftiFile == NULL) {
+        return;
+    }
+    
+    if ( ! m_matrixTexturePyramid) {
+        m_matrixTexturePyramid.reset(new CiftiMatrixTexturePyramid(m_ciftiFile));
+        
+        /*
+         * Building reads every row of the matrix
+         */
+        if (DataFile::isFileOnNetwork(getFileName())) {
+            CaretLogSevere("Matrix chart of "
+                           + getFileNameNoPath()
+                           + " is not available for files on the network, the entire file must be read.");
+        }
+        else {
+            AString errorMessage;
+            if ( ! m_matrixTexturePyramid->build(errorMessage)) {
+                CaretLogSevere("Unable to create matrix chart for "
+                               + getFileNameNoPath()
+                               + ": "
+                               + errorMessage);
+            }
+        }
+    }
+    if ( ! m_matrixTexturePyramid->isValid()) {
+        return;
+    }
+    
+    if (matrixViewMode != m_matrixTexturePrimitivesViewMode) {
+        m_matrixLevelOfDetailTiles.clear();
+        m_matrixTexturePrimitivesViewMode = matrixViewMode;
+    }
+    
+    const int64_t numberOfRows    = m_matrixTexturePyramid->getNumberOfRows();
+    const int64_t numberOfColumns = m_matrixTexturePyramid->getNumberOfColumns();
+    
+    if ((visibleMaxX <= 0.0f)
+        || (visibleMinX >= numberOfColumns)
+        || (visibleMaxY <= 0.0f)
+        || (visibleMinY >= numberOfRows)) {
+        return;
+    }
+    
+    /*
+     * Visible rows and columns.  Row zero is at the top.
+     */
+    const int64_t firstColumn = std::max(static_cast<int64_t>(std::floor(visibleMinX)),
+                                         static_cast<int64_t>(0));
+    const int64_t lastColumn  = std::min(static_cast<int64_t>(std::ceil(visibleMaxX)),
+                                         numberOfColumns) - 1;
+    const int64_t firstRow    = std::max(numberOfRows - static_cast<int64_t>(std::ceil(visibleMaxY)),
+                                         static_cast<int64_t>(0));
+    const int64_t lastRow     = std::min(numberOfRows - static_cast<int64_t>(std::floor(visibleMinY)),
+                                         numberOfRows) - 1;
+    
+    const int32_t level = m_matrixTexturePyramid->getLevelForCellsPerPixel(cellsPerPixel);
+    const int64_t tileCells = (static_cast<int64_t>(m_matrixTexturePyramid->getLevelCellSize(level))
+                               * CiftiMatrixTexturePyramid::TILE_DIMENSION);
+    const int32_t firstTileRow    = static_cast<int32_t>(firstRow / tileCells);
+    const int32_t lastTileRow     = static_cast<int32_t>(lastRow / tileCells);
+    const int32_t firstTileColumn = static_cast<int32_t>(firstColumn / tileCells);
+    const int32_t lastTileColumn  = static_cast<int32_t>(lastColumn / tileCells);
+    
+    m_matrixLevelOfDetailDrawCounter++;
+    
+    for (int32_t tileRow = firstTileRow; tileRow <= lastTileRow; tileRow++) {
+        /*
+         * Tiles not previously loaded in this row of tiles are
+         * read together since their data comes from the same rows
+         */
+        int32_t firstMissingTileColumn = -1;
+        int32_t lastMissingTileColumn  = -1;
+        for (int32_t tileColumn = firstTileColumn; tileColumn <= lastTileColumn; tileColumn++) {
+            if (m_matrixLevelOfDetailTiles.find(std::make_tuple(level, tileRow, tileColumn))
+                == m_matrixLevelOfDetailTiles.end()) {
+                if (firstMissingTileColumn < 0) {
+                    firstMissingTileColumn = tileColumn;
+                }
+                lastMissingTileColumn = tileColumn;
+            }
+        }
+        
+        if (firstMissingTileColumn >= 0) {
+            std::vector<std::vector<float>> tilesData;
+            AString errorMessage;
+            if ( ! m_matrixTexturePyramid->getTileData(level,
+                                                       tileRow,
+                                                       firstMissingTileColumn,
+                                                       lastMissingTileColumn,
+                                                       tilesData,
+                                                       errorMessage)) {
+                CaretLogSevere("Unable to load matrix chart tiles for "
+                               + getFileNameNoPath()
+                               + ": "
+                               + errorMessage);
+                return;
+            }
+            
+            for (int32_t tileColumn = firstMissingTileColumn; tileColumn <= lastMissingTileColumn; tileColumn++) {
+                const auto key = std::make_tuple(level, tileRow, tileColumn);
+                if (m_matrixLevelOfDetailTiles.find(key) == m_matrixLevelOfDetailTiles.end()) {
+                    const int32_t tileIndex = tileColumn - firstMissingTileColumn;
+                    CaretAssertVectorIndex(tilesData, tileIndex);
+                    GraphicsPrimitiveV3fT3f* primitive = createMatrixLevelOfDetailTexturePrimitive(matrixViewMode,
+                                                                                                   level,
+                                                                                                   tileRow,
+                                                                                                   tileColumn,
+                                                                                                   tilesData[tileIndex]);
+                    if (primitive == NULL) {
+                        return;
+                    }
+                    m_matrixLevelOfDetailTiles[key].m_primitive.reset(primitive);
+                }
+            }
+        }
+        
+        for (int32_t tileColumn = firstTileColumn; tileColumn <= lastTileColumn; tileColumn++) {
+            auto iter = m_matrixLevelOfDetailTiles.find(std::make_tuple(level, tileRow, tileColumn));
+            CaretAssert(iter != m_matrixLevelOfDetailTiles.end());
+            iter->second.m_lastDrawnCounter = m_matrixLevelOfDetailDrawCounter;
+            texturePrimitivesOut.push_back(iter->second.m_primitive.get());
+        }
+    }
+    
+    /*
+     * Remove the least recently drawn tiles but never the tiles being drawn
+     */
+    const int64_t numberOfTilesToRemove = (static_cast<int64_t>(m_matrixLevelOfDetailTiles.size())
+                                           - std::max(static_cast<int64_t>(MAXIMUM_NUMBER_OF_MATRIX_LEVEL_OF_DETAIL_TILES),
+                                                      static_cast<int64_t>(texturePrimitivesOut.size())));
+    if (numberOfTilesToRemove > 0) {
+        std::vector<std::pair<int64_t, std::tuple<int32_t, int32_t, int32_t>>> drawnCounterAndKeys;
+        for (const auto& keyAndTile : m_matrixLevelOfDetailTiles) {
+            drawnCounterAndKeys.push_back(std::make_pair(keyAndTile.second.m_lastDrawnCounter,
+                                                         keyAndTile.first));
+        }
+        std::sort(drawnCounterAndKeys.begin(),
+                  drawnCounterAndKeys.end());
+        for (int64_t i = 0; i < numberOfTilesToRemove; i++) {
+            CaretAssertVectorIndex(drawnCounterAndKeys, i);
+            CaretAssert(drawnCounterAndKeys[i].first < m_matrixLevelOfDetailDrawCounter);
+            m_matrixLevelOfDetailTiles.erase(drawnCounterAndKeys[i].second);
+        }
+    }
+}
+
+/**
+ * Create a texture primitive for a tile of the level of detail pyramid.
+ * The tile's data is colored with the palette of the file and the statistics
+ * of the pyramid.  Texels without data and texels not displayed due to the
+ * triangular view are transparent.
+ *
+ * @param matrixViewMode
+ *     The matrix visualization mode (upper/lower).
+ * @param level
+ *     Level of the tile in the pyramid.
+ * @param tileRow
+ *     Row of the tile.
+ * @param tileColumn
+ *     Column of the tile.
+ * @param tileData
+ *     Data for the tile from the pyramid.
+ * @return
+ *     The primitive or NULL if there is an error.
+ */
+GraphicsPrimitiveV3fT3f*
+CiftiMappableDataFile::createMatrixLevelOfDetailTexturePrimitive(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                                 const int32_t level,
+                                                                 const int32_t tileRow,
+                                                                 const int32_t tileColumn,
+                                                                 const std::vector<float>& tileData) const
+{
+    CaretAssert(m_matrixTexturePyramid);
+    
+    if ( ! isMappedWithPalette()) {
+        CaretAssertMessage(0, "Only palette mapped files supported at this time.");
+        return NULL;
+    }
+    if (getNumberOfMaps() <= 0) {
+        return NULL;
+    }
+    const PaletteColorMapping* pcm = getMapPaletteColorMapping(0);
+    CaretAssert(pcm);
+    const AString paletteName = pcm->getSelectedPaletteName();
+    EventPaletteGetByName eventPaletteGetName(paletteName);
+    EventManager::get()->sendEvent(eventPaletteGetName.getPointer());
+    const Palette* palette = eventPaletteGetName.getPalette();
+    if (palette == NULL) {
+        CaretLogSevere("No palette named "
+                       + paletteName
+                       + " found for coloring matrix chart data.");
+        return NULL;
+    }
+    
+    int32_t tileNumberOfRows = 0;
+    int32_t tileNumberOfColumns = 0;
+    m_matrixTexturePyramid->getTileDimensions(level,
+                                              tileRow,
+                                              tileColumn,
+                                              tileNumberOfRows,
+                                              tileNumberOfColumns);
+    const int64_t numberOfTexels = static_cast<int64_t>(tileNumberOfRows) * tileNumberOfColumns;
+    CaretAssert(static_cast<int64_t>(tileData.size()) == numberOfTexels);
+    if (numberOfTexels <= 0) {
+        return NULL;
+    }
+    
+    std::vector<uint8_t> tileRGBA(numberOfTexels * 4);
+    NodeAndVoxelColoring::colorScalarsWithPalette(m_matrixTexturePyramid->getFastStatistics(),
+                                                  pcm,
+                                                  palette,
+                                                  &tileData[0],
+                                                  &tileData[0],
+                                                  numberOfTexels,
+                                                  &tileRGBA[0]);
+    
+    const int64_t numberOfRows    = m_matrixTexturePyramid->getNumberOfRows();
+    const int64_t numberOfColumns = m_matrixTexturePyramid->getNumberOfColumns();
+    const int64_t cellSize        = m_matrixTexturePyramid->getLevelCellSize(level);
+    const int64_t tileFirstRow    = static_cast<int64_t>(tileRow) * CiftiMatrixTexturePyramid::TILE_DIMENSION * cellSize;
+    const int64_t tileFirstColumn = static_cast<int64_t>(tileColumn) * CiftiMatrixTexturePyramid::TILE_DIMENSION * cellSize;
+    
+    /*
+     * First row of texture image is at the bottom
+     * so the last row of the tile is first.
+     * A texel is displayed if the matrix cell at its
+     * center is displayed.
+     */
+    std::vector<uint8_t> imageBytesRGBA(numberOfTexels * 4, 0);
+    int64_t imageOffset = 0;
+    for (int32_t iRow = tileNumberOfRows - 1; iRow >= 0; iRow--) {
+        const int64_t rowIndex = std::min(tileFirstRow + (iRow * cellSize) + (cellSize / 2),
+                                          numberOfRows - 1);
+        for (int32_t jCol = 0; jCol < tileNumberOfColumns; jCol++) {
+            const int64_t columnIndex = std::min(tileFirstColumn + (jCol * cellSize) + (cellSize / 2),
+                                                 numberOfColumns - 1);
+            const int64_t texelOffset = (static_cast<int64_t>(iRow) * tileNumberOfColumns) + jCol;
+            CaretAssertVectorIndex(tileData, texelOffset);
+            CaretAssertVectorIndex(imageBytesRGBA, imageOffset + 3);
+            if (std::isfinite(tileData[texelOffset])
+                && isMatrixChartCellDisplayed(matrixViewMode,
+                                              static_cast<int32_t>(numberOfRows),
+                                              static_cast<int32_t>(numberOfColumns),
+                                              static_cast<int32_t>(rowIndex),
+                                              static_cast<int32_t>(columnIndex))) {
+                for (int32_t k = 0; k < 4; k++) {
+                    imageBytesRGBA[imageOffset + k] = tileRGBA[texelOffset * 4 + k];
+                }
+            }
+            imageOffset += 4;
+        }
+    }
+    
+    GraphicsPrimitiveV3fT3f* primitive = GraphicsPrimitive::newPrimitiveV3fT3f(GraphicsPrimitive::PrimitiveType::OPENGL_TRIANGLE_STRIP,
+                                                                               &imageBytesRGBA[0],
+                                                                               tileNumberOfColumns,
+                                                                               tileNumberOfRows);
+    primitive->setTextureFilteringType(GraphicsPrimitive::TextureFilteringType::NEAREST);
+    primitive->setUsageTypeAll(GraphicsPrimitive::UsageType::MODIFIED_ONCE_DRAWN_MANY_TIMES);
+    
+    /*
+     * Row zero is at the top of the matrix.  The last row
+     * and column of a coarse level may cover fewer cells.
+     * Vertex order is Top Left, Bottom Left, Top Right, Bottom Right.
+     */
+    const float minX = tileFirstColumn;
+    const float maxX = std::min(tileFirstColumn + (tileNumberOfColumns * cellSize),
+                                numberOfColumns);
+    const float maxY = numberOfRows - tileFirstRow;
+    const float minY = numberOfRows - std::min(tileFirstRow + (tileNumberOfRows * cellSize),
+                                               numberOfRows);
+    primitive->addVertex(minX, maxY, 0, 1);
+    primitive->addVertex(minX, minY, 0, 0);
+    primitive->addVertex(maxX, maxY, 1, 1);
+    primitive->addVertex(maxX, minY, 1, 0);
+    
+    return primitive;
+}
+
+
 /**
  * Get the matrix RGBA coloring for this matrix data creator.
  *
@@ -2516,6 +3025,8 @@ CiftiMappableDataFile::updateScalarColoringForMap(const int32_t mapIndex,
     invalidateHistogramChartColoring();
     m_matrixGraphicsPrimitive.reset();
     m_matrixGraphicsOutlinePrimitive.reset();
+    m_matrixTexturePrimitives.clear();
+    m_matrixLevelOfDetailTiles.clear();
 }
 
 /**
@@ -31,18 +31,22 @@
 #include "EventListenerInterface.h"
 #include "VolumeMappableInterface.h"
 
+#include <map>
 #include <memory>
 #include <set>
+#include <tuple>
 
 namespace caret {
     
     class ChartData;
     class ChartDataCartesian;
     class CiftiFile;
+    class CiftiMatrixTexturePyramid;
     class CiftiParcelsMap;
     class CiftiXML;
     class FastStatistics;
     class GraphicsPrimitiveV3fC4f;
+    class GraphicsPrimitiveV3fT3f;
     class GroupAndNameHierarchyModel;
     class Histogram;
     class SparseVolumeIndexer;
@@ -497,6 +501,19 @@ namespace caret {
         GraphicsPrimitiveV3fC4f* getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
                                                                     const MatrixGridMode gridMode) const;
         
+        void getMatrixChartingTexturePrimitives(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                std::vector<GraphicsPrimitiveV3fT3f*>& texturePrimitivesOut) const;
+        
+        bool isMatrixChartingLevelOfDetail() const;
+        
+        void getMatrixChartingTexturePrimitives(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                const float visibleMinX,
+                                                const float visibleMaxX,
+                                                const float visibleMinY,
+                                                const float visibleMaxY,
+                                                const float cellsPerPixel,
+                                                std::vector<GraphicsPrimitiveV3fT3f*>& texturePrimitivesOut) const;
+        
         /** Identifier for the matrix primitives alternative color used for the grid coloring */
         int32_t getMatrixChartGraphicsPrimitiveGridColorIdentifier() const { return 1; }
         
@@ -681,6 +698,12 @@ namespace caret {
         void setupCiftiReadingMappingDirection();
         
         static AString mappingTypeToName(const CiftiMappingType::MappingType mappingType);
+        
+        static bool isMatrixChartCellDisplayed(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                               const int32_t numberOfRows,
+                                               const int32_t numberOfColumns,
+                                               const int32_t rowIndex,
+                                               const int32_t columnIndex);
 
         /**
          * Point to the CIFTI file object.
@@ -755,6 +778,36 @@ namespace caret {
         /** Primitive for grid outline around matrix cells */
         mutable std::unique_ptr<GraphicsPrimitiveV3fC4f> m_matrixGraphicsOutlinePrimitive;
         
+        /** Texture tiles for matrix cells, one texel per cell */
+        mutable std::vector<std::unique_ptr<GraphicsPrimitiveV3fT3f>> m_matrixTexturePrimitives;
+        
+        /** Viewing mode used when the texture tiles were created */
+        mutable ChartTwoMatrixTriangularViewingModeEnum::Enum m_matrixTexturePrimitivesViewMode = ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL;
+        
+        /** A texture tile of the level of detail pyramid and when it was last drawn */
+        struct MatrixLevelOfDetailTile {
+            std::unique_ptr<GraphicsPrimitiveV3fT3f> m_primitive;
+            int64_t m_lastDrawnCounter = 0;
+        };
+        
+        GraphicsPrimitiveV3fT3f* createMatrixLevelOfDetailTexturePrimitive(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                                           const int32_t level,
+                                                                           const int32_t tileRow,
+                                                                           const int32_t tileColumn,
+                                                                           const std::vector<float>& tileData) const;
+        
+        /** Level of detail pyramid for charting dense matrices that are too large for memory */
+        mutable std::unique_ptr<CiftiMatrixTexturePyramid> m_matrixTexturePyramid;
+        
+        /** Texture tiles of the pyramid that have been drawn, key is level, tile row, tile column */
+        mutable std::map<std::tuple<int32_t, int32_t, int32_t>, MatrixLevelOfDetailTile> m_matrixLevelOfDetailTiles;
+        
+        /** Incremented each time level of detail tiles are requested */
+        mutable int64_t m_matrixLevelOfDetailDrawCounter = 0;
+        
+        /** Maximum number of level of detail tiles kept after drawing */
+        static const int32_t MAXIMUM_NUMBER_OF_MATRIX_LEVEL_OF_DETAIL_TILES;
+        
         mutable uint8_t m_previousMatrixGridRGBA[4] = { 0, 1, 2, 3 };
         
         int32_t m_fileHistogramNumberOfBuckets = 100;
@@ -798,6 +851,7 @@ namespace caret {
     
 #ifdef __CIFTI_MAPPABLE_DATA_FILE_DECLARE__
     const int32_t CiftiMappableDataFile::S_CIFTI_XML_ALONG_INVALID = -1;
+    const int32_t CiftiMappableDataFile::MAXIMUM_NUMBER_OF_MATRIX_LEVEL_OF_DETAIL_TILES = 256;
 #endif // __CIFTI_MAPPABLE_DATA_FILE_DECLARE__
     
 } // namespace
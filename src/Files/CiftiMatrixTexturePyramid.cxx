@@ -0,0 +1,713 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __CIFTI_MATRIX_TEXTURE_PYRAMID_DECLARE__
+#include "CiftiMatrixTexturePyramid.h"
+#undef __CIFTI_MATRIX_TEXTURE_PYRAMID_DECLARE__
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <QDir>
+#include <QTemporaryFile>
+
+#include "CaretAssert.h"
+#include "CaretException.h"
+#include "CaretLogger.h"
+#include "CiftiFile.h"
+#include "ElapsedTimer.h"
+#include "FastStatistics.h"
+
+using namespace caret;
+
+
+    
+/**
+ * \class caret::CiftiMatrixTexturePyramid 
+ * \brief Multi-resolution (level of detail) pyramid for charting a large CIFTI matrix.
+ * \ingroup Files
+ *
+ * Dense and parcel-dense matrices are too large to chart with a texel
+ * for every cell (a 91k x 91k matrix is about 33 GB of RGBA).  Level
+ * zero is the matrix and each following level halves the number of
+ * rows and columns with each texel containing the mean of the finite
+ * values in the 2 x 2 texels of the previous level.  Levels continue
+ * until a level fits in one tile.
+ *
+ * The pyramid is built with one pass through the file's rows so that
+ * the matrix is never in memory.  The coarser levels are written, in
+ * tiles, to a temporary cache file.  The finest levels, that would make
+ * the cache file nearly as large as the matrix, are not stored and
+ * their tiles are computed from the file's rows when they are visible.
+ *
+ * Texels contain data values, not colors, so that changes to the
+ * palette do not require rebuilding the pyramid.  A sample of the
+ * matrix values is collected while building for the statistics that
+ * are used by palette color mapping.
+ */
+
+/**
+ * Constructor.
+ *
+ * @param ciftiFile
+ *     The CIFTI file whose rows are read.  Must remain valid
+ *     for the life of this instance.
+ */
+CiftiMatrixTexturePyramid::CiftiMatrixTexturePyramid(const CiftiFile* ciftiFile)
+: CaretObject(),
+m_ciftiFile(ciftiFile)
+{
+    CaretAssert(m_ciftiFile);
+    
+    m_numberOfRows    = m_ciftiFile->getNumberOfRows();
+    m_numberOfColumns = m_ciftiFile->getNumberOfColumns();
+    
+    m_numberOfLevels = 1;
+    while ((getLevelNumberOfRows(m_numberOfLevels - 1) > TILE_DIMENSION)
+           || (getLevelNumberOfColumns(m_numberOfLevels - 1) > TILE_DIMENSION)) {
+        m_numberOfLevels++;
+    }
+    
+    m_firstStoredLevel = FIRST_STORED_LEVEL;
+}
+
+/**
+ * Destructor.
+ */
+CiftiMatrixTexturePyramid::~CiftiMatrixTexturePyramid()
+{
+}
+
+/**
+ * @return True if the pyramid was successfully built.
+ */
+bool
+CiftiMatrixTexturePyramid::isValid() const
+{
+    return m_validFlag;
+}
+
+/**
+ * @return Number of rows in the matrix.
+ */
+int64_t
+CiftiMatrixTexturePyramid::getNumberOfRows() const
+{
+    return m_numberOfRows;
+}
+
+/**
+ * @return Number of columns in the matrix.
+ */
+int64_t
+CiftiMatrixTexturePyramid::getNumberOfColumns() const
+{
+    return m_numberOfColumns;
+}
+
+/**
+ * @return Number of levels in the pyramid.
+ */
+int32_t
+CiftiMatrixTexturePyramid::getNumberOfLevels() const
+{
+    return m_numberOfLevels;
+}
+
+/**
+ * @return Number of matrix rows (and columns) covered by one texel
+ * in the given level.
+ *
+ * @param level
+ *     Index of the level.
+ */
+int32_t
+CiftiMatrixTexturePyramid::getLevelCellSize(const int32_t level) const
+{
+    CaretAssert((level >= 0) && (level < 31));
+    return (1 << level);
+}
+
+/**
+ * @return Number of texel rows in the given level.
+ *
+ * @param level
+ *     Index of the level.
+ */
+int64_t
+CiftiMatrixTexturePyramid::getLevelNumberOfRows(const int32_t level) const
+{
+    const int64_t cellSize = getLevelCellSize(level);
+    return ((m_numberOfRows + cellSize - 1) / cellSize);
+}
+
+/**
+ * @return Number of texel columns in the given level.
+ *
+ * @param level
+ *     Index of the level.
+ */
+int64_t
+CiftiMatrixTexturePyramid::getLevelNumberOfColumns(const int32_t level) const
+{
+    const int64_t cellSize = getLevelCellSize(level);
+    return ((m_numberOfColumns + cellSize - 1) / cellSize);
+}
+
+/**
+ * @return Number of rows of tiles in the given level.
+ *
+ * @param level
+ *     Index of the level.
+ */
+int32_t
+CiftiMatrixTexturePyramid::getLevelNumberOfTileRows(const int32_t level) const
+{
+    return static_cast<int32_t>((getLevelNumberOfRows(level) + TILE_DIMENSION - 1) / TILE_DIMENSION);
+}
+
+/**
+ * @return Number of columns of tiles in the given level.
+ *
+ * @param level
+ *     Index of the level.
+ */
+int32_t
+CiftiMatrixTexturePyramid::getLevelNumberOfTileColumns(const int32_t level) const
+{
+    return static_cast<int32_t>((getLevelNumberOfColumns(level) + TILE_DIMENSION - 1) / TILE_DIMENSION);
+}
+
+/**
+ * Get the level for drawing with the given number of matrix cells per
+ * screen pixel.  It is the finest level whose texels are not smaller
+ * than a pixel.
+ *
+ * @param cellsPerPixel
+ *     Number of matrix cells per screen pixel.
+ * @return
+ *     Index of the level.
+ */
+int32_t
+CiftiMatrixTexturePyramid::getLevelForCellsPerPixel(const float cellsPerPixel) const
+{
+    int32_t level = 0;
+    while ((level < (m_numberOfLevels - 1))
+           && (getLevelCellSize(level) < cellsPerPixel)) {
+        level++;
+    }
+    
+    return level;
+}
+
+/**
+ * Get the number of texel rows and columns in a tile.  Tiles
+ * at the bottom and right of a level may be smaller than
+ * TILE_DIMENSION.
+ *
+ * @param level
+ *     Index of the level.
+ * @param tileRow
+ *     Row of the tile.
+ * @param tileColumn
+ *     Column of the tile.
+ * @param numberOfRowsOut
+ *     Output with number of texel rows in the tile.
+ * @param numberOfColumnsOut
+ *     Output with number of texel columns in the tile.
+ */
+void
+CiftiMatrixTexturePyramid::getTileDimensions(const int32_t level,
+                                             const int32_t tileRow,
+                                             const int32_t tileColumn,
+                                             int32_t& numberOfRowsOut,
+                                             int32_t& numberOfColumnsOut) const
+{
+    const int64_t firstRow    = static_cast<int64_t>(tileRow) * TILE_DIMENSION;
+    const int64_t firstColumn = static_cast<int64_t>(tileColumn) * TILE_DIMENSION;
+    numberOfRowsOut    = static_cast<int32_t>(std::min(static_cast<int64_t>(TILE_DIMENSION),
+                                                       getLevelNumberOfRows(level) - firstRow));
+    numberOfColumnsOut = static_cast<int32_t>(std::min(static_cast<int64_t>(TILE_DIMENSION),
+                                                       getLevelNumberOfColumns(level) - firstColumn));
+}
+
+/**
+ * @return Statistics, from a sample of the matrix values,
+ * for palette color mapping.  NULL if the pyramid is not valid.
+ */
+const FastStatistics*
+CiftiMatrixTexturePyramid::getFastStatistics() const
+{
+    return m_fastStatistics.get();
+}
+
+/**
+ * @return Offset of a tile in the cache file.  Every tile occupies
+ * TILE_DIMENSION x TILE_DIMENSION texels in the file.
+ *
+ * @param level
+ *     Index of the level (must be a stored level).
+ * @param tileRow
+ *     Row of the tile.
+ * @param tileColumn
+ *     Column of the tile.
+ */
+int64_t
+CiftiMatrixTexturePyramid::getTileFileOffset(const int32_t level,
+                                             const int32_t tileRow,
+                                             const int32_t tileColumn) const
+{
+    const int32_t storedLevelIndex = level - m_firstStoredLevel;
+    CaretAssertVectorIndex(m_levelFileOffsets, storedLevelIndex);
+    
+    const int64_t tileIndex = (static_cast<int64_t>(tileRow) * getLevelNumberOfTileColumns(level)) + tileColumn;
+    const int64_t tileSizeInBytes = static_cast<int64_t>(TILE_DIMENSION) * TILE_DIMENSION * sizeof(float);
+    
+    return (m_levelFileOffsets[storedLevelIndex]
+            + (tileIndex * tileSizeInBytes));
+}
+
+/**
+ * Build the pyramid with one pass through the rows of the file.
+ *
+ * @param errorMessageOut
+ *     Output with error message if building fails.
+ * @return
+ *     True if the pyramid was built, else false.
+ */
+bool
+CiftiMatrixTexturePyramid::build(AString& errorMessageOut)
+{
+    errorMessageOut.clear();
+    m_validFlag = false;
+    m_fastStatistics.reset();
+    m_cacheFile.reset();
+    m_levelFileOffsets.clear();
+    
+    if ((m_numberOfRows <= 0)
+        || (m_numberOfColumns <= 0)) {
+        errorMessageOut = "Matrix is empty.";
+        return false;
+    }
+    
+    ElapsedTimer timer;
+    timer.start();
+    
+    /*
+     * Reserve space for the tiles of the stored levels
+     */
+    if (m_numberOfLevels > m_firstStoredLevel) {
+        const int64_t tileSizeInBytes = static_cast<int64_t>(TILE_DIMENSION) * TILE_DIMENSION * sizeof(float);
+        int64_t levelOffset = 0;
+        for (int32_t level = m_firstStoredLevel; level < m_numberOfLevels; level++) {
+            m_levelFileOffsets.push_back(levelOffset);
+            levelOffset += (static_cast<int64_t>(getLevelNumberOfTileRows(level))
+                            * getLevelNumberOfTileColumns(level)
+                            * tileSizeInBytes);
+        }
+        
+        m_cacheFile.reset(new QTemporaryFile(QDir::tempPath()
+                                             + "/wb_matrix_pyramid_XXXXXX"));
+        if ( ! m_cacheFile->open()) {
+            errorMessageOut = ("Unable to create matrix cache file: "
+                               + m_cacheFile->errorString());
+            m_cacheFile.reset();
+            return false;
+        }
+    }
+    
+    /*
+     * Every sampleStride value is kept for the statistics
+     */
+    const int64_t numberOfValues = m_numberOfRows * m_numberOfColumns;
+    const int64_t sampleStride = std::max(static_cast<int64_t>(1),
+                                          (numberOfValues + MAXIMUM_STATISTICS_SAMPLE_SIZE - 1) / MAXIMUM_STATISTICS_SAMPLE_SIZE);
+    std::vector<float> sampleValues;
+    sampleValues.reserve(std::min(numberOfValues, MAXIMUM_STATISTICS_SAMPLE_SIZE) + 1);
+    
+    /*
+     * Row of each level that is being accumulated (level zero is the file's row)
+     * and band of rows for each stored level that is written when it fills a row
+     * of tiles.
+     */
+    std::vector<LevelRow> levelRows(m_numberOfLevels);
+    std::vector<std::vector<float>> levelBands(m_numberOfLevels);
+    std::vector<int32_t> levelBandNumberOfRows(m_numberOfLevels, 0);
+    std::vector<int32_t> levelBandTileRow(m_numberOfLevels, 0);
+    for (int32_t level = 1; level < m_numberOfLevels; level++) {
+        const int64_t numberOfColumns = getLevelNumberOfColumns(level);
+        levelRows[level].m_sums.assign(numberOfColumns, 0.0);
+        levelRows[level].m_counts.assign(numberOfColumns, 0);
+        if (level >= m_firstStoredLevel) {
+            levelBands[level].resize(static_cast<int64_t>(TILE_DIMENSION) * numberOfColumns);
+        }
+    }
+    
+    std::vector<float> rowData(m_numberOfColumns);
+    
+    try {
+        for (int64_t iRow = 0; iRow < m_numberOfRows; iRow++) {
+            m_ciftiFile->getRow(&rowData[0],
+                                iRow);
+            
+            const int64_t rowOffset = iRow * m_numberOfColumns;
+            for (int64_t jCol = (sampleStride - (rowOffset % sampleStride)) % sampleStride;
+                 jCol < m_numberOfColumns;
+                 jCol += sampleStride) {
+                sampleValues.push_back(rowData[jCol]);
+            }
+            
+            if (m_numberOfLevels < 2) {
+                continue;
+            }
+            
+            /*
+             * Add the file's row to the row of level one
+             */
+            LevelRow& levelOneRow = levelRows[1];
+            for (int64_t jCol = 0; jCol < m_numberOfColumns; jCol++) {
+                const float value = rowData[jCol];
+                if (std::isfinite(value)) {
+                    const int64_t levelColumn = jCol / 2;
+                    levelOneRow.m_sums[levelColumn] += value;
+                    levelOneRow.m_counts[levelColumn]++;
+                }
+            }
+            levelOneRow.m_numberOfSourceRows++;
+            
+            /*
+             * A row of a level is complete after two rows of the
+             * previous level or at the end of the matrix.  A completed
+             * row is added to the next level.
+             */
+            const bool lastRowFlag = (iRow == (m_numberOfRows - 1));
+            for (int32_t level = 1; level < m_numberOfLevels; level++) {
+                LevelRow& levelRow = levelRows[level];
+                if (levelRow.m_numberOfSourceRows < 2) {
+                    if (( ! lastRowFlag)
+                        || (levelRow.m_numberOfSourceRows == 0)) {
+                        break;
+                    }
+                }
+                
+                const int64_t numberOfLevelColumns = getLevelNumberOfColumns(level);
+                
+                if (level >= m_firstStoredLevel) {
+                    std::vector<float>& band = levelBands[level];
+                    const int64_t bandOffset = static_cast<int64_t>(levelBandNumberOfRows[level]) * numberOfLevelColumns;
+                    for (int64_t jCol = 0; jCol < numberOfLevelColumns; jCol++) {
+                        CaretAssertVectorIndex(band, bandOffset + jCol);
+                        band[bandOffset + jCol] = ((levelRow.m_counts[jCol] > 0)
+                                                   ? static_cast<float>(levelRow.m_sums[jCol] / levelRow.m_counts[jCol])
+                                                   : std::numeric_limits<float>::quiet_NaN());
+                    }
+                    levelBandNumberOfRows[level]++;
+                    
+                    if ((levelBandNumberOfRows[level] == TILE_DIMENSION)
+                        || lastRowFlag) {
+                        if ( ! writeTileBand(level,
+                                             levelBandTileRow[level],
+                                             band,
+                                             levelBandNumberOfRows[level],
+                                             errorMessageOut)) {
+                            m_cacheFile.reset();
+                            return false;
+                        }
+                        levelBandNumberOfRows[level] = 0;
+                        levelBandTileRow[level]++;
+                    }
+                }
+                
+                if (level < (m_numberOfLevels - 1)) {
+                    LevelRow& nextLevelRow = levelRows[level + 1];
+                    for (int64_t jCol = 0; jCol < numberOfLevelColumns; jCol++) {
+                        const int64_t nextLevelColumn = jCol / 2;
+                        nextLevelRow.m_sums[nextLevelColumn]   += levelRow.m_sums[jCol];
+                        nextLevelRow.m_counts[nextLevelColumn] += levelRow.m_counts[jCol];
+                    }
+                    nextLevelRow.m_numberOfSourceRows++;
+                }
+                
+                std::fill(levelRow.m_sums.begin(), levelRow.m_sums.end(), 0.0);
+                std::fill(levelRow.m_counts.begin(), levelRow.m_counts.end(), 0);
+                levelRow.m_numberOfSourceRows = 0;
+            }
+        }
+    }
+    catch (const CaretException& e) {
+        errorMessageOut = ("Error reading matrix rows: "
+                           + e.whatString());
+        m_cacheFile.reset();
+        return false;
+    }
+    
+    if (m_cacheFile) {
+        if ( ! m_cacheFile->flush()) {
+            errorMessageOut = ("Error writing matrix cache file: "
+                               + m_cacheFile->errorString());
+            m_cacheFile.reset();
+            return false;
+        }
+    }
+    
+    if (sampleValues.empty()) {
+        m_fastStatistics.reset(new FastStatistics());
+    }
+    else {
+        m_fastStatistics.reset(new FastStatistics(&sampleValues[0],
+                                                  sampleValues.size()));
+    }
+    
+    m_validFlag = true;
+    
+    CaretLogInfo("Time to build matrix level of detail pyramid with "
+                 + AString::number(m_numberOfLevels)
+                 + " levels for "
+                 + AString::number(m_numberOfRows)
+                 + " x "
+                 + AString::number(m_numberOfColumns)
+                 + " matrix: "
+                 + AString::number(timer.getElapsedTimeSeconds())
+                 + " seconds.");
+    
+    return true;
+}
+
+/**
+ * Write a band (row of tiles) of a stored level to the cache file.
+ *
+ * @param level
+ *     Index of the level.
+ * @param tileRow
+ *     Row of the tiles.
+ * @param bandData
+ *     Data for the band with the level's number of columns in each row.
+ * @param bandNumberOfRows
+ *     Number of rows in the band.
+ * @param errorMessageOut
+ *     Output with error message if writing fails.
+ * @return
+ *     True if successful, else false.
+ */
+bool
+CiftiMatrixTexturePyramid::writeTileBand(const int32_t level,
+                                         const int32_t tileRow,
+                                         const std::vector<float>& bandData,
+                                         const int32_t bandNumberOfRows,
+                                         AString& errorMessageOut)
+{
+    CaretAssert(m_cacheFile);
+    
+    const int64_t numberOfLevelColumns = getLevelNumberOfColumns(level);
+    const int32_t numberOfTileColumns  = getLevelNumberOfTileColumns(level);
+    
+    std::vector<float> tileData(static_cast<int64_t>(TILE_DIMENSION) * TILE_DIMENSION);
+    for (int32_t tileColumn = 0; tileColumn < numberOfTileColumns; tileColumn++) {
+        int32_t tileNumberOfRows = 0;
+        int32_t tileNumberOfColumns = 0;
+        getTileDimensions(level,
+                          tileRow,
+                          tileColumn,
+                          tileNumberOfRows,
+                          tileNumberOfColumns);
+        CaretAssert(tileNumberOfRows == bandNumberOfRows);
+        
+        const int64_t firstColumn = static_cast<int64_t>(tileColumn) * TILE_DIMENSION;
+        int64_t tileOffset = 0;
+        for (int32_t iRow = 0; iRow < bandNumberOfRows; iRow++) {
+            const int64_t bandOffset = (iRow * numberOfLevelColumns) + firstColumn;
+            for (int32_t jCol = 0; jCol < tileNumberOfColumns; jCol++) {
+                CaretAssertVectorIndex(bandData, bandOffset + jCol);
+                CaretAssertVectorIndex(tileData, tileOffset);
+                tileData[tileOffset] = bandData[bandOffset + jCol];
+                tileOffset++;
+            }
+        }
+        
+        const int64_t numberOfBytes = tileOffset * sizeof(float);
+        if (( ! m_cacheFile->seek(getTileFileOffset(level, tileRow, tileColumn)))
+            || (m_cacheFile->write(reinterpret_cast<const char*>(&tileData[0]),
+                                   numberOfBytes) != numberOfBytes)) {
+            errorMessageOut = ("Error writing matrix cache file: "
+                               + m_cacheFile->errorString());
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * Get the data for a range of tiles in a row of tiles.  Data for a tile
+ * contains the tile's rows, top row first, with the tile's number of
+ * columns in each row (see getTileDimensions()).  A texel containing
+ * no finite values is NaN.
+ *
+ * Tiles of the stored levels are read from the cache file.  Tiles of the
+ * finer levels are computed from the file's rows that are read once for
+ * all of the tiles.
+ *
+ * @param level
+ *     Index of the level.
+ * @param tileRow
+ *     Row of the tiles.
+ * @param firstTileColumn
+ *     Column of the first tile.
+ * @param lastTileColumn
+ *     Column of the last tile (inclusive).
+ * @param tileDataOut
+ *     Output with data for each tile from the first through last tile column.
+ * @param errorMessageOut
+ *     Output with error message if reading fails.
+ * @return
+ *     True if successful, else false.
+ */
+bool
+CiftiMatrixTexturePyramid::getTileData(const int32_t level,
+                                       const int32_t tileRow,
+                                       const int32_t firstTileColumn,
+                                       const int32_t lastTileColumn,
+                                       std::vector<std::vector<float>>& tileDataOut,
+                                       AString& errorMessageOut) const
+{
+    tileDataOut.clear();
+    errorMessageOut.clear();
+    
+    if ( ! m_validFlag) {
+        errorMessageOut = "Matrix pyramid is not valid.";
+        return false;
+    }
+    CaretAssert((level >= 0) && (level < m_numberOfLevels));
+    CaretAssert((tileRow >= 0) && (tileRow < getLevelNumberOfTileRows(level)));
+    CaretAssert((firstTileColumn >= 0) && (firstTileColumn <= lastTileColumn));
+    CaretAssert(lastTileColumn < getLevelNumberOfTileColumns(level));
+    
+    const int32_t numberOfTiles = lastTileColumn - firstTileColumn + 1;
+    tileDataOut.resize(numberOfTiles);
+    
+    if (level >= m_firstStoredLevel) {
+        CaretAssert(m_cacheFile);
+        for (int32_t iTile = 0; iTile < numberOfTiles; iTile++) {
+            const int32_t tileColumn = firstTileColumn + iTile;
+            int32_t tileNumberOfRows = 0;
+            int32_t tileNumberOfColumns = 0;
+            getTileDimensions(level,
+                              tileRow,
+                              tileColumn,
+                              tileNumberOfRows,
+                              tileNumberOfColumns);
+            
+            std::vector<float>& tileData = tileDataOut[iTile];
+            tileData.resize(static_cast<int64_t>(tileNumberOfRows) * tileNumberOfColumns);
+            const int64_t numberOfBytes = tileData.size() * sizeof(float);
+            if (( ! m_cacheFile->seek(getTileFileOffset(level, tileRow, tileColumn)))
+                || (m_cacheFile->read(reinterpret_cast<char*>(&tileData[0]),
+                                      numberOfBytes) != numberOfBytes)) {
+                errorMessageOut = ("Error reading matrix cache file: "
+                                   + m_cacheFile->errorString());
+                tileDataOut.clear();
+                return false;
+            }
+        }
+        
+        return true;
+    }
+    
+    /*
+     * Accumulate the file's rows into a band containing the tiles
+     */
+    const int64_t cellSize = getLevelCellSize(level);
+    int32_t bandNumberOfRows = 0;
+    int32_t lastTileNumberOfColumns = 0;
+    getTileDimensions(level,
+                      tileRow,
+                      lastTileColumn,
+                      bandNumberOfRows,
+                      lastTileNumberOfColumns);
+    const int64_t bandFirstColumn = static_cast<int64_t>(firstTileColumn) * TILE_DIMENSION;
+    const int64_t bandNumberOfColumns = (static_cast<int64_t>(numberOfTiles - 1) * TILE_DIMENSION) + lastTileNumberOfColumns;
+    
+    const int64_t firstFileRow    = static_cast<int64_t>(tileRow) * TILE_DIMENSION * cellSize;
+    const int64_t lastFileRow     = std::min(m_numberOfRows,
+                                             firstFileRow + (bandNumberOfRows * cellSize)) - 1;
+    const int64_t firstFileColumn = bandFirstColumn * cellSize;
+    const int64_t lastFileColumn  = std::min(m_numberOfColumns,
+                                             firstFileColumn + (bandNumberOfColumns * cellSize)) - 1;
+    
+    std::vector<double> bandSums(bandNumberOfRows * bandNumberOfColumns, 0.0);
+    std::vector<int64_t> bandCounts(bandSums.size(), 0);
+    std::vector<float> rowData(m_numberOfColumns);
+    
+    try {
+        for (int64_t iRow = firstFileRow; iRow <= lastFileRow; iRow++) {
+            m_ciftiFile->getRow(&rowData[0],
+                                iRow);
+            const int64_t bandRowOffset = ((iRow - firstFileRow) / cellSize) * bandNumberOfColumns;
+            for (int64_t jCol = firstFileColumn; jCol <= lastFileColumn; jCol++) {
+                const float value = rowData[jCol];
+                if (std::isfinite(value)) {
+                    const int64_t bandOffset = bandRowOffset + ((jCol - firstFileColumn) / cellSize);
+                    CaretAssertVectorIndex(bandSums, bandOffset);
+                    bandSums[bandOffset] += value;
+                    bandCounts[bandOffset]++;
+                }
+            }
+        }
+    }
+    catch (const CaretException& e) {
+        errorMessageOut = ("Error reading matrix rows: "
+                           + e.whatString());
+        tileDataOut.clear();
+        return false;
+    }
+    
+    for (int32_t iTile = 0; iTile < numberOfTiles; iTile++) {
+        const int32_t tileColumn = firstTileColumn + iTile;
+        int32_t tileNumberOfRows = 0;
+        int32_t tileNumberOfColumns = 0;
+        getTileDimensions(level,
+                          tileRow,
+                          tileColumn,
+                          tileNumberOfRows,
+                          tileNumberOfColumns);
+        CaretAssert(tileNumberOfRows == bandNumberOfRows);
+        
+        std::vector<float>& tileData = tileDataOut[iTile];
+        tileData.resize(static_cast<int64_t>(tileNumberOfRows) * tileNumberOfColumns);
+        const int64_t bandColumnOffset = static_cast<int64_t>(iTile) * TILE_DIMENSION;
+        int64_t tileOffset = 0;
+        for (int32_t iRow = 0; iRow < tileNumberOfRows; iRow++) {
+            const int64_t bandOffset = (iRow * bandNumberOfColumns) + bandColumnOffset;
+            for (int32_t jCol = 0; jCol < tileNumberOfColumns; jCol++) {
+                CaretAssertVectorIndex(bandSums, bandOffset + jCol);
+                CaretAssertVectorIndex(tileData, tileOffset);
+                tileData[tileOffset] = ((bandCounts[bandOffset + jCol] > 0)
+                                        ? static_cast<float>(bandSums[bandOffset + jCol] / bandCounts[bandOffset + jCol])
+                                        : std::numeric_limits<float>::quiet_NaN());
+                tileOffset++;
+            }
+        }
+    }
+    
+    return true;
+}
+
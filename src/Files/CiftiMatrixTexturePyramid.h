@@ -0,0 +1,144 @@
+#ifndef __CIFTI_MATRIX_TEXTURE_PYRAMID_H__
+#define __CIFTI_MATRIX_TEXTURE_PYRAMID_H__
+
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include "CaretObject.h"
+
+class QTemporaryFile;
+
+namespace caret {
+
+    class CiftiFile;
+    class FastStatistics;
+    
+    class CiftiMatrixTexturePyramid : public CaretObject {
+        
+    public:
+        CiftiMatrixTexturePyramid(const CiftiFile* ciftiFile);
+        
+        virtual ~CiftiMatrixTexturePyramid();
+        
+        bool build(AString& errorMessageOut);
+        
+        bool isValid() const;
+        
+        int64_t getNumberOfRows() const;
+        
+        int64_t getNumberOfColumns() const;
+        
+        int32_t getNumberOfLevels() const;
+        
+        int32_t getLevelForCellsPerPixel(const float cellsPerPixel) const;
+        
+        int32_t getLevelCellSize(const int32_t level) const;
+        
+        int64_t getLevelNumberOfRows(const int32_t level) const;
+        
+        int64_t getLevelNumberOfColumns(const int32_t level) const;
+        
+        int32_t getLevelNumberOfTileRows(const int32_t level) const;
+        
+        int32_t getLevelNumberOfTileColumns(const int32_t level) const;
+        
+        void getTileDimensions(const int32_t level,
+                               const int32_t tileRow,
+                               const int32_t tileColumn,
+                               int32_t& numberOfRowsOut,
+                               int32_t& numberOfColumnsOut) const;
+        
+        bool getTileData(const int32_t level,
+                         const int32_t tileRow,
+                         const int32_t firstTileColumn,
+                         const int32_t lastTileColumn,
+                         std::vector<std::vector<float>>& tileDataOut,
+                         AString& errorMessageOut) const;
+        
+        const FastStatistics* getFastStatistics() const;
+        
+        /** Maximum number of texels in each dimension of a tile */
+        static const int32_t TILE_DIMENSION;
+        
+    private:
+        CiftiMatrixTexturePyramid(const CiftiMatrixTexturePyramid&);
+
+        CiftiMatrixTexturePyramid& operator=(const CiftiMatrixTexturePyramid&);
+        
+        /** Sums and counts of the finite values in one row of a level */
+        struct LevelRow {
+            std::vector<double> m_sums;
+            std::vector<int64_t> m_counts;
+            int32_t m_numberOfSourceRows = 0;
+        };
+        
+        int64_t getTileFileOffset(const int32_t level,
+                                  const int32_t tileRow,
+                                  const int32_t tileColumn) const;
+        
+        bool writeTileBand(const int32_t level,
+                           const int32_t tileRow,
+                           const std::vector<float>& bandData,
+                           const int32_t bandNumberOfRows,
+                           AString& errorMessageOut);
+        
+        const CiftiFile* m_ciftiFile;
+        
+        int64_t m_numberOfRows = 0;
+        
+        int64_t m_numberOfColumns = 0;
+        
+        int32_t m_numberOfLevels = 0;
+        
+        /** Coarser levels are stored in the cache file, finer levels are computed from the file's rows */
+        int32_t m_firstStoredLevel = 0;
+        
+        /** Offset of each stored level in the cache file */
+        std::vector<int64_t> m_levelFileOffsets;
+        
+        /** Cache file containing the stored levels */
+        std::unique_ptr<QTemporaryFile> m_cacheFile;
+        
+        /** Statistics from a sample of the matrix used for color mapping */
+        std::unique_ptr<FastStatistics> m_fastStatistics;
+        
+        bool m_validFlag = false;
+        
+        /** Maximum number of matrix values sampled for the statistics */
+        static const int64_t MAXIMUM_STATISTICS_SAMPLE_SIZE;
+        
+        /** Levels at least this coarse are stored in the cache file */
+        static const int32_t FIRST_STORED_LEVEL;
+    };
+    
+#ifdef __CIFTI_MATRIX_TEXTURE_PYRAMID_DECLARE__
+    const int32_t CiftiMatrixTexturePyramid::TILE_DIMENSION = 256;
+    const int64_t CiftiMatrixTexturePyramid::MAXIMUM_STATISTICS_SAMPLE_SIZE = 10000000;
+    const int32_t CiftiMatrixTexturePyramid::FIRST_STORED_LEVEL = 2;
+#endif // __CIFTI_MATRIX_TEXTURE_PYRAMID_DECLARE__
+
+} // namespace
+#endif  //__CIFTI_MATRIX_TEXTURE_PYRAMID_H__
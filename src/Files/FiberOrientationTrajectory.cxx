@@ -80,6 +80,26 @@ FiberOrientationTrajectory::addFiberFractionsForAveraging(const FiberFractions&
 {
     const bool includeZeroTotalCountWhenAveraging = true;
     
+    if (addFiberFractionsToSums(fiberFraction)) {
+        m_countForAveraging += 1;
+    }
+    else if (includeZeroTotalCountWhenAveraging) {
+        m_countForAveraging += 1;
+    }
+}
+
+/**
+ * Add a fiber fraction to the sums used for averaging without
+ * changing the count used for averaging.
+ *
+ * @param fiberFraction
+ *    Fiber fraction that is added.
+ * @return
+ *    True if the fiber fraction had a nonzero count and was added.
+ */
+bool
+FiberOrientationTrajectory::addFiberFractionsToSums(const FiberFractions& fiberFraction)
+{
     const int64_t numFractions = fiberFraction.fiberFractions.size();
     if ((fiberFraction.totalCount > 0)
         && (numFractions > 0)) {
@@ -96,7 +116,7 @@ FiberOrientationTrajectory::addFiberFractionsForAveraging(const FiberFractions&
         else if (static_cast<int64_t>(m_fiberCountsSum.size()) != numFractions) {
             CaretAssertMessage(0,
                                "Sizes should be the same");
-            return;
+            return false;
         }
         
         m_totalCountSum += fiberFraction.totalCount;
@@ -107,11 +127,10 @@ FiberOrientationTrajectory::addFiberFractionsForAveraging(const FiberFractions&
         
         m_distanceSum += fiberFraction.distance;
         
-        m_countForAveraging += 1;
-    }
-    else if (includeZeroTotalCountWhenAveraging) {
-        m_countForAveraging += 1;
+        return true;
     }
+    
+    return false;
 }
 
 /**
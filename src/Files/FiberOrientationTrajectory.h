@@ -97,6 +97,8 @@ namespace caret {
 
         FiberOrientationTrajectory& operator=(const FiberOrientationTrajectory&);
         
+        bool addFiberFractionsToSums(const FiberFractions& fiberFraction);
+        
     public:
 
         // ADD_NEW_METHODS_HERE
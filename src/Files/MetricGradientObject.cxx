@@ -0,0 +1,275 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "MetricGradientObject.h"
+
+#include "CaretAssert.h"
+#include "CaretLogger.h"
+#include "CaretOMP.h"
+#include "FloatMatrix.h"
+#include "SurfaceFile.h"
+#include "TopologyHelper.h"
+#include "Vector3D.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace caret;
+
+MetricGradientObject::MetricGradientObject(SurfaceFile* mySurf, const float* roiColumn, const bool& avgNormals, const float* correctedAreas)
+{
+    CaretAssert(mySurf != NULL);
+    m_numNodes = mySurf->getNumberOfNodes();
+    const float* myNormals = NULL;
+    vector<float> avgNormalStorage;
+    if (avgNormals)
+    {
+        avgNormalStorage = mySurf->computeAverageNormals();
+        myNormals = avgNormalStorage.data();
+    } else {
+        mySurf->computeNormals();
+        myNormals = mySurf->getNormalData();
+    }
+    vector<float> sqrtCorrAreas;//same logic as GeodesicHelper
+    vector<float> sqrtVertAreas;
+    const float* vertAreas = NULL;
+    vector<float> areaData;
+    if (correctedAreas != NULL)
+    {
+        sqrtCorrAreas.resize(m_numNodes);
+        mySurf->computeNodeAreas(sqrtVertAreas);
+        for (int i = 0; i < m_numNodes; ++i)
+        {
+            sqrtCorrAreas[i] = sqrt(correctedAreas[i]);
+            sqrtVertAreas[i] = sqrt(sqrtVertAreas[i]);
+        }
+        vertAreas = correctedAreas;
+    } else {
+        mySurf->computeNodeAreas(areaData);
+        vertAreas = areaData.data();
+    }
+    const float* myCoords = mySurf->getCoordinateData();
+    CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
+    m_stencilStart.resize(m_numNodes + 1);
+    m_stencilStart[0] = 0;
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {//stencil is every within-roi neighbor, vertices with fewer than 2 surface neighbors get an empty stencil, and are reported as failed below
+        int64_t count = 0;
+        const vector<int32_t>& neighbors = myTopoHelp->getNodeNeighbors(i);
+        if ((roiColumn == NULL || roiColumn[i] > 0.0f) && neighbors.size() >= 2)
+        {
+            for (int32_t j = 0; j < (int32_t)neighbors.size(); ++j)
+            {
+                if (roiColumn == NULL || roiColumn[neighbors[j]] > 0.0f) ++count;
+            }
+        }
+        m_stencilStart[i + 1] = m_stencilStart[i] + count;
+    }
+    m_stencilNodes.resize(m_stencilStart[m_numNodes]);
+    m_stencilWeights.resize(m_stencilStart[m_numNodes] * 3, 0.0f);
+    bool haveWarned = false, haveFailed = false;//print warning or failure messages only once
+#pragma omp CARET_PAR
+    {
+        Vector3D somevec, xhat, yhat;
+        vector<float> xmags, ymags, unrollMags, mags2d;
+#pragma omp CARET_FOR schedule(dynamic, 256)
+        for (int32_t i = 0; i < m_numNodes; ++i)
+        {
+            if (roiColumn != NULL && roiColumn[i] <= 0.0f) continue;
+            int32_t numNeigh;
+            int32_t i3 = i * 3;
+            const int32_t* myNeighbors = myTopoHelp->getNodeNeighbors(i, numNeigh);
+            Vector3D myNormal = Vector3D(myNormals + i3).normal();//should already be normalized, but just in case
+            Vector3D myCoord = myCoords + i3;
+            somevec[2] = 0.0;
+            if (abs(myNormal[0]) > abs(myNormal[1]))
+            {//generate a vector not parallel to normal
+                somevec[0] = 0.0;
+                somevec[1] = 1.0;
+            } else {
+                somevec[0] = 1.0;
+                somevec[1] = 0.0;
+            }
+            xhat = myNormal.cross(somevec).normal();
+            yhat = myNormal.cross(xhat).normal();//xhat, yhat are orthogonal unit vectors describing a coord system with k = surface normal
+            const int64_t stencilStart = m_stencilStart[i];
+            const int neighCount = (int)(m_stencilStart[i + 1] - stencilStart);//count within-roi neighbors, not simply surface neighbors
+            xmags.resize(neighCount);
+            ymags.resize(neighCount);
+            unrollMags.resize(neighCount);
+            mags2d.resize(neighCount);
+            int k = 0;
+            for (int32_t j = 0; j < numNeigh && k < neighCount; ++j)
+            {
+                int32_t whichNode = myNeighbors[j];
+                if (roiColumn == NULL || roiColumn[whichNode] > 0.0f)
+                {
+                    Vector3D neighCoord = myCoords + whichNode * 3;
+                    somevec = neighCoord - myCoord;
+                    float origMag = somevec.length();//save the original length
+                    float unrollMag = origMag;
+                    float opposite = somevec.dot(myNormal);//check for division by close to zero
+                    if (abs(opposite) > 0.035f * origMag)//do not do unrolling on very small angles - this is ~2 degrees
+                    {
+                        unrollMag = origMag * asin(opposite / origMag) * origMag / opposite;
+                    }
+                    if (correctedAreas != NULL)
+                    {
+                        unrollMag *= (sqrtCorrAreas[i] + sqrtCorrAreas[whichNode]) / (sqrtVertAreas[i] + sqrtVertAreas[whichNode]);
+                    }
+                    float xmag = xhat.dot(somevec);//dot product to get the direction in 2d
+                    float ymag = yhat.dot(somevec);
+                    float mag2d = sqrt(xmag * xmag + ymag * ymag);//get the new magnitude, to divide out
+                    m_stencilNodes[stencilStart + k] = whichNode;
+                    xmags[k] = xmag;
+                    ymags[k] = ymag;
+                    unrollMags[k] = unrollMag;
+                    mags2d[k] = mag2d;
+                    ++k;
+                }
+            }
+            CaretAssert(k == neighCount);
+            float* weights = m_stencilWeights.data() + stencilStart * 3;
+            bool success = false;
+            if (neighCount >= 2)
+            {//solve the area weighted regression with one right hand side per neighbor, so the solution is a linear function of the neighbor differences
+                FloatMatrix myRegress = FloatMatrix::zeros(3, 3 + neighCount);
+                for (k = 0; k < neighCount; ++k)
+                {
+                    float area = vertAreas[m_stencilNodes[stencilStart + k]];
+                    float xmag = xmags[k] * (unrollMags[k] / mags2d[k]);//normalize the 2d vector and multiply by unrolled length
+                    float ymag = ymags[k] * (unrollMags[k] / mags2d[k]);
+                    myRegress[0][0] += xmag * xmag * area;//gather A'A and A' sums for regression, weighted by vertex area
+                    myRegress[0][1] += xmag * ymag * area;
+                    myRegress[0][2] += xmag * area;
+                    myRegress[1][1] += ymag * ymag * area;
+                    myRegress[1][2] += ymag * area;
+                    myRegress[2][2] += area;
+                    myRegress[0][3 + k] = xmag * area;
+                    myRegress[1][3 + k] = ymag * area;
+                    myRegress[2][3 + k] = area;
+                }
+                myRegress[1][0] = myRegress[0][1];//complete the symmetric elements
+                myRegress[2][0] = myRegress[0][2];
+                myRegress[2][1] = myRegress[1][2];
+                myRegress[2][2] += vertAreas[i];//include center (metric and coord differences will be zero, so this is all that is needed)
+                FloatMatrix myRref = myRegress.reducedRowEchelon();
+                if (myRref[0][0] == 1.0f && myRref[1][1] == 1.0f && myRref[2][2] == 1.0f)//a singular system would put a pivot in a neighbor column
+                {
+                    float sanity = 0.0f;
+                    for (k = 0; k < neighCount; ++k)
+                    {
+                        somevec = xhat * myRref[0][3 + k] + yhat * myRref[1][3 + k];
+                        weights[k * 3] = somevec[0];
+                        weights[k * 3 + 1] = somevec[1];
+                        weights[k * 3 + 2] = somevec[2];
+                        sanity += somevec[0] + somevec[1] + somevec[2];
+                    }
+                    success = (sanity == sanity);
+                }
+            }
+            if (neighCount > 0 && !success)
+            {
+                if (!haveWarned && roiColumn == NULL)
+                {//don't issue this warning with an ROI, because it is somewhat expected
+                    haveWarned = true;
+                    CaretLogWarning("WARNING: gradient calculation found a NaN/inf with regression method for at least vertex " + AString::number(i));
+                }
+                float totalWeight = 0.0f;
+                for (k = 0; k < neighCount; ++k)
+                {
+                    totalWeight += vertAreas[m_stencilNodes[stencilStart + k]];
+                }
+                float sanity = 0.0f;
+                for (k = 0; k < neighCount; ++k)
+                {//difference divided by distance gives point estimate of gradient magnitude, times normalized projected direction, weighted average over neighbors
+                    float scale = vertAreas[m_stencilNodes[stencilStart + k]] / (unrollMags[k] * mags2d[k] * totalWeight);
+                    somevec = xhat * (xmags[k] * scale) + yhat * (ymags[k] * scale);
+                    weights[k * 3] = somevec[0];
+                    weights[k * 3 + 1] = somevec[1];
+                    weights[k * 3 + 2] = somevec[2];
+                    sanity += somevec[0] + somevec[1] + somevec[2];
+                }
+                success = (sanity == sanity);
+            }
+            if (!success)
+            {//includes empty stencils (fewer than 2 surface neighbors, or no in-roi neighbors), like the per-column method
+                if (!haveFailed && roiColumn == NULL)
+                {//don't warn with an roi, they can be strange
+                    haveFailed = true;
+                    CaretLogWarning("Failed to compute gradient for at least vertex " + AString::number(i) +
+                    " with standard and fallback methods, outputting ZERO, check your surface for disconnected vertices or other strangeness");
+                }
+                for (k = 0; k < neighCount * 3; ++k)
+                {
+                    weights[k] = 0.0f;
+                }
+            }
+        }
+    }
+}
+
+void MetricGradientObject::computeGradient(const float* valuesIn, float* magnitudeOut, float* vectorsOut) const
+{
+    computeGradients(vector<const float*>(1, valuesIn), vector<float*>(1, magnitudeOut), vector<float*>(1, vectorsOut));
+}
+
+void MetricGradientObject::computeGradients(const vector<const float*>& valuesIn, const vector<float*>& magnitudesOut, const vector<float*>& vectorsOut) const
+{
+    const int numColumns = (int)valuesIn.size();
+    CaretAssert((int)magnitudesOut.size() == numColumns);
+    CaretAssert(vectorsOut.empty() || (int)vectorsOut.size() == numColumns);
+    const bool haveVectors = !vectorsOut.empty();
+#pragma omp CARET_PARFOR schedule(dynamic, 256)
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        const int64_t stencilStart = m_stencilStart[i], stencilEnd = m_stencilStart[i + 1];
+        const int32_t* nodes = m_stencilNodes.data();
+        const float* weights = m_stencilWeights.data();
+        for (int col = 0; col < numColumns; ++col)
+        {//each vertex's stencil stays in cache while all columns are done
+            const float* values = valuesIn[col];
+            const float center = values[i];
+            float grad[3] = { 0.0f, 0.0f, 0.0f };
+            for (int64_t j = stencilStart; j < stencilEnd; ++j)
+            {
+                const float diff = values[nodes[j]] - center;
+                grad[0] += weights[j * 3] * diff;
+                grad[1] += weights[j * 3 + 1] * diff;
+                grad[2] += weights[j * 3 + 2] * diff;
+            }
+            float sanity = grad[0] + grad[1] + grad[2];
+            if (sanity != sanity)
+            {//NaN in the data, output zero like the original method
+                grad[0] = 0.0f;
+                grad[1] = 0.0f;
+                grad[2] = 0.0f;
+            }
+            magnitudesOut[col][i] = sqrt(grad[0] * grad[0] + grad[1] * grad[1] + grad[2] * grad[2]);
+            if (haveVectors && vectorsOut[col] != NULL)
+            {
+                vectorsOut[col][i] = grad[0];//split them up far, so that they can be set to columns easily
+                vectorsOut[col][m_numNodes + i] = grad[1];
+                vectorsOut[col][m_numNodes * 2 + i] = grad[2];
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef __METRIC_GRADIENT_OBJECT_H__
+#define __METRIC_GRADIENT_OBJECT_H__
+
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+//NOTE: this precomputes the regression for the gradient at each vertex as weights on the differences from its neighbors, so that the gradient of each column
+//      is just a weighted sum.  Use it when computing the gradient of many columns on the same surface with the same ROI, otherwise AlgorithmMetricGradient is simpler.
+//
+//NOTE: this object contains no mutable members, multiple threads can call the same function on the same instance, as long as the outputs don't overlap
+
+#include "stdint.h"
+#include "stddef.h"
+#include <vector>
+
+namespace caret {
+    
+    class SurfaceFile;
+    
+    class MetricGradientObject
+    {
+    public:
+        ///roiColumn and correctedAreas may be NULL, they must have one value per vertex
+        MetricGradientObject(SurfaceFile* mySurf, const float* roiColumn = NULL, const bool& avgNormals = false, const float* correctedAreas = NULL);
+        
+        ///vectorsOut may be NULL, otherwise it must have room for 3 * number of vertices, with all x components first, then y, then z
+        void computeGradient(const float* valuesIn, float* magnitudeOut, float* vectorsOut = NULL) const;
+        
+        ///computes several columns in one pass over the vertices, vectorsOut may be empty, or contain NULLs for columns that don't need vectors
+        void computeGradients(const std::vector<const float*>& valuesIn, const std::vector<float*>& magnitudesOut, const std::vector<float*>& vectorsOut = std::vector<float*>()) const;
+        
+        int32_t getNumberOfNodes() const { return m_numNodes; }
+    private:
+        int32_t m_numNodes;
+        std::vector<int64_t> m_stencilStart;//stencil of vertex i is [m_stencilStart[i], m_stencilStart[i + 1])
+        std::vector<int32_t> m_stencilNodes;
+        std::vector<float> m_stencilWeights;//3 per stencil node, gradient vector contributed per unit of difference from the center value
+        MetricGradientObject();
+    };
+    
+}
+
+#endif //__METRIC_GRADIENT_OBJECT_H__
@@ -27,6 +27,7 @@
 #include "GeodesicHelper.h"
 #include "TopologyHelper.h"
 #include "CaretOMP.h"
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
@@ -121,22 +122,16 @@ void MetricSmoothingObject::smoothMetric(const MetricFile* metricIn, MetricFile*
     {
         metricOut->setNumberOfNodesAndColumns(m_weightLists.size(), numCols);
     }
-    vector<float> scratch(metricIn->getNumberOfNodes());
-    if (roi != NULL)
+    if (roi != NULL && roi->getNumberOfNodes() != (int32_t)m_weightLists.size())
     {
-        if (roi->getNumberOfNodes() != (int32_t)m_weightLists.size())
-        {
-            throw CaretException("roi does not match surface number of nodes");
-        }
-        for (int32_t i = 0; i < numCols; ++i)
-        {
-            smoothColumnInternal(scratch.data(), metricIn, i, metricOut, i, roi, 0, fixZeros);
-        }
-    } else {
-        for (int32_t i = 0; i < numCols; ++i)
-        {
-            smoothColumnInternal(scratch.data(), metricIn, i, metricOut, i, fixZeros);
-        }
+        throw CaretException("roi does not match surface number of nodes");
+    }
+    const int COLUMN_BLOCK = 16;//columns smoothed per pass, so each node's weight list is loaded once per block rather than once per column
+    int blockSize = min(COLUMN_BLOCK, (int)numCols);
+    vector<float> scratch((int64_t)metricIn->getNumberOfNodes() * blockSize);
+    for (int32_t i = 0; i < numCols; i += blockSize)
+    {
+        smoothColumnsInternal(scratch.data(), metricIn, i, min(blockSize, (int)(numCols - i)), metricOut, roi, fixZeros);
     }
 }
 
@@ -277,6 +272,72 @@ void MetricSmoothingObject::smoothColumnInternal(float* scratch, const MetricFil
     metricOut->setValuesForColumn(whichOutColumn, scratch);
 }
 
+void MetricSmoothingObject::smoothColumnsInternal(float* scratch, const MetricFile* metricIn, const int& firstColumn, const int& numColumns, MetricFile* metricOut, const MetricFile* roi, const bool& fixZeros) const
+{//same arithmetic as the single column versions, but with the column loop inside the node loop
+    CaretAssert(numColumns > 0 && firstColumn >= 0 && firstColumn + numColumns <= metricIn->getNumberOfColumns());
+    int32_t numNodes = metricIn->getNumberOfNodes();
+    const float* roiColumn = NULL;
+    if (roi != NULL)
+    {
+        roiColumn = roi->getValuePointerForColumn(0);
+    }
+    vector<const float*> columns(numColumns);
+    for (int c = 0; c < numColumns; ++c)
+    {
+        columns[c] = metricIn->getValuePointerForColumn(firstColumn + c);
+    }
+    bool simple = (roiColumn == NULL && !fixZeros);
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int32_t i = 0; i < numNodes; ++i)
+    {
+        const WeightList& myWeightRef = m_weightLists[i];
+        int32_t numWeights = myWeightRef.m_nodes.size();
+        bool skip = (myWeightRef.m_weightSum == 0.0f || (roiColumn != NULL && !(roiColumn[i] > 0.0f)));
+        for (int c = 0; c < numColumns; ++c)
+        {
+            float* colScratch = scratch + (int64_t)c * numNodes;
+            if (skip)
+            {
+                colScratch[i] = 0.0f;
+                continue;
+            }
+            const float* myColumn = columns[c];
+            if (simple)
+            {
+                float sum = 0.0f;
+                for (int32_t j = 0; j < numWeights; ++j)
+                {
+                    sum += myWeightRef.m_weights[j] * myColumn[myWeightRef.m_nodes[j]];
+                }
+                colScratch[i] = sum / myWeightRef.m_weightSum;
+            } else {
+                float sum = 0.0f, weightsum = 0.0f;
+                for (int32_t j = 0; j < numWeights; ++j)
+                {
+                    int32_t neighbor = myWeightRef.m_nodes[j];
+                    float value = myColumn[neighbor];
+                    if ((roiColumn == NULL || roiColumn[neighbor] > 0.0f) && (!fixZeros || value != 0.0f))
+                    {
+                        float weight = myWeightRef.m_weights[j];
+                        sum += weight * value;
+                        weightsum += weight;
+                    }
+                }
+                if (weightsum != 0.0f)
+                {
+                    colScratch[i] = sum / weightsum;
+                } else {
+                    colScratch[i] = 0.0f;
+                }
+            }
+        }
+    }
+    for (int c = 0; c < numColumns; ++c)
+    {
+        metricOut->setValuesForColumn(firstColumn + c, scratch + (int64_t)c * numNodes);
+    }
+}
+
 void MetricSmoothingObject::precomputeWeightsGeoGauss(const SurfaceFile* mySurf, float myKernel)
 {
     int32_t numNodes = mySurf->getNumberOfNodes();
@@ -62,6 +62,8 @@ namespace caret {
         std::vector<WeightList> m_weightLists;
         void smoothColumnInternal(float* scratch, const MetricFile* metricIn, const int& whichColumn, MetricFile* metricOut, const int& whichOutColumn, const bool& fixZeros) const;
         void smoothColumnInternal(float* scratch, const MetricFile* metricIn, const int& whichColumn, MetricFile* metricOut, const int& whichOutColumn, const MetricFile* roi, const int& whichRoiColumn, const bool& fixZeros) const;
+        ///smooths numColumns consecutive columns in one pass over the nodes, scratch must hold numColumns * numNodes floats, roi may be NULL, uses roi column 0
+        void smoothColumnsInternal(float* scratch, const MetricFile* metricIn, const int& firstColumn, const int& numColumns, MetricFile* metricOut, const MetricFile* roi, const bool& fixZeros) const;
         void precomputeWeights(const SurfaceFile* mySurf, float myKernel, const MetricFile* theRoi, Method myMethod, const float* nodeAreas);
         void precomputeWeightsGeoGauss(const SurfaceFile* mySurf, float myKernel);
         void precomputeWeightsROIGeoGauss(const SurfaceFile* mySurf, float myKernel, const MetricFile* theRoi);
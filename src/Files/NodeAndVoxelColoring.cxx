@@ -35,8 +35,10 @@
 #include "CaretOMP.h"
 #include "GiftiLabel.h"
 #include "GiftiLabelTable.h"
+#include "GiftiLabelTableLookup.h"
 #include "GroupAndNameHierarchyItem.h"
 #include "Palette.h"
+#include "PaletteColorLookup.h"
 #include "PaletteColorMapping.h"
 #include "MathFunctions.h"
 
@@ -179,19 +181,24 @@ NodeAndVoxelColoring::colorScalarsWithPalettePrivate(const FastStatistics* stati
                                                           &normalizedValues[0],
                                                           numberOfScalars);
     
+    /*
+     * Compile the palette so that finding the palette interval
+     * for a value usually requires only one or two comparisons
+     */
+    const PaletteColorLookup paletteLookup(palette,
+                                           interpolateFlag);
+    
     /*
      * Get color for normalized values of -1.0 and 1.0.
      * Since there may be a large number of values that are -1.0 or 1.0
      * we can compute the color only once for these values and save time.
      */
     float rgbaPositiveOne[4], rgbaNegativeOne[4];
-    palette->getPaletteColor(1.0,
-                             interpolateFlag,
-                             rgbaPositiveOne);
+    paletteLookup.getPaletteColor(1.0,
+                                  rgbaPositiveOne);
     const bool rgbaPositiveOneValid = (rgbaPositiveOne[3] > 0.0);
-    palette->getPaletteColor(-1.0,
-                             interpolateFlag,
-                             rgbaNegativeOne);
+    paletteLookup.getPaletteColor(-1.0,
+                                  rgbaNegativeOne);
     const bool rgbaNegativeOneValid = (rgbaNegativeOne[3] > 0.0);
     
     /*
@@ -291,9 +298,8 @@ NodeAndVoxelColoring::colorScalarsWithPalettePrivate(const FastStatistics* stati
              * Color scalar using palette
              */
             float rgba[4];
-            palette->getPaletteColor(normalValue,
-                                     interpolateFlag,
-                                     rgba);
+            paletteLookup.getPaletteColor(normalValue,
+                                          rgba);
             if (rgba[3] > 0.0f) {
                 rgbaOut[0] = rgba[0];
                 rgbaOut[1] = rgba[1];
@@ -729,53 +735,68 @@ NodeAndVoxelColoring::colorIndicesWithLabelTableForDisplayGroupTabPrivate(const
     }
     
     /*
-     * Assign colors from labels to nodes
+     * Find the color of each label once, so that selection status
+     * is tested per label instead of per node, then assign colors
+     * from labels to nodes
      */
-    float labelRGBA[4];
-	for (int64_t i = 0; i < numberOfIndices; i++) {
-        const int64_t labelKey = static_cast<int64_t>(labelIndices[i]);
-        const GiftiLabel* gl = labelTable->getLabel(labelKey);
-        if (gl != NULL) {
-            const GroupAndNameHierarchyItem* item = gl->getGroupNameSelectionItem();
-            bool colorDataFlag = false;
-            if (item != NULL) {
-                if (tabIndex == NodeAndVoxelColoring::INVALID_TAB_INDEX) {
-                    colorDataFlag = true;
-                }
-                else if (item->isSelected(displayGroup, tabIndex)) {
-                    colorDataFlag = true;
-                }
+    const GiftiLabelTableLookup labelLookup(labelTable);
+    const int32_t numberOfLabels = labelLookup.getNumberOfLabels();
+    std::vector<float> labelsRGBA(numberOfLabels * 4, 0.0f);
+    for (int32_t iLabel = 0; iLabel < numberOfLabels; iLabel++) {
+        const GiftiLabel* gl = labelLookup.getLabel(iLabel);
+        CaretAssert(gl);
+        const GroupAndNameHierarchyItem* item = gl->getGroupNameSelectionItem();
+        bool colorDataFlag = false;
+        if (item != NULL) {
+            if (tabIndex == NodeAndVoxelColoring::INVALID_TAB_INDEX) {
+                colorDataFlag = true;
             }
-            else {
+            else if (item->isSelected(displayGroup, tabIndex)) {
                 colorDataFlag = true;
             }
-            
-            if (colorDataFlag) {
-                gl->getColor(labelRGBA);
-                if (labelRGBA[3] > 0.0) {
-                    const int64_t i4 = i * 4;
-                    
-                    switch (colorDataType) {
-                        case COLOR_TYPE_FLOAT:
-                            CaretAssertArrayIndex(rgbaFloat, numberOfIndices * 4, i*4+3);
-                            rgbaFloat[i*4] = labelRGBA[0];
-                            rgbaFloat[i*4+1] = labelRGBA[1];
-                            rgbaFloat[i*4+2] = labelRGBA[2];
-                            rgbaFloat[i*4+3] = labelRGBA[3];
-                            break;
-                        case COLOR_TYPE_UNSIGNED_BTYE:
-                            CaretAssertArrayIndex(rgbaUnsignedByte, numberOfIndices * 4, i*4+3);
-                            rgbaUnsignedByte[i4]   = labelRGBA[0] * 255.0;
-                            rgbaUnsignedByte[i4+1] = labelRGBA[1] * 255.0;
-                            rgbaUnsignedByte[i4+2] = labelRGBA[2] * 255.0;
-                            if (labelRGBA[3] > 0.0) {
-                                rgbaUnsignedByte[i4+3] = labelRGBA[3] * 255.0;
-                            }
-                            else {
-                                rgbaUnsignedByte[i4+3] = 0;
-                            }
-                            break;
-                    }
+        }
+        else {
+            colorDataFlag = true;
+        }
+        
+        /*
+         * Labels that are not colored keep an alpha of zero
+         */
+        if (colorDataFlag) {
+            gl->getColor(&labelsRGBA[iLabel * 4]);
+        }
+    }
+    
+#pragma omp CARET_PARFOR schedule(dynamic, 4096)
+    for (int64_t i = 0; i < numberOfIndices; i++) {
+        const int64_t labelKey = static_cast<int64_t>(labelIndices[i]);
+        const int32_t labelIndex = labelLookup.getLabelIndex(labelKey);
+        if (labelIndex >= 0) {
+            CaretAssertVectorIndex(labelsRGBA, labelIndex * 4 + 3);
+            const float* labelRGBA = &labelsRGBA[labelIndex * 4];
+            if (labelRGBA[3] > 0.0) {
+                const int64_t i4 = i * 4;
+                
+                switch (colorDataType) {
+                    case COLOR_TYPE_FLOAT:
+                        CaretAssertArrayIndex(rgbaFloat, numberOfIndices * 4, i*4+3);
+                        rgbaFloat[i*4] = labelRGBA[0];
+                        rgbaFloat[i*4+1] = labelRGBA[1];
+                        rgbaFloat[i*4+2] = labelRGBA[2];
+                        rgbaFloat[i*4+3] = labelRGBA[3];
+                        break;
+                    case COLOR_TYPE_UNSIGNED_BTYE:
+                        CaretAssertArrayIndex(rgbaUnsignedByte, numberOfIndices * 4, i*4+3);
+                        rgbaUnsignedByte[i4]   = labelRGBA[0] * 255.0;
+                        rgbaUnsignedByte[i4+1] = labelRGBA[1] * 255.0;
+                        rgbaUnsignedByte[i4+2] = labelRGBA[2] * 255.0;
+                        if (labelRGBA[3] > 0.0) {
+                            rgbaUnsignedByte[i4+3] = labelRGBA[3] * 255.0;
+                        }
+                        else {
+                            rgbaUnsignedByte[i4+3] = 0;
+                        }
+                        break;
                 }
             }
         }
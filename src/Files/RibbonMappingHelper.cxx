@@ -47,14 +47,25 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 
 #include "RibbonMappingHelper.h"
 
+#include "ByteOrderEnum.h"
+#include "ByteSwapping.h"
+#include "CaretAssert.h"
+#include "CaretBinaryFile.h"
 #include "CaretException.h"
+#include "CaretLogger.h"
+#include "CaretOMP.h"
+#include "DataFileException.h"
+#include "FileInformation.h"
 #include "FloatMatrix.h"
 #include "MathFunctions.h"
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
 #include "VolumeSpace.h"
 
+#include <algorithm>
 #include <cmath>
+#include <exception>
+#include <limits>
 
 using namespace caret;
 using namespace std;
@@ -355,3 +366,344 @@ void RibbonMappingHelper::computeWeightsRibbon(vector<vector<VoxelWeight> >& myW
         }
     }
 }
+
+namespace
+{
+    const char ribbonPlanMagic[] = "\0\0\0\0rwp1";
+    
+    void hashBytes(uint64_t& hash, const void* data, const int64_t& numBytes)
+    {//FNV-1a, doesn't need to be cryptographic, only needs to notice changed inputs
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (int64_t i = 0; i < numBytes; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+}
+
+RibbonWeightPlan::RibbonWeightPlan()
+{
+    m_numVertices = 0;
+    m_dims[0] = 0;
+    m_dims[1] = 0;
+    m_dims[2] = 0;
+    m_signature = 0;
+    m_rowStart.resize(1, 0);
+}
+
+void RibbonWeightPlan::setWeights(const vector<vector<VoxelWeight> >& weightsIn, const int64_t dims[3], const uint64_t& signature)
+{
+    m_numVertices = (int64_t)weightsIn.size();
+    for (int i = 0; i < 3; ++i)
+    {
+        m_dims[i] = dims[i];
+    }
+    m_signature = signature;
+    clearReverse();
+    m_rowStart.resize(m_numVertices + 1);
+    m_rowStart[0] = 0;
+    for (int64_t v = 0; v < m_numVertices; ++v)
+    {
+        m_rowStart[v + 1] = m_rowStart[v] + (int64_t)weightsIn[v].size();
+    }
+    int64_t numWeights = m_rowStart[m_numVertices];
+    m_voxelIndex.resize(numWeights);
+    m_weights.resize(numWeights);
+#pragma omp CARET_PARFOR schedule(dynamic, 256)
+    for (int64_t v = 0; v < m_numVertices; ++v)
+    {
+        int64_t base = m_rowStart[v];
+        for (int64_t i = 0; i < (int64_t)weightsIn[v].size(); ++i)
+        {
+            const VoxelWeight& thisWeight = weightsIn[v][i];
+            m_voxelIndex[base + i] = thisWeight.ijk[0] + dims[0] * (thisWeight.ijk[1] + dims[1] * thisWeight.ijk[2]);
+            m_weights[base + i] = thisWeight.weight;
+        }
+    }
+}
+
+void RibbonWeightPlan::mapToSurface(const vector<const float*>& framesIn, const vector<float*>& surfaceOut) const
+{
+    CaretAssert(framesIn.size() == surfaceOut.size());
+    const int64_t numFrames = (int64_t)framesIn.size();
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
+    for (int64_t node = 0; node < m_numVertices; ++node)
+    {//the row stays in cache while it is applied to every frame
+        const int64_t start = m_rowStart[node], end = m_rowStart[node + 1];
+        float totalWeight = 0.0f;
+        for (int64_t i = start; i < end; ++i)
+        {
+            totalWeight += m_weights[i];
+        }
+        for (int64_t f = 0; f < numFrames; ++f)
+        {
+            if (totalWeight == 0.0f)
+            {
+                surfaceOut[f][node] = 0.0f;
+                continue;
+            }
+            const float* frame = framesIn[f];
+            float accum = 0.0f;
+            for (int64_t i = start; i < end; ++i)
+            {
+                accum += m_weights[i] * frame[m_voxelIndex[i]];
+            }
+            surfaceOut[f][node] = accum / totalWeight;
+        }
+    }
+}
+
+void RibbonWeightPlan::ensureReverse() const
+{
+    CaretMutexLocker locked(&m_reverseMutex);
+    if (m_reverseStart.size() != 0) return;
+    const int64_t numWeights = m_rowStart[m_numVertices];
+    vector<pair<int64_t, int64_t> > byVoxel(numWeights);//transpose by sorting (voxel, position) pairs, so within a voxel the vertices stay in order
+    m_posVertex.resize(numWeights);
+    for (int64_t v = 0; v < m_numVertices; ++v)
+    {
+        for (int64_t i = m_rowStart[v]; i < m_rowStart[v + 1]; ++i)
+        {
+            byVoxel[i] = pair<int64_t, int64_t>(m_voxelIndex[i], i);
+            m_posVertex[i] = v;
+        }
+    }
+    sort(byVoxel.begin(), byVoxel.end());
+    m_reversePos.resize(numWeights);
+    for (int64_t i = 0; i < numWeights; ++i)
+    {
+        if (i == 0 || byVoxel[i].first != byVoxel[i - 1].first)
+        {
+            m_reverseStart.push_back(i);
+            m_reverseVoxel.push_back(byVoxel[i].first);
+        }
+        m_reversePos[i] = byVoxel[i].second;
+    }
+    m_reverseStart.push_back(numWeights);
+}
+
+void RibbonWeightPlan::clearReverse()
+{
+    m_reverseStart.clear();
+    m_reverseVoxel.clear();
+    m_reversePos.clear();
+    m_posVertex.clear();
+}
+
+void RibbonWeightPlan::mapToVolume(const vector<const float*>& surfaceIn, const vector<float*>& framesOut, const bool& greedy, const bool& thickColumn) const
+{
+    CaretAssert(surfaceIn.size() == framesOut.size());
+    const int64_t numFrames = (int64_t)surfaceIn.size();
+    ensureReverse();
+    const int64_t numGroups = (int64_t)m_reverseVoxel.size();
+    float fullWeight = 1.0f;//thin weights are intended to be space filling without overlapping
+    if (thickColumn) fullWeight = 3.0f;//a bit of a hack - ideally, in thick mode every fully covered voxel should have weights sum to 3
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
+    for (int64_t g = 0; g < numGroups; ++g)
+    {
+        const int64_t start = m_reverseStart[g], end = m_reverseStart[g + 1], voxel = m_reverseVoxel[g];
+        double totalWeight = 0.0;
+        for (int64_t i = start; i < end; ++i)
+        {
+            totalWeight += m_weights[m_reversePos[i]];
+        }
+        CaretAssert(totalWeight > 0.0);//ribbon mapping should never add weights of 0 to lists
+        float denom = fullWeight;
+        if (totalWeight > denom)
+        {//the surface contours occasionally turn the polyhedrons partly inside out, so voxels can sum to more than they theoretically should
+            denom = totalWeight;
+        }
+        for (int64_t f = 0; f < numFrames; ++f)
+        {
+            const float* surfData = surfaceIn[f];
+            double accum = 0.0;
+            for (int64_t i = start; i < end; ++i)
+            {
+                int64_t pos = m_reversePos[i];
+                accum += surfData[m_posVertex[pos]] * m_weights[pos];
+            }
+            if (greedy)
+            {
+                framesOut[f][voxel] = accum / totalWeight;
+            } else {
+                framesOut[f][voxel] = accum / denom;
+            }
+        }
+    }
+}
+
+bool RibbonWeightPlan::readFile(const AString& filename, const uint64_t& requiredSignature)
+{
+    CaretBinaryFile myFile(filename);
+    const int64_t HEADER_BYTES = 8 + sizeof(uint64_t) + 4 * sizeof(int64_t);
+    const int64_t fileSize = myFile.size();//all counts are checked against this before allocating, so a corrupt file can't request huge arrays
+    if (fileSize < HEADER_BYTES) throw DataFileException("file '" + filename + "' is too small to be a ribbon weights file");
+    char buf[8];
+    myFile.read(buf, 8);
+    for (int i = 0; i < 8; ++i)
+    {
+        if (buf[i] != ribbonPlanMagic[i]) throw DataFileException("file '" + filename + "' is not a ribbon weights file");
+    }
+    uint64_t signature;
+    int64_t header[4];
+    myFile.read(&signature, sizeof(uint64_t));
+    myFile.read(header, 4 * sizeof(int64_t));
+    if (ByteOrderEnum::isSystemBigEndian())
+    {
+        ByteSwapping::swapBytes(&signature, 1);
+        ByteSwapping::swapBytes(header, 4);
+    }
+    if (signature != requiredSignature) return false;//computed from different inputs, don't bother reading the weights
+    if (header[0] < 0 || header[1] < 1 || header[2] < 1 || header[3] < 1) throw DataFileException("impossible dimensions in ribbon weights file '" + filename + "'");
+    if (header[1] > numeric_limits<int64_t>::max() / header[2] || header[1] * header[2] > numeric_limits<int64_t>::max() / header[3])
+    {
+        throw DataFileException("impossible dimensions in ribbon weights file '" + filename + "'");
+    }
+    if (header[0] >= (fileSize - HEADER_BYTES) / (int64_t)sizeof(int64_t))
+    {
+        throw DataFileException("ribbon weights file '" + filename + "' is too small for its number of vertices");
+    }
+    vector<int64_t> rowStart(header[0] + 1);
+    myFile.read(rowStart.data(), rowStart.size() * sizeof(int64_t));
+    if (ByteOrderEnum::isSystemBigEndian())
+    {
+        ByteSwapping::swapBytes(rowStart.data(), rowStart.size());
+    }
+    if (rowStart[0] != 0) throw DataFileException("impossible row start found in ribbon weights file '" + filename + "'");
+    for (int64_t v = 0; v < header[0]; ++v)
+    {
+        if (rowStart[v + 1] < rowStart[v]) throw DataFileException("impossible row start found in ribbon weights file '" + filename + "'");
+    }
+    int64_t numWeights = rowStart[header[0]], frameSize = header[1] * header[2] * header[3];
+    const int64_t arrayBytes = fileSize - HEADER_BYTES - (header[0] + 1) * (int64_t)sizeof(int64_t);
+    if (numWeights > arrayBytes / (int64_t)(sizeof(int64_t) + sizeof(float)) || numWeights * (int64_t)(sizeof(int64_t) + sizeof(float)) != arrayBytes)
+    {
+        throw DataFileException("ribbon weights file '" + filename + "' has the wrong size for its number of weights");
+    }
+    vector<int64_t> voxelIndex(numWeights);
+    vector<float> weights(numWeights);
+    myFile.read(voxelIndex.data(), numWeights * sizeof(int64_t));
+    myFile.read(weights.data(), numWeights * sizeof(float));
+    if (ByteOrderEnum::isSystemBigEndian())
+    {
+        ByteSwapping::swapBytes(voxelIndex.data(), numWeights);
+        ByteSwapping::swapBytes(weights.data(), numWeights);
+    }
+    for (int64_t i = 0; i < numWeights; ++i)
+    {
+        if (voxelIndex[i] < 0 || voxelIndex[i] >= frameSize) throw DataFileException("impossible voxel index found in ribbon weights file '" + filename + "'");
+    }
+    m_signature = signature;
+    m_numVertices = header[0];
+    for (int i = 0; i < 3; ++i)
+    {
+        m_dims[i] = header[i + 1];
+    }
+    clearReverse();
+    m_rowStart.swap(rowStart);
+    m_voxelIndex.swap(voxelIndex);
+    m_weights.swap(weights);
+    return true;
+}
+
+void RibbonWeightPlan::writeFile(const AString& filename) const
+{
+    CaretBinaryFile myFile(filename, CaretBinaryFile::WRITE_TRUNCATE);
+    myFile.write(ribbonPlanMagic, 8);
+    uint64_t signature = m_signature;
+    int64_t header[4] = { m_numVertices, m_dims[0], m_dims[1], m_dims[2] };
+    if (ByteOrderEnum::isSystemBigEndian())
+    {//make copies to swap, so the plan stays usable
+        ByteSwapping::swapBytes(&signature, 1);
+        ByteSwapping::swapBytes(header, 4);
+        vector<int64_t> rowStart = m_rowStart, voxelIndex = m_voxelIndex;
+        vector<float> weights = m_weights;
+        ByteSwapping::swapBytes(rowStart.data(), rowStart.size());
+        ByteSwapping::swapBytes(voxelIndex.data(), voxelIndex.size());
+        ByteSwapping::swapBytes(weights.data(), weights.size());
+        myFile.write(&signature, sizeof(uint64_t));
+        myFile.write(header, 4 * sizeof(int64_t));
+        myFile.write(rowStart.data(), rowStart.size() * sizeof(int64_t));
+        myFile.write(voxelIndex.data(), voxelIndex.size() * sizeof(int64_t));
+        myFile.write(weights.data(), weights.size() * sizeof(float));
+    } else {
+        myFile.write(&signature, sizeof(uint64_t));
+        myFile.write(header, 4 * sizeof(int64_t));
+        myFile.write(m_rowStart.data(), m_rowStart.size() * sizeof(int64_t));
+        myFile.write(m_voxelIndex.data(), m_voxelIndex.size() * sizeof(int64_t));
+        myFile.write(m_weights.data(), m_weights.size() * sizeof(float));
+    }
+    myFile.close();
+}
+
+void RibbonMappingHelper::computeWeightPlan(RibbonWeightPlan& planOut, const VolumeSpace& myVolSpace, const SurfaceFile* innerSurf, const SurfaceFile* outerSurf,
+                                            const float* roiFrame, const int& numDivisions, const bool& thinColumn, const AString& cacheFile)
+{
+    uint64_t signature = computeSignature(myVolSpace, innerSurf, outerSurf, roiFrame, numDivisions, thinColumn);
+    if (cacheFile != "" && FileInformation(cacheFile).exists())
+    {
+        try
+        {
+            if (planOut.readFile(cacheFile, signature))
+            {
+                return;
+            }
+            CaretLogInfo("ribbon weights file '" + cacheFile + "' was computed from different inputs, recomputing");
+        } catch (CaretException& e) {
+            CaretLogWarning("failed to read ribbon weights file, recomputing: " + e.whatString());
+        } catch (exception& e) {//bad_alloc, etc, a cache file should never stop the mapping
+            CaretLogWarning("failed to read ribbon weights file, recomputing: " + AString(e.what()));
+        }
+    }
+    vector<vector<VoxelWeight> > myWeights;
+    computeWeightsRibbon(myWeights, myVolSpace, innerSurf, outerSurf, roiFrame, numDivisions, thinColumn);
+    planOut.setWeights(myWeights, myVolSpace.getDims(), signature);
+    if (cacheFile != "")
+    {
+        try
+        {
+            planOut.writeFile(cacheFile);
+        } catch (CaretException& e) {
+            CaretLogWarning("failed to write ribbon weights file: " + e.whatString());
+        }
+    }
+}
+
+uint64_t RibbonMappingHelper::computeSignature(const VolumeSpace& myVolSpace, const SurfaceFile* innerSurf, const SurfaceFile* outerSurf,
+                                               const float* roiFrame, const int& numDivisions, const bool& thinColumn)
+{
+    uint64_t ret = 14695981039346656037ULL;
+    const int64_t* dims = myVolSpace.getDims();
+    hashBytes(ret, dims, 3 * sizeof(int64_t));
+    const vector<vector<float> >& sform = myVolSpace.getSform();
+    for (int i = 0; i < (int)sform.size(); ++i)
+    {
+        hashBytes(ret, sform[i].data(), sform[i].size() * sizeof(float));
+    }
+    int32_t innerNodes = innerSurf->getNumberOfNodes(), outerNodes = outerSurf->getNumberOfNodes();
+    hashBytes(ret, &innerNodes, sizeof(int32_t));
+    hashBytes(ret, innerSurf->getCoordinateData(), innerNodes * 3 * sizeof(float));
+    hashBytes(ret, &outerNodes, sizeof(int32_t));
+    hashBytes(ret, outerSurf->getCoordinateData(), outerNodes * 3 * sizeof(float));
+    int32_t numTriangles = innerSurf->getNumberOfTriangles();//the polyhedra use the inner surface's topology
+    hashBytes(ret, &numTriangles, sizeof(int32_t));
+    for (int32_t i = 0; i < numTriangles; ++i)
+    {
+        hashBytes(ret, innerSurf->getTriangle(i), 3 * sizeof(int32_t));
+    }
+    char hasRoi = (roiFrame != NULL ? 1 : 0), thin = (thinColumn ? 1 : 0);
+    hashBytes(ret, &hasRoi, 1);
+    if (roiFrame != NULL)
+    {//only whether each voxel is included matters
+        int64_t frameSize = dims[0] * dims[1] * dims[2];
+        for (int64_t i = 0; i < frameSize; ++i)
+        {
+            char included = (roiFrame[i] > 0.0f ? 1 : 0);
+            hashBytes(ret, &included, 1);
+        }
+    }
+    hashBytes(ret, &numDivisions, sizeof(int));
+    hashBytes(ret, &thin, 1);
+    return ret;
+}
@@ -21,6 +21,9 @@
  */
 /*LICENSE_END*/
 
+#include "AString.h"
+#include "CaretMutex.h"
+
 #include "stdint.h"
 #include <cstddef>
 #include <vector>
@@ -45,6 +48,39 @@ namespace caret
         }
     };
     
+    class RibbonWeightPlan
+    {//ribbon mapping weights in compressed sparse row form, one row per vertex, columns are voxel indices within a frame
+        int64_t m_numVertices, m_dims[3];
+        uint64_t m_signature;//identifies the inputs the weights were computed from, see RibbonMappingHelper::computeSignature
+        std::vector<int64_t> m_rowStart;//m_numVertices + 1 elements, row of vertex v is [m_rowStart[v], m_rowStart[v + 1])
+        std::vector<int64_t> m_voxelIndex;
+        std::vector<float> m_weights;
+        mutable CaretMutex m_reverseMutex;
+        mutable std::vector<int64_t> m_reverseStart, m_reverseVoxel, m_reversePos, m_posVertex;//voxel-major form for mapToVolume, built on first use
+        void ensureReverse() const;
+        void clearReverse();
+    public:
+        RibbonWeightPlan();
+        ///convert per-vertex weights, keeping their order
+        void setWeights(const std::vector<std::vector<VoxelWeight> >& weightsIn, const int64_t dims[3], const uint64_t& signature);
+        int64_t getNumberOfVertices() const { return m_numVertices; }
+        const int64_t* getDims() const { return m_dims; }
+        uint64_t getSignature() const { return m_signature; }
+        int64_t getNumberOfWeights(const int64_t& vertex) const { return m_rowStart[vertex + 1] - m_rowStart[vertex]; }
+        const int64_t* getVoxelIndices(const int64_t& vertex) const { return m_voxelIndex.data() + m_rowStart[vertex]; }
+        const float* getWeights(const int64_t& vertex) const { return m_weights.data() + m_rowStart[vertex]; }
+        
+        ///weighted average of voxels for every vertex, for all frames at once - each output array must have getNumberOfVertices() elements
+        void mapToSurface(const std::vector<const float*>& framesIn, const std::vector<float*>& surfaceOut) const;
+        ///use the weights in reverse, only voxels that have weights are written to - greedy divides by the total weight, otherwise
+        ///partial coverage is antialiased against the weight a fully covered voxel should have (1 for thin columns, 3 for thick)
+        void mapToVolume(const std::vector<const float*>& surfaceIn, const std::vector<float*>& framesOut, const bool& greedy, const bool& thickColumn) const;
+        
+        ///returns false without reading the weights if the file was computed from different inputs, throws if the file is corrupt
+        bool readFile(const AString& filename, const uint64_t& requiredSignature);
+        void writeFile(const AString& filename) const;
+    };
+    
     class RibbonMappingHelper
     {
     public:
@@ -52,6 +88,17 @@ namespace caret
         static void computeWeightsRibbon(std::vector<std::vector<VoxelWeight> >& myWeightsOut, const VolumeSpace& myVolSpace,
                                          const SurfaceFile* innerSurf, const SurfaceFile* outerSurf,
                                          const float* roiFrame = NULL, const int& numDivisions = 3, const bool& thinColumn = false);
+        
+        ///same weights as computeWeightsRibbon, as a sparse plan - if cacheFile is not empty, matching weights are read from it when possible,
+        ///otherwise they are computed and written to it
+        static void computeWeightPlan(RibbonWeightPlan& planOut, const VolumeSpace& myVolSpace,
+                                      const SurfaceFile* innerSurf, const SurfaceFile* outerSurf,
+                                      const float* roiFrame = NULL, const int& numDivisions = 3, const bool& thinColumn = false,
+                                      const AString& cacheFile = "");
+        
+        ///hash of everything that affects the ribbon weights, used to check whether a cached plan can be reused
+        static uint64_t computeSignature(const VolumeSpace& myVolSpace, const SurfaceFile* innerSurf, const SurfaceFile* outerSurf,
+                                         const float* roiFrame, const int& numDivisions, const bool& thinColumn);
     };
 
 }
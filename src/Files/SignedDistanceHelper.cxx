@@ -45,129 +45,121 @@ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FO
 DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 
-#include "BoundingBox.h"
-#include "CaretHeap.h"
+#include "MathFunctions.h"
 #include "SignedDistanceHelper.h"
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 using namespace std;
 using namespace caret;
 
-float SignedDistanceHelper::dist(const float coord[3], WindingLogic myWinding)
+namespace
 {
-    CaretMutexLocker locked(&m_mutex);
-    CaretSimpleMinHeap<Oct<SignedDistanceHelperBase::TriVector>*, float> myHeap;
-    myHeap.push(m_base->m_indexRoot, m_base->m_indexRoot->distToPoint(coord));
-    ClosestPointInfo tempInfo, bestInfo;
-    float tempf = -1.0f, bestTriDist = -1.0f;
-    bool first = true;
-    int numChanged = 0;
-    while (!myHeap.isEmpty())
+    //the batch leaf test and the exact per-triangle test round differently, so allow some slop before rejecting a triangle or node
+    const float CUTOFF_SCALE = 1.0001f;
+    const float CUTOFF_ADD = 0.0001f;
+    
+    struct CentroidCompare
     {
-        Oct<SignedDistanceHelperBase::TriVector>* curOct = myHeap.pop(&tempf);
-        if (first || tempf < bestTriDist)
+        const float* m_centroids;
+        int m_axis;
+        CentroidCompare(const float* centroids, const int axis) : m_centroids(centroids), m_axis(axis) { }
+        bool operator()(const int32_t left, const int32_t right) const
         {
-            if (curOct->m_leaf)
-            {
-                vector<int32_t>& myVecRef = *(curOct->m_data.m_triList);
-                int numTris = (int)myVecRef.size();
-                for (int i = 0; i < numTris; ++i)
-                {
-                    if (m_triMarked[myVecRef[i]] != 1)
-                    {
-                        m_triMarked[myVecRef[i]] = 1;
-                        m_triMarkChanged[numChanged++] = myVecRef[i];
-                        tempf = unsignedDistToTri(coord, myVecRef[i], tempInfo);
-                        if (first || tempf < bestTriDist)
-                        {
-                            bestInfo = tempInfo;
-                            bestTriDist = tempf;
-                            first = false;
-                        }
-                    }
-                }
-            } else {
-                for (int ci = 0; ci < 2; ++ci)
-                {
-                    for (int cj = 0; cj < 2; ++cj)
-                    {
-                        for (int ck = 0; ck < 2; ++ck)
-                        {
-                            tempf = curOct->m_children[ci][cj][ck]->distToPoint(coord);
-                            if (first || tempf < bestTriDist)
-                            {
-                                myHeap.push(curOct->m_children[ci][cj][ck], tempf);
-                            }
-                        }
-                    }
-                }
-            }
+            return m_centroids[left * 3 + m_axis] < m_centroids[right * 3 + m_axis];
         }
-    }
-    while (numChanged)
-    {
-        m_triMarked[m_triMarkChanged[--numChanged]] = 0;//need to do this before computeSign
-    }
+    };
+}
+
+float SignedDistanceHelper::dist(const float coord[3], WindingLogic myWinding)
+{
+    CaretMutexLocker locked(&m_mutex);
+    ClosestPointInfo bestInfo;
+    float bestTriDist = closestTriangle(coord, -1, bestInfo);
     return bestTriDist * computeSign(coord, bestInfo, myWinding);
 }
 
-void SignedDistanceHelper::barycentricWeights(const float coord[3], BarycentricInfo& baryInfoOut)
+void SignedDistanceHelper::dist(const float* coords, const int64_t numCoords, WindingLogic myWinding, float* distOut)
 {
     CaretMutexLocker locked(&m_mutex);
-    CaretSimpleMinHeap<Oct<SignedDistanceHelperBase::TriVector>*, float> myHeap;
-    myHeap.push(m_base->m_indexRoot, m_base->m_indexRoot->distToPoint(coord));
-    ClosestPointInfo tempInfo, bestInfo;
-    float tempf = -1.0f, bestTriDist = -1.0f;
+    ClosestPointInfo bestInfo;
+    int32_t hintTriangle = -1;
+    for (int64_t i = 0; i < numCoords; ++i)
+    {
+        const float* thisCoord = coords + i * 3;
+        float bestTriDist = closestTriangle(thisCoord, hintTriangle, bestInfo);
+        hintTriangle = bestInfo.triangle;//for nearby points, the previous closest triangle gives a tight bound before any traversal
+        distOut[i] = bestTriDist * computeSign(thisCoord, bestInfo, myWinding);
+    }
+}
+
+float SignedDistanceHelper::closestTriangle(const float coord[3], const int32_t hintTriangle, ClosestPointInfo& bestInfo)
+{
+    const SignedDistanceHelperBase& myBase = *m_base;
+    ClosestPointInfo tempInfo;
+    float bestTriDist = -1.0f, cutoffSqr = numeric_limits<float>::infinity();
     bool first = true;
-    int numChanged = 0;
-    while (!myHeap.isEmpty())
+    bestInfo.triangle = -1;
+    if (hintTriangle >= 0)
     {
-        Oct<SignedDistanceHelperBase::TriVector>* curOct = myHeap.pop(&tempf);
-        if (first || tempf < bestTriDist)
+        bestTriDist = unsignedDistToTri(coord, hintTriangle, bestInfo);
+        float cutoff = bestTriDist * CUTOFF_SCALE + CUTOFF_ADD;
+        cutoffSqr = cutoff * cutoff;
+        first = false;
+    }
+    if (myBase.m_nodes.empty()) return bestTriDist;
+    m_nodeStack.clear();
+    m_nodeStack.push_back(0);
+    while (!m_nodeStack.empty())
+    {
+        int32_t curIndex = m_nodeStack.back();
+        m_nodeStack.pop_back();
+        const SignedDistanceHelperBase::BVHNode& curNode = myBase.m_nodes[curIndex];
+        if (curNode.distSquaredToPoint(coord) > cutoffSqr) continue;//the bound may have tightened since this node was pushed
+        if (curNode.m_count > 0)
         {
-            if (curOct->m_leaf)
+            myBase.leafDistSquared(coord, curNode.m_start, curNode.m_count, m_leafScratch.data());
+            for (int i = 0; i < curNode.m_count; ++i)
             {
-                vector<int32_t>& myVecRef = *(curOct->m_data.m_triList);
-                int numTris = (int)myVecRef.size();
-                for (int i = 0; i < numTris; ++i)
-                {
-                    if (m_triMarked[myVecRef[i]] != 1)
-                    {
-                        m_triMarked[myVecRef[i]] = 1;
-                        m_triMarkChanged[numChanged++] = myVecRef[i];
-                        tempf = unsignedDistToTri(coord, myVecRef[i], tempInfo);
-                        if (first || tempf < bestTriDist)
-                        {
-                            bestInfo = tempInfo;
-                            bestTriDist = tempf;
-                            first = false;
-                        }
-                    }
-                }
-            } else {
-                for (int ci = 0; ci < 2; ++ci)
+                if (!(m_leafScratch[i] > cutoffSqr))//written this way so NaN from odd triangles still gets the exact test
                 {
-                    for (int cj = 0; cj < 2; ++cj)
+                    int32_t thisTri = myBase.m_leafTris[curNode.m_start + i];
+                    if (thisTri == hintTriangle) continue;
+                    float tempf = unsignedDistToTri(coord, thisTri, tempInfo);
+                    if (first || tempf < bestTriDist)
                     {
-                        for (int ck = 0; ck < 2; ++ck)
-                        {
-                            tempf = curOct->m_children[ci][cj][ck]->distToPoint(coord);
-                            if (first || tempf < bestTriDist)
-                            {
-                                myHeap.push(curOct->m_children[ci][cj][ck], tempf);
-                            }
-                        }
+                        bestInfo = tempInfo;
+                        bestTriDist = tempf;
+                        float cutoff = bestTriDist * CUTOFF_SCALE + CUTOFF_ADD;
+                        cutoffSqr = cutoff * cutoff;
+                        first = false;
                     }
                 }
             }
+        } else {
+            int32_t nearChild = curIndex + 1, farChild = curNode.m_start;
+            float nearDist = myBase.m_nodes[nearChild].distSquaredToPoint(coord);
+            float farDist = myBase.m_nodes[farChild].distSquaredToPoint(coord);
+            if (farDist < nearDist)
+            {
+                swap(nearChild, farChild);
+                swap(nearDist, farDist);
+            }
+            if (farDist <= cutoffSqr) m_nodeStack.push_back(farChild);//push the far child first so the near child is searched first
+            if (nearDist <= cutoffSqr) m_nodeStack.push_back(nearChild);
         }
     }
-    while (numChanged)
-    {
-        m_triMarked[m_triMarkChanged[--numChanged]] = 0;//clean up
-    }
+    return bestTriDist;
+}
+
+void SignedDistanceHelper::barycentricWeights(const float coord[3], BarycentricInfo& baryInfoOut)
+{
+    CaretMutexLocker locked(&m_mutex);
+    ClosestPointInfo bestInfo;
+    float bestTriDist = closestTriangle(coord, -1, bestInfo);
     baryInfoOut.triangle = bestInfo.triangle;
     baryInfoOut.point = bestInfo.tempPoint;
     baryInfoOut.absDistance = bestTriDist;
@@ -252,68 +244,54 @@ int SignedDistanceHelper::computeSign(const float coord[3], SignedDistanceHelper
         case NEGATIVE:
         case NONZERO:
             {
-                int numChanged = 0;
                 float positiveZ[3] = {0, 0, 1};
                 Vector3D point2 = point + positiveZ;
                 int crossCount = 0;
-                vector<Oct<SignedDistanceHelperBase::TriVector>*> myStack;
-                myStack.push_back(m_base->m_indexRoot);
-                while (!myStack.empty())
+                const SignedDistanceHelperBase& myBase = *m_base;
+                m_nodeStack.clear();
+                if (!myBase.m_nodes.empty()) m_nodeStack.push_back(0);
+                while (!m_nodeStack.empty())
                 {
-                    Oct<SignedDistanceHelperBase::TriVector>* curOct = myStack[myStack.size() - 1];
-                    myStack.pop_back();
-                    if (curOct->m_leaf)
-                    {
-                        vector<int32_t>& myVecRef = *(curOct->m_data.m_triList);
-                        int numTris = (int)myVecRef.size();
-                        for (int i = 0; i < numTris; ++i)
+                    int32_t curIndex = m_nodeStack.back();
+                    m_nodeStack.pop_back();
+                    const SignedDistanceHelperBase::BVHNode& curNode = myBase.m_nodes[curIndex];
+                    if (curNode.m_count > 0)
+                    {//each triangle is in exactly one leaf, so no need to track which have been tested
+                        int32_t leafEnd = curNode.m_start + curNode.m_count;
+                        for (int32_t i = curNode.m_start; i < leafEnd; ++i)
                         {
-                            if (m_triMarked[myVecRef[i]] != 1)
+                            const int32_t* myTileNodes = m_base->getTriangle(myBase.m_leafTris[i]);
+                            Vector3D verts[3];
+                            verts[0] = m_base->getCoordinate(myTileNodes[0]);
+                            verts[1] = m_base->getCoordinate(myTileNodes[1]);
+                            verts[2] = m_base->getCoordinate(myTileNodes[2]);
+                            Vector3D triNormal;
+                            MathFunctions::normalVector(verts[0], verts[1], verts[2], triNormal);
+                            float factor = triNormal[2];//equivalent to dot product with positiveZ
+                            if (factor != 0.0f)
                             {
-                                m_triMarked[myVecRef[i]] = 1;
-                                m_triMarkChanged[numChanged++] = myVecRef[i];
-                                const int32_t* myTileNodes = m_base->getTriangle(myVecRef[i]);
-                                Vector3D verts[3];
-                                verts[0] = m_base->getCoordinate(myTileNodes[0]);
-                                verts[1] = m_base->getCoordinate(myTileNodes[1]);
-                                verts[2] = m_base->getCoordinate(myTileNodes[2]);
-                                Vector3D triNormal;
-                                MathFunctions::normalVector(verts[0], verts[1], verts[2], triNormal);
-                                float factor = triNormal[2];//equivalent to dot product with positiveZ
-                                if (factor != 0.0f)
+                                if (triNormal.dot(verts[0] - point) / factor > 0.0f && pointInTri(verts, point, 0, 1))
                                 {
-                                    if (triNormal.dot(verts[0] - point) / factor > 0.0f && pointInTri(verts, point, 0, 1))
+                                    if (triNormal[2] < 0.0f)
                                     {
-                                        if (triNormal[2] < 0.0f)
-                                        {
-                                            ++crossCount;
-                                        } else {
-                                            --crossCount;
-                                        }
+                                        ++crossCount;
+                                    } else {
+                                        --crossCount;
                                     }
                                 }
                             }
                         }
                     } else {
-                        for (int ci = 0; ci < 2; ++ci)
+                        if (myBase.m_nodes[curIndex + 1].rayIntersects(coord, point2))
                         {
-                            for (int cj = 0; cj < 2; ++cj)
-                            {
-                                for (int ck = 0; ck < 2; ++ck)
-                                {
-                                    if (curOct->m_children[ci][cj][ck]->rayIntersects(coord, point2))
-                                    {
-                                        myStack.push_back(curOct->m_children[ci][cj][ck]);
-                                    }
-                                }
-                            }
+                            m_nodeStack.push_back(curIndex + 1);
+                        }
+                        if (myBase.m_nodes[curNode.m_start].rayIntersects(coord, point2))
+                        {
+                            m_nodeStack.push_back(curNode.m_start);
                         }
                     }
                 }
-                while (numChanged)
-                {
-                    m_triMarked[m_triMarkChanged[--numChanged]] = 0;
-                }
                 switch (myWinding)
                 {
                     case EVEN_ODD:
@@ -339,7 +317,6 @@ int SignedDistanceHelper::computeSign(const float coord[3], SignedDistanceHelper
                 case 0://node
                     {
                         int curSign = 0;
-                        int numChanged = 0;
                         const vector<int>& myTiles = m_base->m_topoHelp->getNodeTiles(myInfo.node1);
                         bool first = true;
                         float bestNorm = 0;
@@ -382,71 +359,58 @@ int SignedDistanceHelper::computeSign(const float coord[3], SignedDistanceHelper
                         {
                             midAxis = 2;
                         }
-                        vector<Oct<SignedDistanceHelperBase::TriVector>*> myStack;
-                        myStack.push_back(m_base->m_indexRoot);
-                        while (!myStack.empty())
+                        const SignedDistanceHelperBase& myBase = *m_base;
+                        m_nodeStack.clear();
+                        if (!myBase.m_nodes.empty()) m_nodeStack.push_back(0);
+                        while (!m_nodeStack.empty())
                         {
-                            Oct<SignedDistanceHelperBase::TriVector>* curOct = myStack[myStack.size() - 1];
-                            myStack.pop_back();
-                            if (curOct->m_leaf)
+                            int32_t curIndex = m_nodeStack.back();
+                            m_nodeStack.pop_back();
+                            const SignedDistanceHelperBase::BVHNode& curNode = myBase.m_nodes[curIndex];
+                            if (curNode.m_count > 0)
                             {
-                                vector<int32_t>& myVecRef = *(curOct->m_data.m_triList);
-                                int numTris = (int)myVecRef.size();
-                                for (int i = 0; i < numTris; ++i)
+                                int32_t leafEnd = curNode.m_start + curNode.m_count;
+                                for (int32_t i = curNode.m_start; i < leafEnd; ++i)
                                 {
-                                    if (m_triMarked[myVecRef[i]] != 1)
+                                    const int32_t* myTileNodes = m_base->getTriangle(myBase.m_leafTris[i]);
+                                    Vector3D verts[3];
+                                    verts[0] = m_base->getCoordinate(myTileNodes[0]);
+                                    verts[1] = m_base->getCoordinate(myTileNodes[1]);
+                                    verts[2] = m_base->getCoordinate(myTileNodes[2]);
+                                    Vector3D triNormal;
+                                    MathFunctions::normalVector(verts[0], verts[1], verts[2], triNormal);
+                                    float factor = triNormal.dot(segNormal);
+                                    if (factor == 0.0f)
                                     {
-                                        m_triMarked[myVecRef[i]] = 1;
-                                        m_triMarkChanged[numChanged++] = myVecRef[i];
-                                        const int32_t* myTileNodes = m_base->getTriangle(myVecRef[i]);
-                                        Vector3D verts[3];
-                                        verts[0] = m_base->getCoordinate(myTileNodes[0]);
-                                        verts[1] = m_base->getCoordinate(myTileNodes[1]);
-                                        verts[2] = m_base->getCoordinate(myTileNodes[2]);
-                                        Vector3D triNormal;
-                                        MathFunctions::normalVector(verts[0], verts[1], verts[2], triNormal);
-                                        float factor = triNormal.dot(segNormal);
-                                        if (factor == 0.0f)
-                                        {
-                                            continue;//skip triangles parallel to the line segment
-                                        }
-                                        float intersectDist = triNormal.dot(point - verts[0]) / factor;
-                                        if (intersectDist > 0.0f && intersectDist < bestDist)
+                                        continue;//skip triangles parallel to the line segment
+                                    }
+                                    float intersectDist = triNormal.dot(point - verts[0]) / factor;
+                                    if (intersectDist > 0.0f && intersectDist < bestDist)
+                                    {
+                                        Vector3D inPlane = point - intersectDist * segNormal;
+                                        if (pointInTri(verts, inPlane, majAxis, midAxis))
                                         {
-                                            Vector3D inPlane = point - intersectDist * segNormal;
-                                            if (pointInTri(verts, inPlane, majAxis, midAxis))
+                                            bestDist = intersectDist;
+                                            if (triNormal.dot(mySeg) > 0.0f)
                                             {
-                                                bestDist = intersectDist;
-                                                if (triNormal.dot(mySeg) > 0.0f)
-                                                {
-                                                    curSign = 1;
-                                                } else {
-                                                    curSign = -1;
-                                                }
+                                                curSign = 1;
+                                            } else {
+                                                curSign = -1;
                                             }
                                         }
                                     }
                                 }
                             } else {
-                                for (int ci = 0; ci < 2; ++ci)
+                                if (myBase.m_nodes[curIndex + 1].lineSegmentIntersects(coord, bestCent))
                                 {
-                                    for (int cj = 0; cj < 2; ++cj)
-                                    {
-                                        for (int ck = 0; ck < 2; ++ck)
-                                        {
-                                            if (curOct->m_children[ci][cj][ck]->lineSegmentIntersects(coord, bestCent))
-                                            {
-                                                myStack.push_back(curOct->m_children[ci][cj][ck]);
-                                            }
-                                        }
-                                    }
+                                    m_nodeStack.push_back(curIndex + 1);
+                                }
+                                if (myBase.m_nodes[curNode.m_start].lineSegmentIntersects(coord, bestCent))
+                                {
+                                    m_nodeStack.push_back(curNode.m_start);
                                 }
                             }
                         }
-                        while (numChanged)
-                        {
-                            m_triMarked[m_triMarkChanged[--numChanged]] = 0;
-                        }
                         return curSign;
                     }
                     break;
@@ -713,24 +677,13 @@ float SignedDistanceHelper::unsignedDistToTri(const float coord[3], int32_t tria
 SignedDistanceHelper::SignedDistanceHelper(CaretPointer<SignedDistanceHelperBase> myBase)
 {
     m_base = myBase;
-    int32_t numTris = m_base->m_numTris;
-    m_triMarked = CaretArray<int>(numTris);
-    m_triMarkChanged = CaretArray<int>(numTris);
-    for (int32_t i = 0; i < numTris; ++i)
-    {
-        m_triMarked[i] = 0;
-    }
+    m_nodeStack.reserve(64);
+    m_leafScratch.resize(SignedDistanceHelperBase::MAX_LEAF_TRIS);
 }
 
 SignedDistanceHelperBase::SignedDistanceHelperBase(const SurfaceFile* mySurf)
 {
     m_topoHelp = mySurf->getTopologyHelper();
-    const float* myBB = mySurf->getBoundingBox()->getBounds();
-    Vector3D minCoord, maxCoord;
-    minCoord[0] = myBB[0]; maxCoord[0] = myBB[1];
-    minCoord[1] = myBB[2]; maxCoord[1] = myBB[3];
-    minCoord[2] = myBB[4]; maxCoord[2] = myBB[5];
-    m_indexRoot.grabNew(new Oct<TriVector>(minCoord, maxCoord));
     const float* myCoordData = mySurf->getCoordinateData();
     m_numNodes = mySurf->getNumberOfNodes();
     int32_t numNodes3 = m_numNodes * 3;
@@ -741,6 +694,7 @@ SignedDistanceHelperBase::SignedDistanceHelperBase(const SurfaceFile* mySurf)
     }
     m_numTris = mySurf->getNumberOfTriangles();
     m_triangleList.resize(m_numTris * 3);
+    vector<float> triBounds(m_numTris * 6), triCentroids(m_numTris * 3);
     for (int32_t i = 0; i < m_numTris; ++i)
     {
         int32_t i3 = i * 3;
@@ -748,106 +702,217 @@ SignedDistanceHelperBase::SignedDistanceHelperBase(const SurfaceFile* mySurf)
         m_triangleList[i3] = thisTri[0];
         m_triangleList[i3 + 1] = thisTri[1];
         m_triangleList[i3 + 2] = thisTri[2];
-        maxCoord = minCoord = myCoordData + thisTri[0] * 3;//set both to the coordinates of the first node in the triangle
+        float* minCoord = triBounds.data() + i * 6;
+        float* maxCoord = minCoord + 3;
+        for (int m = 0; m < 3; ++m)
+        {
+            minCoord[m] = maxCoord[m] = myCoordData[thisTri[0] * 3 + m];//set both to the coordinates of the first node in the triangle
+        }
         for (int j = 1; j < 3; ++j)
         {
             int32_t thisNode3 = thisTri[j] * 3;
-            if (myCoordData[thisNode3] < minCoord[0]) minCoord[0] = myCoordData[thisNode3];
-            if (myCoordData[thisNode3 + 1] < minCoord[1]) minCoord[1] = myCoordData[thisNode3 + 1];
-            if (myCoordData[thisNode3 + 2] < minCoord[2]) minCoord[2] = myCoordData[thisNode3 + 2];
-            if (myCoordData[thisNode3] > maxCoord[0]) maxCoord[0] = myCoordData[thisNode3];
-            if (myCoordData[thisNode3 + 1] > maxCoord[1]) maxCoord[1] = myCoordData[thisNode3 + 1];
-            if (myCoordData[thisNode3 + 2] > maxCoord[2]) maxCoord[2] = myCoordData[thisNode3 + 2];
+            for (int m = 0; m < 3; ++m)
+            {
+                if (myCoordData[thisNode3 + m] < minCoord[m]) minCoord[m] = myCoordData[thisNode3 + m];
+                if (myCoordData[thisNode3 + m] > maxCoord[m]) maxCoord[m] = myCoordData[thisNode3 + m];
+            }
+        }
+        for (int m = 0; m < 3; ++m)
+        {
+            triCentroids[i3 + m] = (minCoord[m] + maxCoord[m]) * 0.5f;//bounding box center is good enough for partitioning
+        }
+    }
+    m_leafTris.resize(m_numTris);
+    for (int32_t i = 0; i < m_numTris; ++i)
+    {
+        m_leafTris[i] = i;
+    }
+    if (m_numTris > 0)
+    {
+        m_nodes.reserve(4 * (m_numTris / MAX_LEAF_TRIS + 1));
+        buildNode(0, m_numTris, triBounds, triCentroids);
+    }
+    m_triSoA.resize(NUM_SOA_COMPONENTS * (int64_t)m_numTris);
+    for (int32_t slot = 0; slot < m_numTris; ++slot)
+    {
+        const int32_t* thisTri = getTriangle(m_leafTris[slot]);
+        Vector3D vertA = getCoordinate(thisTri[0]);
+        Vector3D ab = Vector3D(getCoordinate(thisTri[1])) - vertA;
+        Vector3D ac = Vector3D(getCoordinate(thisTri[2])) - vertA;
+        Vector3D normal = ab.cross(ac);//not normalized, the batch test divides by its squared length
+        for (int m = 0; m < 3; ++m)
+        {
+            m_triSoA[(A_X + m) * (int64_t)m_numTris + slot] = vertA[m];
+            m_triSoA[(AB_X + m) * (int64_t)m_numTris + slot] = ab[m];
+            m_triSoA[(AC_X + m) * (int64_t)m_numTris + slot] = ac[m];
+            m_triSoA[(N_X + m) * (int64_t)m_numTris + slot] = normal[m];
         }
-        addTriangle(m_indexRoot, i, minCoord, maxCoord);//use bounding box for now as an easy test to capture any chance of the triangle intersecting the Oct
     }
 }
 
-void SignedDistanceHelperBase::addTriangle(Oct<TriVector>* thisOct, int32_t triangle, float minCoord[3], float maxCoord[3])
+void SignedDistanceHelperBase::buildNode(const int32_t start, const int32_t end, const vector<float>& triBounds, const vector<float>& triCentroids)
 {
-    if (thisOct->m_leaf)
+    int32_t myIndex = (int32_t)m_nodes.size();
+    m_nodes.push_back(BVHNode());//don't keep a reference, recursion may reallocate
+    float nodeMin[3], nodeMax[3], centMin[3], centMax[3];
+    for (int m = 0; m < 3; ++m)
     {
-        thisOct->m_data.m_triList->push_back(triangle);
-        int numTris = (int)thisOct->m_data.m_triList->size();
-        if (numTris >= NUM_TRIS_TO_TEST && numTris % NUM_TRIS_TEST_INCR == NUM_TRIS_TO_TEST % NUM_TRIS_TEST_INCR)//the second modulus should const out
+        nodeMin[m] = centMin[m] = numeric_limits<float>::max();
+        nodeMax[m] = centMax[m] = -numeric_limits<float>::max();
+    }
+    for (int32_t i = start; i < end; ++i)
+    {
+        const float* thisBounds = triBounds.data() + m_leafTris[i] * 6;
+        const float* thisCent = triCentroids.data() + m_leafTris[i] * 3;
+        for (int m = 0; m < 3; ++m)
         {
-            Vector3D tempMinCoord, tempMaxCoord;
-            const float* myCoordData = m_coordList.data();
-            int totalSize = 0;
-            int numSplit = 0;
-            for (int i = 0; i < numTris; ++i)//gather data on how it would end up splitting
+            if (thisBounds[m] < nodeMin[m]) nodeMin[m] = thisBounds[m];
+            if (thisBounds[m + 3] > nodeMax[m]) nodeMax[m] = thisBounds[m + 3];
+            if (thisCent[m] < centMin[m]) centMin[m] = thisCent[m];
+            if (thisCent[m] > centMax[m]) centMax[m] = thisCent[m];
+        }
+    }
+    for (int m = 0; m < 3; ++m)
+    {
+        m_nodes[myIndex].m_min[m] = nodeMin[m];
+        m_nodes[myIndex].m_max[m] = nodeMax[m];
+    }
+    if (end - start <= MAX_LEAF_TRIS)
+    {
+        m_nodes[myIndex].m_start = start;
+        m_nodes[myIndex].m_count = end - start;
+        return;
+    }
+    int axis = 0;//split on the longest axis of the centroids, at the median, so the tree is always balanced
+    if (centMax[1] - centMin[1] > centMax[axis] - centMin[axis]) axis = 1;
+    if (centMax[2] - centMin[2] > centMax[axis] - centMin[axis]) axis = 2;
+    int32_t mid = start + (end - start) / 2;
+    nth_element(m_leafTris.begin() + start, m_leafTris.begin() + mid, m_leafTris.begin() + end, CentroidCompare(triCentroids.data(), axis));
+    m_nodes[myIndex].m_count = 0;
+    buildNode(start, mid, triBounds, triCentroids);//first child immediately follows
+    m_nodes[myIndex].m_start = (int32_t)m_nodes.size();
+    buildNode(mid, end, triBounds, triCentroids);
+}
+
+void SignedDistanceHelperBase::leafDistSquared(const float coord[3], const int32_t start, const int32_t count, float* distSquaredOut) const
+{//branch-free so that the compiler can vectorize across the triangles of the leaf
+    const int64_t stride = m_numTris;
+    const float* aX = m_triSoA.data() + A_X * stride + start, *aY = m_triSoA.data() + A_Y * stride + start, *aZ = m_triSoA.data() + A_Z * stride + start;
+    const float* abX = m_triSoA.data() + AB_X * stride + start, *abY = m_triSoA.data() + AB_Y * stride + start, *abZ = m_triSoA.data() + AB_Z * stride + start;
+    const float* acX = m_triSoA.data() + AC_X * stride + start, *acY = m_triSoA.data() + AC_Y * stride + start, *acZ = m_triSoA.data() + AC_Z * stride + start;
+    const float* nX = m_triSoA.data() + N_X * stride + start, *nY = m_triSoA.data() + N_Y * stride + start, *nZ = m_triSoA.data() + N_Z * stride + start;
+    const float px = coord[0], py = coord[1], pz = coord[2];
+    for (int32_t i = 0; i < count; ++i)
+    {
+        float apx = px - aX[i], apy = py - aY[i], apz = pz - aZ[i];
+        float bcx = acX[i] - abX[i], bcy = acY[i] - abY[i], bcz = acZ[i] - abZ[i];
+        float bpx = apx - abX[i], bpy = apy - abY[i], bpz = apz - abZ[i];
+        //closest point on each edge, clamped to the segment
+        float abLen2 = abX[i] * abX[i] + abY[i] * abY[i] + abZ[i] * abZ[i];
+        float acLen2 = acX[i] * acX[i] + acY[i] * acY[i] + acZ[i] * acZ[i];
+        float bcLen2 = bcx * bcx + bcy * bcy + bcz * bcz;
+        float tab = (abLen2 > 0.0f ? (apx * abX[i] + apy * abY[i] + apz * abZ[i]) / abLen2 : 0.0f);
+        float tac = (acLen2 > 0.0f ? (apx * acX[i] + apy * acY[i] + apz * acZ[i]) / acLen2 : 0.0f);
+        float tbc = (bcLen2 > 0.0f ? (bpx * bcx + bpy * bcy + bpz * bcz) / bcLen2 : 0.0f);
+        tab = min(max(tab, 0.0f), 1.0f);
+        tac = min(max(tac, 0.0f), 1.0f);
+        tbc = min(max(tbc, 0.0f), 1.0f);
+        float dx = apx - tab * abX[i], dy = apy - tab * abY[i], dz = apz - tab * abZ[i];
+        float edgeDist2 = dx * dx + dy * dy + dz * dz;
+        dx = apx - tac * acX[i]; dy = apy - tac * acY[i]; dz = apz - tac * acZ[i];
+        edgeDist2 = min(edgeDist2, dx * dx + dy * dy + dz * dz);
+        dx = bpx - tbc * bcx; dy = bpy - tbc * bcy; dz = bpz - tbc * bcz;
+        edgeDist2 = min(edgeDist2, dx * dx + dy * dy + dz * dz);
+        //the projection to the plane is inside if it is on the inner side of all three edges, measured along the normal
+        float nLen2 = nX[i] * nX[i] + nY[i] * nY[i] + nZ[i] * nZ[i];
+        float side1 = nX[i] * (abY[i] * apz - abZ[i] * apy) + nY[i] * (abZ[i] * apx - abX[i] * apz) + nZ[i] * (abX[i] * apy - abY[i] * apx);//(ab x ap) . n
+        float side2 = nX[i] * (bcy * bpz - bcz * bpy) + nY[i] * (bcz * bpx - bcx * bpz) + nZ[i] * (bcx * bpy - bcy * bpx);//(bc x bp) . n
+        float side3 = nX[i] * (apy * acZ[i] - apz * acY[i]) + nY[i] * (apz * acX[i] - apx * acZ[i]) + nZ[i] * (apx * acY[i] - apy * acX[i]);//(ap x ac) . n
+        float planeDist = apx * nX[i] + apy * nY[i] + apz * nZ[i];
+        bool inside = nLen2 > 0.0f && side1 >= 0.0f && side2 >= 0.0f && side3 >= 0.0f;
+        distSquaredOut[i] = (inside ? planeDist * planeDist / nLen2 : edgeDist2);
+    }
+}
+
+float SignedDistanceHelperBase::BVHNode::distSquaredToPoint(const float point[3]) const
+{
+    float ret = 0.0f;
+    for (int i = 0; i < 3; ++i)
+    {
+        float temp = max(max(m_min[i] - point[i], point[i] - m_max[i]), 0.0f);
+        ret += temp * temp;
+    }
+    return ret;
+}
+
+bool SignedDistanceHelperBase::BVHNode::rayIntersects(const float start[3], const float p2[3]) const
+{//same logic as Oct::rayIntersects
+    float curlow = 1.0f, curhigh = -1.0f;
+    bool first = true;
+    for (int i = 0; i < 3; ++i)
+    {
+        float direction = p2[i] - start[i];
+        if (direction != 0.0f)
+        {
+            float templow, temphigh;
+            if (direction > 0.0f)
             {
-                const int32_t* tempTri = getTriangle((*(thisOct->m_data.m_triList))[i]);
-                tempMaxCoord = tempMinCoord = myCoordData + tempTri[0] * 3;//set both to the coordinates of the first node in the triangle
-                for (int j = 1; j < 3; ++j)
-                {
-                    int32_t thisNode3 = tempTri[j] * 3;
-                    if (myCoordData[thisNode3] < tempMinCoord[0]) tempMinCoord[0] = myCoordData[thisNode3];
-                    if (myCoordData[thisNode3 + 1] < tempMinCoord[1]) tempMinCoord[1] = myCoordData[thisNode3 + 1];
-                    if (myCoordData[thisNode3 + 2] < tempMinCoord[2]) tempMinCoord[2] = myCoordData[thisNode3 + 2];
-                    if (myCoordData[thisNode3] > tempMaxCoord[0]) tempMaxCoord[0] = myCoordData[thisNode3];
-                    if (myCoordData[thisNode3 + 1] > tempMaxCoord[1]) tempMaxCoord[1] = myCoordData[thisNode3 + 1];
-                    if (myCoordData[thisNode3 + 2] > tempMaxCoord[2]) tempMaxCoord[2] = myCoordData[thisNode3 + 2];
-                }
-                int minOct[3], maxOct[3];
-                thisOct->containingChild(tempMinCoord, minOct);
-                thisOct->containingChild(tempMaxCoord, maxOct);
-                int splitSize = 8;
-                if (minOct[0] == maxOct[0]) splitSize >>= 1;
-                if (minOct[1] == maxOct[1]) splitSize >>= 1;
-                if (minOct[2] == maxOct[2]) splitSize >>= 1;
-                totalSize += splitSize;
-                if (splitSize != 8) ++numSplit;
+                templow = (m_min[i] - start[i]) / direction;//compute the range of t over which this line lies between the planes for this axis
+                temphigh = (m_max[i] - start[i]) / direction;
+            } else {
+                templow = (m_max[i] - start[i]) / direction;
+                temphigh = (m_min[i] - start[i]) / direction;
             }
-            if (numSplit > 0 && totalSize < 3.0f * numTris)//don't split if all triangles end up in all child octs, and try to balance speedup with memory usage
+            if (first)
             {
-                thisOct->makeChildren();//do the split
-                for (int i = 0; i < numTris; ++i)//gather data on how it would end up splitting
-                {
-                    const int32_t* tempTri = getTriangle((*(thisOct->m_data.m_triList))[i]);
-                    tempMaxCoord = tempMinCoord = myCoordData + tempTri[0] * 3;//set both to the coordinates of the first node in the triangle
-                    for (int j = 1; j < 3; ++j)
-                    {
-                        int32_t thisNode3 = tempTri[j] * 3;
-                        if (myCoordData[thisNode3] < tempMinCoord[0]) tempMinCoord[0] = myCoordData[thisNode3];
-                        if (myCoordData[thisNode3 + 1] < tempMinCoord[1]) tempMinCoord[1] = myCoordData[thisNode3 + 1];
-                        if (myCoordData[thisNode3 + 2] < tempMinCoord[2]) tempMinCoord[2] = myCoordData[thisNode3 + 2];
-                        if (myCoordData[thisNode3] > tempMaxCoord[0]) tempMaxCoord[0] = myCoordData[thisNode3];
-                        if (myCoordData[thisNode3 + 1] > tempMaxCoord[1]) tempMaxCoord[1] = myCoordData[thisNode3 + 1];
-                        if (myCoordData[thisNode3 + 2] > tempMaxCoord[2]) tempMaxCoord[2] = myCoordData[thisNode3 + 2];
-                    }
-                    for (int ci = 0; ci < 2; ++ci)
-                    {
-                        for (int cj = 0; cj < 2; ++cj)
-                        {
-                            for (int ck = 0; ck < 2; ++ck)
-                            {
-                                if (thisOct->m_children[ci][cj][ck]->boundsOverlaps(tempMinCoord, tempMaxCoord))
-                                {
-                                    addTriangle(thisOct->m_children[ci][cj][ck], (*(thisOct->m_data.m_triList))[i], tempMinCoord, tempMaxCoord);
-                                }
-                            }
-                        }
-                    }
-                }
-                thisOct->m_data.freeData();//and free up some memory
+                first = false;
+                curlow = templow;
+                curhigh = temphigh;
+            } else {
+                if (templow > curlow) curlow = templow;//intersect the ranges
+                if (temphigh < curhigh) curhigh = temphigh;
             }
+            if (curhigh < curlow || curhigh < 0.0f) return false;//if intersection is null or has no positive range, false
+        } else {
+            if (start[i] < m_min[i] || start[i] > m_max[i]) return false;
         }
-    } else {
-        for (int ci = 0; ci < 2; ++ci)
+    }
+    return true;
+}
+
+bool SignedDistanceHelperBase::BVHNode::lineSegmentIntersects(const float start[3], const float end[3]) const
+{//same logic as Oct::lineSegmentIntersects
+    float curlow = 1.0f, curhigh = -1.0f;
+    bool first = true;
+    for (int i = 0; i < 3; ++i)
+    {
+        float direction = end[i] - start[i];//parameterize the line segment to the range [0, 1] of t
+        if (direction != 0.0f)
         {
-            for (int cj = 0; cj < 2; ++cj)
+            float templow, temphigh;
+            if (direction > 0.0f)
             {
-                for (int ck = 0; ck < 2; ++ck)
-                {
-                    if (thisOct->m_children[ci][cj][ck]->boundsOverlaps(minCoord, maxCoord))
-                    {
-                        addTriangle(thisOct->m_children[ci][cj][ck], triangle, minCoord, maxCoord);
-                    }
-                }
+                templow = (m_min[i] - start[i]) / direction;
+                temphigh = (m_max[i] - start[i]) / direction;
+            } else {
+                templow = (m_max[i] - start[i]) / direction;
+                temphigh = (m_min[i] - start[i]) / direction;
+            }
+            if (first)
+            {
+                first = false;
+                curlow = templow;
+                curhigh = temphigh;
+            } else {
+                if (templow > curlow) curlow = templow;
+                if (temphigh < curhigh) curhigh = temphigh;
             }
+            if (curhigh < curlow || curhigh < 0.0f || curlow > 1.0f) return false;//if intersection is null or has no positive range, or has no range less than 1, false
+        } else {
+            if (start[i] < m_min[i] || start[i] > m_max[i]) return false;
         }
     }
+    return true;
 }
 
 const float* SignedDistanceHelperBase::getCoordinate(const int32_t nodeIndex) const
@@ -24,7 +24,6 @@
 #include "Vector3D.h"
 #include "CaretMutex.h"
 #include "CaretPointer.h"
-#include "OctTree.h"
 #include <vector>
 
 namespace caret {
@@ -34,29 +33,35 @@ namespace caret {
     
     class SignedDistanceHelperBase
     {
-        struct TriVector
-        {//specifically so we can cleanly deallocate the vector from non-leaf nodes when they split
-            std::vector<int32_t>* m_triList;
-            TriVector() { m_triList = new std::vector<int32_t>(); }
-            ~TriVector() { freeData(); }
-            void freeData()
-            {
-                if (m_triList != NULL)
-                {
-                    delete m_triList;
-                    m_triList = NULL;
-                }
-            }
+        struct BVHNode
+        {//flattened bounding volume hierarchy, stored depth-first so the first child of an internal node is always the next node
+            float m_min[3], m_max[3];
+            int32_t m_start;//leaf: first slot in m_leafTris, internal: index of the second child
+            int32_t m_count;//number of triangles in leaf, 0 for internal nodes
+            float distSquaredToPoint(const float point[3]) const;
+            bool rayIntersects(const float start[3], const float p2[3]) const;
+            bool lineSegmentIntersects(const float start[3], const float end[3]) const;
         };
-        static const int NUM_TRIS_TO_TEST = 50;//test for whether to split leaf at this number
-        static const int NUM_TRIS_TEST_INCR = 50;//and again at further multiples of this
-        CaretPointer<Oct<TriVector> > m_indexRoot;
+        enum TriSoAComponent
+        {//per-triangle precomputed values, stored structure-of-arrays in leaf order so that leaves can be tested in vectorizable batches
+            A_X, A_Y, A_Z,
+            AB_X, AB_Y, AB_Z,
+            AC_X, AC_Y, AC_Z,
+            N_X, N_Y, N_Z,
+            NUM_SOA_COMPONENTS
+        };
+        static const int MAX_LEAF_TRIS = 8;//don't split nodes with this many or fewer triangles
+        std::vector<BVHNode> m_nodes;
+        std::vector<int32_t> m_leafTris;//triangle indices, grouped by leaf
+        std::vector<float> m_triSoA;//NUM_SOA_COMPONENTS blocks of m_numTris floats each, indexed by position in m_leafTris
         int32_t m_numTris, m_numNodes;
         std::vector<float> m_coordList;//make a copy of what we need from SurfaceFile so that if the SurfaceFile gets destroyed, we don't crash
         std::vector<int32_t> m_triangleList;
         CaretPointer<TopologyHelper> m_topoHelp;
         SignedDistanceHelperBase();
-        void addTriangle(Oct<TriVector>* thisOct, int32_t triangle, float minCoord[3], float maxCoord[3]);
+        void buildNode(const int32_t start, const int32_t end, const std::vector<float>& triBounds, const std::vector<float>& triCentroids);
+        ///computes squared distance from the point to each triangle of a leaf, without classifying the closest point
+        void leafDistSquared(const float coord[3], const int32_t start, const int32_t count, float* distSquaredOut) const;
         const float* getCoordinate(const int32_t nodeIndex) const;//make these public? probably don't want them to be widely used, that is what SurfaceFile is for (but we don't want to store a SurfaceFile pointer)
         const int32_t* getTriangle(const int32_t tileIndex) const;
     public:
@@ -94,8 +99,8 @@ namespace caret {
     private:
         CaretMutex m_mutex;
         CaretPointer<SignedDistanceHelperBase> m_base;
-        CaretArray<int> m_triMarked;
-        CaretArray<int> m_triMarkChanged;
+        std::vector<int32_t> m_nodeStack;//scratch space, kept to avoid reallocation between queries
+        std::vector<float> m_leafScratch;
         SignedDistanceHelper();
         struct ClosestPointInfo
         {
@@ -103,6 +108,8 @@ namespace caret {
             int32_t node1, node2, triangle;
             Vector3D tempPoint;
         };
+        ///hintTriangle is tested first to tighten the search bound, use -1 for none
+        float closestTriangle(const float coord[3], const int32_t hintTriangle, ClosestPointInfo& bestInfo);
         float unsignedDistToTri(const float coord[3], int32_t triangle, ClosestPointInfo& myInfo);
         int computeSign(const float coord[3], ClosestPointInfo myInfo, WindingLogic myWinding);
         bool pointInTri(Vector3D verts[3], Vector3D inPlane, int majAxis, int midAxis);
@@ -112,6 +119,9 @@ namespace caret {
         ///return the signed distance value at the point
         float dist(const float coord[3], WindingLogic myWinding);
         
+        ///return the signed distances for many points, faster when consecutive points are near each other
+        void dist(const float* coords, const int64_t numCoords, WindingLogic myWinding, float* distOut);
+        
         ///find the closest point ON the surface, and return information about it
         ///will never have negative barycentric weights, or a point outside the triangle
         void barycentricWeights(const float coordIn[3], BarycentricInfo& baryInfoOut);
@@ -0,0 +1,126 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "SurfaceSmoothingHelper.h"
+
+#include "CaretAssert.h"
+#include "CaretOMP.h"
+#include "MathFunctions.h"
+#include "SurfaceFile.h"
+#include "TopologyHelper.h"
+
+using namespace caret;
+using namespace std;
+
+SurfaceSmoothingHelper::SurfaceSmoothingHelper(const SurfaceFile* mySurf)
+{
+    CaretAssert(mySurf != NULL);
+    m_numNodes = mySurf->getNumberOfNodes();
+    CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper(true);
+    m_neighborStart.resize(m_numNodes + 1);
+    m_neighborStart[0] = 0;
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        int32_t numNeighbors = 0;
+        myTopoHelp->getNodeNeighbors(i, numNeighbors);
+        m_neighborStart[i + 1] = m_neighborStart[i] + numNeighbors;
+    }
+    m_neighbors.resize(m_neighborStart[m_numNodes]);
+    m_maxNeighbors = 0;
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        int32_t numNeighbors = 0;
+        const int32_t* neighbors = myTopoHelp->getNodeNeighbors(i, numNeighbors);
+        for (int32_t j = 0; j < numNeighbors; ++j)
+        {
+            m_neighbors[m_neighborStart[i] + j] = neighbors[j];
+        }
+        if (numNeighbors > m_maxNeighbors) m_maxNeighbors = numNeighbors;
+    }
+}
+
+void SurfaceSmoothingHelper::iterate(const float* coordsIn, float* coordsOut, const float& strength) const
+{
+    CaretAssert(coordsIn != coordsOut);
+    const float inverseStrength = 1.0 - strength;
+#pragma omp CARET_PAR
+    {
+        vector<float> triangleAreas(m_maxNeighbors);//per-thread scratch
+        vector<float> triangleCenters(m_maxNeighbors * 3);
+#pragma omp CARET_FOR schedule(dynamic, 256)
+        for (int32_t iNode = 0; iNode < m_numNodes; ++iNode)
+        {
+            const int32_t* neighbors = m_neighbors.data() + m_neighborStart[iNode];
+            const int32_t numNeighbors = m_neighborStart[iNode + 1] - m_neighborStart[iNode];
+            const float* c1 = coordsIn + iNode * 3;
+            float* out = coordsOut + iNode * 3;
+            if (numNeighbors < 2)
+            {
+                out[0] = c1[0];
+                out[1] = c1[1];
+                out[2] = c1[2];
+                continue;
+            }
+            double totalArea = 0.0;
+            for (int32_t jn = 0; jn < numNeighbors; ++jn)
+            {//triangle formed by node and two consecutive neighbors
+                const int32_t n1 = neighbors[jn];
+                const int32_t n2 = neighbors[(jn + 1 < numNeighbors) ? jn + 1 : 0];
+                const float* c2 = coordsIn + n1 * 3;
+                const float* c3 = coordsIn + n2 * 3;
+                const float area = MathFunctions::triangleArea(c1, c2, c3);
+                triangleAreas[jn] = area;
+                totalArea += area;
+                for (int32_t k = 0; k < 3; ++k)
+                {
+                    triangleCenters[jn * 3 + k] = (c1[k] + c2[k] + c3[k]) / 3.0;
+                }
+            }
+            float neighborAverageX = 0.0;
+            float neighborAverageY = 0.0;
+            float neighborAverageZ = 0.0;
+            for (int32_t j = 0; j < numNeighbors; ++j)
+            {
+                if (triangleAreas[j] > 0.0)
+                {
+                    const float weight = triangleAreas[j] / totalArea;
+                    neighborAverageX += (weight * triangleCenters[j * 3]);
+                    neighborAverageY += (weight * triangleCenters[j * 3 + 1]);
+                    neighborAverageZ += (weight * triangleCenters[j * 3 + 2]);
+                }
+            }
+            out[0] = ((c1[0] * inverseStrength) + (neighborAverageX * strength));
+            out[1] = ((c1[1] * inverseStrength) + (neighborAverageY * strength));
+            out[2] = ((c1[2] * inverseStrength) + (neighborAverageZ * strength));
+        }
+    }
+}
+
+void SurfaceSmoothingHelper::smooth(vector<float>& coords, vector<float>& scratch, const float& strength, const int32_t& iterations) const
+{
+    CaretAssert((int64_t)coords.size() == (int64_t)m_numNodes * 3);
+    scratch.resize(coords.size());
+    for (int32_t iter = 0; iter < iterations; ++iter)
+    {
+        iterate(coords.data(), scratch.data(), strength);
+        coords.swap(scratch);//vector swap only exchanges pointers
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef __SURFACE_SMOOTHING_HELPER_H__
+#define __SURFACE_SMOOTHING_HELPER_H__
+
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <stdint.h>
+#include <vector>
+
+namespace caret {
+    
+    class SurfaceFile;
+    
+    ///area-weighted neighborhood averaging of surface coordinates, as used by -surface-smoothing and -surface-inflation
+    ///neighbor lists are copied out of TopologyHelper once, in compressed row form, so repeated smoothing doesn't revisit the topology
+    class SurfaceSmoothingHelper
+    {
+        std::vector<int32_t> m_neighborStart;//m_numNodes + 1 elements
+        std::vector<int32_t> m_neighbors;//in ring order, as returned by TopologyHelper
+        int32_t m_numNodes, m_maxNeighbors;
+    public:
+        SurfaceSmoothingHelper(const SurfaceFile* mySurf);
+        
+        int32_t getNumberOfNodes() const { return m_numNodes; }
+        
+        ///one iteration, reads only from coordsIn so that nodes can be done in parallel, coordsIn and coordsOut must not overlap
+        void iterate(const float* coordsIn, float* coordsOut, const float& strength) const;
+        
+        ///several iterations in place, swapping buffers instead of copying, scratch is resized if needed so it can be reused between calls
+        void smooth(std::vector<float>& coords, std::vector<float>& scratch, const float& strength, const int32_t& iterations) const;
+    };
+    
+}
+
+#endif //__SURFACE_SMOOTHING_HELPER_H__
@@ -70,7 +70,7 @@ VolumePaddingHelper VolumePaddingHelper::padMM(const VolumeFile* orig, const flo
     return padVoxels(orig, ipad, jpad, kpad);
 }
 
-void VolumePaddingHelper::doPadding(const VolumeFile* orig, VolumeFile* padded, const float& padval)
+void VolumePaddingHelper::doPadding(const VolumeFile* orig, VolumeFile* padded, const float& padval) const
 {
     CaretAssert(padded != orig);
     if (!orig->matchesVolumeSpace(m_origDims.data(), m_origSform)) throw CaretException("attempted to pad a volume that doesn't match the one initialized with");
@@ -113,7 +113,7 @@ void VolumePaddingHelper::doPadding(const VolumeFile* orig, VolumeFile* padded,
     }
 }
 
-void VolumePaddingHelper::undoPadding(const VolumeFile* padded, VolumeFile* orig)
+void VolumePaddingHelper::undoPadding(const VolumeFile* padded, VolumeFile* orig) const
 {
     CaretAssert(orig != padded);
     if (!padded->matchesVolumeSpace(m_paddedDims.data(), m_paddedSform)) throw CaretException("attempted to unpad a volume that doesn't match padding");
@@ -0,0 +1,125 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <algorithm>
+
+#include "CaretAssert.h"
+#include "GiftiLabel.h"
+#include "GiftiLabelTable.h"
+#include "GiftiLabelTableLookup.h"
+
+using namespace caret;
+
+/**
+ * Constructor.
+ *
+ * @param labelTable
+ *     Label table that is copied into the lookup.
+ */
+GiftiLabelTableLookup::GiftiLabelTableLookup(const GiftiLabelTable* labelTable)
+: m_minimumKey(0),
+m_hashMask(0)
+{
+    CaretAssert(labelTable);
+    labelTable->getKeys(m_keys);
+    const int32_t numberOfLabels = static_cast<int32_t>(m_keys.size());
+    m_labels.resize(numberOfLabels);
+    for (int32_t i = 0; i < numberOfLabels; i++) {
+        m_labels[i] = labelTable->getLabel(m_keys[i]);
+    }
+    
+    if (numberOfLabels <= 0) {
+        /*
+         * Dense array with one invalid entry so lookups
+         * never use the hash table
+         */
+        m_denseIndices.push_back(-1);
+        return;
+    }
+    
+    /*
+     * Keys are sorted, use a dense array unless the keys are sparse
+     */
+    m_minimumKey = m_keys.front();
+    const int64_t keyRange = static_cast<int64_t>(m_keys.back()) - m_minimumKey + 1;
+    const int64_t maximumDenseSize = std::max(static_cast<int64_t>(numberOfLabels) * 4, static_cast<int64_t>(65536));
+    if (keyRange <= maximumDenseSize) {
+        m_denseIndices.resize(keyRange, -1);
+        for (int32_t i = 0; i < numberOfLabels; i++) {
+            m_denseIndices[m_keys[i] - m_minimumKey] = i;
+        }
+        return;
+    }
+    
+    /*
+     * Hash table is at most half full so probe sequences are short
+     */
+    uint32_t numberOfSlots = 16;
+    while (numberOfSlots < static_cast<uint32_t>(numberOfLabels) * 2) {
+        numberOfSlots *= 2;
+    }
+    m_hashMask = numberOfSlots - 1;
+    m_hashSlots.resize(numberOfSlots * 2, -1);
+    for (int32_t i = 0; i < numberOfLabels; i++) {
+        uint32_t slot = hashKey(m_keys[i]) & m_hashMask;
+        while (m_hashSlots[slot * 2 + 1] >= 0) {
+            slot = (slot + 1) & m_hashMask;
+        }
+        m_hashSlots[slot * 2]     = m_keys[i];
+        m_hashSlots[slot * 2 + 1] = i;
+    }
+}
+
+/**
+ * @return Hash of a key.
+ *
+ * @param key
+ *     The key.
+ */
+uint32_t
+GiftiLabelTableLookup::hashKey(const int32_t key)
+{
+    return static_cast<uint32_t>(key) * 2654435761u;
+}
+
+/**
+ * @return Index of label with the given key, found in the hash
+ * table, or -1 if the key is not in the label table.
+ *
+ * @param key
+ *     Key of label.
+ */
+int32_t
+GiftiLabelTableLookup::getLabelIndexFromHash(const int32_t key) const
+{
+    CaretAssert( ! m_hashSlots.empty());
+    uint32_t slot = hashKey(key) & m_hashMask;
+    while (true) {
+        const int32_t labelIndex = m_hashSlots[slot * 2 + 1];
+        if (labelIndex < 0) {
+            return -1;
+        }
+        if (m_hashSlots[slot * 2] == key) {
+            return labelIndex;
+        }
+        slot = (slot + 1) & m_hashMask;
+    }
+}
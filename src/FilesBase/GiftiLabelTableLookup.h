@@ -0,0 +1,108 @@
+#ifndef __GIFTI_LABEL_TABLE_LOOKUP_H__
+#define __GIFTI_LABEL_TABLE_LOOKUP_H__
+
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <vector>
+#include <stdint.h>
+
+namespace caret {
+
+class GiftiLabel;
+class GiftiLabelTable;
+    
+/**
+ * Flat snapshot of a label table for mapping label keys to labels
+ * in per-vertex or per-voxel loops.  Each label is assigned an index,
+ * in ascending key order, so that per-label information (colors,
+ * selection status, parcel assignment) can be kept in vectors.
+ *
+ * Keys are located with a dense array when the range of keys is
+ * small relative to the number of labels (the usual case) and with
+ * an open addressing hash table otherwise.  Either way, no tree
+ * traversal or allocation occurs when a key is looked up.
+ *
+ * The lookup must be recreated if the label table is modified.
+ */
+class GiftiLabelTableLookup {
+
+public:
+    GiftiLabelTableLookup(const GiftiLabelTable* labelTable);
+    
+    /** @return Number of labels */
+    inline int32_t getNumberOfLabels() const { return m_keys.size(); }
+    
+    /**
+     * @return Index of label with the given key or -1 if
+     * the key is not in the label table.
+     * @param key
+     *     Key of label.
+     */
+    inline int32_t getLabelIndex(const int32_t key) const {
+        if ( ! m_denseIndices.empty()) {
+            const int64_t offset = static_cast<int64_t>(key) - m_minimumKey;
+            if ((offset < 0)
+                || (offset >= static_cast<int64_t>(m_denseIndices.size()))) {
+                return -1;
+            }
+            return m_denseIndices[offset];
+        }
+        return getLabelIndexFromHash(key);
+    }
+    
+    /** @return Key of label at the given index */
+    inline int32_t getLabelKey(const int32_t labelIndex) const { return m_keys[labelIndex]; }
+    
+    /** @return Label at the given index */
+    inline const GiftiLabel* getLabel(const int32_t labelIndex) const { return m_labels[labelIndex]; }
+    
+private:
+    GiftiLabelTableLookup(const GiftiLabelTableLookup&);
+    
+    GiftiLabelTableLookup& operator=(const GiftiLabelTableLookup&);
+    
+    int32_t getLabelIndexFromHash(const int32_t key) const;
+    
+    static uint32_t hashKey(const int32_t key);
+    
+    /** Keys in ascending order */
+    std::vector<int32_t> m_keys;
+    
+    /** Labels in same order as keys */
+    std::vector<const GiftiLabel*> m_labels;
+    
+    /** Smallest key, offset for dense indices */
+    int64_t m_minimumKey;
+    
+    /** Label index for each key from minimum to maximum key, -1 for keys not in table */
+    std::vector<int32_t> m_denseIndices;
+    
+    /** Hash slots containing a key and label index, index is -1 for an empty slot */
+    std::vector<int32_t> m_hashSlots;
+    
+    /** Number of hash slots minus one (number of slots is a power of two) */
+    uint32_t m_hashMask;
+};
+    
+} // namespace
+
+#endif // __GIFTI_LABEL_TABLE_LOOKUP_H__
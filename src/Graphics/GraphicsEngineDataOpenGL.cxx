@@ -384,6 +384,14 @@ GraphicsEngineDataOpenGL::loadTextureImageDataBuffer(GraphicsPrimitive* primitiv
             glBindTexture(GL_TEXTURE_2D, openGLTextureName);
             
             bool useMipMapFlag = true;
+            switch (primitive->m_textureFilteringType) {
+                case GraphicsPrimitive::TextureFilteringType::LINEAR:
+                    useMipMapFlag = true;
+                    break;
+                case GraphicsPrimitive::TextureFilteringType::NEAREST:
+                    useMipMapFlag = false;
+                    break;
+            }
             if (useMipMapFlag) {
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
@@ -415,6 +423,7 @@ GraphicsEngineDataOpenGL::loadTextureImageDataBuffer(GraphicsPrimitive* primitiv
                                                         GL_UNSIGNED_BYTE,  // data type of pixel data
                                                         imageBytesRGBA);    // pointer to image data
                 if (errorCode != 0) {
+                    CaretAssert(0);   // image must be 2^N by 2^M
                     useMipMapFlag = false;
                     
                     const GLubyte* errorChars = gluErrorString(errorCode);
@@ -427,7 +436,6 @@ GraphicsEngineDataOpenGL::loadTextureImageDataBuffer(GraphicsPrimitive* primitiv
             }
             
             if ( ! useMipMapFlag) {
-                CaretAssert(0);   // image must be 2^N by 2^M
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -131,6 +131,7 @@ GraphicsPrimitive::copyHelperGraphicsPrimitive(const GraphicsPrimitive& obj)
     m_textureImageBytesRGBA       = obj.m_textureImageBytesRGBA;
     m_textureImageWidth           = obj.m_textureImageWidth;
     m_textureImageHeight          = obj.m_textureImageHeight;
+    m_textureFilteringType        = obj.m_textureFilteringType;
 
     m_graphicsEngineDataForOpenGL.reset();
 }
@@ -1459,6 +1460,24 @@ GraphicsPrimitive::setTextureImage(const uint8_t* imageBytesRGBA,
     }
 }
 
+/**
+ * Set the filtering used for the texture.  NEAREST is used when
+ * each texel must remain a distinct, sharp rectangle (such as a
+ * matrix cell) and also avoids resampling of the image to
+ * power of two dimensions.
+ *
+ * @param textureFilteringType
+ *     New filtering type.
+ */
+void
+GraphicsPrimitive::setTextureFilteringType(const TextureFilteringType textureFilteringType)
+{
+    if (textureFilteringType != m_textureFilteringType) {
+        m_textureFilteringType = textureFilteringType;
+        m_graphicsEngineDataForOpenGL.reset();
+    }
+}
+
 /**
  * Get the OpenGL graphics engine data in this instance.
  *
@@ -95,6 +95,16 @@ namespace caret {
             FLOAT_STR
         };
         
+        /**
+         * Filtering used when a texture is magnified or minified
+         */
+        enum class TextureFilteringType {
+            /** Mipmapped, linear interpolation (texture is scaled to power of two dimensions) */
+            LINEAR,
+            /** Nearest texel, no mipmaps, texture dimensions are used as-is */
+            NEAREST
+        };
+        
         /**
          * Type of primitives for drawing.  There are NO primitives equivalent to
          * OpenGL's GL_QUAD_STRIP and GL_POLYGON.  The reason is that these
@@ -330,6 +340,13 @@ namespace caret {
          */
         inline TextureDataType getTextureDataType() const { return m_textureDataType; }
         
+        /**
+         * @return Filtering of texture.
+         */
+        inline TextureFilteringType getTextureFilteringType() const { return m_textureFilteringType; }
+        
+        void setTextureFilteringType(const TextureFilteringType textureFilteringType);
+        
         /**
          * @return The float coordinates.
          */
@@ -447,6 +464,8 @@ namespace caret {
         
         int32_t m_textureImageHeight = -1;
         
+        TextureFilteringType m_textureFilteringType = TextureFilteringType::LINEAR;
+        
         mutable PointSizeType m_pointSizeType = PointSizeType::PIXELS;
         
         mutable float m_pointDiameterValue = 1.0f;
@@ -31,6 +31,7 @@
 #ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
 #endif
 #include <QOpenGLContext>
+#include <QTimer>
 #include <QToolTip>
 #include <QWheelEvent>
 
@@ -40,6 +41,7 @@
 #include "BrainOpenGLFixedPipeline.h"
 #include "BrainOpenGLShape.h"
 #include "BrainOpenGLViewportContent.h"
+#include "BrainOpenGLWidgetTabImageCache.h"
 #include "BrainStructure.h"
 #include "BrowserTabContent.h"
 #include "CaretAssert.h"
@@ -195,6 +197,11 @@ BrainOpenGLWidget::~BrainOpenGLWidget()
 {
     makeCurrent();
     
+    /*
+     * Images must be deleted while the context is current
+     */
+    m_tabImageCache.reset();
+    
     this->clearDrawingViewportContents();
     
     delete this->userInputViewModeProcessor;
@@ -258,6 +265,15 @@ BrainOpenGLWidget::initializeGL()
     
     s_singletonOpenGL->initializeOpenGL();
     
+    /*
+     * initializeGL() is also called for the temporary context
+     * used by renderPixmap() so create the cache only once,
+     * for the widget's context.
+     */
+    if ( ! m_tabImageCache) {
+        m_tabImageCache.reset(new BrainOpenGLWidgetTabImageCache());
+    }
+    
     this->lastMouseX = 0;
     this->lastMouseY = 0;
     this->isMousePressedNearToolBox = false;
@@ -635,7 +651,8 @@ BrainOpenGLWidget::paintGL()
     s_singletonOpenGL->drawModels(this->windowIndex,
                                   GuiManager::get()->getBrain(),
                                   m_contextShareGroupPointer,
-                                  m_windowContent.getAllTabViewports());
+                                  m_windowContent.getAllTabViewports(),
+                                  m_tabImageCache.get());
     
     /*
      * Issue browser window redrawn event
@@ -1495,6 +1512,76 @@ BrainOpenGLWidget::mouseMoveEvent(QMouseEvent* me)
     me->accept();
 }
 
+/**
+ * Invalidate the cached images of tabs that have changed so
+ * that those tabs are drawn and the other tabs are drawn from
+ * their cached images.
+ *
+ * @param tabIndices
+ *     Indices of tabs that have changed.  If empty, all tabs
+ *     have changed.
+ */
+void
+BrainOpenGLWidget::invalidateTabImages(const std::set<int32_t>& tabIndices)
+{
+    if ( ! m_tabImageCache) {
+        return;
+    }
+    
+    if (tabIndices.empty()) {
+        m_tabImageCache->invalidateAllTabs();
+    }
+    else {
+        for (std::set<int32_t>::const_iterator iter = tabIndices.begin();
+             iter != tabIndices.end();
+             iter++) {
+            m_tabImageCache->invalidateTab(*iter);
+        }
+    }
+}
+
+/**
+ * Schedule an update of the graphics.  A single user action (such as
+ * dragging a slider or stepping a yoked map) may send many graphics
+ * update events.  Rather than drawing for each event, the first event
+ * schedules a redraw that occurs when control returns to the event
+ * loop and later events are ignored until that redraw occurs.
+ */
+void
+BrainOpenGLWidget::scheduleGraphicsUpdate()
+{
+    if ( ! m_graphicsUpdateScheduledFlag) {
+        m_graphicsUpdateScheduledFlag = true;
+        QTimer::singleShot(0, this, SLOT(processScheduledGraphicsUpdate()));
+    }
+}
+
+/**
+ * Redraw the graphics for a scheduled update.  The redraw always
+ * occurs, even if the graphics were painted after the update was
+ * scheduled, since that paint may have been to a pixmap or an
+ * off-screen buffer (image capture) and not to the window.
+ */
+void
+BrainOpenGLWidget::processScheduledGraphicsUpdate()
+{
+    m_graphicsUpdateScheduledFlag = false;
+    
+    if (( ! isVisible())
+        || window()->isMinimized()) {
+        /*
+         * Qt paints a hidden or minimized window when it is exposed
+         */
+        return;
+    }
+    
+#ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
+    this->update();
+#else
+    this->updateGL();
+#endif
+}
+
 /**
  * Receive events from the event manager.
  * 
@@ -1510,6 +1597,10 @@ BrainOpenGLWidget::receiveEvent(Event* event)
         
         this->borderBeingDrawn->clear();
         
+        if (m_tabImageCache) {
+            m_tabImageCache->invalidateAllTabs();
+        }
+        
         brainResetEvent->setEventProcessed();
     }
     else if (event->getEventType() == EventTypeEnum::EVENT_GRAPHICS_UPDATE_ALL_WINDOWS) {
@@ -1519,15 +1610,13 @@ BrainOpenGLWidget::receiveEvent(Event* event)
         
         updateAllEvent->setEventProcessed();
         
+        invalidateTabImages(updateAllEvent->getTabIndicesToUpdate());
+        
         if (updateAllEvent->isRepaint()) {
             this->repaint();
         }
         else {
-#ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
-            this->update();
-#else
-            this->updateGL();
-#endif
+            scheduleGraphicsUpdate();
         }
     }
     else if (event->getEventType() == EventTypeEnum::EVENT_GRAPHICS_UPDATE_ONE_WINDOW) {
@@ -1538,11 +1627,9 @@ BrainOpenGLWidget::receiveEvent(Event* event)
         if (updateOneEvent->getWindowIndex() == this->windowIndex) {
             updateOneEvent->setEventProcessed();
             
-#ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
-            this->update();
-#else
-            this->updateGL();
-#endif
+            invalidateTabImages(updateOneEvent->getTabIndicesToUpdate());
+            
+            scheduleGraphicsUpdate();
         }
         else {
             /*
@@ -54,6 +54,7 @@ namespace caret {
     class Border;
     class BrainOpenGL;
     class BrainOpenGLViewportContent;
+    class BrainOpenGLWidgetTabImageCache;
     class BrowserTabContent;
     class EventImageCapture;
     class SelectionItemAnnotation;
@@ -145,8 +146,16 @@ namespace caret {
         
         virtual void leaveEvent(QEvent* e);
         
+    private slots:
+        void processScheduledGraphicsUpdate();
+        
     private:
         
+        void scheduleGraphicsUpdate();
+        
+        void invalidateTabImages(const std::set<int32_t>& tabIndices);
+        
+        
         std::vector<BrainOpenGLViewportContent*> getDrawingViewportContent(const int32_t windowViewportIn[4]) const;
         
         void getDrawingWindowContent(const int32_t windowViewportIn[4],
@@ -169,6 +178,9 @@ namespace caret {
         //std::vector<BrainOpenGLViewportContent*> tabsViewportContent;
         BrainOpenGLWindowContent m_windowContent;
         
+        /** Images of unchanged tabs that are drawn in place of the tab's model */
+        std::unique_ptr<BrainOpenGLWidgetTabImageCache> m_tabImageCache;
+        
         int32_t windowWidth[BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_WINDOWS];
         int32_t windowHeight[BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_WINDOWS];
         
@@ -208,6 +220,9 @@ namespace caret {
         
         void* m_contextShareGroupPointer = NULL;
         
+        /** An update of the graphics is waiting for the event loop */
+        bool m_graphicsUpdateScheduledFlag = false;
+        
         static bool s_defaultGLFormatInitialized;
         
         static std::set<BrainOpenGLWidget*> s_brainOpenGLWidgets;
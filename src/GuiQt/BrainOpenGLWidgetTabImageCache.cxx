@@ -0,0 +1,457 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "BrainOpenGLWidgetTabImageCache.h"
+
+#ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#else
+#include <QGLContext>
+#endif
+
+#include "BrainOpenGLViewportContent.h"
+#include "BrowserTabContent.h"
+#include "CaretAssert.h"
+#include "Model.h"
+
+using namespace caret;
+
+
+    
+/**
+ * \class caret::BrainOpenGLWidgetTabImageCache 
+ * \brief Images of the model drawing in each of a window's tabs.
+ * \ingroup GuiQt
+ *
+ * After a tab's model is drawn, the tab's region of the frame buffer
+ * is copied to an image.  When the window is redrawn and a tab has
+ * not changed since its image was copied, the image is drawn in
+ * place of the model so that only the tabs that have changed are
+ * drawn.  A tab is changed by calling invalidateTab() or
+ * invalidateAllTabs(), or when its model or viewport changes.
+ *
+ * Only the models that are drawn without creating annotations
+ * (surfaces and volumes) are cached, the charts are always drawn.
+ */
+
+/**
+ * Constructor.  Must be called with the widget's OpenGL context current.
+ */
+BrainOpenGLWidgetTabImageCache::BrainOpenGLWidgetTabImageCache()
+: BrainOpenGLTabImageCacheInterface()
+{
+#ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
+    m_openGLContext = QOpenGLContext::currentContext();
+#else
+    m_openGLContext = QGLContext::currentContext();
+#endif
+    
+    for (int32_t i = 0; i < BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS; i++) {
+        m_tabChangeCount[i] = 0;
+    }
+}
+
+/**
+ * Destructor.  Must be called with the widget's OpenGL context current.
+ */
+BrainOpenGLWidgetTabImageCache::~BrainOpenGLWidgetTabImageCache()
+{
+    if ( ! isContextCurrent()) {
+        return;
+    }
+    
+    for (int32_t i = 0; i < BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS; i++) {
+#ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
+        m_tabImages[i].m_framebuffer.reset();
+#else
+        if (m_tabImages[i].m_textureName != 0) {
+            glDeleteTextures(1, &m_tabImages[i].m_textureName);
+            m_tabImages[i].m_textureName = 0;
+        }
+#endif
+    }
+}
+
+/**
+ * Invalidate the images of all tabs so that all tabs are drawn.
+ */
+void
+BrainOpenGLWidgetTabImageCache::invalidateAllTabs()
+{
+    ++m_allTabsChangeCount;
+}
+
+/**
+ * Invalidate the image of a tab so that the tab is drawn.
+ *
+ * @param tabIndex
+ *     Index of the tab.
+ */
+void
+BrainOpenGLWidgetTabImageCache::invalidateTab(const int32_t tabIndex)
+{
+    if ((tabIndex >= 0)
+        && (tabIndex < BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS)) {
+        ++m_tabChangeCount[tabIndex];
+    }
+}
+
+/**
+ * @return True if the signatures are the same.
+ *
+ * @param rhs
+ *     Signature compared to this signature.
+ */
+bool
+BrainOpenGLWidgetTabImageCache::TabSignature::operator==(const TabSignature& rhs) const
+{
+    for (int32_t i = 0; i < 4; i++) {
+        if ((m_tabViewport[i] != rhs.m_tabViewport[i])
+            || (m_modelViewport[i] != rhs.m_modelViewport[i])) {
+            return false;
+        }
+    }
+    
+    return ((m_browserTabContent == rhs.m_browserTabContent)
+            && (m_model == rhs.m_model)
+            && (m_allTabsChangeCount == rhs.m_allTabsChangeCount)
+            && (m_tabChangeCount == rhs.m_tabChangeCount));
+}
+
+/**
+ * @return True if the OpenGL context in which the images
+ * were created is the current context.
+ */
+bool
+BrainOpenGLWidgetTabImageCache::isContextCurrent() const
+{
+#ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
+    const void* currentContext = QOpenGLContext::currentContext();
+#else
+    const void* currentContext = QGLContext::currentContext();
+#endif
+    return ((m_openGLContext != NULL)
+            && (currentContext == m_openGLContext));
+}
+
+/**
+ * Get the signature of a tab's drawing.
+ *
+ * @param viewportContent
+ *     Viewport content of the tab.
+ * @param tabIndexOut
+ *     Output with index of the tab.
+ * @param signatureOut
+ *     Output with the signature.
+ * @return
+ *     True if the tab's drawing may be cached, else false.
+ */
+bool
+BrainOpenGLWidgetTabImageCache::getTabSignature(const BrainOpenGLViewportContent* viewportContent,
+                                                int32_t& tabIndexOut,
+                                                TabSignature& signatureOut) const
+{
+    CaretAssert(viewportContent);
+    
+    if ( ! isContextCurrent()) {
+        return false;
+    }
+    
+    const BrowserTabContent* browserTabContent = viewportContent->getBrowserTabContent();
+    if (browserTabContent == NULL) {
+        return false;
+    }
+    const Model* model = browserTabContent->getModelForDisplay();
+    if (model == NULL) {
+        return false;
+    }
+    
+    switch (model->getModelType()) {
+        case ModelTypeEnum::MODEL_TYPE_SURFACE:
+        case ModelTypeEnum::MODEL_TYPE_SURFACE_MONTAGE:
+        case ModelTypeEnum::MODEL_TYPE_VOLUME_SLICES:
+        case ModelTypeEnum::MODEL_TYPE_WHOLE_BRAIN:
+            break;
+        default:
+            /*
+             * Charts add annotations while they are drawn
+             */
+            return false;
+    }
+    
+    tabIndexOut = viewportContent->getTabIndex();
+    if ((tabIndexOut < 0)
+        || (tabIndexOut >= BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS)) {
+        return false;
+    }
+    
+    signatureOut.m_browserTabContent = browserTabContent;
+    signatureOut.m_model             = model;
+    viewportContent->getTabViewportBeforeApplyingMargins(signatureOut.m_tabViewport);
+    viewportContent->getModelViewport(signatureOut.m_modelViewport);
+    signatureOut.m_allTabsChangeCount = m_allTabsChangeCount;
+    signatureOut.m_tabChangeCount     = m_tabChangeCount[tabIndexOut];
+    
+    if ((signatureOut.m_tabViewport[2] <= 0)
+        || (signatureOut.m_tabViewport[3] <= 0)) {
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * If an image of the tab's model drawing is cached and the
+ * tab has not changed since the image was cached, draw the
+ * image into the tab's viewport.
+ *
+ * @param viewportContent
+ *     Viewport content of the tab.
+ * @return
+ *     True if the image was drawn, false if the model
+ *     must be drawn.
+ */
+bool
+BrainOpenGLWidgetTabImageCache::drawTabImage(const BrainOpenGLViewportContent* viewportContent)
+{
+    int32_t tabIndex = -1;
+    TabSignature signature;
+    if ( ! getTabSignature(viewportContent,
+                           tabIndex,
+                           signature)) {
+        return false;
+    }
+    
+    const TabImage& tabImage = m_tabImages[tabIndex];
+    if ( ! tabImage.m_valid) {
+        return false;
+    }
+    if ( ! (tabImage.m_signature == signature)) {
+        return false;
+    }
+    
+#ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
+    CaretAssert(tabImage.m_framebuffer);
+    drawTexture(tabImage.m_framebuffer->texture(),
+                signature.m_tabViewport,
+                1.0,
+                1.0);
+#else
+    CaretAssert(tabImage.m_textureName != 0);
+    drawTexture(tabImage.m_textureName,
+                signature.m_tabViewport,
+                (static_cast<float>(signature.m_tabViewport[2])
+                 / static_cast<float>(tabImage.m_textureWidth)),
+                (static_cast<float>(signature.m_tabViewport[3])
+                 / static_cast<float>(tabImage.m_textureHeight)));
+#endif
+    
+    return true;
+}
+
+/**
+ * Cache the image of the tab's model drawing that was just
+ * drawn into the tab's viewport.
+ *
+ * @param viewportContent
+ *     Viewport content of the tab.
+ */
+void
+BrainOpenGLWidgetTabImageCache::cacheTabImage(const BrainOpenGLViewportContent* viewportContent)
+{
+    int32_t tabIndex = -1;
+    TabSignature signature;
+    if ( ! getTabSignature(viewportContent,
+                           tabIndex,
+                           signature)) {
+        return;
+    }
+    
+    TabImage& tabImage = m_tabImages[tabIndex];
+    tabImage.m_valid = false;
+    
+    const int32_t x      = signature.m_tabViewport[0];
+    const int32_t y      = signature.m_tabViewport[1];
+    const int32_t width  = signature.m_tabViewport[2];
+    const int32_t height = signature.m_tabViewport[3];
+    
+#ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
+    /*
+     * The widget draws into a multisample frame buffer that
+     * cannot be copied to a texture so blit (resolve) the
+     * tab's region into a frame buffer object.
+     */
+    if ( ! QOpenGLFramebufferObject::hasOpenGLFramebufferBlit()) {
+        return;
+    }
+    if (tabImage.m_framebuffer) {
+        if ((tabImage.m_framebuffer->width() != width)
+            || (tabImage.m_framebuffer->height() != height)) {
+            tabImage.m_framebuffer.reset();
+        }
+    }
+    if ( ! tabImage.m_framebuffer) {
+        tabImage.m_framebuffer.reset(new QOpenGLFramebufferObject(width,
+                                                                  height));
+    }
+    if ( ! tabImage.m_framebuffer->isValid()) {
+        tabImage.m_framebuffer.reset();
+        return;
+    }
+    
+    QOpenGLFramebufferObject::blitFramebuffer(tabImage.m_framebuffer.get(),
+                                              QRect(0, 0, width, height),
+                                              NULL,
+                                              QRect(x, y, width, height));
+#else
+    /*
+     * Texture dimensions are a power of two for older OpenGL
+     */
+    int32_t textureWidth = 1;
+    while (textureWidth < width) {
+        textureWidth *= 2;
+    }
+    int32_t textureHeight = 1;
+    while (textureHeight < height) {
+        textureHeight *= 2;
+    }
+    GLint maximumTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE,
+                  &maximumTextureSize);
+    if ((textureWidth > maximumTextureSize)
+        || (textureHeight > maximumTextureSize)) {
+        return;
+    }
+    
+    glPushAttrib(GL_TEXTURE_BIT
+                 | GL_PIXEL_MODE_BIT);
+    
+    if (tabImage.m_textureName == 0) {
+        glGenTextures(1, &tabImage.m_textureName);
+        tabImage.m_textureWidth  = 0;
+        tabImage.m_textureHeight = 0;
+    }
+    glBindTexture(GL_TEXTURE_2D,
+                  tabImage.m_textureName);
+    if ((tabImage.m_textureWidth != textureWidth)
+        || (tabImage.m_textureHeight != textureHeight)) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D,
+                     0,
+                     GL_RGB,
+                     textureWidth,
+                     textureHeight,
+                     0,
+                     GL_RGB,
+                     GL_UNSIGNED_BYTE,
+                     NULL);
+        tabImage.m_textureWidth  = textureWidth;
+        tabImage.m_textureHeight = textureHeight;
+    }
+    
+    glReadBuffer(GL_BACK);
+    glCopyTexSubImage2D(GL_TEXTURE_2D,
+                        0,
+                        0,
+                        0,
+                        x,
+                        y,
+                        width,
+                        height);
+    
+    glPopAttrib();
+    
+    if (glGetError() != GL_NO_ERROR) {
+        return;
+    }
+#endif
+    
+    tabImage.m_signature = signature;
+    tabImage.m_valid     = true;
+}
+
+/**
+ * Draw a texture filling a viewport.
+ *
+ * @param textureName
+ *     Name of the texture.
+ * @param viewport
+ *     The viewport.
+ * @param maximumS
+ *     Texture coordinate at the right side of the viewport.
+ * @param maximumT
+ *     Texture coordinate at the top side of the viewport.
+ */
+void
+BrainOpenGLWidgetTabImageCache::drawTexture(const GLuint textureName,
+                                            const int viewport[4],
+                                            const float maximumS,
+                                            const float maximumT) const
+{
+    glPushAttrib(GL_ENABLE_BIT
+                 | GL_TEXTURE_BIT
+                 | GL_VIEWPORT_BIT
+                 | GL_CURRENT_BIT);
+    glViewport(viewport[0],
+               viewport[1],
+               viewport[2],
+               viewport[3]);
+    
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_BLEND);
+    
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0.0, 1.0, 0.0, 1.0, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D,
+                  textureName);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0, 0.0);
+    glVertex2f(0.0, 0.0);
+    glTexCoord2f(maximumS, 0.0);
+    glVertex2f(1.0, 0.0);
+    glTexCoord2f(maximumS, maximumT);
+    glVertex2f(1.0, 1.0);
+    glTexCoord2f(0.0, maximumT);
+    glVertex2f(0.0, 1.0);
+    glEnd();
+    
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    
+    glPopAttrib();
+}
+
@@ -0,0 +1,115 @@
+#ifndef __BRAIN_OPEN_G_L_WIDGET_TAB_IMAGE_CACHE_H__
+#define __BRAIN_OPEN_G_L_WIDGET_TAB_IMAGE_CACHE_H__
+
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+#include <memory>
+#include <stdint.h>
+
+/*
+ * When GLEW is used, CaretOpenGLInclude.h will include "Gl/glew.h".
+ * Gl/glew.h MUST BE BEFORE Gl/gl.h and Gl/gl.h is included by
+ * the Qt OpenGL headers so, we must include CaretOpenGL.h first.
+ */
+#include "CaretOpenGLInclude.h"
+
+#include "BrainConstants.h"
+#include "BrainOpenGLTabImageCacheInterface.h"
+
+#ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
+class QOpenGLFramebufferObject;
+#endif
+
+namespace caret {
+    class BrowserTabContent;
+    class Model;
+
+    class BrainOpenGLWidgetTabImageCache : public BrainOpenGLTabImageCacheInterface {
+        
+    public:
+        BrainOpenGLWidgetTabImageCache();
+        
+        virtual ~BrainOpenGLWidgetTabImageCache();
+        
+        void invalidateAllTabs();
+        
+        void invalidateTab(const int32_t tabIndex);
+        
+        virtual bool drawTabImage(const BrainOpenGLViewportContent* viewportContent);
+        
+        virtual void cacheTabImage(const BrainOpenGLViewportContent* viewportContent);
+        
+    private:
+        BrainOpenGLWidgetTabImageCache(const BrainOpenGLWidgetTabImageCache&);
+
+        BrainOpenGLWidgetTabImageCache& operator=(const BrainOpenGLWidgetTabImageCache&);
+        
+        /** What a tab's image shows, an image is drawn only when its signature matches the tab's current signature */
+        struct TabSignature {
+            const BrowserTabContent* m_browserTabContent;
+            const Model* m_model;
+            int m_tabViewport[4];
+            int m_modelViewport[4];
+            int64_t m_allTabsChangeCount;
+            int64_t m_tabChangeCount;
+            
+            bool operator==(const TabSignature& rhs) const;
+        };
+        
+        struct TabImage {
+            TabSignature m_signature;
+            bool m_valid = false;
+#ifdef WORKBENCH_USE_QT5_QOPENGL_WIDGET
+            std::unique_ptr<QOpenGLFramebufferObject> m_framebuffer;
+#else
+            GLuint m_textureName = 0;
+            int32_t m_textureWidth = 0;
+            int32_t m_textureHeight = 0;
+#endif
+        };
+        
+        bool getTabSignature(const BrainOpenGLViewportContent* viewportContent,
+                             int32_t& tabIndexOut,
+                             TabSignature& signatureOut) const;
+        
+        bool isContextCurrent() const;
+        
+        void drawTexture(const GLuint textureName,
+                         const int viewport[4],
+                         const float maximumS,
+                         const float maximumT) const;
+        
+        /** OpenGL context in which the images were created */
+        const void* m_openGLContext;
+        
+        /** Incremented when all tabs have changed */
+        int64_t m_allTabsChangeCount = 0;
+        
+        /** Incremented when a tab has changed */
+        int64_t m_tabChangeCount[BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS];
+        
+        TabImage m_tabImages[BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS];
+    };
+    
+} // namespace
+#endif  //__BRAIN_OPEN_G_L_WIDGET_TAB_IMAGE_CACHE_H__
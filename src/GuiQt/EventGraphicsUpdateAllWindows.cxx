@@ -60,3 +60,37 @@ EventGraphicsUpdateAllWindows::isRepaint() const
     return this->doRepaint; 
 }
 
+/**
+ * Limit the update to the given tabs.  Tabs that are not
+ * given are unchanged and may be drawn from cached images.
+ * By default, all tabs are updated.
+ *
+ * @param tabIndices
+ *    Indices of the tabs that have changed.
+ */
+void
+EventGraphicsUpdateAllWindows::setTabIndicesToUpdate(const std::set<int32_t>& tabIndices)
+{
+    m_tabIndicesToUpdate = tabIndices;
+}
+
+/**
+ * @return True if all tabs are updated (no tabs
+ * were given to setTabIndicesToUpdate()).
+ */
+bool
+EventGraphicsUpdateAllWindows::isAllTabsUpdate() const
+{
+    return m_tabIndicesToUpdate.empty();
+}
+
+/**
+ * @return Indices of the tabs that have changed.  Empty
+ * if all tabs are updated.
+ */
+const std::set<int32_t>&
+EventGraphicsUpdateAllWindows::getTabIndicesToUpdate() const
+{
+    return m_tabIndicesToUpdate;
+}
+
@@ -22,6 +22,9 @@
 /*LICENSE_END*/
 
 
+#include <set>
+#include <stdint.h>
+
 #include "Event.h"
 
 namespace caret {
@@ -36,12 +39,21 @@ namespace caret {
         
         bool isRepaint() const;
         
+        void setTabIndicesToUpdate(const std::set<int32_t>& tabIndices);
+        
+        bool isAllTabsUpdate() const;
+        
+        const std::set<int32_t>& getTabIndicesToUpdate() const;
+        
     private:
         EventGraphicsUpdateAllWindows(const EventGraphicsUpdateAllWindows&);
         
         EventGraphicsUpdateAllWindows& operator=(const EventGraphicsUpdateAllWindows&);
         
         bool doRepaint;
+        
+        /** Tabs that have changed, empty if all tabs have changed */
+        std::set<int32_t> m_tabIndicesToUpdate;
     };
 
 } // namespace
@@ -22,6 +22,9 @@
 /*LICENSE_END*/
 
 
+#include <set>
+#include <stdint.h>
+
 #include "Event.h"
 
 namespace caret {
@@ -37,6 +40,12 @@ namespace caret {
         /// get the index of the window that is to be updated.
         int32_t getWindowIndex() const { return this->windowIndex; }
         
+        void setTabIndicesToUpdate(const std::set<int32_t>& tabIndices);
+        
+        bool isAllTabsUpdate() const;
+        
+        const std::set<int32_t>& getTabIndicesToUpdate() const;
+        
     private:
         EventGraphicsUpdateOneWindow(const EventGraphicsUpdateOneWindow&);
         
@@ -44,6 +53,9 @@ namespace caret {
         
         /** index of window for update */
         int32_t windowIndex;
+        
+        /** Tabs that have changed, empty if all tabs have changed */
+        std::set<int32_t> m_tabIndicesToUpdate;
     };
 
 } // namespace
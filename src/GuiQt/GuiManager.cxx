@@ -1024,6 +1024,40 @@ GuiManager::getModelInBrowserWindow(const int32_t browserWindowIndex)
     return model;
 }
 
+/**
+ * Get the indices of tabs that display a data file.
+ *
+ * @param caretDataFile
+ *    The data file.
+ * @return
+ *    Indices of tabs in which the file is displayed.
+ */
+std::set<int32_t>
+GuiManager::getTabIndicesDisplayingDataFile(const CaretDataFile* caretDataFile) const
+{
+    std::set<int32_t> tabIndices;
+    
+    EventBrowserTabGetAll getAllTabs;
+    EventManager::get()->sendEvent(getAllTabs.getPointer());
+    const std::vector<BrowserTabContent*> allTabs = getAllTabs.getAllBrowserTabs();
+    for (std::vector<BrowserTabContent*>::const_iterator tabIter = allTabs.begin();
+         tabIter != allTabs.end();
+         tabIter++) {
+        BrowserTabContent* btc = *tabIter;
+        CaretAssert(btc);
+        
+        std::vector<CaretDataFile*> displayedFiles;
+        btc->getFilesDisplayedInTab(displayedFiles);
+        if (std::find(displayedFiles.begin(),
+                      displayedFiles.end(),
+                      caretDataFile) != displayedFiles.end()) {
+            tabIndices.insert(btc->getTabNumber());
+        }
+    }
+    
+    return tabIndices;
+}
+
 
 /**
  * Get the browser tab content in a browser window.
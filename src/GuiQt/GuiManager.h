@@ -45,6 +45,7 @@ namespace caret {
     class BrainBrowserWindow;
     class BrowserTabContent;
     class BugReportDialog;
+    class CaretDataFile;
     class ChartTwoLineSeriesHistoryDialog;
     class ClippingPlanesDialog;
     class CursorManager;
@@ -111,6 +112,8 @@ namespace caret {
         
         Model* getModelInBrowserWindow(const int32_t browserWindowIndex);
         
+        std::set<int32_t> getTabIndicesDisplayingDataFile(const CaretDataFile* caretDataFile) const;
+        
         void receiveEvent(Event* event);
 
         const CursorManager* getCursorManager() const;
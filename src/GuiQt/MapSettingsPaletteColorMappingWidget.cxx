@@ -503,7 +503,13 @@ MapSettingsPaletteColorMappingWidget::updateColoringAndGraphics()
                                                                 paletteFile);
     }
     EventManager::get()->sendEvent(EventSurfaceColoringInvalidate().getPointer());
-    EventManager::get()->sendEvent(EventGraphicsUpdateAllWindows().getPointer());
+    
+    /*
+     * Only the tabs displaying the file need to be drawn
+     */
+    EventGraphicsUpdateAllWindows graphicsUpdateEvent;
+    graphicsUpdateEvent.setTabIndicesToUpdate(GuiManager::get()->getTabIndicesDisplayingDataFile(this->caretMappableDataFile));
+    EventManager::get()->sendEvent(graphicsUpdateEvent.getPointer());
 }
 
 /**
@@ -1627,16 +1633,16 @@ MapSettingsPaletteColorMappingWidget::updatePaletteMappedToDataValueLabels()
                 negMaxLabelValue = statistics->getMostNegativeValue();
                 break;
             case PaletteScaleModeEnum::MODE_AUTO_SCALE_ABSOLUTE_PERCENTAGE:
-                posMaxLabelValue = statistics->getApproxPositivePercentile(this->paletteColorMapping->getAutoScaleAbsolutePercentageMaximum());
-                posMinLabelValue = statistics->getApproxPositivePercentile(this->paletteColorMapping->getAutoScaleAbsolutePercentageMinimum());
+                posMaxLabelValue = statistics->getPositivePercentile(this->paletteColorMapping->getAutoScaleAbsolutePercentageMaximum());
+                posMinLabelValue = statistics->getPositivePercentile(this->paletteColorMapping->getAutoScaleAbsolutePercentageMinimum());
                 negMinLabelValue = -posMinLabelValue;
                 negMaxLabelValue = -posMaxLabelValue;
                 break;
             case PaletteScaleModeEnum::MODE_AUTO_SCALE_PERCENTAGE:
-                posMaxLabelValue = statistics->getApproxPositivePercentile(this->paletteColorMapping->getAutoScalePercentagePositiveMaximum());
-                posMinLabelValue = statistics->getApproxPositivePercentile(this->paletteColorMapping->getAutoScalePercentagePositiveMinimum());
-                negMinLabelValue = statistics->getApproxNegativePercentile(this->paletteColorMapping->getAutoScalePercentageNegativeMinimum());
-                negMaxLabelValue = statistics->getApproxNegativePercentile(this->paletteColorMapping->getAutoScalePercentageNegativeMaximum());
+                posMaxLabelValue = statistics->getPositivePercentile(this->paletteColorMapping->getAutoScalePercentagePositiveMaximum());
+                posMinLabelValue = statistics->getPositivePercentile(this->paletteColorMapping->getAutoScalePercentagePositiveMinimum());
+                negMinLabelValue = statistics->getNegativePercentile(this->paletteColorMapping->getAutoScalePercentageNegativeMinimum());
+                negMaxLabelValue = statistics->getNegativePercentile(this->paletteColorMapping->getAutoScalePercentageNegativeMaximum());
                 break;
             case PaletteScaleModeEnum::MODE_USER_SCALE:
                 posMaxLabelValue = this->paletteColorMapping->getUserScalePositiveMaximum();
@@ -1856,16 +1862,16 @@ MapSettingsPaletteColorMappingWidget::getHistogram(const FastStatistics* statist
                     mostNeg  = statisticsForAll->getMin();
                     break;
                 case PaletteScaleModeEnum::MODE_AUTO_SCALE_ABSOLUTE_PERCENTAGE:
-                    mostPos  =  statisticsForAll->getApproxAbsolutePercentile(this->scaleAutoAbsolutePercentageMaximumSpinBox->value());
-                    leastPos =  statisticsForAll->getApproxAbsolutePercentile(this->scaleAutoAbsolutePercentageMinimumSpinBox->value());
-                    leastNeg = -statisticsForAll->getApproxAbsolutePercentile(this->scaleAutoAbsolutePercentageMinimumSpinBox->value());
-                    mostNeg  = -statisticsForAll->getApproxAbsolutePercentile(this->scaleAutoAbsolutePercentageMaximumSpinBox->value());
+                    mostPos  =  statisticsForAll->getAbsolutePercentile(this->scaleAutoAbsolutePercentageMaximumSpinBox->value());
+                    leastPos =  statisticsForAll->getAbsolutePercentile(this->scaleAutoAbsolutePercentageMinimumSpinBox->value());
+                    leastNeg = -statisticsForAll->getAbsolutePercentile(this->scaleAutoAbsolutePercentageMinimumSpinBox->value());
+                    mostNeg  = -statisticsForAll->getAbsolutePercentile(this->scaleAutoAbsolutePercentageMaximumSpinBox->value());
                     break;
                 case PaletteScaleModeEnum::MODE_AUTO_SCALE_PERCENTAGE:
-                    mostPos  = statisticsForAll->getApproxPositivePercentile(this->scaleAutoPercentagePositiveMaximumSpinBox->value());
-                    leastPos = statisticsForAll->getApproxPositivePercentile(this->scaleAutoPercentagePositiveMinimumSpinBox->value());
-                    leastNeg = statisticsForAll->getApproxNegativePercentile(this->scaleAutoPercentageNegativeMinimumSpinBox->value());
-                    mostNeg  = statisticsForAll->getApproxNegativePercentile(this->scaleAutoPercentageNegativeMaximumSpinBox->value());
+                    mostPos  = statisticsForAll->getPositivePercentile(this->scaleAutoPercentagePositiveMaximumSpinBox->value());
+                    leastPos = statisticsForAll->getPositivePercentile(this->scaleAutoPercentagePositiveMinimumSpinBox->value());
+                    leastNeg = statisticsForAll->getNegativePercentile(this->scaleAutoPercentageNegativeMinimumSpinBox->value());
+                    mostNeg  = statisticsForAll->getNegativePercentile(this->scaleAutoPercentageNegativeMaximumSpinBox->value());
                     break;
                 case PaletteScaleModeEnum::MODE_USER_SCALE:
                     mostPos  = this->scaleFixedPositiveMaximumSpinBox->value();
@@ -38,7 +38,10 @@
 #undef __OVERLAY_VIEW_CONTROLLER_DECLARE__
 
 #include "AnnotationColorBar.h"
+#include "BrowserTabContent.h"
+#include "CaretAssert.h"
 #include "CaretMappableDataFile.h"
+#include "EventBrowserTabGetAll.h"
 #include "EventDataFileReload.h"
 #include "EventGraphicsUpdateAllWindows.h"
 #include "EventGraphicsUpdateOneWindow.h"
@@ -52,6 +55,7 @@
 #include "GuiManager.h"
 #include "MapYokingGroupComboBox.h"
 #include "Overlay.h"
+#include "OverlaySet.h"
 #include "UsernamePasswordWidget.h"
 #include "WuQFactory.h"
 #include "WuQMessageBox.h"
@@ -790,12 +794,74 @@ void
 OverlayViewController::updateGraphicsWindow()
 {
     EventManager::get()->sendEvent(EventSurfaceColoringInvalidate().getPointer());
+    
+    /*
+     * Only the tabs changed by the overlay need to be drawn
+     */
+    const std::set<int32_t> tabIndices = getTabIndicesChangedByOverlay();
     if (this->overlay->getMapYokingGroup() != MapYokingGroupEnum::MAP_YOKING_GROUP_OFF) {
-        EventManager::get()->sendEvent(EventGraphicsUpdateAllWindows().getPointer());
+        EventGraphicsUpdateAllWindows graphicsUpdateEvent;
+        graphicsUpdateEvent.setTabIndicesToUpdate(tabIndices);
+        EventManager::get()->sendEvent(graphicsUpdateEvent.getPointer());
     }
     else {
-        EventManager::get()->sendEvent(EventGraphicsUpdateOneWindow(this->browserWindowIndex).getPointer());
+        EventGraphicsUpdateOneWindow graphicsUpdateEvent(this->browserWindowIndex);
+        graphicsUpdateEvent.setTabIndicesToUpdate(tabIndices);
+        EventManager::get()->sendEvent(graphicsUpdateEvent.getPointer());
+    }
+}
+
+/**
+ * @return Indices of the tabs changed by a change to the overlay:
+ * the tab containing the overlay and, if the overlay is map yoked,
+ * the tabs containing overlays in the same yoking group.  Empty
+ * (all tabs are changed) if the tab containing the overlay is
+ * not found.
+ */
+std::set<int32_t>
+OverlayViewController::getTabIndicesChangedByOverlay() const
+{
+    std::set<int32_t> tabIndices;
+    if (this->overlay == NULL) {
+        return tabIndices;
+    }
+    
+    const MapYokingGroupEnum::Enum mapYoking = this->overlay->getMapYokingGroup();
+    bool overlayTabFoundFlag = false;
+    
+    EventBrowserTabGetAll getAllTabs;
+    EventManager::get()->sendEvent(getAllTabs.getPointer());
+    const std::vector<BrowserTabContent*> allTabs = getAllTabs.getAllBrowserTabs();
+    for (std::vector<BrowserTabContent*>::const_iterator tabIter = allTabs.begin();
+         tabIter != allTabs.end();
+         tabIter++) {
+        BrowserTabContent* btc = *tabIter;
+        CaretAssert(btc);
+        
+        const OverlaySet* overlaySet = btc->getOverlaySet();
+        if (overlaySet == NULL) {
+            continue;
+        }
+        
+        const int32_t numberOfOverlays = overlaySet->getNumberOfDisplayedOverlays();
+        for (int32_t i = 0; i < numberOfOverlays; i++) {
+            const Overlay* tabOverlay = overlaySet->getOverlay(i);
+            if (tabOverlay == this->overlay) {
+                tabIndices.insert(btc->getTabNumber());
+                overlayTabFoundFlag = true;
+            }
+            else if ((mapYoking != MapYokingGroupEnum::MAP_YOKING_GROUP_OFF)
+                     && (tabOverlay->getMapYokingGroup() == mapYoking)) {
+                tabIndices.insert(btc->getTabNumber());
+            }
+        }
     }
+    
+    if ( ! overlayTabFoundFlag) {
+        tabIndices.clear();
+    }
+    
+    return tabIndices;
 }
 
 /**
@@ -1021,6 +1087,11 @@ void OverlayViewController::menuReloadFileTriggered()
             updateOverlaySettingsEditor();
             
             updateUserInterfaceAndGraphicsWindow();
+            
+            /*
+             * Reloaded file may be displayed by more than the overlay
+             */
+            EventManager::get()->sendEvent(EventGraphicsUpdateAllWindows().getPointer());
         }
     }
 }
@@ -21,6 +21,7 @@
  */
 /*LICENSE_END*/
 
+#include <set>
 #include <stdint.h>
 
 #include <QWidget>
@@ -114,6 +115,8 @@ namespace caret {
         
         void updateGraphicsWindow();
         
+        std::set<int32_t> getTabIndicesChangedByOverlay() const;
+        
         QMenu* createConstructionMenu(QWidget* parent);
         
         void validateYokingSelection();
@@ -20,6 +20,7 @@
 
 #include "NiftiIO.h"
 
+#include "CaretProfiler.h"
 #include "DataFileException.h"
 
 using namespace std;
@@ -27,6 +28,7 @@ using namespace caret;
 
 void NiftiIO::openRead(const QString& filename)
 {
+    CaretProfileScope myScope("nifti-header-read");
     m_file.open(filename);
     m_header.read(m_file);
     if (m_header.getDataType() == DT_BINARY)
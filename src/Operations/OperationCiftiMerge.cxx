@@ -22,6 +22,7 @@
 #include "OperationException.h"
 
 #include "CaretAssert.h"
+#include "CaretOMP.h"
 #include "CaretPointer.h"
 #include "CiftiFile.h"
 
@@ -54,12 +55,17 @@ OperationParameters* OperationCiftiMerge::getParameters()
     upToOpt->addStringParameter(1, "last-column", "the number or name of the last column to include");
     upToOpt->createOptionalParameter(2, "-reverse", "use the range in reverse order");
     
+    OptionalParameter* memLimitOpt = ret->createOptionalParameter(3, "-mem-limit", "restrict memory usage");
+    memLimitOpt->addDoubleParameter(1, "limit-GB", "memory limit in gigabytes");
+    
     ret->setHelpText(
         AString("Given input CIFTI files which have matching mappings along columns, and for which mappings along rows ") +
         "are the same type, all either series, scalars, or labels, this command concatenates the specified columns horizontally (rows become longer).\n\n" +
         "Example: wb_command -cifti-merge out.dtseries.nii -cifti first.dtseries.nii -column 1 -cifti second.dtseries.nii\n\n" +
         "This example would take the first column from first.dtseries.nii, followed by all columns from second.dtseries.nii, " +
-        "and write these columns to out.dtseries.nii."
+        "and write these columns to out.dtseries.nii.\n\n" +
+        "Rows are merged in blocks, with the input files read in parallel.  " +
+        "The -mem-limit option sets the size of these blocks, larger blocks can be faster when inputs are read from disk."
     );
     return ret;
 }
@@ -85,6 +91,18 @@ void OperationCiftiMerge::useParameters(OperationParameters* myParams, ProgressO
         default:
             throw OperationException("row mapping type must be series, scalars, or labels");
     }
+    OptionalParameter* memLimitOpt = myParams->getOptionalParameter(3);
+    float memLimitGB = -1.0f;
+    if (memLimitOpt->m_present)
+    {
+        memLimitGB = (float)memLimitOpt->getDouble(1);
+        if (memLimitGB < 0.0f)
+        {
+            throw OperationException("memory limit cannot be negative");
+        }
+    }
+    vector<vector<int64_t> > sourceColumns(numInputs);//which input columns each file contributes, in output order
+    vector<bool> useWholeRow(numInputs, false);
     int64_t numOutColumns = 0;//output row length
     for (int i = 0; i < numInputs; ++i)
     {
@@ -105,17 +123,24 @@ void OperationCiftiMerge::useParameters(OperationParameters* myParams, ProgressO
                 OptionalParameter* upToOpt = columnOpts[j]->getOptionalParameter(2);
                 if (upToOpt->m_present)
                 {
-                    int finalColumn = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(upToOpt->getString(1));//ditto
+                    int64_t finalColumn = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(upToOpt->getString(1));//ditto
                     if (finalColumn < 0 || finalColumn >= thisDims[0]) throw OperationException("ending column '" + columnOpts[j]->getString(1) + "' not valid in file '" + ciftiIn->getFileName() + "'");
                     if (finalColumn < initialColumn) throw OperationException("ending column occurs before starting column in file '" + ciftiIn->getFileName() + "'");
-                    numOutColumns += finalColumn - initialColumn + 1;//inclusive - we don't need to worry about reversing for counting, though
+                    if (upToOpt->getOptionalParameter(2)->m_present)
+                    {
+                        for (int64_t c = finalColumn; c >= initialColumn; --c) sourceColumns[i].push_back(c);
+                    } else {
+                        for (int64_t c = initialColumn; c <= finalColumn; ++c) sourceColumns[i].push_back(c);
+                    }
                 } else {
-                    numOutColumns += 1;
+                    sourceColumns[i].push_back(initialColumn);
                 }
             }
         } else {
-            numOutColumns += thisDims[0];
+            useWholeRow[i] = true;
+            for (int64_t c = 0; c < thisDims[0]; ++c) sourceColumns[i].push_back(c);
         }
+        numOutColumns += (int64_t)sourceColumns[i].size();
     }
     CiftiScalarsMap outScalarMap;//we only use one of these
     CiftiLabelsMap outLabelMap;
@@ -140,103 +165,38 @@ void OperationCiftiMerge::useParameters(OperationParameters* myParams, ProgressO
         default:
             CaretAssert(false);
     }
+    vector<int64_t> outColOffset(numInputs);
     int64_t curCol = 0, scratchRowLength = 0;
     for (int i = 0; i < numInputs; ++i)
     {
-        const CiftiFile* ciftiIn = myInputs[i]->getCifti(1);
-        vector<int64_t> thisDims = ciftiIn->getDimensions();
-        const CiftiXML& thisXML = ciftiIn->getCiftiXML();
-        const vector<ParameterComponent*>& columnOpts = *(myInputs[i]->getRepeatableParameterInstances(2));
-        int numColumnOpts = (int)columnOpts.size();
-        if (numColumnOpts > 0)
+        const CiftiXML& thisXML = myInputs[i]->getCifti(1)->getCiftiXML();
+        outColOffset[i] = curCol;
+        if (!useWholeRow[i])
         {
             scratchRowLength = max(scratchRowLength, thisXML.getDimensionLength(CiftiXML::ALONG_ROW));//if we use the entire row, we don't need a separate scratch row for it
-            if (doLoop)
-            {
-                for (int j = 0; j < numColumnOpts; ++j)
-                {
-                    int64_t initialColumn = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(columnOpts[j]->getString(1));//this function has the 1-indexing convention built in
-                    OptionalParameter* upToOpt = columnOpts[j]->getOptionalParameter(2);//we already checked that these strings give a valid column
-                    if (upToOpt->m_present)
-                    {
-                        int finalColumn = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(upToOpt->getString(1));//ditto
-                        bool reverse = upToOpt->getOptionalParameter(2)->m_present;
-                        if (reverse)
-                        {
-                            for (int c = finalColumn; c >= initialColumn; --c)
-                            {
-                                if (isLabel)
-                                {
-                                    const CiftiLabelsMap& thisLabelMap = thisXML.getLabelsMap(CiftiXML::ALONG_ROW);
-                                    outLabelMap.setMapName(curCol, thisLabelMap.getMapName(c));
-                                    *(outLabelMap.getMapLabelTable(curCol)) = *(thisLabelMap.getMapLabelTable(c));
-                                    *(outLabelMap.getMapMetadata(curCol)) = *(thisLabelMap.getMapMetadata(c));
-                                } else {
-                                    const CiftiScalarsMap& thisScalarMap = thisXML.getScalarsMap(CiftiXML::ALONG_ROW);
-                                    outScalarMap.setMapName(curCol, thisScalarMap.getMapName(c));
-                                    *(outScalarMap.getMapPalette(curCol)) = *(thisScalarMap.getMapPalette(c));
-                                    *(outScalarMap.getMapMetadata(curCol)) = *(thisScalarMap.getMapMetadata(c));
-                                }
-                                ++curCol;
-                            }
-                        } else {
-                            for (int c = initialColumn; c <= finalColumn; ++c)
-                            {
-                                if (isLabel)
-                                {
-                                    const CiftiLabelsMap& thisLabelMap = thisXML.getLabelsMap(CiftiXML::ALONG_ROW);
-                                    outLabelMap.setMapName(curCol, thisLabelMap.getMapName(c));
-                                    *(outLabelMap.getMapLabelTable(curCol)) = *(thisLabelMap.getMapLabelTable(c));
-                                    *(outLabelMap.getMapMetadata(curCol)) = *(thisLabelMap.getMapMetadata(c));
-                                } else {
-                                    const CiftiScalarsMap& thisScalarMap = thisXML.getScalarsMap(CiftiXML::ALONG_ROW);
-                                    outScalarMap.setMapName(curCol, thisScalarMap.getMapName(c));
-                                    *(outScalarMap.getMapPalette(curCol)) = *(thisScalarMap.getMapPalette(c));
-                                    *(outScalarMap.getMapMetadata(curCol)) = *(thisScalarMap.getMapMetadata(c));
-                                }
-                                ++curCol;
-                            }
-                        }
-                    } else {
-                        if (isLabel)
-                        {
-                            const CiftiLabelsMap& thisLabelMap = thisXML.getLabelsMap(CiftiXML::ALONG_ROW);
-                            outLabelMap.setMapName(curCol, thisLabelMap.getMapName(initialColumn));
-                            *(outLabelMap.getMapLabelTable(curCol)) = *(thisLabelMap.getMapLabelTable(initialColumn));
-                            *(outLabelMap.getMapMetadata(curCol)) = *(thisLabelMap.getMapMetadata(initialColumn));
-                        } else {
-                            const CiftiScalarsMap& thisScalarMap = thisXML.getScalarsMap(CiftiXML::ALONG_ROW);
-                            outScalarMap.setMapName(curCol, thisScalarMap.getMapName(initialColumn));
-                            *(outScalarMap.getMapPalette(curCol)) = *(thisScalarMap.getMapPalette(initialColumn));
-                            *(outScalarMap.getMapMetadata(curCol)) = *(thisScalarMap.getMapMetadata(initialColumn));
-                        }
-                        ++curCol;
-                    }
-                }
-            }
-        } else {
-            if (doLoop)
+        }
+        if (doLoop)
+        {
+            for (int64_t j = 0; j < (int64_t)sourceColumns[i].size(); ++j)
             {
-                for (int64_t j = 0; j < thisDims[0]; ++j)
+                int64_t c = sourceColumns[i][j];
+                if (isLabel)
                 {
-                    if (isLabel)
-                    {
-                        const CiftiLabelsMap& thisLabelMap = thisXML.getLabelsMap(CiftiXML::ALONG_ROW);
-                        outLabelMap.setMapName(curCol, thisLabelMap.getMapName(j));
-                        *(outLabelMap.getMapLabelTable(curCol)) = *(thisLabelMap.getMapLabelTable(j));
-                        *(outLabelMap.getMapMetadata(curCol)) = *(thisLabelMap.getMapMetadata(j));
-                    } else {
-                        const CiftiScalarsMap& thisScalarMap = thisXML.getScalarsMap(CiftiXML::ALONG_ROW);
-                        outScalarMap.setMapName(curCol, thisScalarMap.getMapName(j));
-                        *(outScalarMap.getMapPalette(curCol)) = *(thisScalarMap.getMapPalette(j));
-                        *(outScalarMap.getMapMetadata(curCol)) = *(thisScalarMap.getMapMetadata(j));
-                    }
-                    ++curCol;
+                    const CiftiLabelsMap& thisLabelMap = thisXML.getLabelsMap(CiftiXML::ALONG_ROW);
+                    outLabelMap.setMapName(curCol + j, thisLabelMap.getMapName(c));
+                    *(outLabelMap.getMapLabelTable(curCol + j)) = *(thisLabelMap.getMapLabelTable(c));
+                    *(outLabelMap.getMapMetadata(curCol + j)) = *(thisLabelMap.getMapMetadata(c));
+                } else {
+                    const CiftiScalarsMap& thisScalarMap = thisXML.getScalarsMap(CiftiXML::ALONG_ROW);
+                    outScalarMap.setMapName(curCol + j, thisScalarMap.getMapName(c));
+                    *(outScalarMap.getMapPalette(curCol + j)) = *(thisScalarMap.getMapPalette(c));
+                    *(outScalarMap.getMapMetadata(curCol + j)) = *(thisScalarMap.getMapMetadata(c));
                 }
             }
         }
+        curCol += (int64_t)sourceColumns[i].size();
     }
-    CaretAssert(!doLoop || curCol == numOutColumns);
+    CaretAssert(curCol == numOutColumns);
     CiftiXML outXML;
     outXML.setNumberOfDimensions(2);
     outXML.setMap(CiftiXML::ALONG_COLUMN, baseColMapping);
@@ -256,53 +216,61 @@ void OperationCiftiMerge::useParameters(OperationParameters* myParams, ProgressO
     }
     ciftiOut->setCiftiXML(outXML);
     int64_t numRows = baseColMapping.getLength();
-    vector<float> outRow(numOutColumns), scratchRow(scratchRowLength);
-    for (int64_t row = 0; row < numRows; ++row)
+    int64_t outRowBytes = max(numOutColumns + scratchRowLength, (int64_t)1) * sizeof(float);
+    int64_t blockRows = min(numRows, (int64_t)256);//default block keeps memory near that of a few hundred rows, while giving each thread a useful run of rows
+    if (memLimitGB >= 0.0f)
     {
-        curCol = 0;
-        for (int i = 0; i < numInputs; ++i)
+        blockRows = (int64_t)(memLimitGB * 1024 * 1024 * 1024 / outRowBytes);
+        if (blockRows > numRows) blockRows = numRows;
+    }
+    if (blockRows < 1) blockRows = 1;
+    vector<float> outBlock(blockRows * numOutColumns);
+    vector<AString> errors(numInputs);
+    for (int64_t blockStart = 0; blockStart < numRows; blockStart += blockRows)
+    {
+        int64_t blockEnd = min(blockStart + blockRows, numRows);
+#pragma omp CARET_PAR if (numInputs > 1)
         {
-            const CiftiFile* ciftiIn = myInputs[i]->getCifti(1);
-            vector<int64_t> thisDims = ciftiIn->getDimensions();
-            const CiftiXML& thisXML = ciftiIn->getCiftiXML();
-            const vector<ParameterComponent*>& columnOpts = *(myInputs[i]->getRepeatableParameterInstances(2));
-            int numColumnOpts = (int)columnOpts.size();
-            if (numColumnOpts > 0)
-            {
-                ciftiIn->getRow(scratchRow.data(), row);
-                for (int j = 0; j < numColumnOpts; ++j)
+            vector<float> scratchRow(scratchRowLength);
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int i = 0; i < numInputs; ++i)
+            {//each input file is read by only one thread, in row order, so on-disk inputs get sequential reads
+                try
                 {
-                    int64_t initialColumn = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(columnOpts[j]->getString(1));//this function has the 1-indexing convention built in
-                    OptionalParameter* upToOpt = columnOpts[j]->getOptionalParameter(2);//we already checked that these strings give a valid column
-                    if (upToOpt->m_present)
+                    const CiftiFile* ciftiIn = myInputs[i]->getCifti(1);
+                    const vector<int64_t>& thisSource = sourceColumns[i];
+                    const int64_t numSource = (int64_t)thisSource.size();
+                    for (int64_t row = blockStart; row < blockEnd; ++row)
                     {
-                        int finalColumn = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(upToOpt->getString(1));//ditto
-                        bool reverse = upToOpt->getOptionalParameter(2)->m_present;
-                        if (reverse)
+                        float* outRow = outBlock.data() + (row - blockStart) * numOutColumns + outColOffset[i];
+                        if (useWholeRow[i])
                         {
-                            for (int c = finalColumn; c >= initialColumn; --c)
+                            ciftiIn->getRow(outRow, row);
+                        } else {
+                            const float* inRow = ciftiIn->getRowPointer(row);//avoid the copy when the input is in memory
+                            if (inRow == NULL)
                             {
-                                outRow[curCol] = scratchRow[c];
-                                ++curCol;
+                                ciftiIn->getRow(scratchRow.data(), row);
+                                inRow = scratchRow.data();
                             }
-                        } else {
-                            for (int c = initialColumn; c <= finalColumn; ++c)
+                            for (int64_t j = 0; j < numSource; ++j)
                             {
-                                outRow[curCol] = scratchRow[c];
-                                ++curCol;
+                                outRow[j] = inRow[thisSource[j]];
                             }
                         }
-                    } else {
-                        outRow[curCol] = scratchRow[initialColumn];
-                        ++curCol;
                     }
+                } catch (CaretException& e) {
+                    errors[i] = e.whatString();
                 }
-            } else {
-                ciftiIn->getRow(outRow.data() + curCol, row);
-                curCol += thisDims[0];
             }
         }
-        CaretAssert(curCol == numOutColumns);
-        ciftiOut->setRow(outRow.data(), row);
+        for (int i = 0; i < numInputs; ++i)
+        {
+            if (errors[i] != "") throw OperationException(errors[i]);
+        }
+        for (int64_t row = blockStart; row < blockEnd; ++row)
+        {//output is written in order
+            ciftiOut->setRow(outBlock.data() + (row - blockStart) * numOutColumns, row);
+        }
     }
 }
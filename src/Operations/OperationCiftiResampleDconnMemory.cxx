@@ -23,11 +23,15 @@
 
 #include "AffineFile.h"
 #include "AlgorithmCiftiResample.h"
+#include "AlgorithmCiftiTranspose.h"
 #include "CiftiFile.h"
 #include "MetricFile.h"
 #include "SurfaceFile.h"
 #include "WarpfieldFile.h"
 
+#include <QDir>
+#include <QTemporaryFile>
+
 using namespace caret;
 using namespace std;
 
@@ -114,6 +118,9 @@ OperationParameters* OperationCiftiResampleDconnMemory::getParameters()
     cerebAreaMetricsOpt->addMetricParameter(1, "current-area", "a metric file with vertex areas for the current mesh");
     cerebAreaMetricsOpt->addMetricParameter(2, "new-area", "a metric file with vertex areas for the new mesh");
     
+    OptionalParameter* memLimitOpt = ret->createOptionalParameter(16, "-mem-limit", "use temporary files on disk instead of keeping the intermediate in memory");
+    memLimitOpt->addDoubleParameter(1, "limit-GB", "memory limit in gigabytes for the transposes");
+    
     AString myHelpText =
         AString("This command does the same thing as running -cifti-resample twice, but uses memory up to approximately 2x the size that the intermediate file would be.  ") +
         "This is because the intermediate dconn is kept in memory, rather than written to disk, " +
@@ -122,6 +129,9 @@ OperationParameters* OperationCiftiResampleDconnMemory::getParameters()
         "If spheres are not specified for a surface structure which exists in the cifti files, its data is copied without resampling or dilation.  " +
         "Dilation is done with the 'nearest' method, and is done on <new-sphere> for surface data.  " +
         "Volume components are padded before dilation so that dilation doesn't run into the edge of the component bounding box.\n\n" +
+        "If -mem-limit is specified, the intermediate is instead kept in temporary files next to the output file: rows are resampled, the result is transposed in blocks that fit the limit, " +
+        "rows are resampled again, and the result is transposed into the output.  " +
+        "This needs disk space for about 3 times the size of the output, but memory use no longer depends on the size of the dconn.\n\n" +
         "The <volume-method> argument must be one of the following:\n\n" +
         "CUBIC\nENCLOSING_VOXEL\nTRILINEAR\n\n" +
         "The <surface-method> argument must be one of the following:\n\n";
@@ -396,6 +406,66 @@ void OperationCiftiResampleDconnMemory::useParameters(OperationParameters* myPar
     {
         throw OperationException(message);
     }
+    OptionalParameter* memLimitOpt = myParams->getOptionalParameter(16);
+    if (memLimitOpt->m_present)
+    {
+        float memLimitGB = (float)memLimitOpt->getDouble(1);
+        if (memLimitGB < 0.0f)
+        {
+            throw OperationException("memory limit cannot be negative");
+        }
+        //resampling along rows streams through the file, so resample rows, transpose, resample rows again, and transpose back
+        AString tempTemplate = myCiftiOut->getFileName();
+        if (tempTemplate == "") tempTemplate = QDir::tempPath() + "/wb_command";
+        tempTemplate += ".XXXXXX.tmp.nii";
+        QTemporaryFile tempFile1(tempTemplate), tempFile2(tempTemplate), tempFile3(tempTemplate);//declared before the cifti objects, so they are deleted after the files are closed
+        if (!tempFile1.open() || !tempFile2.open() || !tempFile3.open())
+        {
+            throw OperationException("failed to create temporary files from template '" + tempTemplate + "'");
+        }
+        tempFile1.close();//we only need the names reserved, CiftiFile does its own file access
+        tempFile2.close();
+        tempFile3.close();
+        CiftiFile rowsResampled, transposed, transposedResampled;
+        rowsResampled.setWritingFile(tempFile1.fileName());
+        transposed.setWritingFile(tempFile2.fileName());
+        transposedResampled.setWritingFile(tempFile3.fileName());
+        if (warpfieldOpt->m_present)
+        {
+            AlgorithmCiftiResample(myProgObj, myCiftiIn, CiftiXML::ALONG_ROW, myTemplate, templateDir, mySurfMethod, myVolMethod, &rowsResampled, surfLargest, voldilatemm, surfdilatemm, myWarpfield.getWarpfield(),
+                                   curLeftSphere, newLeftSphere, curLeftAreas, newLeftAreas,
+                                   curRightSphere, newRightSphere, curRightAreas, newRightAreas,
+                                   curCerebSphere, newCerebSphere, curCerebAreas, newCerebAreas,
+                                   volDilateMethod, volDilateExponent, surfDilateMethod, surfDilateExponent);
+        } else {
+            AlgorithmCiftiResample(myProgObj, myCiftiIn, CiftiXML::ALONG_ROW, myTemplate, templateDir, mySurfMethod, myVolMethod, &rowsResampled, surfLargest, voldilatemm, surfdilatemm, myAffine.getMatrix(),
+                                   curLeftSphere, newLeftSphere, curLeftAreas, newLeftAreas,
+                                   curRightSphere, newRightSphere, curRightAreas, newRightAreas,
+                                   curCerebSphere, newCerebSphere, curCerebAreas, newCerebAreas,
+                                   volDilateMethod, volDilateExponent, surfDilateMethod, surfDilateExponent);
+        }
+        AlgorithmCiftiTranspose(NULL, &rowsResampled, &transposed, memLimitGB);
+        rowsResampled.close();
+        tempFile1.remove();//free the disk space early
+        if (warpfieldOpt->m_present)
+        {
+            AlgorithmCiftiResample(myProgObj, &transposed, CiftiXML::ALONG_ROW, myTemplate, templateDir, mySurfMethod, myVolMethod, &transposedResampled, surfLargest, voldilatemm, surfdilatemm, myWarpfield.getWarpfield(),
+                                   curLeftSphere, newLeftSphere, curLeftAreas, newLeftAreas,
+                                   curRightSphere, newRightSphere, curRightAreas, newRightAreas,
+                                   curCerebSphere, newCerebSphere, curCerebAreas, newCerebAreas,
+                                   volDilateMethod, volDilateExponent, surfDilateMethod, surfDilateExponent);
+        } else {
+            AlgorithmCiftiResample(myProgObj, &transposed, CiftiXML::ALONG_ROW, myTemplate, templateDir, mySurfMethod, myVolMethod, &transposedResampled, surfLargest, voldilatemm, surfdilatemm, myAffine.getMatrix(),
+                                   curLeftSphere, newLeftSphere, curLeftAreas, newLeftAreas,
+                                   curRightSphere, newRightSphere, curRightAreas, newRightAreas,
+                                   curCerebSphere, newCerebSphere, curCerebAreas, newCerebAreas,
+                                   volDilateMethod, volDilateExponent, surfDilateMethod, surfDilateExponent);
+        }
+        transposed.close();
+        tempFile2.remove();
+        AlgorithmCiftiTranspose(NULL, &transposedResampled, myCiftiOut, memLimitGB);
+        return;
+    }
     CiftiFile tempCifti;
     //TSC: resampling along column first causes it to hit peak memory usage earlier
     if (warpfieldOpt->m_present)
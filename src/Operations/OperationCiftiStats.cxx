@@ -21,6 +21,7 @@
 #include "OperationCiftiStats.h"
 #include "OperationException.h"
 
+#include "CaretOMP.h"
 #include "CiftiFile.h"
 #include "ReductionOperation.h"
 
@@ -119,13 +120,7 @@ namespace
             }
         }
         if (toUse.empty()) throw OperationException("roi is empty");
-        sort(toUse.begin(), toUse.end());
-        const float index = percent / 100.0f * (toUse.size() - 1);
-        if (index <= 0) return toUse[0];
-        if (index >= toUse.size() - 1) return toUse.back();
-        float ipart, fpart;
-        fpart = modf(index, &ipart);
-        return (1.0f - fpart) * toUse[(int)ipart] + fpart * toUse[((int)ipart) + 1];
+        return ReductionOperation::percentile(toUse.data(), toUse.size(), percent);//selection, not a full sort
     }
 }
 
@@ -196,27 +191,48 @@ void OperationCiftiStats::useParameters(OperationParameters* myParams, ProgressO
         {
             roiCifti->convertToInMemory();//ditto
         }
-        for (int i = 0; i < numCols; ++i)
+        vector<float> results(numCols);
+        vector<AString> errors(numCols);//report the first failing column in order, regardless of thread timing
+#pragma omp CARET_PAR
         {
-            myInput->getColumn(colScratch.data(), i);
+            vector<float> threadColumn(colLength), threadRoi;
             if (matchColumnMode)
             {
-                roiCifti->getColumn(roiData.data(), i);
+                threadRoi.resize(colLength);
+            } else {
+                threadRoi = roiData;
             }
-            float result;
-            if (reduceOpt->m_present)
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int i = 0; i < numCols; ++i)
             {
-                result = reduce(colScratch, myop, roiData);
-            } else {
-                CaretAssert(percentileOpt->m_present);
-                result = percentile(colScratch, percent, roiData);
+                try
+                {
+                    myInput->getColumn(threadColumn.data(), i);//in-memory, so this is safe from multiple threads
+                    if (matchColumnMode)
+                    {
+                        roiCifti->getColumn(threadRoi.data(), i);
+                    }
+                    if (reduceOpt->m_present)
+                    {
+                        results[i] = reduce(threadColumn, myop, threadRoi);
+                    } else {
+                        CaretAssert(percentileOpt->m_present);
+                        results[i] = percentile(threadColumn, percent, threadRoi);
+                    }
+                } catch (CaretException& e) {
+                    errors[i] = e.whatString();
+                }
             }
+        }
+        for (int i = 0; i < numCols; ++i)
+        {
+            if (!errors[i].isEmpty()) throw OperationException(errors[i]);
             if (showMapName)
             {
                 cout << AString::number(i + 1) << ": " << rowMap->getIndexName(i) << ": ";
             }
             stringstream resultsstr;
-            resultsstr << setprecision(7) << result;
+            resultsstr << setprecision(7) << results[i];
             cout << resultsstr.str() << endl;
         }
     } else {
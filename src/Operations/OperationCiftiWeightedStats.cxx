@@ -22,6 +22,7 @@
 #include "OperationException.h"
 
 #include "CaretHeap.h"
+#include "CaretOMP.h"
 #include "CiftiFile.h"
 #include "MetricFile.h"
 #include "SurfaceFile.h"
@@ -398,91 +399,101 @@ void OperationCiftiWeightedStats::useParameters(OperationParameters* myParams, P
         {
             myRoi->convertToInMemory();//ditto
         }
-        if (myXML.getMappingType(CiftiXML::ALONG_COLUMN) == CiftiMappingType::BRAIN_MODELS)
+        vector<vector<float> > results(numCols);//one result per surface structure, then volume, or just one for non-dense files
+        vector<AString> errors(numCols);//report the first failing column in order, regardless of thread timing
+        const bool isDense = (myXML.getMappingType(CiftiXML::ALONG_COLUMN) == CiftiMappingType::BRAIN_MODELS);
+        vector<CiftiBrainModelsMap::ModelInfo> myModels;
+        vector<CiftiBrainModelsMap::VolumeMap> volMap;
+        if (isDense)
         {
             const CiftiBrainModelsMap& myDenseMap = myXML.getBrainModelsMap(CiftiXML::ALONG_COLUMN);
-            vector<CiftiBrainModelsMap::ModelInfo> myModels = myDenseMap.getModelInfo();
-            int numModels = (int)myModels.size();
+            myModels = myDenseMap.getModelInfo();
+            volMap = myDenseMap.getFullVolumeMap();
+        }
+        int numModels = (int)myModels.size();
+        int64_t mapSize = (int64_t)volMap.size();
+#pragma omp CARET_PAR
+        {
+            vector<float> threadColumn(colLength), threadRoi = roiData;
+            vector<float> volData(mapSize), weightVolData(mapSize), roiVolData(mapSize);
+#pragma omp CARET_FOR schedule(dynamic)
             for (int64_t i = 0; i < numCols; ++i)
             {
-                myInput->getColumn(inColumn.data(), i);
-                if (matchColumnMode)
+                try
                 {
-                    myRoi->getColumn(roiData.data(), i);
+                    myInput->getColumn(threadColumn.data(), i);//in-memory, so this is safe from multiple threads
+                    if (matchColumnMode)
+                    {
+                        myRoi->getColumn(threadRoi.data(), i);
+                    }
+                    if (isDense)
+                    {
+                        for (int j = 0; j < numModels; ++j)
+                        {
+                            if (myModels[j].m_type == CiftiBrainModelsMap::SURFACE)
+                            {
+                                results[i].push_back(doOperation(threadColumn.data() + myModels[j].m_indexStart,
+                                                                 combinedWeights.data() + myModels[j].m_indexStart,
+                                                                 myModels[j].m_indexCount,
+                                                                 myop,
+                                                                 (threadRoi.empty() ? NULL : threadRoi.data() + myModels[j].m_indexStart),
+                                                                 argument));
+                            }
+                        }
+                        if (mapSize > 0)
+                        {
+                            for (int64_t j = 0; j < mapSize; ++j)
+                            {
+                                volData[j] = threadColumn[volMap[j].m_ciftiIndex];
+                                weightVolData[j] = combinedWeights[volMap[j].m_ciftiIndex];
+                                if (!threadRoi.empty())
+                                {
+                                    roiVolData[j] = threadRoi[volMap[j].m_ciftiIndex];
+                                }
+                            }
+                            results[i].push_back(doOperation(volData.data(), weightVolData.data(), mapSize, myop, (threadRoi.empty() ? NULL : roiVolData.data()), argument));
+                        }
+                    } else {
+                        results[i].push_back(doOperation(threadColumn.data(), combinedWeights.data(), colLength, myop, (threadRoi.empty() ? NULL : threadRoi.data()), argument));
+                    }
+                } catch (CaretException& e) {
+                    errors[i] = e.whatString();
                 }
+            }
+        }
+        for (int64_t i = 0; i < numCols; ++i)
+        {
+            if (!errors[i].isEmpty()) throw OperationException(errors[i]);
+            if (isDense)
+            {
                 if (showMapName)
                 {
                     cout << AString::number(i + 1) << ": " << rowMap->getIndexName(i) << ":" << endl;
                 }
+                int resultIndex = 0;
                 for (int j = 0; j < numModels; ++j)
                 {
                     if (myModels[j].m_type == CiftiBrainModelsMap::SURFACE)
                     {
-                        float result;
-                        if (roiData.empty())
-                        {
-                            result = doOperation(inColumn.data() + myModels[j].m_indexStart,
-                                                 combinedWeights.data() + myModels[j].m_indexStart,
-                                                 myModels[j].m_indexCount,
-                                                 myop,
-                                                 NULL,
-                                                 argument);
-                        } else {
-                            result = doOperation(inColumn.data() + myModels[j].m_indexStart,
-                                                 combinedWeights.data() + myModels[j].m_indexStart,
-                                                 myModels[j].m_indexCount,
-                                                 myop,
-                                                 roiData.data() + myModels[j].m_indexStart,
-                                                 argument);
-                        }
                         stringstream resultsstr;
-                        resultsstr << setprecision(7) << result;
+                        resultsstr << setprecision(7) << results[i][resultIndex];
                         cout << StructureEnum::toName(myModels[j].m_structure) << ": " << resultsstr.str() << endl;
+                        ++resultIndex;
                     }
                 }
-                vector<CiftiBrainModelsMap::VolumeMap> volMap = myDenseMap.getFullVolumeMap();
-                int64_t mapSize = (int64_t)volMap.size();
                 if (mapSize > 0)
                 {
-                    vector<float> volData(mapSize), weightVolData(mapSize), roiVolData(mapSize);
-                    for (int64_t j = 0; j < mapSize; ++j)
-                    {
-                        volData[j] = inColumn[volMap[j].m_ciftiIndex];
-                        weightVolData[j] = combinedWeights[volMap[j].m_ciftiIndex];
-                        if (!roiData.empty())
-                        {
-                            roiVolData[j] = roiData[volMap[j].m_ciftiIndex];
-                        }
-                    }
-                    float result;
-                    if (roiData.empty())
-                    {
-                        result = doOperation(volData.data(), weightVolData.data(), mapSize, myop, NULL, argument);
-                    } else {
-                        result = doOperation(volData.data(), weightVolData.data(), mapSize, myop, roiVolData.data(), argument);
-                    }
                     stringstream resultsstr;
-                    resultsstr << setprecision(7) << result;
+                    resultsstr << setprecision(7) << results[i][resultIndex];
                     cout << "VOLUME: " << resultsstr.str() << endl;
                 }
-            }
-        } else {
-            for (int64_t i = 0; i < numCols; ++i)
-            {
-                myInput->getColumn(inColumn.data(), i);
-                float result;
-                if (roiData.empty())
-                {
-                    result = doOperation(inColumn.data(), combinedWeights.data(), colLength, myop, NULL, argument);
-                } else {
-                    result = doOperation(inColumn.data(), combinedWeights.data(), colLength, myop, roiData.data(), argument);
-                }
+            } else {
                 if (showMapName)
                 {
                     cout << AString::number(i + 1) << ": " << rowMap->getIndexName(i) << ": ";
                 }
                 stringstream resultsstr;
-                resultsstr << setprecision(7) << result;
+                resultsstr << setprecision(7) << results[i][0];
                 cout << resultsstr.str() << endl;
             }
         }
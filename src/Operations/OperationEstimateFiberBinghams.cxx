@@ -201,16 +201,21 @@ void OperationEstimateFiberBinghams::useParameters(OperationParameters* myParams
     CiftiFile* myCifti = myParams->getOutputCifti(11);
     myCifti->setCiftiXML(myXML);
     vector<CiftiVolumeMap> volMap;
-    CaretArray<float> temprow(24);
     myXML.getVolumeMapForColumns(volMap);//we don't need to know which voxel is from which parcel
     int64_t end = (int64_t)volMap.size();
+    vector<float> allRows(end * 24);//voxels are independent, estimate them all in parallel and write the rows afterwards
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
     for (int64_t i = 0; i < end; ++i)
     {
-        myVolLabel->indexToSpace(volMap[i].m_ijk, temprow);//first three elements are the coordinates
-        estimateBingham(temprow.getArray() + 3, volMap[i].m_ijk, f1_samples, th1_samples, ph1_samples);
-        estimateBingham(temprow.getArray() + 10, volMap[i].m_ijk, f2_samples, th2_samples, ph2_samples);
-        estimateBingham(temprow.getArray() + 17, volMap[i].m_ijk, f3_samples, th3_samples, ph3_samples);
-        myCifti->setRow(temprow, volMap[i].m_ciftiIndex);
+        float* thisRow = allRows.data() + i * 24;
+        myVolLabel->indexToSpace(volMap[i].m_ijk, thisRow);//first three elements are the coordinates
+        estimateBingham(thisRow + 3, volMap[i].m_ijk, f1_samples, th1_samples, ph1_samples);
+        estimateBingham(thisRow + 10, volMap[i].m_ijk, f2_samples, th2_samples, ph2_samples);
+        estimateBingham(thisRow + 17, volMap[i].m_ijk, f3_samples, th3_samples, ph3_samples);
+    }
+    for (int64_t i = 0; i < end; ++i)
+    {
+        myCifti->setRow(allRows.data() + i * 24, volMap[i].m_ciftiIndex);
     }
 }
 
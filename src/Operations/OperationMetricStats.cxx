@@ -21,6 +21,7 @@
 #include "OperationMetricStats.h"
 #include "OperationException.h"
 
+#include "CaretOMP.h"
 #include "MetricFile.h"
 #include "ReductionOperation.h"
 
@@ -115,13 +116,7 @@ namespace
             }
         }
         if (toUse.empty()) throw OperationException("roi contains no vertices");
-        sort(toUse.begin(), toUse.end());
-        const float index = percent / 100.0f * (toUse.size() - 1);
-        if (index <= 0) return toUse[0];
-        if (index >= toUse.size() - 1) return toUse.back();
-        float ipart, fpart;
-        fpart = modf(index, &ipart);
-        return (1.0f - fpart) * toUse[(int)ipart] + fpart * toUse[((int)ipart) + 1];
+        return ReductionOperation::percentile(toUse.data(), toUse.size(), percent);//selection, not a full sort
     }
 }
 
@@ -179,35 +174,37 @@ void OperationMetricStats::useParameters(OperationParameters* myParams, Progress
     bool showMapName = myParams->getOptionalParameter(6)->m_present;
     if (column == -1)
     {
-        if (reduceOpt->m_present)
+        vector<float> results(numCols);
+        vector<AString> errors(numCols);//report the first failing column in order, regardless of thread timing
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int i = 0; i < numCols; ++i)
         {
-            for (int i = 0; i < numCols; ++i)
-            {//store result before printing anything, in case it throws while computing
+            try
+            {
+                const float* thisRoi = roiData;
                 if (matchColumnMode)
                 {
-                    roiData = myRoi->getValuePointerForColumn(i);
+                    thisRoi = myRoi->getValuePointerForColumn(i);
                 }
-                const float result = reduce(input->getValuePointerForColumn(i), numNodes, myop, roiData);
-                if (showMapName) cout << AString::number(i + 1) << ": " << input->getMapName(i) << ": ";
-                stringstream resultsstr;
-                resultsstr << setprecision(7) << result;
-                cout << resultsstr.str() << endl;
-            }
-        } else {
-            CaretAssert(percentileOpt->m_present);
-            for (int i = 0; i < numCols; ++i)
-            {//store result before printing anything, in case it throws while computing
-                if (matchColumnMode)
+                if (reduceOpt->m_present)
                 {
-                    roiData = myRoi->getValuePointerForColumn(i);
+                    results[i] = reduce(input->getValuePointerForColumn(i), numNodes, myop, thisRoi);
+                } else {
+                    CaretAssert(percentileOpt->m_present);
+                    results[i] = percentile(input->getValuePointerForColumn(i), numNodes, percent, thisRoi);
                 }
-                const float result = percentile(input->getValuePointerForColumn(i), numNodes, percent, roiData);
-                if (showMapName) cout << AString::number(i + 1) << ": " << input->getMapName(i) << ": ";
-                stringstream resultsstr;
-                resultsstr << setprecision(7) << result;
-                cout << resultsstr.str() << endl;
+            } catch (CaretException& e) {
+                errors[i] = e.whatString();
             }
         }
+        for (int i = 0; i < numCols; ++i)
+        {
+            if (!errors[i].isEmpty()) throw OperationException(errors[i]);
+            if (showMapName) cout << AString::number(i + 1) << ": " << input->getMapName(i) << ": ";
+            stringstream resultsstr;
+            resultsstr << setprecision(7) << results[i];
+            cout << resultsstr.str() << endl;
+        }
     } else {
         CaretAssert(column >= 0 && column < numCols);
         if (matchColumnMode)
@@ -22,6 +22,7 @@
 #include "OperationException.h"
 
 #include "CaretHeap.h"
+#include "CaretOMP.h"
 #include "MetricFile.h"
 #include "SurfaceFile.h"
 
@@ -290,16 +291,29 @@ void OperationMetricWeightedStats::useParameters(OperationParameters* myParams,
     bool showMapName = myParams->getOptionalParameter(10)->m_present;
     if (column == -1)
     {
+        vector<float> results(numCols);
+        vector<AString> errors(numCols);//report the first failing column in order, regardless of thread timing
+#pragma omp CARET_PARFOR schedule(dynamic)
         for (int i = 0; i < numCols; ++i)
-        {//store result before printing anything, in case it throws while computing
-            if (matchColumnMode)
+        {
+            try
             {
-                roiData = myRoi->getValuePointerForColumn(i);
+                const float* thisRoi = roiData;
+                if (matchColumnMode)
+                {
+                    thisRoi = myRoi->getValuePointerForColumn(i);
+                }
+                results[i] = doOperation(input->getValuePointerForColumn(i), useWeights, numNodes, myop, thisRoi, argument);
+            } catch (CaretException& e) {
+                errors[i] = e.whatString();
             }
-            const float result = doOperation(input->getValuePointerForColumn(i), useWeights, numNodes, myop, roiData, argument);
+        }
+        for (int i = 0; i < numCols; ++i)
+        {
+            if (!errors[i].isEmpty()) throw OperationException(errors[i]);
             if (showMapName) cout << AString::number(i + 1) << ": " << input->getMapName(i) << ": ";
             stringstream resultsstr;
-            resultsstr << setprecision(7) << result;
+            resultsstr << setprecision(7) << results[i];
             cout << resultsstr.str() << endl;
         }
     } else {
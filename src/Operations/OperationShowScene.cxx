@@ -19,6 +19,7 @@
  */
 /*LICENSE_END*/
 
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
 
@@ -34,12 +35,16 @@
 #include <QColor>
 
 
+#include "Annotation.h"
+#include "AnnotationManager.h"
 #include "Brain.h"
 #include "BrainOpenGLFixedPipeline.h"
 #include "BrainOpenGLViewportContent.h"
 #include "BrainOpenGLWindowContent.h"
 #include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
+#include "CaretPointer.h"
 #include "DataFileException.h"
 #include "EventBrowserTabGet.h"
 #include "EventMapYokingSelectMap.h"
@@ -65,6 +70,205 @@
 
 using namespace caret;
 
+namespace {
+    /**
+     * Holds copies of rendered images so that a batch of them can be
+     * compressed and written in parallel while the render buffer is reused.
+     */
+    class ImageWriteQueue {
+    public:
+        ImageWriteQueue() {
+            m_maximumPending = 1;
+#ifdef CARET_OMP
+            m_maximumPending = omp_get_max_threads();
+#endif
+        }
+        
+        ~ImageWriteQueue() {
+            for (std::vector<ImageFile*>::iterator iter = m_images.begin();
+                 iter != m_images.end();
+                 iter++) {
+                delete *iter;
+            }
+        }
+        
+        void addImage(const AString& imageFileName,
+                      const unsigned char* imageContent,
+                      const int32_t imageWidth,
+                      const int32_t imageHeight) {
+            /*
+             * ImageFile copies the pixels
+             */
+            m_images.push_back(new ImageFile(imageContent,
+                                             imageWidth,
+                                             imageHeight,
+                                             ImageFile::IMAGE_DATA_ORIGIN_AT_BOTTOM));
+            m_imageFileNames.push_back(imageFileName);
+            if (static_cast<int32_t>(m_images.size()) >= m_maximumPending) {
+                writePendingImages();
+            }
+        }
+        
+        void writePendingImages() {
+            const int32_t numImages = static_cast<int32_t>(m_images.size());
+            std::vector<AString> errors(numImages);
+#pragma omp CARET_PARFOR schedule(dynamic)
+            for (int32_t i = 0; i < numImages; i++) {
+                try {
+                    m_images[i]->writeFile(m_imageFileNames[i]);
+                }
+                catch (const DataFileException& dfe) {
+                    errors[i] = dfe.whatString();
+                }
+            }
+            for (int32_t i = 0; i < numImages; i++) {
+                delete m_images[i];
+            }
+            m_images.clear();
+            m_imageFileNames.clear();
+            
+            for (int32_t i = 0; i < numImages; i++) {
+                if ( ! errors[i].isEmpty()) {
+                    throw OperationException(errors[i]);
+                }
+            }
+        }
+        
+    private:
+        std::vector<ImageFile*> m_images;
+        std::vector<AString> m_imageFileNames;
+        int32_t m_maximumPending;
+    };
+    
+#ifdef HAVE_OSMESA
+    /**
+     * Create the viewport contents for drawing the tabs of a window.
+     *
+     * @param tabContents
+     *     Content of each tab.
+     * @param tileTabsConfiguration
+     *     The tile tabs configuration, NULL when drawing a single tab.
+     * @param gapsAndMargins
+     *     Contains margins around edges of tabs.
+     * @param windowIndex
+     *     Index of the window.
+     * @param windowViewport
+     *     The window's viewport, offset when drawing one tile of a larger image.
+     * @return
+     *     Viewport contents, caller must delete them.
+     */
+    std::vector<BrainOpenGLViewportContent*> createWindowViewportContents(std::vector<BrowserTabContent*>& tabContents,
+                                                                          TileTabsConfiguration* tileTabsConfiguration,
+                                                                          const GapsAndMargins* gapsAndMargins,
+                                                                          const int32_t windowIndex,
+                                                                          const int32_t windowViewport[4]) {
+        if (tileTabsConfiguration != NULL) {
+            const int32_t tabIndexToHighlight = -1;
+            return BrainOpenGLViewportContent::createViewportContentForTileTabs(tabContents,
+                                                                                tileTabsConfiguration,
+                                                                                gapsAndMargins,
+                                                                                windowIndex,
+                                                                                windowViewport,
+                                                                                tabIndexToHighlight);
+        }
+        
+        std::vector<BrainOpenGLViewportContent*> viewports;
+        CaretAssert(tabContents.size() == 1);
+        viewports.push_back(BrainOpenGLViewportContent::createViewportForSingleTab(tabContents[0],
+                                                                                   gapsAndMargins,
+                                                                                   windowIndex,
+                                                                                   windowViewport));
+        return viewports;
+    }
+    
+    /**
+     * Delete viewport contents and clear the vector.
+     *
+     * @param viewports
+     *     The viewport contents.
+     */
+    void deleteViewportContents(std::vector<BrainOpenGLViewportContent*>& viewports) {
+        for (std::vector<BrainOpenGLViewportContent*>::iterator vpIter = viewports.begin();
+             vpIter != viewports.end();
+             vpIter++) {
+            delete *vpIter;
+        }
+        viewports.clear();
+    }
+    
+    /**
+     * OpenGL clamps viewports to its maximum size, so a tab, or the window
+     * when it has window annotations, that is larger would be drawn cropped.
+     *
+     * @param brain
+     *     Brain containing the annotations.
+     * @param windowIndex
+     *     Index of the window.
+     * @param viewports
+     *     Viewport contents of the window.
+     * @param maximumViewportWidth
+     *     Maximum viewport width, zero if unknown.
+     * @param maximumViewportHeight
+     *     Maximum viewport height, zero if unknown.
+     * @return
+     *     Error message, empty if all viewports fit.
+     */
+    AString getViewportSizeError(Brain* brain,
+                                 const int32_t windowIndex,
+                                 const std::vector<BrainOpenGLViewportContent*>& viewports,
+                                 const int32_t maximumViewportWidth,
+                                 const int32_t maximumViewportHeight) {
+        if ((maximumViewportWidth <= 0)
+            || (maximumViewportHeight <= 0)) {
+            return "";
+        }
+        
+        const AString maximumText(" exceeds the maximum size supported by Mesa, width="
+                                  + QString::number(maximumViewportWidth)
+                                  + " height="
+                                  + QString::number(maximumViewportHeight));
+        for (std::vector<BrainOpenGLViewportContent*>::const_iterator vpIter = viewports.begin();
+             vpIter != viewports.end();
+             vpIter++) {
+            int tabViewport[4];
+            (*vpIter)->getTabViewportBeforeApplyingMargins(tabViewport);
+            if ((tabViewport[2] > maximumViewportWidth)
+                || (tabViewport[3] > maximumViewportHeight)) {
+                return ("Tab size width="
+                        + QString::number(tabViewport[2])
+                        + " height="
+                        + QString::number(tabViewport[3])
+                        + maximumText);
+            }
+        }
+        
+        if (viewports.empty()) {
+            return "";
+        }
+        int windowViewport[4];
+        viewports[0]->getWindowViewport(windowViewport);
+        if ((windowViewport[2] > maximumViewportWidth)
+            || (windowViewport[3] > maximumViewportHeight)) {
+            const std::vector<Annotation*> annotations = brain->getAnnotationManager()->getAllAnnotations();
+            for (std::vector<Annotation*>::const_iterator annIter = annotations.begin();
+                 annIter != annotations.end();
+                 annIter++) {
+                if (((*annIter)->getCoordinateSpace() == AnnotationCoordinateSpaceEnum::WINDOW)
+                    && ((*annIter)->getWindowIndex() == windowIndex)) {
+                    return ("Window with annotations, size width="
+                            + QString::number(windowViewport[2])
+                            + " height="
+                            + QString::number(windowViewport[3])
+                            + maximumText);
+                }
+            }
+        }
+        
+        return "";
+    }
+#endif // HAVE_OSMESA
+}
+
 /**
  * \class caret::OperationShowScene 
  * \brief Offscreen rendering of scene to an image file
@@ -116,6 +320,8 @@ OperationShowScene::getParameters()
     OptionalParameter* mapYokeOpt = ret->createOptionalParameter(8, "-set-map-yoke", "Override selected map index for a map yoking group.");
     mapYokeOpt->addStringParameter(1, "Map Yoking Roman Numeral", "Roman numeral identifying the map yoking group (I, II, III, IV, V, VI, VII, VIII, IX, X)");
     mapYokeOpt->addIntegerParameter(2, "Map Index", "Map index for yoking group.  Indices start at 1 (one)");
+    OptionalParameter* mapYokeUpToOpt = mapYokeOpt->createOptionalParameter(3, "-up-to", "Render an image for each map index in an inclusive range");
+    mapYokeUpToOpt->addIntegerParameter(1, "Last Map Index", "Last map index for yoking group.  Indices start at 1 (one)");
     
     AString helpText("Render content of browser windows displayed in a scene "
                      "into image file(s).  The image file name should be "
@@ -154,6 +360,16 @@ OperationShowScene::getParameters()
                  "      of the graphics region, the width and height specified\n"
                  "      on the command line is used for the size of the \n"
                  "      output image.\n"
+                 "\n"
+                 "When \"-up-to\" is used with \"-set-map-yoke\", the scene\n"
+                 "is loaded once and an image is rendered for each map index\n"
+                 "in the range.  The map index is inserted into the image\n"
+                 "name: \"capture_0001.png\", \"capture_0002.png\", etc.\n"
+                 "(after the window index, if there is more than one window).\n"
+                 "\n"
+                 "Images larger than the largest offscreen buffer are\n"
+                 "rendered in tiles that are joined into one image.  Each\n"
+                 "tab must still fit within the maximum OpenGL viewport.\n"
                  );
     
     
@@ -192,6 +408,7 @@ OperationShowScene::useParameters(OperationParameters* myParams,
     
     MapYokingGroupEnum::Enum mapYokingGroup = MapYokingGroupEnum::MAP_YOKING_GROUP_OFF;
     int32_t mapYokingMapIndex = -1;
+    int32_t mapYokingLastMapIndex = -1;
     OptionalParameter* mapYokeOpt = myParams->getOptionalParameter(8);
     if (mapYokeOpt->m_present) {
         const AString romanNumeral = mapYokeOpt->getString(1);
@@ -210,7 +427,34 @@ OperationShowScene::useParameters(OperationParameters* myParams,
          * Map indice in code start at zero
          */
         mapYokingMapIndex--;
+        
+        OptionalParameter* mapYokeUpToOpt = mapYokeOpt->getOptionalParameter(3);
+        if (mapYokeUpToOpt->m_present) {
+            mapYokingLastMapIndex = mapYokeUpToOpt->getInteger(1) - 1;
+            if (mapYokingLastMapIndex < mapYokingMapIndex) {
+                throw OperationException("Last map index must not be less than the map index.");
+            }
+        }
+        else {
+            mapYokingLastMapIndex = mapYokingMapIndex;
+        }
+    }
+    
+    /*
+     * Each frame is rendered with a different map selected in the yoking group,
+     * or there is a single frame when map yoking is not overridden
+     */
+    std::vector<int32_t> frameMapIndices;
+    if (mapYokingGroup != MapYokingGroupEnum::MAP_YOKING_GROUP_OFF) {
+        for (int32_t mapIndex = mapYokingMapIndex; mapIndex <= mapYokingLastMapIndex; mapIndex++) {
+            frameMapIndices.push_back(mapIndex);
+        }
     }
+    else {
+        frameMapIndices.push_back(-1);
+    }
+    const int32_t numFrames = static_cast<int32_t>(frameMapIndices.size());
+    const int32_t frameNumberDigits = std::max(4, AString::number(mapYokingLastMapIndex + 1).length());
     
     if ( ! useWindowSizeForImageSizeFlag) {
         if ((userImageWidth <= 0)
@@ -285,18 +529,7 @@ OperationShowScene::useParameters(OperationParameters* myParams,
     
     bool missingWindowMessageHasBeenDisplayed = false;
     
-    /*
-     * Apply map yoking
-     */
-    if (mapYokingGroup != MapYokingGroupEnum::MAP_YOKING_GROUP_OFF) {
-        MapYokingGroupEnum::setSelectedMapIndex(mapYokingGroup, mapYokingMapIndex);
-        
-        EventMapYokingSelectMap yokeEvent(mapYokingGroup,
-                                          NULL,
-                                          mapYokingMapIndex,
-                                          true);
-        EventManager::get()->sendEvent(yokeEvent.getPointer());
-    }
+    ImageWriteQueue imageWriteQueue;
     
     /*
      * Restore windows
@@ -373,16 +606,86 @@ OperationShowScene::useParameters(OperationParameters* myParams,
                                          + QString::number(imageHeight));
             }
             
-            int windowViewport[4] = { 0, 0, imageWidth, imageHeight };
-            
 //            float aspectRatio = -1.0;
 //            const bool windowAspectRatioLocked = browserClass->getBooleanValue("m_aspectRatioLockedStatus");
 //            if (windowAspectRatioLocked) {
 //                aspectRatio = browserClass->getFloatValue("m_aspectRatio", -1.0);
 //            }
             
-            const int windowWidth  = windowViewport[2];
-            const int windowHeight = windowViewport[3];
+            /*
+             * Find the tabs to draw, and the tile tabs configuration if it was saved to the scene
+             */
+            std::vector<BrowserTabContent*> allTabContent;
+            TileTabsConfiguration tileTabsConfiguration;
+            TileTabsConfiguration* tileTabsConfigurationPointer = NULL;
+            const SceneClass* toolbarClass = browserClass->getClass("m_toolbar");
+            if (restoreToTabTiles) {
+                const AString tileTabsConfigString = browserClass->getStringValue("m_sceneTileTabsConfiguration");
+                if (tileTabsConfigString.isEmpty()) {
+                    throw OperationException("Tile tabs configuration is corrupted.");
+                }
+                tileTabsConfiguration.decodeFromXML(tileTabsConfigString);
+                tileTabsConfigurationPointer = &tileTabsConfiguration;
+                
+                if (toolbarClass != NULL) {
+                    /*
+                     * Index of selected browser tab (NOT the tabBar)
+                     */
+                    const ScenePrimitiveArray* tabIndexArray = toolbarClass->getPrimitiveArray("tabIndices");
+                    if (tabIndexArray != NULL) {
+                        const int32_t numTabs = tabIndexArray->getNumberOfArrayElements();
+                        for (int32_t iTab = 0; iTab < numTabs; iTab++) {
+                            const int32_t tabIndex = tabIndexArray->integerValue(iTab);
+                            
+                            EventBrowserTabGet getTabContent(tabIndex);
+                            EventManager::get()->sendEvent(getTabContent.getPointer());
+                            BrowserTabContent* tabContent = getTabContent.getBrowserTab();
+                            if (tabContent == NULL) {
+                                throw OperationException("Failed to obtain tab number "
+                                                         + AString::number(tabIndex + 1)
+                                                         + " for window "
+                                                         + AString::number(windowIndex + 1));
+                            }
+                            allTabContent.push_back(tabContent);
+                        }
+                    }
+                    
+                    const int32_t numTabContent = static_cast<int32_t>(allTabContent.size());
+                    if (numTabContent <= 0) {
+                        throw OperationException("Failed to find any tab content");
+                    }
+                    std::vector<int32_t> rowHeights;
+                    std::vector<int32_t> columnWidths;
+                    if ( ! tileTabsConfiguration.getRowHeightsAndColumnWidthsForWindowSize(imageWidth,
+                                                                                           imageHeight,
+                                                                                           numTabContent,
+                                                                                           rowHeights,
+                                                                                           columnWidths)) {
+                        throw OperationException("Tile Tabs Row/Column sizing failed !!!");
+                    }
+                }
+            }
+            else if (toolbarClass != NULL) {
+                /*
+                 * Index of selected browser tab (NOT the tabBar)
+                 */
+                const int32_t selectedTabIndex = toolbarClass->getIntegerValue("selectedTabIndex", -1);
+                
+                EventBrowserTabGet getTabContent(selectedTabIndex);
+                EventManager::get()->sendEvent(getTabContent.getPointer());
+                BrowserTabContent* tabContent = getTabContent.getBrowserTab();
+                if (tabContent == NULL) {
+                    throw OperationException("Failed to obtain tab number "
+                                             + AString::number(selectedTabIndex + 1)
+                                             + " for window "
+                                             + AString::number(i + 1));
+                }
+                allTabContent.push_back(tabContent);
+            }
+            
+            if (allTabContent.empty()) {
+                continue;
+            }
             
             //
             // Create the Mesa Context
@@ -396,13 +699,99 @@ OperationShowScene::useParameters(OperationParameters* myParams,
                                                                accumBits,
                                                                NULL);
             if (mesaContext == 0) {
-                throw ("Creating Mesa Context failed.");
+                throw OperationException("Creating Mesa Context failed.");
+            }
+            
+            //
+            // Make the context current with a one pixel buffer so that the
+            // maximum buffer and viewport sizes can be queried.
+            //
+            unsigned char probeBuffer[4];
+            if (OSMesaMakeCurrent(mesaContext,
+                                  probeBuffer,
+                                  GL_UNSIGNED_BYTE,
+                                  1,
+                                  1) == 0) {
+                OSMesaDestroyContext(mesaContext);
+                throw OperationException("Making Mesa context current failed.");
+            }
+            GLint maximumBufferWidth  = 0;
+            GLint maximumBufferHeight = 0;
+            OSMesaGetIntegerv(OSMESA_MAX_WIDTH,
+                              &maximumBufferWidth);
+            OSMesaGetIntegerv(OSMESA_MAX_HEIGHT,
+                              &maximumBufferHeight);
+            GLint maximumViewportSize[2] = { 0, 0 };
+            glGetIntegerv(GL_MAX_VIEWPORT_DIMS,
+                          maximumViewportSize);
+            
+            //
+            // An image larger than the largest Mesa buffer is drawn in tiles.
+            // Each tile draws the whole window with the viewports offset so
+            // that the tile's part of the image lands in the tile buffer.
+            // Tiles are drawn one at a time since Brain and the OpenGL
+            // drawing state are not thread-safe.
+            //
+            int32_t tileWidth  = imageWidth;
+            int32_t tileHeight = imageHeight;
+            if (maximumBufferWidth > 0) {
+                tileWidth = std::min(tileWidth, static_cast<int32_t>(maximumBufferWidth));
+            }
+            if (maximumBufferHeight > 0) {
+                tileHeight = std::min(tileHeight, static_cast<int32_t>(maximumBufferHeight));
+            }
+            const bool tiledFlag = ((tileWidth < imageWidth)
+                                    || (tileHeight < imageHeight));
+            
+            //
+            // Viewport offsets are limited to the maximum viewport size,
+            // which limits how far the last tile can be from the origin.
+            //
+            if (tiledFlag
+                && (maximumViewportSize[0] > 0)
+                && (maximumViewportSize[1] > 0)) {
+                if (((imageWidth - tileWidth) > maximumViewportSize[0])
+                    || ((imageHeight - tileHeight) > maximumViewportSize[1])) {
+                    OSMesaDestroyContext(mesaContext);
+                    throw OperationException("Image size width="
+                                             + QString::number(imageWidth)
+                                             + " height="
+                                             + QString::number(imageHeight)
+                                             + " is too large to draw in tiles, maximum is width="
+                                             + QString::number(tileWidth + maximumViewportSize[0])
+                                             + " height="
+                                             + QString::number(tileHeight + maximumViewportSize[1]));
+                }
+            }
+            
+            //
+            // Each tab is drawn with one viewport, so a tab larger than
+            // the maximum viewport would be silently cropped.
+            //
+            {
+                const int windowViewport[4] = { 0, 0, imageWidth, imageHeight };
+                std::vector<BrainOpenGLViewportContent*> viewports = createWindowViewportContents(allTabContent,
+                                                                                                  tileTabsConfigurationPointer,
+                                                                                                  gapsAndMargins,
+                                                                                                  windowIndex,
+                                                                                                  windowViewport);
+                const AString viewportSizeError = getViewportSizeError(brain,
+                                                                       windowIndex,
+                                                                       viewports,
+                                                                       maximumViewportSize[0],
+                                                                       maximumViewportSize[1]);
+                deleteViewportContents(viewports);
+                if ( ! viewportSizeError.isEmpty()) {
+                    OSMesaDestroyContext(mesaContext);
+                    throw OperationException(viewportSizeError);
+                }
             }
             
             //
             // Allocate image buffer
+            // (64-bit size, large publication captures overflow 32 bits)
             //
-            const int32_t imageBufferSize =imageWidth * imageHeight * 4 * sizeof(unsigned char);
+            const int64_t imageBufferSize = static_cast<int64_t>(imageWidth) * imageHeight * 4 * sizeof(unsigned char);
             unsigned char* imageBuffer = new unsigned char[imageBufferSize];
             if (imageBuffer == 0) {
                 throw OperationException("Allocating image buffer size="
@@ -410,154 +799,86 @@ OperationShowScene::useParameters(OperationParameters* myParams,
                                          + " failed.");
             }
             
+            std::vector<unsigned char> tileBuffer;
+            unsigned char* renderBuffer = imageBuffer;
+            if (tiledFlag) {
+                tileBuffer.resize(static_cast<int64_t>(tileWidth) * tileHeight * 4);
+                renderBuffer = &tileBuffer[0];
+            }
+            
             //
             // Assign buffer to Mesa Context and make current
             //
             if (OSMesaMakeCurrent(mesaContext,
-                                  imageBuffer,
+                                  renderBuffer,
                                   GL_UNSIGNED_BYTE,
-                                  imageWidth,
-                                  imageHeight) == 0) {
-                throw OperationException("Assigning buffer to context and make current failed.");
+                                  tileWidth,
+                                  tileHeight) == 0) {
+                throw OperationException("Assigning buffer to context and make current failed.  "
+                                         "Buffer size width="
+                                         + QString::number(tileWidth)
+                                         + " height="
+                                         + QString::number(tileHeight)
+                                         + " may exceed the maximum size supported by Mesa.");
             }
             
-            /*
-             * If tile tabs was saved to the scene, restore it as the scenes tile tabs configuration
-             */
-            if (restoreToTabTiles) {
+            {
                 CaretPointer<BrainOpenGL> brainOpenGL(createBrainOpenGL());
                 
-                const AString tileTabsConfigString = browserClass->getStringValue("m_sceneTileTabsConfiguration");
-                if ( ! tileTabsConfigString.isEmpty()) {
-                    TileTabsConfiguration tileTabsConfiguration;
-                    tileTabsConfiguration.decodeFromXML(tileTabsConfigString);
+                const int32_t outputImageIndex = ((numBrowserClasses > 1)
+                                                  ? i
+                                                  : -1);
+                
+                for (int32_t iFrame = 0; iFrame < numFrames; iFrame++) {
+                    applyMapYoking(mapYokingGroup,
+                                   frameMapIndices[iFrame]);
                     
-                    /*
-                     * Restore toolbar
-                     */
-                    const SceneClass* toolbarClass = browserClass->getClass("m_toolbar");
-                    if (toolbarClass != NULL) {
-                        /*
-                         * Index of selected browser tab (NOT the tabBar)
-                         */
-                        std::vector<BrowserTabContent*> allTabContent;
-                        const ScenePrimitiveArray* tabIndexArray = toolbarClass->getPrimitiveArray("tabIndices");
-                        if (tabIndexArray != NULL) {
-                            const int32_t numTabs = tabIndexArray->getNumberOfArrayElements();
-                            for (int32_t iTab = 0; iTab < numTabs; iTab++) {
-                                const int32_t tabIndex = tabIndexArray->integerValue(iTab);
-                                
-                                EventBrowserTabGet getTabContent(tabIndex);
-                                EventManager::get()->sendEvent(getTabContent.getPointer());
-                                BrowserTabContent* tabContent = getTabContent.getBrowserTab();
-                                if (tabContent == NULL) {
-                                    throw OperationException("Failed to obtain tab number "
-                                                             + AString::number(tabIndex + 1)
-                                                             + " for window "
-                                                             + AString::number(windowIndex + 1));
+                    for (int32_t tileY = 0; tileY < imageHeight; tileY += tileHeight) {
+                        for (int32_t tileX = 0; tileX < imageWidth; tileX += tileWidth) {
+                            /*
+                             * Window viewport is moved so that this tile's
+                             * region of the image is at the buffer's origin
+                             */
+                            const int windowViewport[4] = { -tileX, -tileY, imageWidth, imageHeight };
+                            std::vector<BrainOpenGLViewportContent*> viewports = createWindowViewportContents(allTabContent,
+                                                                                                              tileTabsConfigurationPointer,
+                                                                                                              gapsAndMargins,
+                                                                                                              windowIndex,
+                                                                                                              windowViewport);
+                            std::vector<const BrainOpenGLViewportContent*> constViewports(viewports.begin(),
+                                                                                          viewports.end());
+                            brainOpenGL->drawModels(windowIndex,
+                                                    brain,
+                                                    mesaContext,
+                                                    constViewports);
+                            deleteViewportContents(viewports);
+                            
+                            if (tiledFlag) {
+                                /*
+                                 * Both buffers have their origin at the bottom
+                                 */
+                                glFinish();
+                                const int32_t copyWidth  = std::min(tileWidth, imageWidth - tileX);
+                                const int32_t copyHeight = std::min(tileHeight, imageHeight - tileY);
+                                for (int32_t row = 0; row < copyHeight; row++) {
+                                    const unsigned char* tileRow = renderBuffer + static_cast<int64_t>(row) * tileWidth * 4;
+                                    std::copy(tileRow,
+                                              tileRow + copyWidth * 4,
+                                              imageBuffer + (static_cast<int64_t>(tileY + row) * imageWidth + tileX) * 4);
                                 }
-                                allTabContent.push_back(tabContent);
                             }
                         }
-                        
-                        const int32_t numTabContent = static_cast<int32_t>(allTabContent.size());
-                        if (numTabContent <= 0) {
-                            throw OperationException("Failed to find any tab content");
-                        }
-                        std::vector<int32_t> rowHeights;
-                        std::vector<int32_t> columnWidths;
-                        if ( ! tileTabsConfiguration.getRowHeightsAndColumnWidthsForWindowSize(windowWidth,
-                                                                                               windowHeight,
-                                                                                               numTabContent,
-                                                                                               rowHeights,
-                                                                                               columnWidths)) {
-                            throw OperationException("Tile Tabs Row/Column sizing failed !!!");
-                        }
-                        
-                        const int32_t tabIndexToHighlight = -1;
-                        std::vector<BrainOpenGLViewportContent*> viewports =
-                            BrainOpenGLViewportContent::createViewportContentForTileTabs(allTabContent,
-                                                                                                     &tileTabsConfiguration,
-                                                                                                     gapsAndMargins,
-                                                                                                     windowIndex,
-                                                                                                     windowViewport,
-                                                                                                     tabIndexToHighlight);
-                        
-                        std::vector<const BrainOpenGLViewportContent*> constViewports(viewports.begin(),
-                                                                                      viewports.end());
-                        brainOpenGL->drawModels(windowIndex,
-                                                brain,
-                                                mesaContext,
-                                                constViewports);
-                        
-                        const int32_t outputImageIndex = ((numBrowserClasses > 1)
-                                                          ? i
-                                                          : -1);
-                        
-                        writeImage(imageFileName,
-                                   outputImageIndex,
-                                   imageBuffer,
-                                   imageWidth,
-                                   imageHeight);
-                        
-                        for (std::vector<BrainOpenGLViewportContent*>::iterator vpIter = viewports.begin();
-                             vpIter != viewports.end();
-                             vpIter++) {
-                            delete *vpIter;
-                        }
-                        viewports.clear();
-                    }
-                }
-                else {
-                    throw OperationException("Tile tabs configuration is corrupted.");
-                }
-            }
-            else {
-                CaretPointer<BrainOpenGL> brainOpenGL(createBrainOpenGL());
-                
-                /*
-                 * Restore toolbar
-                 */
-                const SceneClass* toolbarClass = browserClass->getClass("m_toolbar");
-                if (toolbarClass != NULL) {
-                    /*
-                     * Index of selected browser tab (NOT the tabBar)
-                     */
-                    const int32_t selectedTabIndex = toolbarClass->getIntegerValue("selectedTabIndex", -1);
-                    
-                    EventBrowserTabGet getTabContent(selectedTabIndex);
-                    EventManager::get()->sendEvent(getTabContent.getPointer());
-                    BrowserTabContent* tabContent = getTabContent.getBrowserTab();
-                    if (tabContent == NULL) {
-                        throw OperationException("Failed to obtain tab number "
-                                                 + AString::number(selectedTabIndex + 1)
-                                                 + " for window "
-                                                 + AString::number(i + 1));
                     }
                     
-                    CaretPointer<BrainOpenGLViewportContent> content(NULL);
-                    content.grabNew(BrainOpenGLViewportContent::createViewportForSingleTab(tabContent,
-                                                                                           gapsAndMargins,
-                                                                                           windowIndex,
-                                                                                           windowViewport));
-                    std::vector<const BrainOpenGLViewportContent*> viewportContents;
-                    viewportContents.push_back(content);
-                    
-                    brainOpenGL->drawModels(windowIndex,
-                                            brain,
-                                            mesaContext,
-                                            viewportContents);
-                    
-                    const int32_t outputImageIndex = ((numBrowserClasses > 1)
-                                                      ? i
-                                                      : -1);
-                    
-                    writeImage(imageFileName,
-                               outputImageIndex,
-                               imageBuffer,
-                               imageWidth,
-                               imageHeight);
-                    
+                    imageWriteQueue.addImage(createImageFileName(imageFileName,
+                                                                 outputImageIndex,
+                                                                 ((numFrames > 1)
+                                                                  ? frameMapIndices[iFrame]
+                                                                  : -1),
+                                                                 frameNumberDigits),
+                                             imageBuffer,
+                                             imageWidth,
+                                             imageHeight);
                 }
             }
             
@@ -568,6 +889,8 @@ OperationShowScene::useParameters(OperationParameters* myParams,
             OSMesaDestroyContext(mesaContext);
         }
     }
+    
+    imageWriteQueue.writePendingImages();
 
     /*
      * Print error messages
@@ -758,35 +1081,41 @@ OperationShowScene::createBrainOpenGL()
 #endif // HAVE_OSMESA
 
 /**
- * Write the image data to a Image File.
+ * Create the name of an image file.
  *
  * @param imageFileName
  *     Name of image file.
  * @param imageIndex
- *     Index of image.
- * @param imageContent
- *     content of image.
- * @param imageWidth
- *     width of image.
- * @param imageHeight
- *     height of image.
+ *     Index of image (window), negative if only one window.
+ * @param mapIndex
+ *     Index of map yoking map, negative if not rendering a range of maps.
+ * @param mapIndexDigits
+ *     Number of digits for the map index.
+ * @return
+ *     Name for the image file.
  */
-void
-OperationShowScene::writeImage(const AString& imageFileName,
-                               const int32_t imageIndex,
-                               const unsigned char* imageContent,
-                               const int32_t imageWidth,
-                               const int32_t imageHeight)
+AString
+OperationShowScene::createImageFileName(const AString& imageFileName,
+                                        const int32_t imageIndex,
+                                        const int32_t mapIndex,
+                                        const int32_t mapIndexDigits)
 {
-    /*
-     * Create name of image
-     */
-    QString outputName(imageFileName);
+    AString imageNumber;
     if (imageIndex >= 0) {
-        const AString imageNumber = QString("_%1").arg((int)(imageIndex + 1),
-                                                       2, // width
-                                                       10, // base
-                                                       QChar('0')); // fill character
+        imageNumber += QString("_%1").arg((int)(imageIndex + 1),
+                                          2, // width
+                                          10, // base
+                                          QChar('0')); // fill character
+    }
+    if (mapIndex >= 0) {
+        imageNumber += QString("_%1").arg((int)(mapIndex + 1),
+                                          mapIndexDigits, // width
+                                          10, // base
+                                          QChar('0')); // fill character
+    }
+    
+    QString outputName(imageFileName);
+    if ( ! imageNumber.isEmpty()) {
         const int dotOffset = outputName.lastIndexOf(".");
         if (dotOffset >= 0) {
             outputName.insert(dotOffset,
@@ -798,17 +1127,32 @@ OperationShowScene::writeImage(const AString& imageFileName,
         }
     }
     
-    try {
-        //ImageFile imageFile(image);
-        ImageFile imageFile(imageContent,
-                            imageWidth,
-                            imageHeight,
-                            ImageFile::IMAGE_DATA_ORIGIN_AT_BOTTOM);
-        imageFile.writeFile(outputName);
-    }
-    catch (const DataFileException& dfe) {
-        throw OperationException(dfe);
+    return outputName;
+}
+
+/**
+ * Select a map in a map yoking group.
+ *
+ * @param mapYokingGroup
+ *     The map yoking group, nothing is done if it is off.
+ * @param mapIndex
+ *     Index of map to select.
+ */
+void
+OperationShowScene::applyMapYoking(const MapYokingGroupEnum::Enum mapYokingGroup,
+                                   const int32_t mapIndex)
+{
+    if (mapYokingGroup == MapYokingGroupEnum::MAP_YOKING_GROUP_OFF) {
+        return;
     }
+    
+    MapYokingGroupEnum::setSelectedMapIndex(mapYokingGroup, mapIndex);
+    
+    EventMapYokingSelectMap yokeEvent(mapYokingGroup,
+                                      NULL,
+                                      mapIndex,
+                                      true);
+    EventManager::get()->sendEvent(yokeEvent.getPointer());
 }
 
 /**
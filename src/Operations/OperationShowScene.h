@@ -23,6 +23,7 @@
 
 
 #include "AbstractOperation.h"
+#include "MapYokingGroupEnum.h"
 
 namespace caret {
 
@@ -45,11 +46,13 @@ namespace caret {
     private:
         static BrainOpenGLFixedPipeline* createBrainOpenGL();
         
-        static void writeImage(const AString& imageFileName,
-                                  const int32_t imageIndex,
-                                  const unsigned char* imageContent,
-                                  const int32_t imageWidth,
-                                  const int32_t imageHeight);
+        static AString createImageFileName(const AString& imageFileName,
+                                           const int32_t imageIndex,
+                                           const int32_t mapIndex,
+                                           const int32_t mapIndexDigits);
+        
+        static void applyMapYoking(const MapYokingGroupEnum::Enum mapYokingGroup,
+                                   const int32_t mapIndex);
         
         static void estimateGraphicsSize(const SceneClass* windowSceneClass,
                                          float& estimatedWidthOut,
@@ -21,6 +21,7 @@
 #include "OperationVolumeStats.h"
 #include "OperationException.h"
 
+#include "CaretOMP.h"
 #include "ReductionOperation.h"
 #include "VolumeFile.h"
 
@@ -115,13 +116,7 @@ namespace
             }
         }
         if (toUse.empty()) throw OperationException("roi contains no voxels");
-        sort(toUse.begin(), toUse.end());
-        const double index = percent / 100.0f * (toUse.size() - 1);
-        if (index <= 0) return toUse[0];
-        if (index >= toUse.size() - 1) return toUse.back();
-        double ipart, fpart;
-        fpart = modf(index, &ipart);
-        return (1.0f - fpart) * toUse[(int64_t)ipart] + fpart * toUse[((int64_t)ipart) + 1];
+        return ReductionOperation::percentile(toUse.data(), toUse.size(), percent);//selection, not a full sort
     }
 }
 
@@ -181,35 +176,37 @@ void OperationVolumeStats::useParameters(OperationParameters* myParams, Progress
     int numMaps = input->getNumberOfMaps();
     if (subvol == -1)
     {
-        if (reduceOpt->m_present)
+        vector<float> results(numMaps);
+        vector<AString> errors(numMaps);//report the first failing subvolume in order, regardless of thread timing
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int i = 0; i < numMaps; ++i)
         {
-            for (int i = 0; i < numMaps; ++i)
-            {//store result before printing anything, in case it throws while computing
+            try
+            {
+                const float* thisRoi = roiData;
                 if (matchSubvolMode)
                 {
-                    roiData = myRoi->getFrame(i);
+                    thisRoi = myRoi->getFrame(i);
                 }
-                const float result = reduce(input->getFrame(i), frameSize, myop, roiData);
-                if (showMapName) cout << AString::number(i + 1) << ": " << input->getMapName(i) << ": ";
-                stringstream resultsstr;
-                resultsstr << setprecision(7) << result;
-                cout << resultsstr.str() << endl;
-            }
-        } else {
-            CaretAssert(percentileOpt->m_present);
-            for (int i = 0; i < numMaps; ++i)
-            {//store result before printing anything, in case it throws while computing
-                if (matchSubvolMode)
+                if (reduceOpt->m_present)
                 {
-                    roiData = myRoi->getFrame(i);
+                    results[i] = reduce(input->getFrame(i), frameSize, myop, thisRoi);
+                } else {
+                    CaretAssert(percentileOpt->m_present);
+                    results[i] = percentile(input->getFrame(i), frameSize, percent, thisRoi);
                 }
-                const float result = percentile(input->getFrame(i), frameSize, percent, roiData);
-                if (showMapName) cout << AString::number(i + 1) << ": " << input->getMapName(i) << ": ";
-                stringstream resultsstr;
-                resultsstr << setprecision(7) << result;
-                cout << resultsstr.str() << endl;
+            } catch (CaretException& e) {
+                errors[i] = e.whatString();
             }
         }
+        for (int i = 0; i < numMaps; ++i)
+        {
+            if (!errors[i].isEmpty()) throw OperationException(errors[i]);
+            if (showMapName) cout << AString::number(i + 1) << ": " << input->getMapName(i) << ": ";
+            stringstream resultsstr;
+            resultsstr << setprecision(7) << results[i];
+            cout << resultsstr.str() << endl;
+        }
     } else {
         CaretAssert(subvol >= 0 && subvol < numMaps);
         if (matchSubvolMode)
@@ -22,6 +22,7 @@
 #include "OperationException.h"
 
 #include "CaretHeap.h"
+#include "CaretOMP.h"
 #include "VolumeFile.h"
 
 #include <cmath>
@@ -358,26 +359,38 @@ void OperationVolumeWeightedStats::useParameters(OperationParameters* myParams,
     int numMaps = input->getNumberOfMaps();
     if (subvol == -1)
     {
+        vector<float> results(numMaps);
+        vector<AString> errors(numMaps);//report the first failing subvolume in order, regardless of thread timing
+#pragma omp CARET_PARFOR schedule(dynamic)
         for (int i = 0; i < numMaps; ++i)
-        {//store result before printing anything, in case it throws while computing
-            if (matchSubvolMode)
-            {
-                roiData = myRoi->getFrame(i);
-            }
-            if (matchSubvolWeights)
-            {
-                weightData = myWeights->getFrame(i);
-            }
-            float result;
-            if (weightData != NULL)
+        {
+            try
             {
-                result = doOperation(input->getFrame(i), weightData, frameSize, myop, roiData, argument);
-            } else {
-                result = doOperationSingleWeight(input->getFrame(i), constWeight, frameSize, myop, roiData, argument);
+                const float* thisRoi = roiData, *thisWeights = weightData;
+                if (matchSubvolMode)
+                {
+                    thisRoi = myRoi->getFrame(i);
+                }
+                if (matchSubvolWeights)
+                {
+                    thisWeights = myWeights->getFrame(i);
+                }
+                if (thisWeights != NULL)
+                {
+                    results[i] = doOperation(input->getFrame(i), thisWeights, frameSize, myop, thisRoi, argument);
+                } else {
+                    results[i] = doOperationSingleWeight(input->getFrame(i), constWeight, frameSize, myop, thisRoi, argument);
+                }
+            } catch (CaretException& e) {
+                errors[i] = e.whatString();
             }
+        }
+        for (int i = 0; i < numMaps; ++i)
+        {
+            if (!errors[i].isEmpty()) throw OperationException(errors[i]);
             if (showMapName) cout << AString::number(i + 1) << ": " << input->getMapName(i) << ": ";
             stringstream resultsstr;
-            resultsstr << setprecision(7) << result;
+            resultsstr << setprecision(7) << results[i];
             cout << resultsstr.str() << endl;
         }
     } else {
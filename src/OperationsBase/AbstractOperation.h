@@ -66,6 +66,7 @@ namespace caret {
         virtual AString getCommandSwitch() = 0;
         virtual AString getShortDescription() = 0;
         virtual bool takesParameters() = 0;
+        virtual AutoOperationInterface* clone() = 0;//so that parsers can make independent instances
         virtual ~AutoOperationInterface();
     };
 
@@ -80,6 +81,7 @@ namespace caret {
         AString getCommandSwitch() { return T::getCommandSwitch(); }
         AString getShortDescription() { return T::getShortDescription(); }
         bool takesParameters() { return T::takesParameters(); }
+        AutoOperationInterface* clone() { return new TemplateAutoOperation<T>(); }
     };
 
     ///interface class for parsers to inherit from
@@ -0,0 +1,182 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "CaretAssert.h"
+#include "Palette.h"
+#include "PaletteColorLookup.h"
+#include "PaletteScalarAndColor.h"
+
+using namespace caret;
+
+/**
+ * Constructor.
+ *
+ * @param palette
+ *     Palette that is compiled.
+ * @param interpolateColorFlag
+ *     If true, interpolate colors between palette scalars.
+ */
+PaletteColorLookup::PaletteColorLookup(const Palette* palette,
+                                       const bool interpolateColorFlag)
+: m_numberOfScalars(0),
+m_interpolateColorFlag(interpolateColorFlag)
+{
+    CaretAssert(palette);
+    m_numberOfScalars = palette->getNumberOfScalarsAndColors();
+    m_scalars.resize(m_numberOfScalars);
+    m_rgba.resize(m_numberOfScalars * 4);
+    m_noneColorFlags.resize(m_numberOfScalars);
+    for (int32_t i = 0; i < m_numberOfScalars; i++) {
+        const PaletteScalarAndColor* psac = palette->getScalarAndColor(i);
+        m_scalars[i] = psac->getScalar();
+        psac->getColor(&m_rgba[i * 4]);
+        m_noneColorFlags[i] = (psac->isNoneColor() ? 1 : 0);
+    }
+    
+    /*
+     * The search for a value starts at the first index whose scalar
+     * is below the top of the value's bucket.  All scalars before that
+     * index are greater than or equal to the value so the search result
+     * is the same as searching from the beginning.  The top is moved
+     * up an additional bucket to allow for rounding when the bucket
+     * index is computed.
+     */
+    m_bucketSearchStartIndex.resize(NUMBER_OF_BUCKETS);
+    for (int32_t iBucket = 0; iBucket < NUMBER_OF_BUCKETS; iBucket++) {
+        const float bucketTop = -1.0f + (2.0f * (iBucket + 2)) / NUMBER_OF_BUCKETS;
+        m_bucketSearchStartIndex[iBucket] = getFirstIndexBelow(bucketTop);
+    }
+}
+
+/**
+ * @return The first index, starting at one, with a palette scalar
+ * less than the given scalar.  If there is no such index, the last
+ * index is returned.
+ *
+ * @param scalar
+ *     The scalar.
+ */
+int32_t
+PaletteColorLookup::getFirstIndexBelow(const float scalar) const
+{
+    for (int32_t i = 1; i < m_numberOfScalars; i++) {
+        if (scalar > m_scalars[i]) {
+            return i;
+        }
+    }
+    return std::max(m_numberOfScalars - 1, 0);
+}
+
+/**
+ * Get the color for a normalized scalar.  Produces the same color
+ * as Palette::getPaletteColor().
+ *
+ * @param scalarIn
+ *     Normalized scalar ranging -1.0 to 1.0.
+ * @param rgbaOut
+ *     Output color.
+ */
+void
+PaletteColorLookup::getPaletteColor(const float scalarIn,
+                                    float rgbaOut[4]) const
+{
+    rgbaOut[0] = 0.0f;
+    rgbaOut[1] = 0.0f;
+    rgbaOut[2] = 0.0f;
+    rgbaOut[3] = 1.0f;
+    
+    if (m_numberOfScalars <= 0) {
+        return;
+    }
+    
+    bool interpolateColorFlag = m_interpolateColorFlag;
+    
+    float scalar = scalarIn;
+    if (scalar < -1.0) scalar = -1.0;
+    if (scalar >  1.0) scalar = 1.0;
+    
+    int32_t paletteIndex = -1;
+    if (m_numberOfScalars == 1) {
+        paletteIndex = 0;
+        interpolateColorFlag = false;
+    }
+    else if (scalar >= m_scalars[0]) {
+        paletteIndex = 0;
+        interpolateColorFlag = false;
+    }
+    else if (scalar <= m_scalars[m_numberOfScalars - 1]) {
+        paletteIndex = m_numberOfScalars - 1;
+        interpolateColorFlag = false;
+    }
+    else if (m_numberOfScalars == 2) {
+        paletteIndex = 0;
+        interpolateColorFlag = true;
+    }
+    else if ( ! std::isnan(scalar)) {
+        const int32_t bucketIndex = std::min(std::max(static_cast<int32_t>((scalar + 1.0f) * (NUMBER_OF_BUCKETS * 0.5f)),
+                                                      0),
+                                             NUMBER_OF_BUCKETS - 1);
+        CaretAssertVectorIndex(m_bucketSearchStartIndex, bucketIndex);
+        const int32_t lastIndex = m_numberOfScalars - 1;
+        int32_t i = m_bucketSearchStartIndex[bucketIndex];
+        while ((i < lastIndex)
+               && ( ! (scalar > m_scalars[i]))) {
+            i++;
+        }
+        paletteIndex = i - 1;
+    }
+    
+    if (paletteIndex >= 0) {
+        if (m_noneColorFlags[paletteIndex]) {
+            rgbaOut[3] = 0.0;
+        }
+        else {
+            const float* rgbaAbove = &m_rgba[paletteIndex * 4];
+            rgbaOut[0] = rgbaAbove[0];
+            rgbaOut[1] = rgbaAbove[1];
+            rgbaOut[2] = rgbaAbove[2];
+            rgbaOut[3] = rgbaAbove[3];
+            if (interpolateColorFlag
+                && (paletteIndex < (m_numberOfScalars - 1))) {
+                const int32_t belowIndex = paletteIndex + 1;
+                float totalDiff = m_scalars[paletteIndex] - m_scalars[belowIndex];
+                if (totalDiff != 0.0) {
+                    float offset = scalar - m_scalars[belowIndex];
+                    float percentAbove = offset / totalDiff;
+                    float percentBelow = 1.0f - percentAbove;
+                    if ( ! m_noneColorFlags[belowIndex]) {
+                        const float* rgbaBelow = &m_rgba[belowIndex * 4];
+                        
+                        rgbaOut[0] = (percentAbove * rgbaAbove[0]
+                                      + percentBelow * rgbaBelow[0]);
+                        rgbaOut[1] = (percentAbove * rgbaAbove[1]
+                                      + percentBelow * rgbaBelow[1]);
+                        rgbaOut[2] = (percentAbove * rgbaAbove[2]
+                                      + percentBelow * rgbaBelow[2]);
+                    }
+                }
+            }
+        }
+    }
+}
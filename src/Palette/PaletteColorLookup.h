@@ -0,0 +1,82 @@
+#ifndef __PALETTE_COLOR_LOOKUP_H__
+#define __PALETTE_COLOR_LOOKUP_H__
+
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <stdint.h>
+#include <vector>
+
+namespace caret {
+
+    class Palette;
+    
+    /**
+     * A palette compiled for coloring many values.  The palette's
+     * scalars and colors are copied into flat arrays and a table,
+     * indexed by the normalized value, provides the index at which
+     * the search for the palette interval begins.  Colors are
+     * identical to those from Palette::getPaletteColor() but
+     * usually require only one or two comparisons.
+     *
+     * The lookup is a snapshot of the palette and must be recreated
+     * if the palette is modified.  Methods are const and may be
+     * called from multiple threads.
+     */
+    class PaletteColorLookup {
+        
+    public:
+        PaletteColorLookup(const Palette* palette,
+                           const bool interpolateColorFlag);
+        
+        void getPaletteColor(const float scalar,
+                             float rgbaOut[4]) const;
+        
+    private:
+        PaletteColorLookup(const PaletteColorLookup&);
+        
+        PaletteColorLookup& operator=(const PaletteColorLookup&);
+        
+        int32_t getFirstIndexBelow(const float scalar) const;
+        
+        /** Number of buckets covering the normalized range -1.0 to 1.0 */
+        static const int32_t NUMBER_OF_BUCKETS = 1024;
+        
+        /** Palette scalars in descending order */
+        std::vector<float> m_scalars;
+        
+        /** Palette colors, four per scalar */
+        std::vector<float> m_rgba;
+        
+        /** Non-zero if the palette color is the 'none' color */
+        std::vector<uint8_t> m_noneColorFlags;
+        
+        /** For each bucket, index at which searching begins */
+        std::vector<int32_t> m_bucketSearchStartIndex;
+        
+        int32_t m_numberOfScalars;
+        
+        bool m_interpolateColorFlag;
+    };
+    
+} // namespace
+
+#endif // __PALETTE_COLOR_LOOKUP_H__
@@ -1608,10 +1608,10 @@ PaletteColorMapping::mapDataToPaletteNormalizedValues(const FastStatistics* stat
         {
             const float mostPercentage  = this->getAutoScaleAbsolutePercentageMaximum();
             const float leastPercentage = this->getAutoScaleAbsolutePercentageMinimum();
-            mappingMostNegative  = -statistics->getApproxAbsolutePercentile(mostPercentage);
-            mappingLeastNegative = -statistics->getApproxAbsolutePercentile(leastPercentage);
-            mappingLeastPositive =  statistics->getApproxAbsolutePercentile(leastPercentage);
-            mappingMostPositive  =  statistics->getApproxAbsolutePercentile(mostPercentage);
+            mappingMostNegative  = -statistics->getAbsolutePercentile(mostPercentage);
+            mappingLeastNegative = -statistics->getAbsolutePercentile(leastPercentage);
+            mappingLeastPositive =  statistics->getAbsolutePercentile(leastPercentage);
+            mappingMostPositive  =  statistics->getAbsolutePercentile(mostPercentage);
         }
             break;
         case PaletteScaleModeEnum::MODE_AUTO_SCALE_PERCENTAGE:
@@ -1620,10 +1620,10 @@ PaletteColorMapping::mapDataToPaletteNormalizedValues(const FastStatistics* stat
             const float leastNegativePercentage = this->getAutoScalePercentageNegativeMinimum();
             const float leastPositivePercentage = this->getAutoScalePercentagePositiveMinimum();
             const float mostPositivePercentage  = this->getAutoScalePercentagePositiveMaximum();
-            mappingMostNegative  = statistics->getApproxNegativePercentile(mostNegativePercentage);
-            mappingLeastNegative = statistics->getApproxNegativePercentile(leastNegativePercentage);
-            mappingLeastPositive = statistics->getApproxPositivePercentile(leastPositivePercentage);
-            mappingMostPositive  = statistics->getApproxPositivePercentile(mostPositivePercentage);
+            mappingMostNegative  = statistics->getNegativePercentile(mostNegativePercentage);
+            mappingLeastNegative = statistics->getNegativePercentile(leastNegativePercentage);
+            mappingLeastPositive = statistics->getPositivePercentile(leastPositivePercentage);
+            mappingMostPositive  = statistics->getPositivePercentile(mostPositivePercentage);
         }
             break;
         case PaletteScaleModeEnum::MODE_USER_SCALE:
@@ -1813,10 +1813,10 @@ PaletteColorMapping::getPaletteColorBarScaleText(const FastStatistics* statistic
             const float maxPct = getAutoScaleAbsolutePercentageMaximum();
             const float minPct = getAutoScaleAbsolutePercentageMinimum();
             
-            negMax = -statistics->getApproxAbsolutePercentile(maxPct);
-            negMin = -statistics->getApproxAbsolutePercentile(minPct);
-            posMin =  statistics->getApproxAbsolutePercentile(minPct);
-            posMax =  statistics->getApproxAbsolutePercentile(maxPct);
+            negMax = -statistics->getAbsolutePercentile(maxPct);
+            negMin = -statistics->getAbsolutePercentile(minPct);
+            posMin =  statistics->getAbsolutePercentile(minPct);
+            posMax =  statistics->getAbsolutePercentile(maxPct);
         }
             break;
         case PaletteScaleModeEnum::MODE_AUTO_SCALE_PERCENTAGE:
@@ -1826,10 +1826,10 @@ PaletteColorMapping::getPaletteColorBarScaleText(const FastStatistics* statistic
             const float posMinPct = getAutoScalePercentagePositiveMinimum();
             const float posMaxPct = getAutoScalePercentagePositiveMaximum();
             
-            negMax = statistics->getApproxNegativePercentile(negMaxPct);
-            negMin = statistics->getApproxNegativePercentile(negMinPct);
-            posMin = statistics->getApproxPositivePercentile(posMinPct);
-            posMax = statistics->getApproxPositivePercentile(posMaxPct);
+            negMax = statistics->getNegativePercentile(negMaxPct);
+            negMin = statistics->getNegativePercentile(negMinPct);
+            posMin = statistics->getPositivePercentile(posMinPct);
+            posMax = statistics->getPositivePercentile(posMaxPct);
         }
             break;
         case PaletteScaleModeEnum::MODE_USER_SCALE:
@@ -0,0 +1,389 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "HttpRangeTest.h"
+
+#include "CaretBinaryFile.h"
+#include "CaretException.h"
+#include "CiftiBrainModelsMap.h"
+#include "CiftiFile.h"
+#include "DataFileException.h"
+
+#include <QDir>
+#include <QFile>
+#include <QHostAddress>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryFile>
+#include <QThread>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    const int64_t BLOCK_SIZE = 1<<20;//must match the block size CaretBinaryFile uses for files on web servers
+    const int64_t NUM_VERTICES = 1100;//~4.8MB of matrix, so the file has several blocks, rows cross block boundaries, and the last block is short
+    const int64_t MAX_WHOLE_FILE = 128 * BLOCK_SIZE;//must match the cache size CaretBinaryFile uses, largest file it will download without byte ranges
+    
+    class LocalFileServer : public QThread
+    {//minimal HTTP server for a single file on localhost, one connection at a time, optionally ignoring Range headers like some real servers do
+        QByteArray m_contents;
+        bool m_supportRanges, m_answerHead, m_stop;
+        int64_t m_claimedSize;//if not negative, Content-Length claims the file is this big, to check that big downloads are refused without sending that much
+        quint16 m_port;
+        vector<int64_t> m_responseSizes;//body size of each GET response, to check read-ahead
+        QMutex m_mutex;
+        QSemaphore m_started;
+        void handleConnection(QTcpSocket* socket);
+    protected:
+        void run();
+    public:
+        LocalFileServer(const QByteArray& contents, const bool& supportRanges, const bool& answerHead = true, const int64_t& claimedSize = -1) :
+            m_contents(contents), m_supportRanges(supportRanges), m_answerHead(answerHead), m_stop(false), m_claimedSize(claimedSize), m_port(0) { }
+        void startServing() { start(); m_started.acquire(); }//returns once the port is known
+        void stopServing()
+        {
+            {
+                QMutexLocker locker(&m_mutex);
+                m_stop = true;
+            }
+            wait();
+        }
+        quint16 getPort() const { return m_port; }//0 if listen failed
+        vector<int64_t> getResponseSizes()
+        {
+            QMutexLocker locker(&m_mutex);
+            return m_responseSizes;
+        }
+        void clearResponseSizes()
+        {
+            QMutexLocker locker(&m_mutex);
+            m_responseSizes.clear();
+        }
+    };
+    
+    void LocalFileServer::run()
+    {
+        QTcpServer server;//must be created in the thread that uses it
+        if (server.listen(QHostAddress::LocalHost, 0))
+        {
+            m_port = server.serverPort();
+        }
+        m_started.release();
+        if (m_port == 0) return;
+        while (true)
+        {
+            {
+                QMutexLocker locker(&m_mutex);
+                if (m_stop) break;
+            }
+            if (!server.waitForNewConnection(50)) continue;
+            QTcpSocket* socket = server.nextPendingConnection();
+            handleConnection(socket);
+            delete socket;
+        }
+    }
+    
+    void LocalFileServer::handleConnection(QTcpSocket* socket)
+    {
+        QByteArray request;
+        while (!request.contains("\r\n\r\n"))
+        {
+            if (!socket->waitForReadyRead(5000)) return;
+            request += socket->readAll();
+        }
+        QList<QByteArray> lines = request.left(request.indexOf("\r\n\r\n")).split('\n');
+        int64_t fileSize = m_contents.size();
+        int64_t advertisedSize = (m_claimedSize < 0 ? fileSize : m_claimedSize);
+        if (lines[0].startsWith("HEAD "))
+        {
+            QByteArray header;
+            if (m_answerHead)
+            {
+                header = "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: " + QByteArray::number((qint64)advertisedSize) +
+                         "\r\nAccept-Ranges: " + (m_supportRanges ? "bytes" : "none") + "\r\nConnection: close\r\n\r\n";
+            } else {
+                header = "HTTP/1.1 405 Method Not Allowed\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            }
+            socket->write(header);
+            while (socket->bytesToWrite() > 0)
+            {
+                if (!socket->waitForBytesWritten(5000)) break;
+            }
+            socket->disconnectFromHost();
+            if (socket->state() != QAbstractSocket::UnconnectedState) socket->waitForDisconnected(5000);
+            return;
+        }
+        int64_t start = 0, end = fileSize - 1;
+        bool haveRange = false;
+        for (int i = 1; i < lines.size(); ++i)
+        {
+            QByteArray line = lines[i].trimmed();
+            if (!line.toLower().startsWith("range:")) continue;
+            QByteArray spec = line.mid(6).trimmed();//"bytes=start-end", end is inclusive and optional
+            if (!spec.startsWith("bytes=")) continue;
+            QList<QByteArray> parts = spec.mid(6).split('-');
+            if (parts.size() != 2) continue;
+            start = parts[0].toLongLong();
+            if (!parts[1].isEmpty()) end = min(parts[1].toLongLong(), fileSize - 1);
+            haveRange = true;
+        }
+        QByteArray header;
+        if (haveRange && m_supportRanges)
+        {
+            header = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes " + QByteArray::number((qint64)start) + "-" + QByteArray::number((qint64)end) +
+                     "/" + QByteArray::number((qint64)fileSize) + "\r\n";
+        } else {
+            start = 0;
+            end = fileSize - 1;
+            header = "HTTP/1.1 200 OK\r\n";
+        }
+        int64_t length = max((int64_t)0, end - start + 1);
+        int64_t advertisedLength = (haveRange && m_supportRanges ? length : advertisedSize);//with a claimed size, the connection closes early, like an interrupted download
+        header += "Content-Type: application/octet-stream\r\nContent-Length: " + QByteArray::number((qint64)advertisedLength) + "\r\nConnection: close\r\n\r\n";
+        {
+            QMutexLocker locker(&m_mutex);
+            m_responseSizes.push_back(length);
+        }
+        socket->write(header);
+        socket->write(m_contents.constData() + start, length);
+        while (socket->bytesToWrite() > 0)
+        {
+            if (!socket->waitForBytesWritten(5000)) break;
+        }
+        socket->disconnectFromHost();
+        if (socket->state() != QAbstractSocket::UnconnectedState) socket->waitForDisconnected(5000);
+    }
+}
+
+HttpRangeTest::HttpRangeTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void HttpRangeTest::execute()
+{
+    QTemporaryFile tempFile(QDir::tempPath() + "/wb_httprange_XXXXXX.dconn.nii");
+    if (!tempFile.open())
+    {
+        setFailed("failed to create temporary file");
+        return;
+    }
+    tempFile.close();//we only need the name reserved, CiftiFile does its own file access
+    {
+        CiftiXML myXML;
+        myXML.setNumberOfDimensions(2);
+        CiftiBrainModelsMap myMap;
+        myMap.addSurfaceModel(NUM_VERTICES, StructureEnum::CORTEX_LEFT);
+        myXML.setMap(CiftiXML::ALONG_ROW, myMap);
+        myXML.setMap(CiftiXML::ALONG_COLUMN, myMap);
+        CiftiFile outFile;
+        outFile.setWritingFile(tempFile.fileName());
+        outFile.setCiftiXML(myXML);
+        vector<float> row(NUM_VERTICES);
+        for (int64_t i = 0; i < NUM_VERTICES; ++i)
+        {
+            for (int64_t j = 0; j < NUM_VERTICES; ++j)
+            {
+                row[j] = i * NUM_VERTICES + j;//all distinct and exactly representable
+            }
+            outFile.setRow(row.data(), i);
+        }
+        outFile.close();
+    }
+    QFile rawFile(tempFile.fileName());
+    if (!rawFile.open(QIODevice::ReadOnly))
+    {
+        setFailed("failed to read back temporary file '" + tempFile.fileName() + "'");
+        return;
+    }
+    QByteArray contents = rawFile.readAll();
+    rawFile.close();
+    if (contents.size() % BLOCK_SIZE == 0 || contents.size() < 3 * BLOCK_SIZE)
+    {
+        setFailed("test file size " + AString::number(contents.size()) + " doesn't have a short last block, adjust NUM_VERTICES");
+        return;
+    }
+    CiftiFile localFile(tempFile.fileName());
+    checkServer(contents, localFile, true);
+    checkServer(contents, localFile, false);
+    checkTooLarge(contents, true);
+    checkTooLarge(contents, false);
+}
+
+void HttpRangeTest::checkTooLarge(const QByteArray& contents, const bool& answerHead)
+{//server without byte ranges claims a file too large to keep, it must be refused by HEAD, or by aborting the GET, not by downloading it
+    const AString modeString = (answerHead ? "when HEAD is answered" : "when HEAD is refused");
+    LocalFileServer myServer(contents, false, answerHead, MAX_WHOLE_FILE + 1);
+    myServer.startServing();
+    if (myServer.getPort() == 0)
+    {
+        setFailed("failed to start local web server " + modeString);
+        myServer.wait();
+        return;
+    }
+    const AString url = "http://127.0.0.1:" + AString::number(myServer.getPort()) + "/huge.dconn.nii";
+    bool threw = false;
+    try
+    {
+        CaretBinaryFile remoteRaw(url);
+    } catch (DataFileException& e) {
+        threw = true;
+        if (!e.whatString().contains("too large"))
+        {
+            setFailed("file too large to read without byte ranges gave the wrong error " + modeString + ": " + e.whatString());
+        }
+    } catch (CaretException& e) {
+        threw = true;
+        setFailed("file too large to read without byte ranges gave the wrong exception " + modeString + ": " + e.whatString());
+    }
+    if (!threw)
+    {
+        setFailed("file too large to read without byte ranges was opened " + modeString);
+    }
+    vector<int64_t> responseSizes = myServer.getResponseSizes();
+    if (answerHead && !responseSizes.empty())
+    {
+        setFailed("file too large to read without byte ranges was requested with GET after HEAD said it was too large");
+    }
+    myServer.stopServing();
+}
+
+void HttpRangeTest::checkServer(const QByteArray& contents, const CiftiFile& localFile, const bool& supportRanges)
+{
+    const AString modeString = (supportRanges ? "with byte ranges" : "without byte ranges");
+    LocalFileServer myServer(contents, supportRanges);
+    myServer.startServing();
+    if (myServer.getPort() == 0)
+    {
+        setFailed("failed to start local web server " + modeString);
+        myServer.wait();
+        return;
+    }
+    const AString url = "http://127.0.0.1:" + AString::number(myServer.getPort()) + "/test.dconn.nii";
+    const int64_t fileSize = contents.size();
+    const int64_t numFileBlocks = (fileSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    try
+    {
+        vector<float> localRow(NUM_VERTICES), remoteRow(NUM_VERTICES);
+        {//sequential scan, should use read-ahead
+            CiftiFile remoteFile(url);
+            if (remoteFile.getNumberOfRows() != NUM_VERTICES || remoteFile.getNumberOfColumns() != NUM_VERTICES)
+            {
+                setFailed("remote file " + modeString + " has wrong dimensions");
+            }
+            for (int64_t i = 0; i < NUM_VERTICES && !failed(); ++i)
+            {
+                localFile.getRow(localRow.data(), i);
+                remoteFile.getRow(remoteRow.data(), i);
+                if (memcmp(localRow.data(), remoteRow.data(), NUM_VERTICES * sizeof(float)) != 0)
+                {
+                    setFailed("row " + AString::number(i) + " differs when read sequentially " + modeString);
+                }
+            }
+            vector<int64_t> responseSizes = myServer.getResponseSizes();
+            if (supportRanges)
+            {
+                if ((int64_t)responseSizes.size() >= numFileBlocks)//open fetches block 0, then read-ahead fetches the rest in fewer, larger requests
+                {
+                    setFailed("sequential scan made " + AString::number(responseSizes.size()) + " requests for " + AString::number(numFileBlocks) + " blocks");
+                }
+                int64_t totalFetched = 0;
+                for (int i = 0; i < (int)responseSizes.size(); ++i)
+                {
+                    totalFetched += responseSizes[i];
+                }
+                if (totalFetched != fileSize)
+                {
+                    setFailed("sequential scan fetched " + AString::number(totalFetched) + " bytes of a " + AString::number(fileSize) + " byte file");
+                }
+            } else {
+                if (responseSizes.size() != 1)
+                {
+                    setFailed("server without byte ranges was asked " + AString::number(responseSizes.size()) + " times, entire file should have been kept");
+                }
+            }
+        }
+        myServer.clearResponseSizes();
+        {//reverse scan on a fresh cache, fetches single blocks, starting with the short last block
+            CiftiFile remoteFile(url);
+            for (int64_t i = NUM_VERTICES - 1; i >= 0 && !failed(); --i)
+            {
+                localFile.getRow(localRow.data(), i);
+                remoteFile.getRow(remoteRow.data(), i);
+                if (memcmp(localRow.data(), remoteRow.data(), NUM_VERTICES * sizeof(float)) != 0)
+                {
+                    setFailed("row " + AString::number(i) + " differs when read in reverse " + modeString);
+                }
+            }
+            if (supportRanges)
+            {
+                vector<int64_t> responseSizes = myServer.getResponseSizes();
+                for (int i = 0; i < (int)responseSizes.size(); ++i)
+                {
+                    if (responseSizes[i] > BLOCK_SIZE)
+                    {
+                        setFailed("reverse scan fetched " + AString::number(responseSizes[i]) + " bytes in one request, read-ahead should only follow sequential reads");
+                        break;
+                    }
+                }
+            }
+        }
+        {//raw reads around block boundaries
+            CaretBinaryFile remoteRaw(url);
+            if (remoteRaw.size() != fileSize)
+            {
+                setFailed("remote file " + modeString + " reports size " + AString::number(remoteRaw.size()) + " instead of " + AString::number(fileSize));
+            }
+            const int64_t lastBlockStart = (numFileBlocks - 1) * BLOCK_SIZE;
+            const int64_t starts[] = { 0, BLOCK_SIZE - 3, BLOCK_SIZE, 2 * BLOCK_SIZE - 1, lastBlockStart - 2, fileSize - 5, 7 };
+            const int64_t counts[] = { 10, 6, BLOCK_SIZE, BLOCK_SIZE + 2, 4, 5, fileSize - 7 };//last one reads almost everything from a warm cache
+            vector<char> buffer;
+            for (int i = 0; i < (int)(sizeof(starts) / sizeof(starts[0])) && !failed(); ++i)
+            {
+                buffer.resize(counts[i]);
+                remoteRaw.seek(starts[i]);
+                remoteRaw.read(buffer.data(), counts[i]);
+                if (memcmp(buffer.data(), contents.constData() + starts[i], counts[i]) != 0)
+                {
+                    setFailed("raw read of " + AString::number(counts[i]) + " bytes at offset " + AString::number(starts[i]) + " differs " + modeString);
+                }
+            }
+            buffer.resize(10);
+            int64_t numRead = -1;
+            remoteRaw.seek(fileSize - 5);
+            remoteRaw.read(buffer.data(), 10, &numRead);
+            if (numRead != 5 || memcmp(buffer.data(), contents.constData() + fileSize - 5, 5) != 0)
+            {
+                setFailed("read past end of file " + modeString + " returned " + AString::number(numRead) + " bytes instead of 5, or wrong data");
+            }
+        }
+    } catch (CaretException& e) {
+        setFailed("exception reading from local web server " + modeString + ": " + e.whatString());
+    }
+    myServer.stopServing();
+}
@@ -0,0 +1,309 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "PointLocatorTest.h"
+
+#include "CaretPointLocator.h"
+#include "CaretPointLocatorOld.h"
+#include "ElapsedTimer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+PointLocatorTest::PointLocatorTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+namespace
+{
+    float distSquared(const float* a, const float* b)
+    {
+        float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+    
+    struct BruteSet
+    {
+        int32_t whichSet;
+        vector<float> coords;
+    };
+    
+    //returns squared distance to the closest point over all sets, with its set and index
+    float bruteClosest(const vector<BruteSet>& sets, const float* target, int32_t& setOut, int64_t& indexOut)
+    {
+        float best = -1.0f;
+        setOut = -1;
+        indexOut = -1;
+        for (size_t s = 0; s < sets.size(); ++s)
+        {
+            int64_t numPoints = (int64_t)sets[s].coords.size() / 3;
+            for (int64_t i = 0; i < numPoints; ++i)
+            {
+                float dist = distSquared(sets[s].coords.data() + i * 3, target);
+                if (best < 0.0f || dist < best)
+                {
+                    best = dist;
+                    setOut = sets[s].whichSet;
+                    indexOut = i;
+                }
+            }
+        }
+        return best;
+    }
+    
+    const float* brutePoint(const vector<BruteSet>& sets, const int32_t whichSet, const int64_t index)
+    {
+        for (size_t s = 0; s < sets.size(); ++s)
+        {
+            if (sets[s].whichSet == whichSet && index >= 0 && index < (int64_t)sets[s].coords.size() / 3)
+            {
+                return sets[s].coords.data() + index * 3;
+            }
+        }
+        return NULL;
+    }
+}
+
+void PointLocatorTest::execute()
+{
+    const int NUM_POINTS = 200000, NUM_TARGETS = 200000, NUM_RANGE_TARGETS = 20000, NUM_CHECK_KNN = 200, K = 10;
+    const float EXTENT = 100.0f, RANGE = 3.0f;
+    vector<float> points(NUM_POINTS * 3), targets(NUM_TARGETS * 3);
+    for (int i = 0; i < NUM_POINTS * 3; ++i)
+    {
+        points[i] = EXTENT * rand() / RAND_MAX;
+    }
+    for (int i = 0; i < NUM_TARGETS * 3; ++i)
+    {
+        targets[i] = (EXTENT + 10.0f) * rand() / RAND_MAX - 5.0f;//some targets outside the points' bounding box
+    }
+    ElapsedTimer myTimer;
+    myTimer.start();
+    CaretPointLocatorOld oldLocator(points.data(), NUM_POINTS);
+    double oldBuild = myTimer.getElapsedTimeMilliseconds();
+    myTimer.start();
+    CaretPointLocator newLocator(points.data(), NUM_POINTS);
+    double newBuild = myTimer.getElapsedTimeMilliseconds();
+    vector<int64_t> oldClosest(NUM_TARGETS), newClosest(NUM_TARGETS), batchClosest;
+    myTimer.start();
+    for (int i = 0; i < NUM_TARGETS; ++i)
+    {
+        oldClosest[i] = oldLocator.closestPoint(targets.data() + i * 3);
+    }
+    double oldQuery = myTimer.getElapsedTimeMilliseconds();
+    myTimer.start();
+    for (int i = 0; i < NUM_TARGETS; ++i)
+    {
+        newClosest[i] = newLocator.closestPoint(targets.data() + i * 3);
+    }
+    double newQuery = myTimer.getElapsedTimeMilliseconds();
+    myTimer.start();
+    newLocator.closestPoints(targets.data(), NUM_TARGETS, batchClosest);
+    double batchQuery = myTimer.getElapsedTimeMilliseconds();
+    for (int i = 0; i < NUM_TARGETS; ++i)
+    {//ties may pick a different point, so compare distances
+        const float* target = targets.data() + i * 3;
+        float oldDist = distSquared(points.data() + oldClosest[i] * 3, target);
+        if (distSquared(points.data() + newClosest[i] * 3, target) != oldDist)
+        {
+            setFailed("closest point mismatch at target " + AString::number(i));
+        }
+        if (distSquared(points.data() + batchClosest[i] * 3, target) != oldDist)
+        {
+            setFailed("batch closest point mismatch at target " + AString::number(i));
+        }
+    }
+    myTimer.start();
+    for (int i = 0; i < NUM_RANGE_TARGETS; ++i)
+    {
+        set<LocatorInfo> found = oldLocator.pointsInRange(targets.data() + i * 3, RANGE);
+    }
+    double oldRange = myTimer.getElapsedTimeMilliseconds();
+    vector<LocatorInfo> foundVec;
+    myTimer.start();
+    for (int i = 0; i < NUM_RANGE_TARGETS; ++i)
+    {
+        newLocator.pointsInRange(targets.data() + i * 3, RANGE, foundVec);
+    }
+    double newRange = myTimer.getElapsedTimeMilliseconds();
+    for (int i = 0; i < NUM_CHECK_KNN; ++i)
+    {
+        const float* target = targets.data() + i * 3;
+        if (oldLocator.pointsInRange(target, RANGE) != newLocator.pointsInRange(target, RANGE))
+        {
+            setFailed("points in range mismatch at target " + AString::number(i));
+        }
+        if (oldLocator.anyInRange(target, RANGE) != newLocator.anyInRange(target, RANGE))
+        {
+            setFailed("any in range mismatch at target " + AString::number(i));
+        }
+        if ((oldLocator.closestPointLimited(target, RANGE) == -1) != (newLocator.closestPointLimited(target, RANGE) == -1))
+        {
+            setFailed("closest point limited mismatch at target " + AString::number(i));
+        }
+        vector<float> allDists(NUM_POINTS);
+        for (int j = 0; j < NUM_POINTS; ++j)
+        {
+            allDists[j] = distSquared(points.data() + j * 3, target);
+        }
+        partial_sort(allDists.begin(), allDists.begin() + K, allDists.end());
+        newLocator.kNearest(target, K, foundVec);
+        if ((int)foundVec.size() != K)
+        {
+            setFailed("k nearest returned wrong number of points at target " + AString::number(i));
+            continue;
+        }
+        for (int j = 0; j < K; ++j)
+        {
+            if (distSquared(points.data() + foundVec[j].index * 3, target) != allDists[j])
+            {
+                setFailed("k nearest mismatch at target " + AString::number(i) + ", neighbor " + AString::number(j));
+            }
+        }
+    }
+    checkMultipleSets();
+    checkTies();
+    cout << "build: octree " << oldBuild << " ms, k-d tree " << newBuild << " ms" << endl;
+    cout << "closest point: octree " << oldQuery << " ms, k-d tree " << newQuery << " ms, k-d tree batch " << batchQuery << " ms" << endl;
+    cout << "points in range: octree " << oldRange << " ms, k-d tree " << newRange << " ms" << endl;
+}
+
+void PointLocatorTest::checkMultipleSets()
+{
+    const int NUM_SET_POINTS = 2000, NUM_TARGETS = 2000;
+    const float EXTENT = 100.0f, RANGE = 5.0f;
+    float minBounds[3] = { 0.0f, 0.0f, 0.0f }, maxBounds[3] = { EXTENT, EXTENT, EXTENT };
+    CaretPointLocator myLocator(minBounds, maxBounds);
+    vector<BruteSet> sets;
+    for (int s = 0; s < 3; ++s)
+    {
+        BruteSet thisSet;
+        thisSet.coords.resize(NUM_SET_POINTS * 3);
+        for (int i = 0; i < NUM_SET_POINTS * 3; ++i)
+        {
+            thisSet.coords[i] = EXTENT * rand() / RAND_MAX;
+        }
+        thisSet.whichSet = myLocator.addPointSet(thisSet.coords.data(), NUM_SET_POINTS);
+        sets.push_back(thisSet);
+    }
+    vector<float> targets(NUM_TARGETS * 3);
+    for (int i = 0; i < NUM_TARGETS * 3; ++i)
+    {
+        targets[i] = EXTENT * rand() / RAND_MAX;
+    }
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        AString passName;
+        if (pass == 1)
+        {//remove the middle set, so the remaining set indexes are no longer contiguous
+            passName = "after removal, ";
+            myLocator.removePointSet(sets[1].whichSet);
+            sets.erase(sets.begin() + 1);
+        } else if (pass == 2) {//a new set may reuse the removed index, and must not find stale points
+            passName = "after re-add, ";
+            BruteSet thisSet;
+            thisSet.coords.resize(NUM_SET_POINTS / 2 * 3);
+            for (int i = 0; i < NUM_SET_POINTS / 2 * 3; ++i)
+            {
+                thisSet.coords[i] = EXTENT * rand() / RAND_MAX;
+            }
+            thisSet.whichSet = myLocator.addPointSet(thisSet.coords.data(), NUM_SET_POINTS / 2);
+            sets.push_back(thisSet);
+        }
+        vector<int64_t> batchIndices, limitedIndices;
+        vector<int32_t> batchSets, limitedSets;
+        myLocator.closestPoints(targets.data(), NUM_TARGETS, batchIndices, &batchSets);
+        myLocator.closestPointsLimited(targets.data(), NUM_TARGETS, RANGE, limitedIndices, &limitedSets);
+        for (int i = 0; i < NUM_TARGETS; ++i)
+        {
+            const float* target = targets.data() + i * 3;
+            int32_t bruteSet;
+            int64_t bruteIndex;
+            float bruteDist = bruteClosest(sets, target, bruteSet, bruteIndex);
+            LocatorInfo myInfo(-1, -1, Vector3D());
+            int64_t found = myLocator.closestPoint(target, &myInfo);
+            const float* foundPoint = brutePoint(sets, myInfo.whichSet, found);
+            if (foundPoint == NULL || myInfo.index != found)
+            {
+                setFailed(passName + "closest point returned invalid set " + AString::number(myInfo.whichSet) + " at target " + AString::number(i));
+            } else if (distSquared(foundPoint, target) != bruteDist) {
+                setFailed(passName + "closest point mismatch at target " + AString::number(i));
+            }
+            foundPoint = brutePoint(sets, batchSets[i], batchIndices[i]);
+            if (foundPoint == NULL || distSquared(foundPoint, target) != bruteDist)
+            {
+                setFailed(passName + "batch closest point mismatch at target " + AString::number(i));
+            }
+            if (bruteDist > RANGE * RANGE)
+            {
+                if (limitedIndices[i] != -1 || limitedSets[i] != -1)
+                {
+                    setFailed(passName + "closest points limited found a point out of range at target " + AString::number(i));
+                }
+            } else {
+                foundPoint = brutePoint(sets, limitedSets[i], limitedIndices[i]);
+                if (foundPoint == NULL || distSquared(foundPoint, target) != bruteDist)
+                {
+                    setFailed(passName + "closest points limited mismatch at target " + AString::number(i));
+                }
+            }
+        }
+    }
+}
+
+void PointLocatorTest::checkTies()
+{//targets equidistant from several grid points must get the same answer from the batch query (hint, threads) as from single queries
+    const int GRID = 30, NUM_TARGETS = 100000;
+    vector<float> points;
+    for (int i = 0; i < GRID; ++i)
+    {
+        for (int j = 0; j < GRID; ++j)
+        {
+            for (int k = 0; k < GRID; ++k)
+            {
+                points.push_back(i);
+                points.push_back(j);
+                points.push_back(k);
+            }
+        }
+    }
+    vector<float> targets(NUM_TARGETS * 3);
+    for (int i = 0; i < NUM_TARGETS * 3; ++i)
+    {
+        targets[i] = (rand() % (2 * GRID - 2)) * 0.5f;//half-integer coordinates are tied between grid points
+    }
+    CaretPointLocator myLocator(points.data(), GRID * GRID * GRID);
+    vector<int64_t> batchClosest, batchClosest2;
+    myLocator.closestPoints(targets.data(), NUM_TARGETS, batchClosest);
+    myLocator.closestPoints(targets.data(), NUM_TARGETS, batchClosest2);
+    for (int i = 0; i < NUM_TARGETS; ++i)
+    {
+        int64_t single = myLocator.closestPoint(targets.data() + i * 3);
+        if (batchClosest[i] != single || batchClosest2[i] != single)
+        {
+            setFailed("tied closest point depends on query order at target " + AString::number(i));
+            return;
+        }
+    }
+}
@@ -0,0 +1,180 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "SurfaceSmoothingTest.h"
+
+#include "AlgorithmException.h"
+#include "AlgorithmSurfaceInflation.h"
+#include "AlgorithmSurfaceSmoothing.h"
+#include "MathFunctions.h"
+#include "SurfaceFile.h"
+#include "SurfaceSmoothingHelper.h"
+#include "TopologyHelper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+SurfaceSmoothingTest::SurfaceSmoothingTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+namespace
+{
+    //bumpy open grid, so both interior and boundary vertices are smoothed
+    void makeGridSurface(SurfaceFile& surfOut, const int& gridSize)
+    {
+        surfOut.setNumberOfNodesAndTriangles(gridSize * gridSize, 2 * (gridSize - 1) * (gridSize - 1));
+        for (int i = 0; i < gridSize; ++i)
+        {
+            for (int j = 0; j < gridSize; ++j)
+            {
+                float noise = 2.0f * rand() / RAND_MAX - 1.0f;
+                surfOut.setCoordinate(i * gridSize + j, i + 0.3f * noise, j - 0.2f * noise, sin(0.5f * i) * cos(0.3f * j) + noise);
+            }
+        }
+        int triangle = 0;
+        for (int i = 0; i < gridSize - 1; ++i)
+        {
+            for (int j = 0; j < gridSize - 1; ++j)
+            {
+                int corner = i * gridSize + j;
+                surfOut.setTriangle(triangle++, corner, corner + gridSize, corner + 1);
+                surfOut.setTriangle(triangle++, corner + 1, corner + gridSize, corner + gridSize + 1);
+            }
+        }
+    }
+    
+    //the serial loop that -surface-smoothing used before SurfaceSmoothingHelper
+    void oldSmoothing(const SurfaceFile& mySurf, vector<float>& coordsOut, const float& strength, const int& iterations)
+    {
+        CaretPointer<TopologyHelper> myTopoHelp = mySurf.getTopologyHelper(true);
+        const int32_t numNodes = mySurf.getNumberOfNodes();
+        vector<float> coordsIn(mySurf.getCoordinateData(), mySurf.getCoordinateData() + numNodes * 3);
+        coordsOut = coordsIn;
+        vector<float> triangleAreas(100), triangleCenters(100 * 3);
+        const float inverseStrength = 1.0 - strength;
+        for (int iter = 1; iter <= iterations; ++iter)
+        {
+            if (iter > 1) coordsIn = coordsOut;
+            for (int32_t iNode = 0; iNode < numNodes; ++iNode)
+            {
+                int32_t numNeighbors = 0;
+                const int32_t* neighbors = myTopoHelp->getNodeNeighbors(iNode, numNeighbors);
+                if (numNeighbors < 2)
+                {
+                    for (int k = 0; k < 3; ++k) coordsOut[iNode * 3 + k] = coordsIn[iNode * 3 + k];
+                    continue;
+                }
+                if (numNeighbors > (int32_t)triangleAreas.size())
+                {
+                    triangleAreas.resize(numNeighbors);
+                    triangleCenters.resize(numNeighbors * 3);
+                }
+                double totalArea = 0.0;
+                for (int jn = 0; jn < numNeighbors; ++jn)
+                {
+                    const int32_t n1 = neighbors[jn];
+                    const int32_t n2 = neighbors[(jn + 1 < numNeighbors) ? jn + 1 : 0];
+                    const float* c1 = &coordsIn[iNode * 3];
+                    const float* c2 = &coordsIn[n1 * 3];
+                    const float* c3 = &coordsIn[n2 * 3];
+                    const float area = MathFunctions::triangleArea(c1, c2, c3);
+                    triangleAreas[jn] = area;
+                    totalArea += area;
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        triangleCenters[jn * 3 + k] = (c1[k] + c2[k] + c3[k]) / 3.0;
+                    }
+                }
+                float neighborAverage[3] = { 0.0f, 0.0f, 0.0f };
+                for (int j = 0; j < numNeighbors; ++j)
+                {
+                    if (triangleAreas[j] > 0.0)
+                    {
+                        const float weight = triangleAreas[j] / totalArea;
+                        for (int k = 0; k < 3; ++k) neighborAverage[k] += weight * triangleCenters[j * 3 + k];
+                    }
+                }
+                for (int k = 0; k < 3; ++k)
+                {
+                    coordsOut[iNode * 3 + k] = coordsIn[iNode * 3 + k] * inverseStrength + neighborAverage[k] * strength;
+                }
+            }
+        }
+    }
+    
+    float maxDifference(const float* left, const float* right, const int64_t& count)
+    {
+        float ret = 0.0f;
+        for (int64_t i = 0; i < count; ++i)
+        {
+            ret = max(ret, abs(left[i] - right[i]));
+        }
+        return ret;
+    }
+}
+
+void SurfaceSmoothingTest::execute()
+{
+    const int GRID_SIZE = 30, ITERATIONS = 20;
+    const float STRENGTH = 0.7f, TOLERANCE = 1e-4f;
+    SurfaceFile mySurf;
+    makeGridSurface(mySurf, GRID_SIZE);
+    const int32_t numNodes = mySurf.getNumberOfNodes();
+    vector<float> oldCoords;
+    oldSmoothing(mySurf, oldCoords, STRENGTH, ITERATIONS);
+    SurfaceSmoothingHelper mySmoothHelp(&mySurf);
+    vector<float> helperCoords(mySurf.getCoordinateData(), mySurf.getCoordinateData() + numNodes * 3), scratch;
+    mySmoothHelp.smooth(helperCoords, scratch, STRENGTH, ITERATIONS);
+    float diff = maxDifference(helperCoords.data(), oldCoords.data(), numNodes * 3);
+    if (diff > TOLERANCE)
+    {
+        setFailed("smoothing helper differs from old smoothing by " + AString::number(diff));
+    }
+    SurfaceFile algSurf;
+    AlgorithmSurfaceSmoothing(NULL, &mySurf, &algSurf, STRENGTH, ITERATIONS);
+    diff = maxDifference(algSurf.getCoordinateData(), oldCoords.data(), numNodes * 3);
+    if (diff > TOLERANCE)
+    {
+        setFailed("-surface-smoothing differs from old smoothing by " + AString::number(diff));
+    }
+    const float badStrengths[] = { -0.5f, 1.5f, 0.5f };
+    const int32_t badIterations[] = { 10, 10, 0 };
+    for (int i = 0; i < 3; ++i)
+    {
+        bool threw = false;
+        try
+        {
+            SurfaceFile inflated;
+            AlgorithmSurfaceInflation(NULL, &mySurf, &mySurf, &inflated, 2, badStrengths[i], badIterations[i], 1.0f);
+        } catch (AlgorithmException&) {
+            threw = true;
+        }
+        if (!threw)
+        {
+            setFailed("-surface-inflation accepted strength " + AString::number(badStrengths[i]) + " with " + AString::number(badIterations[i]) + " iterations");
+        }
+    }
+}